@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace hft {
+
+    // Function: ByteRing
+    // Description: Lock-free Single-Producer-Single-Consumer ring of raw bytes for
+    //              variable-length records. Positions are free-running 64-bit counters,
+    //              so full/empty never alias; capacity must be a power of 2.
+    //              A write() is published with one release store, so the consumer never
+    //              sees half a record.
+    class ByteRing {
+    public:
+        explicit ByteRing(size_t capacity) : capacity_(capacity), mask_(capacity - 1) {
+            if (capacity == 0 || (capacity & (capacity - 1)) != 0) throw std::bad_alloc();
+            data_ = static_cast<char*>(std::aligned_alloc(64, capacity));
+            if (!data_) throw std::bad_alloc();
+        }
+
+        ~ByteRing() { std::free(data_); }
+
+        ByteRing(const ByteRing&) = delete;
+        ByteRing& operator=(const ByteRing&) = delete;
+
+        // Function: write
+        // Description: Producer side. Appends header and payload as one contiguous record.
+        // Inputs: header/header_len, payload/payload_len - Bytes to append (either may be empty).
+        // Outputs: Returns true if successful, false if there is not enough free space.
+        bool write(const void* header, size_t header_len, const void* payload, size_t payload_len) {
+            size_t total = header_len + payload_len;
+            uint64_t current_head = head_.load(std::memory_order_relaxed);
+            if (current_head + total - cached_tail_ > capacity_) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (current_head + total - cached_tail_ > capacity_) return false;
+            }
+
+            copy_in(current_head, header, header_len);
+            copy_in(current_head + header_len, payload, payload_len);
+            head_.store(current_head + total, std::memory_order_release);
+            return true;
+        }
+
+        // Function: readable
+        // Description: Consumer side. Bytes published and not yet consumed.
+        size_t readable() {
+            if (cached_head_ == read_pos_) cached_head_ = head_.load(std::memory_order_acquire);
+            return static_cast<size_t>(cached_head_ - read_pos_);
+        }
+
+        // Function: peek
+        // Description: Consumer side. Copies len bytes at the read position without consuming.
+        //              Caller must have checked readable() >= len.
+        void peek(void* out, size_t len) const {
+            size_t offset = read_pos_ & mask_;
+            size_t first = len < capacity_ - offset ? len : capacity_ - offset;
+            std::memcpy(out, data_ + offset, first);
+            std::memcpy(static_cast<char*>(out) + first, data_, len - first);
+        }
+
+        // Function: read
+        // Description: Consumer side. Copies and consumes len bytes (readable() >= len).
+        void read(void* out, size_t len) {
+            peek(out, len);
+            consume(len);
+        }
+
+        void consume(size_t len) {
+            read_pos_ += len;
+            tail_.store(read_pos_, std::memory_order_release);
+        }
+
+        size_t capacity() const { return capacity_; }
+
+        bool isEmpty() const {
+            return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+        }
+
+    private:
+        void copy_in(uint64_t pos, const void* src, size_t len) {
+            if (len == 0) return;
+            size_t offset = pos & mask_;
+            size_t first = len < capacity_ - offset ? len : capacity_ - offset;
+            std::memcpy(data_ + offset, src, first);
+            std::memcpy(data_, static_cast<const char*>(src) + first, len - first);
+        }
+
+        char* data_ = nullptr;
+        const size_t capacity_;
+        const size_t mask_;
+
+        // Producer-owned line
+        alignas(64) std::atomic<uint64_t> head_{0};
+        uint64_t cached_tail_ = 0;
+
+        // Consumer-owned line
+        alignas(64) std::atomic<uint64_t> tail_{0};
+        uint64_t read_pos_ = 0;
+        uint64_t cached_head_ = 0;
+    };
+
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "common/Utils.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace hft::decimal {
+
+    // Fractional digits of our fixed point scale (1e-8, Satoshis)
+    constexpr size_t SCALE_DIGITS = 8;
+
+    // Function: parse_eight_digits
+    // Description: SWAR conversion of 8 ASCII digits (first digit in the lowest byte)
+    //              into their integer value, using three multiplies instead of eight.
+    inline uint32_t parse_eight_digits(uint64_t chunk) {
+        constexpr uint64_t MASK = 0x000000FF000000FFULL;
+        constexpr uint64_t MUL1 = 0x000F424000000064ULL; // 100 + (1000000ULL << 32)
+        constexpr uint64_t MUL2 = 0x0000271000000001ULL; // 1 + (10000ULL << 32)
+        chunk -= 0x3030303030303030ULL;
+        chunk = (chunk * 10) + (chunk >> 8);
+        chunk = (((chunk & MASK) * MUL1) + (((chunk >> 16) & MASK) * MUL2)) >> 32;
+        return static_cast<uint32_t>(chunk);
+    }
+
+    // Function: load_digits
+    // Description: Loads up to 8 digits into a SWAR chunk. Integer digits are right-aligned
+    //              (left-padded with '0'), fractional digits left-aligned (right-padded with '0'),
+    //              so the chunk value is already at the right magnitude. Never reads past len.
+    inline uint64_t load_digits(const char* p, size_t len, bool right_align) {
+        uint64_t chunk = 0x3030303030303030ULL;
+        if (len == 8) {
+            std::memcpy(&chunk, p, 8);
+        } else if (len > 0) {
+            char tmp[8];
+            std::memcpy(tmp, &chunk, 8);
+            std::memcpy(tmp + (right_align ? 8 - len : 0), p, len);
+            std::memcpy(&chunk, tmp, 8);
+        }
+        return chunk;
+    }
+
+    // Function: parse_fixed
+    // Description: Parses a plain decimal string ("-123.456") into int64 fixed point with
+    //              SCALE_DIGITS fractional digits. No allocation, no floating point.
+    //              Digits beyond the scale are rounded half away from zero, so "0.1" is
+    //              exactly 10000000 and "0.123456785" is 12345679.
+    // Inputs: str - Decimal string (optional sign, digits, optional '.', digits).
+    //         out - Result in 1e-8 units.
+    // Outputs: False on malformed input or overflow (out untouched).
+    inline bool parse_fixed(std::string_view str, int64_t& out) {
+        const char* p = str.data();
+        const char* end = p + str.size();
+
+        bool negative = false;
+        if (p != end && (*p == '-' || *p == '+')) {
+            negative = (*p == '-');
+            ++p;
+        }
+
+        // 1. Integer part
+        const char* int_begin = p;
+        while (p != end && static_cast<unsigned char>(*p - '0') < 10) ++p;
+        size_t int_len = static_cast<size_t>(p - int_begin);
+
+        // Skip leading zeros so long zero-padded inputs still fit the 16 digit window
+        while (int_len > 1 && *int_begin == '0') {
+            ++int_begin;
+            --int_len;
+        }
+        if (int_len > 16) return false;
+
+        uint64_t int_value = 0;
+        if (int_len > 8) {
+            uint64_t hi = load_digits(int_begin, int_len - 8, true);
+            uint64_t lo = load_digits(int_begin + int_len - 8, 8, true);
+            int_value = static_cast<uint64_t>(parse_eight_digits(hi)) * 100000000ULL + parse_eight_digits(lo);
+        } else {
+            int_value = parse_eight_digits(load_digits(int_begin, int_len, true));
+        }
+
+        // 2. Fractional part
+        size_t frac_len = 0;
+        uint64_t frac_value = 0;
+        bool round_up = false;
+        if (p != end && *p == '.') {
+            ++p;
+            const char* frac_begin = p;
+            while (p != end && static_cast<unsigned char>(*p - '0') < 10) ++p;
+            frac_len = static_cast<size_t>(p - frac_begin);
+
+            size_t kept = frac_len < SCALE_DIGITS ? frac_len : SCALE_DIGITS;
+            frac_value = parse_eight_digits(load_digits(frac_begin, kept, false));
+
+            // First dropped digit decides rounding (half away from zero)
+            if (frac_len > SCALE_DIGITS) {
+                round_up = frac_begin[SCALE_DIGITS] >= '5';
+            }
+        }
+
+        // 3. Validation: something was parsed and nothing trails it
+        if (p != end || (int_len == 0 && frac_len == 0)) return false;
+
+        // 4. Combine with overflow check
+        constexpr uint64_t SCALE = static_cast<uint64_t>(constants::PRICE_SCALE);
+        constexpr uint64_t MAX_INT = static_cast<uint64_t>(INT64_MAX) / SCALE;
+        if (int_value > MAX_INT) return false;
+        uint64_t magnitude = int_value * SCALE + frac_value + (round_up ? 1 : 0);
+        if (magnitude > static_cast<uint64_t>(INT64_MAX)) return false;
+
+        out = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+        return true;
+    }
+
+    // Function: scale_decimal
+    // Description: Rescales a binary decimal (mantissa * 10^exponent, as carried by SBE
+    //              Decimal64 fields) to SCALE_DIGITS fixed point. Extra digits are rounded
+    //              half away from zero, like parse_fixed, so both feeds agree to the unit.
+    // Inputs: mantissa, exponent - Wire value.
+    //         out - Result in 1e-8 units.
+    // Outputs: False on overflow (out untouched).
+    inline bool scale_decimal(int64_t mantissa, int exponent, int64_t& out) {
+        static constexpr uint64_t POW10[20] = {
+            1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+            100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+            10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+            100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL};
+
+        int shift = exponent + static_cast<int>(SCALE_DIGITS);
+        if (shift == 0) {
+            out = mantissa;
+            return true;
+        }
+
+        bool negative = mantissa < 0;
+        uint64_t magnitude = negative ? 0ULL - static_cast<uint64_t>(mantissa) : static_cast<uint64_t>(mantissa);
+        if (shift > 0) {
+            // More precision needed than the wire carries: exact multiply
+            if (shift >= 20) {
+                if (magnitude != 0) return false;
+            } else if (__builtin_mul_overflow(magnitude, POW10[shift], &magnitude)) {
+                return false;
+            }
+            if (magnitude > static_cast<uint64_t>(INT64_MAX)) return false;
+        } else {
+            // Finer than 1e-8: drop digits, first dropped digit decides rounding
+            int drop = -shift;
+            if (drop >= 20) {
+                magnitude = 0;
+            } else {
+                uint64_t divisor = POW10[drop];
+                uint64_t remainder = magnitude % divisor;
+                magnitude = magnitude / divisor + (remainder >= divisor / 2 ? 1 : 0);
+            }
+        }
+
+        out = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+        return true;
+    }
+
+}
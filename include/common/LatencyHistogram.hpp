@@ -0,0 +1,148 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include "common/Utils.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+namespace hft {
+
+    // Function: LatencyHistogram
+    // Description: Fixed-size log-linear histogram of nanosecond values (~12% bucket width).
+    //              Single writer; counters are relaxed atomics so another thread can read
+    //              live percentiles without locking. No allocation after construction.
+    class LatencyHistogram {
+        static constexpr int SUB_BITS = 3;                 // 8 sub-buckets per power of two
+        static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+        static constexpr int BUCKETS = 64 * SUB_BUCKETS;
+
+    public:
+        void record(uint64_t value_ns) {
+            size_t idx = bucket_of(value_ns);
+            // Single writer: load + store is enough and avoids a locked RMW
+            counts_[idx].store(counts_[idx].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (value_ns > max_.load(std::memory_order_relaxed)) max_.store(value_ns, std::memory_order_relaxed);
+        }
+
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+        // Function: percentile
+        // Description: Upper bound of the bucket holding the q-th quantile (q in [0, 1]).
+        uint64_t percentile(double q) const {
+            uint64_t total = count();
+            if (total == 0) return 0;
+            uint64_t target = static_cast<uint64_t>(q * total);
+            if (target >= total) target = total - 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                seen += counts_[i].load(std::memory_order_relaxed);
+                if (seen > target) return std::min(bucket_upper(i), max());
+            }
+            return max();
+        }
+
+    private:
+        static size_t bucket_of(uint64_t v) {
+            if (v < SUB_BUCKETS) return v;
+            int msb = 63 - __builtin_clzll(v);
+            size_t sub = (v >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1);
+            return static_cast<size_t>(msb - SUB_BITS + 1) * SUB_BUCKETS + sub;
+        }
+
+        static uint64_t bucket_upper(size_t idx) {
+            if (idx < SUB_BUCKETS) return idx;
+            int msb = static_cast<int>(idx / SUB_BUCKETS) + SUB_BITS - 1;
+            uint64_t sub = idx % SUB_BUCKETS;
+            uint64_t base = (SUB_BUCKETS + sub) << (msb - SUB_BITS);
+            return base + (1ULL << (msb - SUB_BITS)) - 1;
+        }
+
+        std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+
+    // Function: LatencyAttribution
+    // Description: Per-hop histograms built from OrderTimestamps, from exchange event
+    //              time through to the exchange ack. Recorded by the gateway thread.
+    class LatencyAttribution {
+    public:
+        enum Hop : size_t {
+            EXCHANGE_TO_RX,   // Exchange event -> receive (wall clock, includes clock offset)
+            RX_TO_READ,       // Kernel/NIC RX timestamp -> socket read (socket queue, TLS decrypt)
+            READ_TO_PARSE,    // Socket read -> tick built
+            PARSE_TO_POP,     // Feed -> strategy ring
+            POP_TO_DECISION,  // Strategy logic
+            DECISION_TO_GW,   // Strategy -> gateway ring
+            GW_TO_RISK,       // Pre-trade risk
+            RISK_TO_WIRE,     // JSON build + HTTP write
+            WIRE_TO_ACK,      // Exchange round trip
+            TICK_TO_WIRE,     // Receive -> bytes on wire
+            HOP_COUNT
+        };
+
+        static const char* hop_name(size_t hop) {
+            static constexpr const char* names[HOP_COUNT] = {
+                "exchange_to_rx", "rx_to_read", "read_to_parse", "parse_to_pop", "pop_to_decision",
+                "decision_to_gateway", "gateway_to_risk", "risk_to_wire", "wire_to_ack", "tick_to_wire"
+            };
+            return names[hop];
+        }
+
+        void record(const OrderTimestamps& s) {
+            if (s.rx_tsc == 0) return;
+
+            if (s.exchange_to_rx_ns != 0) hops_[EXCHANGE_TO_RX].record(s.exchange_to_rx_ns);
+
+            // Only receive paths with kernel/NIC timestamps split receive from read
+            if (s.read != 0) hops_[RX_TO_READ].record(to_ns(s.read));
+
+            // Consecutive TSC stamps from the read; skip hops whose end was never reached
+            const uint32_t stamps[] = {s.read, s.parse, s.strategy_pop, s.decision, s.gateway_pop, s.risk, s.wire, s.ack};
+            for (size_t i = 1; i < sizeof(stamps) / sizeof(stamps[0]); ++i) {
+                if (stamps[i] == 0 || (i > 1 && stamps[i - 1] == 0)) continue;
+                uint32_t d = stamps[i] >= stamps[i - 1] ? stamps[i] - stamps[i - 1] : 0;
+                hops_[READ_TO_PARSE + i - 1].record(to_ns(d));
+            }
+            if (s.wire != 0) hops_[TICK_TO_WIRE].record(to_ns(s.wire));
+        }
+
+        const LatencyHistogram& hop(size_t h) const { return hops_[h]; }
+
+        // Function: print
+        // Description: Writes a percentile table (safe to call while recording).
+        void print(FILE* out) const {
+            fprintf(out, "%-20s %10s %12s %12s %12s %12s\n", "hop", "count", "p50_ns", "p99_ns", "p99.9_ns", "max_ns");
+            for (size_t h = 0; h < HOP_COUNT; ++h) {
+                const auto& hist = hops_[h];
+                fprintf(out, "%-20s %10lu %12lu %12lu %12lu %12lu\n", hop_name(h),
+                        hist.count(), hist.percentile(0.5), hist.percentile(0.99), hist.percentile(0.999), hist.max());
+            }
+        }
+
+        void save_to_csv(const std::string& filename) const {
+            FILE* f = fopen(filename.c_str(), "w");
+            if (!f) return;
+            fprintf(f, "hop,count,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n");
+            for (size_t h = 0; h < HOP_COUNT; ++h) {
+                const auto& hist = hops_[h];
+                fprintf(f, "%s,%lu,%lu,%lu,%lu,%lu,%lu\n", hop_name(h), hist.count(),
+                        hist.percentile(0.5), hist.percentile(0.9), hist.percentile(0.99), hist.percentile(0.999), hist.max());
+            }
+            fclose(f);
+        }
+
+    private:
+        static uint64_t to_ns(uint32_t cycles) {
+            return static_cast<uint64_t>(cycles / utils::CYCLES_PER_NS);
+        }
+
+        std::array<LatencyHistogram, HOP_COUNT> hops_;
+    };
+
+}
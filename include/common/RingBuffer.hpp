@@ -42,6 +42,26 @@ namespace hft {
             return true;
         }
 
+        // Function: push_batch
+        // Description: Pushes count items with a single head update, so the consumer sees
+        //              either none or all of them. All or nothing.
+        // Inputs: items - The data to push.
+        //         count - Number of items (at most capacity()).
+        // Outputs: Returns true if successful, false if fewer than count slots are free.
+        bool push_batch(const T* items, size_t count) {
+            size_t current_head = head.load(std::memory_order_relaxed);
+            size_t free_slots = (tail.load(std::memory_order_acquire) - current_head - 1) & (Size - 1);
+            if (count > free_slots) {
+                return false;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                buffer[(current_head + i) & (Size - 1)].value = items[i];
+            }
+            head.store((current_head + count) & (Size - 1), std::memory_order_release);
+            return true;
+        }
+
         // Function: pop
         // Description: Pops an item from the buffer.
         // Inputs: item - Reference to store the popped data.
@@ -58,6 +78,8 @@ namespace hft {
             return true;
         }
 
+        static constexpr size_t capacity() { return Size - 1; }
+
         size_t size() const {
             size_t current_head = head.load(std::memory_order_relaxed);
             size_t current_tail = tail.load(std::memory_order_relaxed);
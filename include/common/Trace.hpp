@@ -0,0 +1,221 @@
+#pragma once
+
+#include "common/RingBuffer.hpp"
+#include "common/Utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Hot-path trace points.
+// Compiled in only with -DHFT_TRACING (CMake: -DENABLE_TRACING=ON). Otherwise every
+// TRACE_* macro expands to nothing and the hot path carries no extra instructions.
+//
+// Each thread records TSC-stamped spans into its own SPSC ring. A background exporter
+// drains all rings and writes Chrome trace JSON (load in chrome://tracing or ui.perfetto.dev).
+
+namespace hft::trace {
+
+    enum class Stage : uint8_t {
+        WS_RECEIVE,
+        JSON_PARSE,
+        RING_PUSH,
+        RING_POP,
+        BOOK_UPDATE,
+        OFI,
+        DECISION,
+        ORDER_PUSH,
+        RISK,
+        JSON_BUILD,
+        HTTP_WRITE,
+        HTTP_READ,
+        COUNT
+    };
+
+    inline const char* stage_name(Stage stage) {
+        switch (stage) {
+            case Stage::WS_RECEIVE:  return "ws_receive";
+            case Stage::JSON_PARSE:  return "json_parse";
+            case Stage::RING_PUSH:   return "ring_push";
+            case Stage::RING_POP:    return "ring_pop";
+            case Stage::BOOK_UPDATE: return "book_update";
+            case Stage::OFI:         return "ofi";
+            case Stage::DECISION:    return "decision";
+            case Stage::ORDER_PUSH:  return "order_push";
+            case Stage::RISK:        return "risk";
+            case Stage::JSON_BUILD:  return "json_build";
+            case Stage::HTTP_WRITE:  return "http_write";
+            case Stage::HTTP_READ:   return "http_read";
+            default:                 return "unknown";
+        }
+    }
+
+    struct TraceEvent {
+        uint64_t begin_tsc;
+        uint64_t end_tsc;
+        Stage stage;
+    };
+
+    // Per-thread span buffer. Written only by its owner thread, drained by the exporter.
+    struct ThreadBuffer {
+        RingBuffer<TraceEvent, 16384> events;
+        std::atomic<uint64_t> dropped{0};
+        uint32_t tid = 0;
+        char name[32] = {};
+    };
+
+    // Function: TraceCollector
+    // Description: Registry of per-thread buffers plus the background exporter thread.
+    class TraceCollector {
+    public:
+        static TraceCollector& instance() {
+            static TraceCollector instance;
+            return instance;
+        }
+
+        // Function: register_thread
+        // Description: Creates (once) the calling thread's buffer. Takes a lock; call at thread start.
+        ThreadBuffer* register_thread(const char* name) {
+            if (tls_buffer_) return tls_buffer_;
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->tid = static_cast<uint32_t>(buffers_.size() + 1);
+            snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+            tls_buffer_ = buffer.get();
+            buffers_.push_back(std::move(buffer));
+            return tls_buffer_;
+        }
+
+        // Function: emit
+        // Description: Records one span. Never blocks; drops (and counts) if the ring is full.
+        void emit(Stage stage, uint64_t begin_tsc, uint64_t end_tsc) {
+            ThreadBuffer* buffer = tls_buffer_;
+            if (!buffer) [[unlikely]] buffer = register_thread("thread");
+            if (!buffer->events.push({begin_tsc, end_tsc, stage})) {
+                buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void start(const std::string& filename) {
+            file_ = fopen(filename.c_str(), "w");
+            if (!file_) return;
+            base_tsc_ = utils::rdtsc();
+            fprintf(file_, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+            first_event_ = true;
+            running_ = true;
+            thread_ = std::thread(&TraceCollector::run, this);
+        }
+
+        void stop() {
+            if (!running_) return;
+            running_ = false;
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+            drain();
+            write_thread_names();
+            fprintf(file_, "\n]}\n");
+            fclose(file_);
+            file_ = nullptr;
+
+            uint64_t dropped = 0;
+            for (const auto& buffer : buffers_) dropped += buffer->dropped.load(std::memory_order_relaxed);
+            std::cout << "[Trace] Wrote " << written_ << " spans (" << dropped << " dropped)" << std::endl;
+        }
+
+    private:
+        TraceCollector() = default;
+        ~TraceCollector() { stop(); }
+
+        void run() {
+            utils::pin_thread_to_core(constants::LOGGER_CORE);
+            while (running_) {
+                // Keep draining while there is work, back off when idle
+                if (drain() == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+
+        size_t drain() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            TraceEvent event;
+            size_t count = 0;
+            for (const auto& buffer : buffers_) {
+                while (buffer->events.pop(event)) {
+                    write_event(buffer->tid, event);
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+        void write_event(uint32_t tid, const TraceEvent& event) {
+            // Chrome "complete" event: ts and dur in microseconds
+            double ts_us = static_cast<double>(static_cast<int64_t>(event.begin_tsc - base_tsc_)) / utils::CYCLES_PER_NS / 1000.0;
+            double dur_us = static_cast<double>(event.end_tsc - event.begin_tsc) / utils::CYCLES_PER_NS / 1000.0;
+            fprintf(file_, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    first_event_ ? "" : ",\n", stage_name(event.stage), tid, ts_us, dur_us);
+            first_event_ = false;
+            ++written_;
+        }
+
+        void write_thread_names() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& buffer : buffers_) {
+                fprintf(file_, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                        first_event_ ? "" : ",\n", buffer->tid, buffer->name);
+                first_event_ = false;
+            }
+        }
+
+        static inline thread_local ThreadBuffer* tls_buffer_ = nullptr;
+
+        std::mutex mutex_;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+        std::atomic<bool> running_{false};
+        std::thread thread_;
+        FILE* file_ = nullptr;
+        uint64_t base_tsc_ = 0;
+        uint64_t written_ = 0;
+        bool first_event_ = true;
+    };
+
+    // Function: Scope
+    // Description: RAII span from construction to destruction.
+    class Scope {
+    public:
+        explicit Scope(Stage stage) : stage_(stage), begin_(utils::rdtsc()) {}
+        ~Scope() { TraceCollector::instance().emit(stage_, begin_, utils::rdtsc()); }
+
+    private:
+        Stage stage_;
+        uint64_t begin_;
+    };
+
+}
+
+#define HFT_TRACE_CONCAT_INNER(a, b) a##b
+#define HFT_TRACE_CONCAT(a, b) HFT_TRACE_CONCAT_INNER(a, b)
+
+#ifdef HFT_TRACING
+// Span covering the rest of the enclosing block
+#define TRACE_SCOPE(stage) hft::trace::Scope HFT_TRACE_CONCAT(trace_scope_, __LINE__)(hft::trace::Stage::stage)
+// Explicit span: TRACE_BEGIN(var) ... TRACE_END(stage, var)
+#define TRACE_BEGIN(var) uint64_t var = hft::utils::rdtsc()
+#define TRACE_END(stage, var) hft::trace::TraceCollector::instance().emit(hft::trace::Stage::stage, var, hft::utils::rdtsc())
+#define TRACE_THREAD(name) hft::trace::TraceCollector::instance().register_thread(name)
+#define TRACE_START(filename) hft::trace::TraceCollector::instance().start(filename)
+#define TRACE_STOP() hft::trace::TraceCollector::instance().stop()
+#else
+#define TRACE_SCOPE(stage) ((void)0)
+#define TRACE_BEGIN(var) ((void)0)
+#define TRACE_END(stage, var) ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+#define TRACE_START(filename) ((void)0)
+#define TRACE_STOP() ((void)0)
+#endif
@@ -19,7 +19,7 @@ namespace hft {
     // Optimized binary structure for memory mapping
     // Aligned to 64 bytes to prevent false sharing and optimize cache line usage
     struct alignas(64) BinaryTick {
-        uint64_t id;
+        uint64_t id;      // Live feed: message sequence number. Tick files: record index
         uint64_t timestamp;
         int64_t price;    // Fixed point: Satoshis (1e-8)
         int64_t quantity; // Fixed point: Satoshis (1e-8)
@@ -27,7 +27,74 @@ namespace hft {
         bool is_bid;
         bool is_trade;    // True = Trade, False = Depth Update
         bool is_snapshot; // True = Snapshot (Clear book), False = Update
-        // Implicit padding to 64 bytes
+        bool end_of_message; // True = Last tick decoded from one feed message
+        uint32_t rx_read_delta;      // TSC cycles from rx_timestamp to the userspace read (0 = rx_timestamp is the read)
+        uint64_t exchange_timestamp; // Exchange event time, ns since Unix epoch (0 = unknown)
+        uint64_t rx_timestamp;       // TSC when the carrying message was received: its kernel/NIC
+                                     // RX timestamp where the socket provides one, else the read
+
+        // Receive time from the TSC of the read and the kernel/NIC RX timestamp on the TSC
+        // timebase (0 = none). A stamp after the read (clock skew) is not trusted.
+        void set_rx(uint64_t read_tsc, uint64_t stamp_tsc) {
+            if (stamp_tsc == 0 || stamp_tsc > read_tsc) {
+                rx_timestamp = read_tsc;
+                rx_read_delta = 0;
+                return;
+            }
+            uint64_t d = read_tsc - stamp_tsc;
+            rx_timestamp = stamp_tsc;
+            rx_read_delta = d > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(d);
+        }
+    };
+    static_assert(sizeof(BinaryTick) == 64, "BinaryTick must stay one cache line");
+
+    struct Order;
+
+    // Function: OrderTimestamps
+    // Description: Tick-to-wire timestamp vector of one order, completed by the gateway.
+    //              Hops are stored as TSC deltas from rx_tsc to keep the struct compact;
+    //              a delta of 0 means the hop was not reached. Deltas saturate at UINT32_MAX.
+    struct OrderTimestamps {
+        uint64_t rx_tsc = 0;            // Receive: kernel/NIC RX timestamp, else the socket read
+        uint32_t exchange_to_rx_ns = 0; // Exchange event -> receive, wall clock (0 = unknown)
+        uint32_t read = 0;              // Socket read, when rx_tsc is a kernel/NIC timestamp
+        uint32_t parse = 0;             // Parse done / tick constructed
+        uint32_t strategy_pop = 0;      // Strategy popped the tick
+        uint32_t decision = 0;          // Order constructed
+        uint32_t gateway_pop = 0;       // Gateway popped the order
+        uint32_t risk = 0;              // Risk checks passed
+        uint32_t wire = 0;              // Request bytes written to the socket
+        uint32_t ack = 0;               // Exchange response read
+
+        static uint32_t delta(uint64_t base, uint64_t tsc) {
+            if (tsc <= base) return 1; // Reached, but not after base (clock skew)
+            uint64_t d = tsc - base;
+            return d > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(d);
+        }
+
+        // The strategy's hops carried by an order; the gateway fills in the rest
+        static OrderTimestamps from(const Order& order);
+    };
+
+    // Function: OrderStamps
+    // Description: The strategy's part of OrderTimestamps, small enough to keep Order in one
+    //              cache line. The receive time is not carried: it is origin_timestamp (the
+    //              tick's construction) minus parse.
+    struct OrderStamps {
+        uint32_t exchange_to_rx_ns = 0;
+        uint32_t read = 0;
+        uint32_t parse = 0;
+        uint32_t strategy_pop = 0;
+        uint32_t decision = 0;
+    };
+
+    // Function: OrderAction
+    // Description: What an Order message asks the venue to do.
+    //              CANCEL and REPLACE refer to a previously placed order by its id.
+    enum class OrderAction : uint8_t {
+        NEW,
+        CANCEL,
+        REPLACE // Amend price/quantity of a resting order (loses queue priority)
     };
 
     // Function: Order
@@ -40,6 +107,21 @@ namespace hft {
         int64_t quantity; // Fixed point: Satoshis
         uint64_t symbol;  // Encoded symbol
         bool is_buy;
+        OrderAction action = OrderAction::NEW;
+        OrderStamps stamps;
     };
+    static_assert(sizeof(Order) == 64, "Order must stay one cache line");
+
+    inline OrderTimestamps OrderTimestamps::from(const Order& order) {
+        OrderTimestamps t;
+        if (order.stamps.parse == 0) return t; // Not stamped
+        t.rx_tsc = order.origin_timestamp - order.stamps.parse;
+        t.exchange_to_rx_ns = order.stamps.exchange_to_rx_ns;
+        t.read = order.stamps.read;
+        t.parse = order.stamps.parse;
+        t.strategy_pop = order.stamps.strategy_pop;
+        t.decision = order.stamps.decision;
+        return t;
+    }
 
 }
@@ -7,6 +7,10 @@
 #include <sched.h>
 #include <cstring>
 #include <cstdio>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <time.h>
 
 #if defined(__x86_64__) || defined(_M_X64)
 #include <immintrin.h>
@@ -39,6 +43,10 @@ namespace hft::utils {
     // cycles per nanosecond (calibrated at startup)
     inline double CYCLES_PER_NS = 3.0;
 
+    // Wall-clock anchor for the TSC (set by calibrate_tsc)
+    inline uint64_t TSC_ANCHOR = 0;
+    inline int64_t UNIX_NS_ANCHOR = 0;
+
     // Function: rdtsc
     // Description: Reads the Time Stamp Counter (TSC) for high-precision timing.
     //              Uses rte_rdtsc() if DPDK is enabled, otherwise lfence; rdtsc.
@@ -84,9 +92,98 @@ namespace hft::utils {
         uint64_t cycles = end_tsc - start_tsc;
         
         CYCLES_PER_NS = static_cast<double>(cycles) / duration_ns;
+
+        TSC_ANCHOR = rdtsc();
+        UNIX_NS_ANCHOR = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
         std::cout << "[System] Calibrated TSC Frequency: " << (CYCLES_PER_NS * 1.0) << " GHz" << std::endl;
     }
 
+    // Function: tsc_to_unix_ns
+    // Description: Converts a TSC reading to wall-clock ns since the Unix epoch.
+    // Inputs: tsc - Cycle count from rdtsc().
+    // Outputs: ns since epoch (valid after calibrate_tsc).
+    inline int64_t tsc_to_unix_ns(uint64_t tsc) {
+        int64_t delta_cycles = static_cast<int64_t>(tsc - TSC_ANCHOR);
+        return UNIX_NS_ANCHOR + static_cast<int64_t>(delta_cycles / CYCLES_PER_NS);
+    }
+
+    // Function: realtime_ns
+    // Description: CLOCK_REALTIME in ns since the Unix epoch (vDSO, no syscall).
+    inline uint64_t realtime_ns() {
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+    }
+
+    // Function: realtime_to_tsc
+    // Description: Moves a CLOCK_REALTIME time (a kernel or PHC-synchronized NIC receive
+    //              timestamp) onto the TSC timebase. Its age against a (now_tsc, now_ns) pair
+    //              read back to back is taken off now_tsc, so calibration error only scales
+    //              the age (microseconds), not the time since calibrate_tsc. One pair serves a
+    //              whole receive batch.
+    // Inputs: unix_ns - ns since epoch. now_tsc, now_ns - rdtsc() and realtime_ns() just read.
+    // Outputs: TSC of unix_ns (now_tsc for a time in the future, e.g. after a clock step).
+    inline uint64_t realtime_to_tsc(uint64_t unix_ns, uint64_t now_tsc, uint64_t now_ns) {
+        if (unix_ns >= now_ns) return now_tsc;
+        uint64_t age_cycles = static_cast<uint64_t>((now_ns - unix_ns) * CYCLES_PER_NS);
+        return age_cycles < now_tsc ? now_tsc - age_cycles : now_tsc;
+    }
+
+    // Function: parse_iso8601_ns
+    // Description: Parses an exchange timestamp like "2023-02-09T20:32:50.714964855Z".
+    //              Fractional seconds are optional; digits past the ninth are truncated.
+    //              Only 'Z' (UTC) is supported, and it must end the string.
+    // Inputs: ts - The timestamp string.
+    // Outputs: ns since epoch, or 0 if malformed or before 1970.
+    inline uint64_t parse_iso8601_ns(std::string_view ts) {
+        if (ts.size() < 20 || ts[4] != '-' || ts[7] != '-' || ts[10] != 'T' || ts[13] != ':' || ts[16] != ':') return 0;
+
+        bool valid = true;
+        auto num = [&](size_t pos, size_t len) {
+            int v = 0;
+            for (size_t i = pos; i < pos + len; ++i) {
+                unsigned digit = static_cast<unsigned>(ts[i] - '0');
+                valid &= digit <= 9;
+                v = v * 10 + static_cast<int>(digit);
+            }
+            return v;
+        };
+        int y = num(0, 4);
+        unsigned m = num(5, 2);
+        unsigned d = num(8, 2);
+        int hh = num(11, 2);
+        int mm = num(14, 2);
+        int ss = num(17, 2);
+        if (!valid || y < 1970 || m < 1 || m > 12 || hh > 23 || mm > 59 || ss > 59) return 0;
+        static constexpr unsigned MONTH_DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+        if (d < 1 || d > MONTH_DAYS[m - 1] + (m == 2 && leap)) return 0;
+
+        uint64_t frac = 0;
+        size_t pos = 19;
+        if (ts[pos] == '.') {
+            size_t digits = 0;
+            for (++pos; pos < ts.size() && ts[pos] >= '0' && ts[pos] <= '9'; ++pos, ++digits) {
+                if (digits < 9) frac = frac * 10 + (ts[pos] - '0');
+            }
+            if (digits == 0) return 0;
+            for (; digits < 9; ++digits) frac *= 10;
+        }
+        if (pos + 1 != ts.size() || ts[pos] != 'Z') return 0; // Offsets and trailing bytes
+
+        // Days from civil (Howard Hinnant)
+        y -= m <= 2;
+        int era = (y >= 0 ? y : y - 399) / 400;
+        unsigned yoe = static_cast<unsigned>(y - era * 400);
+        unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        int64_t days = static_cast<int64_t>(era) * 146097 + static_cast<int64_t>(doe) - 719468;
+
+        int64_t secs = days * 86400 + hh * 3600 + mm * 60 + ss;
+        return static_cast<uint64_t>(secs) * 1000000000ULL + frac;
+    }
+
     // Function: pin_thread_to_core
     // Description: Pins the current thread to a specific CPU core.
     // Inputs: core_id - The ID of the core to pin to.
@@ -3,11 +3,16 @@
 #include "common/RingBuffer.hpp"
 #include "common/Types.hpp"
 #include "common/Utils.hpp"
+#include "common/LatencyHistogram.hpp"
 #include "execution/CoinbaseAuth.hpp"
 #include "strategy/RiskManager.hpp"
 #include <atomic>
 #include <thread>
 #include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/ssl.hpp>
@@ -74,16 +79,22 @@ namespace hft {
         // Description: Stops the execution thread.
         void stop();
 
+        // Function: print_latency_attribution
+        // Description: Prints live per-hop tick-to-wire percentiles (callable from any thread).
+        void print_latency_attribution() const;
+
     private:
         void run();
         void connect();
         void reconcile_loop();
+        void prune_live_orders();
 
         RingBuffer<Order, constants::RING_BUFFER_SIZE>& input_buffer_;
         std::atomic<bool> running_{false};
         std::thread thread_;
         std::thread reconcile_thread_;
         std::vector<uint64_t> latencies_; 
+        LatencyAttribution attribution_; // Per-hop histograms from Order::stamps
         std::vector<Order> executed_orders_;
 
         // Boost Beast & Auth
@@ -102,10 +113,36 @@ namespace hft {
         char auth_header_buffer_[1200];
 
         // JWT Caching
-        std::string cached_jwt_;
-        std::chrono::steady_clock::time_point jwt_expiry_;
+        // The JWT 'uri' claim is bound to one request path, so each endpoint keeps its own token.
+        struct CachedJwt {
+            const char* path;
+            std::string token;
+            std::chrono::steady_clock::time_point expiry;
+        };
+        CachedJwt order_jwt_{"/api/v3/brokerage/orders", {}, {}};
+        CachedJwt cancel_jwt_{"/api/v3/brokerage/orders/batch_cancel", {}, {}};
+        CachedJwt edit_jwt_{"/api/v3/brokerage/orders/edit", {}, {}};
         std::mutex jwt_mutex_;
-        void update_jwt();
+        void update_jwt(CachedJwt& jwt);
+
+        // Orders acknowledged by the exchange, keyed by our client order id.
+        // Needed to address CANCEL/REPLACE and to release their risk reservation.
+        // Left by a confirmed cancel, or once reconciliation no longer lists them as open.
+        struct LiveOrder {
+            std::string exchange_order_id;
+            Order order;
+            std::chrono::steady_clock::time_point acked_at;
+        };
+        std::unordered_map<uint64_t, LiveOrder> live_orders_;
+
+        // Open exchange order ids, listed by the reconcile thread, applied by the order thread
+        struct OpenOrders {
+            std::unordered_set<std::string> ids;
+            std::chrono::steady_clock::time_point requested_at;
+        };
+        std::mutex open_orders_mutex_;
+        OpenOrders open_orders_;
+        std::atomic<bool> open_orders_ready_{false};
     };
 
 }
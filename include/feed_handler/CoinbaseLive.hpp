@@ -4,6 +4,12 @@
 #include "../common/RingBuffer.hpp"
 #include "../common/Types.hpp"
 #include "../common/Utils.hpp"
+#include "../common/Trace.hpp"
+#include "../common/DecimalParser.hpp"
+#include "../network/WebSocketClient.hpp"
+#include "LineArbiter.hpp"
+#include "RecoveryStats.hpp"
+#include "../storage/CaptureWriter.hpp"
 
 // Parsing and Networking
 #include "simdjson.h"
@@ -18,11 +24,29 @@
 #include <thread>
 #include <chrono>
 #include <cstring> // For optimization (memcmp)
-#include <fstream>
+#include <memory>
+#include <mutex>
+#include <algorithm>
 
 namespace hft {
 
+    // WebSocket implementation used by the feed handler
+    enum class WsTransport : uint8_t {
+        IXWEBSOCKET, // Library-owned thread, one std::string per frame
+        NATIVE       // network::WebSocketClient busy-polled on our own pinned thread
+    };
+
+    static_assert(network::WebSocketClient::PADDING >= simdjson::SIMDJSON_PADDING,
+                  "Native frames must be parseable in place");
+
     class CoinbaseFeedHandler {
+        // Batch capacity reserved up front; only snapshots deeper than this grow it
+        static constexpr size_t MESSAGE_BATCH_RESERVE = 4096;
+
+        // Recovery gives up and reconnects past either limit
+        static constexpr uint64_t RECOVERY_TIMEOUT_NS = 5000000000ULL;
+        static constexpr size_t RECOVERY_BUFFER_LIMIT = 1 << 18; // Ticks (16 MB)
+
         // Core output buffer to the strategy engine
         RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& output_buffer_;
         
@@ -34,121 +58,275 @@ namespace hft {
         
         // Logic state
         bool synchronized_ = false;       // Have we processed the snapshot?
-        int64_t last_sequence_num_ = -1;  // For gap detection
+
+        // One connection per line. With several, every line subscribes to the same channels
+        // and the first copy of each message wins. Coinbase numbers messages per connection,
+        // so copies are matched on a hash of their events payload.
+        struct Line {
+            ix::WebSocket ix_ws;
+            network::WebSocketClient native_ws;
+            int64_t last_sequence_num = -1;   // For gap detection
+            bool synced = false;              // Snapshot received on this line
+            std::chrono::steady_clock::time_point retry_at{};
+        };
+        std::vector<std::unique_ptr<Line>> lines_;
+        LineArbiter arbiter_;
+        size_t current_line_ = 0;         // Line of the message being parsed
+        std::mutex ix_mutex_;             // Serializes the IXWebSocket threads of several lines
+
+        // Gap recovery: after a gap the book is stale. Trades are buffered (in sequence
+        // order) until a fresh level2 snapshot arrives on the same session, then replayed
+        // ahead of it. The snapshot comes after every buffered message, so buffered depth
+        // would only ever be superseded and is dropped as it arrives.
+        bool recovering_ = false;
+        size_t recovery_line_ = 0;
+        bool message_has_snapshot_ = false;
+        uint64_t recovery_start_tsc_ = 0;
+        std::vector<BinaryTick> recovery_buffer_;
+        RecoveryStats recovery_stats_;
+
+        // Ticks decoded from the current message. They are published together when the
+        // message ends (one ring head update), the last one carrying end_of_message.
+        std::vector<BinaryTick> batch_;
+
+        // Per-message fields copied into every tick of the message
+        uint64_t message_sequence_ = 0;
+        uint64_t message_rx_tsc_ = 0;
+        uint64_t message_stamp_tsc_ = 0;  // Socket receive time, 0 without receive timestamps
+        uint64_t message_exchange_ns_ = 0;
         
         // Networking handles
-        ix::WebSocket webSocket_;
+        WsTransport transport_;
+        std::string url_ = "wss://advanced-trade-ws.coinbase.com";
+        bool tls_verify_ = true;
+        bool rx_timestamps_ = false;
+        bool hardware_timestamps_ = false;
+        std::thread feed_thread_;
 
-        // Capture
-        std::ofstream capture_file_;
-        bool capture_enabled_ = false;
+        // Capture (written off-thread; the receive path only copies into the writer's ring)
+        std::unique_ptr<storage::CaptureWriter> capture_;
 
     public:
         // Constructor injection of the RingBuffer dependency
-        CoinbaseFeedHandler(RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& buffer, bool capture = false) 
-            : output_buffer_(buffer), capture_enabled_(capture) {
+        CoinbaseFeedHandler(RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& buffer, bool capture = false,
+                            WsTransport transport = WsTransport::IXWEBSOCKET,
+                            storage::Compression capture_compression = storage::Compression::NONE) 
+            : output_buffer_(buffer), transport_(transport) {
             // Initialize network system (required for Windows, harmless on Linux)
             ix::initNetSystem();
-            if (capture_enabled_) {
-                capture_file_.open("market_data.bin", std::ios::binary);
+            batch_.reserve(MESSAGE_BATCH_RESERVE);
+            set_lines(1);
+            if (capture) {
+                storage::CaptureWriter::Options options;
+                options.compression = capture_compression;
+                capture_ = std::make_unique<storage::CaptureWriter>("market_data.bin", options);
             }
         }
 
         ~CoinbaseFeedHandler() {
-            if (capture_file_.is_open()) capture_file_.close();
             stop();
             ix::uninitNetSystem();
         }
 
+        const RecoveryStats& recovery_stats() const { return recovery_stats_; }
+        const LineStats& line_stats(size_t line) const { return arbiter_.stats(line); }
+        size_t line_count() const { return lines_.size(); }
+
+        // Per-line win rate and latency saved (read after stop())
+        void print_line_stats() const {
+            if (lines_.size() > 1) arbiter_.print("[Coinbase]");
+        }
+
+        // Redundant connections to the same channels (1 to LineArbiter::MAX_LINES).
+        // Call before start().
+        void set_lines(size_t lines) {
+            lines = std::clamp<size_t>(lines, 1, LineArbiter::MAX_LINES);
+            lines_.clear();
+            for (size_t i = 0; i < lines; ++i) lines_.push_back(std::make_unique<Line>());
+            arbiter_.reset(lines);
+        }
+
+        // Endpoint override (e.g. ws://127.0.0.1:8080 for the local stand-in). Call before start().
+        void set_url(const std::string& url) { url_ = url; }
+
+        // Skip TLS certificate verification (self-signed local stand-in only). Call before start().
+        void set_tls_verify(bool verify) { tls_verify_ = verify; }
+
+        // Socket receive timestamps (SO_TIMESTAMPING) in each tick's rx_timestamp, with the
+        // wait until the feed thread read the message in rx_read_delta. Native transport
+        // only: IXWebSocket owns its sockets. Call before start().
+        void set_rx_timestamps(bool enable, bool hardware = false) {
+            rx_timestamps_ = enable;
+            hardware_timestamps_ = hardware;
+        }
+
         // Lifecycle management: Start the network thread
         void start() {
             running_ = true;
-            
-            std::string url("wss://advanced-trade-ws.coinbase.com");
-            webSocket_.setUrl(url);
-            
-            // Optional: Heartbeat (Ping) every 15 seconds to keep connection alive
-            webSocket_.setPingInterval(15);
-
-            // Setup callback
-            webSocket_.setOnMessageCallback([this](const ix::WebSocketMessagePtr& msg) {
-                // Thread Pinning (Run once per thread)
-                static thread_local bool pinned = false;
-                if (!pinned) {
-                    utils::pin_thread_to_core(constants::FEED_HANDLER_CORE);
-                    pinned = true;
+            if (capture_ && !capture_->start()) {
+                std::cerr << "[Coinbase] Capture disabled: cannot open market_data.bin" << std::endl;
+                capture_.reset();
+            }
+
+            for (auto& line : lines_) {
+                line->native_ws.set_tls_verify(tls_verify_);
+                line->native_ws.set_rx_timestamps(rx_timestamps_, hardware_timestamps_);
+                if (!tls_verify_) {
+                    ix::SocketTLSOptions tls_options;
+                    tls_options.caFile = "NONE";
+                    line->ix_ws.setTLSOptions(tls_options);
                 }
+            }
+
+            if (rx_timestamps_ && transport_ != WsTransport::NATIVE) {
+                std::cerr << "[Coinbase] Receive timestamps need the native transport; using read times" << std::endl;
+            }
+
+            if (transport_ == WsTransport::NATIVE) {
+                feed_thread_ = std::thread(&CoinbaseFeedHandler::run_native, this);
+                return;
+            }
 
-                if (msg->type == ix::WebSocketMessageType::Message) {
-                    if (this->capture_enabled_ && this->capture_file_.is_open()) {
-                        uint64_t ts = utils::rdtsc();
-                        uint32_t len = static_cast<uint32_t>(msg->str.size());
-                        this->capture_file_.write(reinterpret_cast<const char*>(&ts), sizeof(ts));
-                        this->capture_file_.write(reinterpret_cast<const char*>(&len), sizeof(len));
-                        this->capture_file_.write(msg->str.data(), len);
+            for (size_t i = 0; i < lines_.size(); ++i) {
+                ix::WebSocket& ws = lines_[i]->ix_ws;
+                ws.setUrl(url_);
+
+                // Optional: Heartbeat (Ping) every 15 seconds to keep connection alive
+                ws.setPingInterval(15);
+
+                // Setup callback
+                ws.setOnMessageCallback([this, i](const ix::WebSocketMessagePtr& msg) {
+                    // Thread Pinning (Run once per thread)
+                    static thread_local bool pinned = false;
+                    if (!pinned) {
+                        utils::pin_thread_to_core(constants::FEED_HANDLER_CORE);
+                        TRACE_THREAD("feed");
+                        pinned = true;
                     }
-                    this->process_message(msg->str);
-                } else if (msg->type == ix::WebSocketMessageType::Open) {
-                    std::cout << "[Coinbase] Connected. Subscribing..." << std::endl;
-                    this->subscribe();
-                } else if (msg->type == ix::WebSocketMessageType::Close) {
-                    std::cout << "[Coinbase] Disconnected. Code: " << msg->closeInfo.code 
-                              << " Reason: " << msg->closeInfo.reason << std::endl;
-                    this->synchronized_ = false;
-                    this->last_sequence_num_ = -1;
-                } else if (msg->type == ix::WebSocketMessageType::Error) {
-                    std::cout << "[Coinbase] Error: " << msg->errorInfo.reason << std::endl;
-                }
-            });
 
-            // Start connection
-            webSocket_.start();
+                    // Each line has its own IXWebSocket thread; with several they take turns
+                    std::unique_lock<std::mutex> lock(ix_mutex_, std::defer_lock);
+                    if (lines_.size() > 1) lock.lock();
+
+                    if (msg->type == ix::WebSocketMessageType::Message) {
+                        TRACE_SCOPE(WS_RECEIVE);
+                        uint64_t rx_tsc = utils::rdtsc();
+                        if (i == 0) this->capture_message(msg->str, rx_tsc);
+                        this->process_line_message(i, msg->str, rx_tsc, msg->str.capacity());
+                    } else if (msg->type == ix::WebSocketMessageType::Open) {
+                        std::cout << log_prefix(i) << " Connected. Subscribing..." << std::endl;
+                        this->subscribe(i);
+                    } else if (msg->type == ix::WebSocketMessageType::Close) {
+                        std::cout << log_prefix(i) << " Disconnected. Code: " << msg->closeInfo.code
+                                  << " Reason: " << msg->closeInfo.reason << std::endl;
+                        this->reset_line(i);
+                    } else if (msg->type == ix::WebSocketMessageType::Error) {
+                        std::cout << log_prefix(i) << " Error: " << msg->errorInfo.reason << std::endl;
+                    }
+                });
+
+                // Start connection
+                ws.start();
+            }
         }
 
         // Lifecycle management: Graceful shutdown
         void stop() {
             running_ = false;
-            webSocket_.stop();
+            if (feed_thread_.joinable()) {
+                feed_thread_.join();
+            }
+            for (auto& line : lines_) line->ix_ws.stop();
+            // Receive paths are quiet now; flush the last block and the index
+            if (capture_) capture_->stop();
         }
 
         // Core Parsing Logic (Exposed for Replay/Testing)
-        void process_message(std::string_view message) {
-            // Optimization: Reuse a thread-local buffer to avoid allocation
-            static thread_local std::vector<char> buffer;
-            // Optimization: Thread-local parser to avoid race conditions
-            static thread_local simdjson::dom::parser parser;
+        // rx_tsc: TSC when the message came off the socket (0 = now)
+        // capacity: Bytes readable at message.data(). If it leaves SIMDJSON_PADDING bytes of
+        //           slack past the message, the message is parsed in place without a copy.
+        void process_message(std::string_view message, uint64_t rx_tsc = 0, size_t capacity = 0) {
+            process_line_message(0, message, rx_tsc, capacity);
+        }
 
-            if (buffer.size() < message.size() + simdjson::SIMDJSON_PADDING) {
-                buffer.resize(message.size() + simdjson::SIMDJSON_PADDING);
+    private:
+        // Function: process_line_message
+        // Description: process_message for a message received on line line_index.
+        //              stamp_tsc: socket receive time on the TSC timebase, 0 if unknown.
+        void process_line_message(size_t line_index, std::string_view message, uint64_t rx_tsc, size_t capacity,
+                                  uint64_t stamp_tsc = 0) {
+            message_rx_tsc_ = rx_tsc != 0 ? rx_tsc : utils::rdtsc();
+            message_stamp_tsc_ = stamp_tsc;
+            current_line_ = line_index;
+            Line& line = *lines_[line_index];
+
+            // Optimization: Thread-local parser to avoid race conditions
+            static thread_local simdjson::ondemand::parser parser;
+
+            const char* data = message.data();
+            size_t allocated = capacity;
+            if (capacity < message.size() + simdjson::SIMDJSON_PADDING) {
+                // Fallback: copy into a reusable padded buffer. On-Demand only needs the
+                // padding to be readable, not zeroed.
+                static thread_local std::vector<char> buffer;
+                if (buffer.size() < message.size() + simdjson::SIMDJSON_PADDING) {
+                    buffer.resize(message.size() + simdjson::SIMDJSON_PADDING);
+                }
+                std::memcpy(buffer.data(), message.data(), message.size());
+                data = buffer.data();
+                allocated = buffer.size();
             }
-            std::memcpy(buffer.data(), message.data(), message.size());
-            // Add padding (simdjson requirement)
-            std::memset(buffer.data() + message.size(), 0, simdjson::SIMDJSON_PADDING);
 
-            simdjson::dom::element doc;
-            
-            // 1. Parse Document
-            auto error = parser.parse(buffer.data(), message.size(), false).get(doc);
+            // 1. Start iteration (no DOM: fields are decoded as we walk past them,
+            //    so the parse span covers the whole walk including tick publication)
+            TRACE_SCOPE(JSON_PARSE);
+            simdjson::ondemand::document doc;
+            simdjson::ondemand::object root;
+            auto error = parser.iterate(data, message.size(), allocated).get(doc);
+            if (!error) error = doc.get_object().get(root);
             if (error) {
                 std::cerr << "[Coinbase] JSON Parse Error: " << simdjson::error_message(error) << std::endl;
                 return; 
             }
 
+            // Fields are looked up in the order Coinbase sends them:
+            // channel, client_id, timestamp, sequence_num, events
+
             // 2. Extract Channel Name
             std::string_view channel;
-            if (doc["channel"].get(channel) != simdjson::SUCCESS) return;
+            if (root["channel"].get_string().get(channel) != simdjson::SUCCESS) return;
+
+            // Exchange event time of the whole message
+            std::string_view exchange_ts;
+            message_exchange_ns_ = (root["timestamp"].get_string().get(exchange_ts) == simdjson::SUCCESS)
+                                       ? utils::parse_iso8601_ns(exchange_ts) : 0;
 
-            // Global Sequence Number Handling
+            // Sequence Number Handling (per connection)
             int64_t current_seq;
-            if (doc["sequence_num"].get(current_seq) == simdjson::SUCCESS) {
-                if (last_sequence_num_ != -1 && current_seq != last_sequence_num_ + 1) {
-                    // GAP DETECTED!
-                    std::cerr << "[Coinbase] Gap detected: " << last_sequence_num_ << " -> " << current_seq << std::endl;
-                    // Force reconnect to resync
-                    webSocket_.close();
-                    return; 
+            if (root["sequence_num"].get_int64().get(current_seq) == simdjson::SUCCESS) {
+                if (line.last_sequence_num != -1 && current_seq <= line.last_sequence_num) {
+                    // Numbering restarted: a new session (e.g. a capture spanning a reconnect)
+                    reset_line(line_index);
+                } else if (line.last_sequence_num != -1 && current_seq != line.last_sequence_num + 1) {
+                    // GAP DETECTED! Another synchronized line covers it; otherwise resync
+                    // in-session instead of reconnecting
+                    ++arbiter_.stats(line_index).gaps;
+                    if (!other_line_synced(line_index)) {
+                        begin_recovery(line_index, line.last_sequence_num, current_seq);
+                    }
                 }
-                last_sequence_num_ = current_seq;
+                line.last_sequence_num = current_seq;
+                message_sequence_ = static_cast<uint64_t>(current_seq);
+            } else {
+                ++message_sequence_;
+            }
+
+            // Recovery deadline (heartbeats keep this checked on a quiet book)
+            if (recovering_ && message_rx_tsc_ - recovery_start_tsc_ > RECOVERY_TIMEOUT_NS * utils::CYCLES_PER_NS) {
+                std::cerr << log_prefix(recovery_line_) << " No snapshot within " << RECOVERY_TIMEOUT_NS / 1000000
+                          << " ms of the gap. Reconnecting." << std::endl;
+                disconnect(recovery_line_);
+                return;
             }
 
             // 3. Heartbeat Handling
@@ -156,90 +334,374 @@ namespace hft {
                 return;
             }
 
+            bool l2 = (channel == "l2_data" || channel == "level2");
+            if (!l2 && channel != "market_trades") return;
+
+            // Arbitration: only the first copy across lines goes on; ticks are numbered in
+            // arbitrated order. Duplicates are dropped before their events are parsed.
+            if (lines_.size() > 1) {
+                size_t events_at = message.find("\"events\"");
+                std::string_view payload = events_at == std::string_view::npos ? message : message.substr(events_at);
+                LineArbiter::PayloadKey key = LineArbiter::payload_key(payload);
+                if (!arbiter_.first_arrival(key.key, line_index, message_rx_tsc_, key.check)) return;
+                message_sequence_ = arbiter_.unique();
+            }
+
             // 4. L2 Data Handling
-            if (channel == "l2_data" || channel == "level2") {
-                handle_l2_data(doc);
+            if (l2) {
+                handle_l2_data(root);
+            } else {
+                handle_market_trades(root);
             }
+
+            // 5. Publish the message's ticks as one batch
+            end_message();
         }
 
-    private:
-        void handle_l2_data(simdjson::dom::element& doc) {
-            simdjson::dom::array events;
-            if (doc["events"].get(events) != simdjson::SUCCESS) return;
+        // Function: run_native
+        // Description: Feed thread for the native transport. Pinned once up front, then
+        //              busy-polls every line's socket in turn; a line that drops is
+        //              reconnected (and resubscribed) once a second while the others stream.
+        void run_native() {
+            utils::pin_thread_to_core(constants::FEED_HANDLER_CORE);
+            TRACE_THREAD("feed");
+
+            while (running_) {
+                bool any_open = false;
+                for (size_t i = 0; i < lines_.size() && running_; ++i) {
+                    Line& line = *lines_[i];
+                    if (!line.native_ws.is_open()) {
+                        auto now = std::chrono::steady_clock::now();
+                        if (now < line.retry_at) continue;
+                        if (!line.native_ws.connect(url_)) {
+                            std::cout << log_prefix(i) << " Connect failed. Retrying..." << std::endl;
+                            line.retry_at = now + std::chrono::seconds(1);
+                            continue;
+                        }
+                        std::cout << log_prefix(i) << " Connected. Subscribing..." << std::endl;
+                        subscribe(i);
+                    }
+                    any_open = true;
+
+                    line.native_ws.poll([this, i](std::string_view frame, size_t capacity, uint64_t rx_tsc, uint64_t stamp_tsc) {
+                        TRACE_SCOPE(WS_RECEIVE);
+                        if (i == 0) capture_message(frame, rx_tsc);
+                        process_line_message(i, frame, rx_tsc, capacity, stamp_tsc);
+                    });
+
+                    if (!line.native_ws.is_open()) {
+                        line.native_ws.close();
+                        std::cout << log_prefix(i) << " Disconnected." << std::endl;
+                        reset_line(i);
+                    }
+                }
+                if (!any_open) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            for (auto& line : lines_) line->native_ws.close();
+        }
+
+        // Drops a line's connection; the transport reconnects and the line resyncs from a
+        // fresh snapshot. Sync state is cleared here as well, so anything parsed before the
+        // transport reports the close (or, offline, the rest of a capture spanning a
+        // reconnect) waits for it.
+        void disconnect(size_t line) {
+            if (recovering_) ++recovery_stats_.reconnects;
+            reset_line(line);
+            if (transport_ == WsTransport::NATIVE) {
+                lines_[line]->native_ws.close();
+            } else {
+                lines_[line]->ix_ws.close();
+            }
+        }
+
+        void send(size_t line, const std::string& message) {
+            if (transport_ == WsTransport::NATIVE) {
+                lines_[line]->native_ws.send_text(message);
+            } else {
+                lines_[line]->ix_ws.send(message);
+            }
+        }
+
+        std::string log_prefix(size_t line) const {
+            return lines_.size() > 1 ? "[Coinbase:" + std::to_string(line) + "]" : "[Coinbase]";
+        }
+
+        bool other_line_synced(size_t line) const {
+            for (size_t i = 0; i < lines_.size(); ++i) {
+                if (i != line && lines_[i]->synced) return true;
+            }
+            return false;
+        }
+
+        void capture_message(std::string_view frame, uint64_t rx_tsc) {
+            if (capture_) capture_->record(rx_tsc, frame);
+        }
+
+        void handle_l2_data(simdjson::ondemand::object& root) {
+            simdjson::ondemand::array events;
+            if (root["events"].get_array().get(events) != simdjson::SUCCESS) return;
 
             // Coinbase wraps updates in an 'events' array.
-            for (auto event : events) {
+            for (auto event_value : events) {
+                simdjson::ondemand::object event;
+                if (event_value.get_object().get(event) != simdjson::SUCCESS) return;
+
+                // Event fields arrive as: type, product_id, updates
                 std::string_view type;
-                if (event["type"].get(type) != simdjson::SUCCESS) continue;
+                if (event["type"].get_string().get(type) != simdjson::SUCCESS) continue;
 
                 // 5. Snapshot vs Update Logic
                 bool is_snapshot = (type == "snapshot");
 
                 // If we aren't synchronized and this isn't a snapshot, 
                 // we technically have a gap or started late. 
-                if (!synchronized_ && !is_snapshot) {
+                // While recovering, the deltas are kept for replay after the snapshot.
+                if (!synchronized_ && !is_snapshot && !recovering_) {
                     return; 
                 }
 
                 if (is_snapshot) {
-                    std::cout << "[Coinbase] Snapshot received. Synchronized." << std::endl;
+                    lines_[current_line_]->synced = true;
+                    // Another line keeps the book current; this snapshot was taken at a
+                    // different point of the stream, so it only syncs its own line.
+                    if (synchronized_ && !recovering_ && lines_.size() > 1) {
+                        std::cout << log_prefix(current_line_) << " Snapshot received. Line synchronized." << std::endl;
+                        return;
+                    }
+                    if (!recovering_) std::cout << log_prefix(current_line_) << " Snapshot received. Synchronized." << std::endl;
                     synchronized_ = true;
+                    message_has_snapshot_ = true;
                 }
 
                 // 6. Process Updates Array
-                simdjson::dom::array updates;
-                if (event["updates"].get(updates) != simdjson::SUCCESS) continue;
+                simdjson::ondemand::array updates;
+                if (event["updates"].get_array().get(updates) != simdjson::SUCCESS) continue;
 
                 for (auto update_value : updates) {
-                    simdjson::dom::object update;
-                    if (update_value.get(update) == simdjson::SUCCESS) {
-                        push_update(update, is_snapshot);
-                    }
+                    simdjson::ondemand::object update;
+                    if (update_value.get_object().get(update) != simdjson::SUCCESS) return;
+                    push_update(update, is_snapshot);
                 }
             }
         }
 
-        void push_update(simdjson::dom::object update, bool is_snapshot) {
+        void push_update(simdjson::ondemand::object& update, bool is_snapshot) {
             
             std::string_view side_str, price_str, qty_str;
             
-            // Extract fields: "side", "price_level", "new_quantity"
-            if (update["side"].get(side_str) != simdjson::SUCCESS) return;
-            if (update["price_level"].get(price_str) != simdjson::SUCCESS) return;
-            if (update["new_quantity"].get(qty_str) != simdjson::SUCCESS) return;
+            // Extract fields in wire order: "side", ("event_time"), "price_level", "new_quantity"
+            if (update["side"].get_string().get(side_str) != simdjson::SUCCESS) return;
+            // Numeric strings never contain escapes: take the raw token, skip unescaping
+            if (update["price_level"].raw_json_token().get(price_str) != simdjson::SUCCESS) return;
+            if (update["new_quantity"].raw_json_token().get(qty_str) != simdjson::SUCCESS) return;
+            price_str = unquote(price_str);
+            qty_str = unquote(qty_str);
 
             // 7. Side Parsing Optimization
             bool is_bid = (!side_str.empty() && side_str[0] == 'b');
 
-            // 8. Numeric Conversion
-            double p = std::stod(std::string(price_str));
-            double q = std::stod(std::string(qty_str));
+            // 8. Numeric Conversion (exact fixed point, no allocation)
+            int64_t price = 0, quantity = 0;
+            if (!decimal::parse_fixed(price_str, price)) return;
+            if (!decimal::parse_fixed(qty_str, quantity)) return;
 
             // 9. Tick Construction
             BinaryTick t;
+            t.id = message_sequence_;
             t.timestamp = utils::rdtsc(); // Capture hardware timestamp
-            t.price = static_cast<int64_t>(p * constants::PRICE_SCALE_DBL);
-            t.quantity = static_cast<int64_t>(q * constants::PRICE_SCALE_DBL);
+            t.price = price;
+            t.quantity = quantity;
             t.is_bid = is_bid;
             t.symbol = 0; // Hardcoded ID for BTC-USD
             t.is_trade = false; // L2 update, not a trade
             t.is_snapshot = is_snapshot; // Flag to tell engine to Reset book if true
+            t.end_of_message = false;
+            t.exchange_timestamp = message_exchange_ns_;
+            t.set_rx(message_rx_tsc_, message_stamp_tsc_);
+
+            // 10. Stage for the end-of-message publish
+            batch_.push_back(t);
+        }
+
+        // Function: handle_market_trades
+        // Description: Publishes each print of a market_trades update as a trade tick, in
+        //              message order with the level2 ticks (both channels share the
+        //              connection's sequence_num). The snapshot event replays recent history,
+        //              so it is skipped, as are prints before the book is synchronized.
+        void handle_market_trades(simdjson::ondemand::object& root) {
+            simdjson::ondemand::array events;
+            if (root["events"].get_array().get(events) != simdjson::SUCCESS) return;
+
+            for (auto event_value : events) {
+                simdjson::ondemand::object event;
+                if (event_value.get_object().get(event) != simdjson::SUCCESS) return;
+
+                // Event fields arrive as: type, trades
+                std::string_view type;
+                if (event["type"].get_string().get(type) != simdjson::SUCCESS) continue;
+                if (type != "update" || !(synchronized_ || recovering_)) continue;
+
+                simdjson::ondemand::array trades;
+                if (event["trades"].get_array().get(trades) != simdjson::SUCCESS) continue;
+
+                for (auto trade_value : trades) {
+                    simdjson::ondemand::object trade;
+                    if (trade_value.get_object().get(trade) != simdjson::SUCCESS) return;
+                    push_trade(trade);
+                }
+            }
+        }
+
+        void push_trade(simdjson::ondemand::object& trade) {
+            std::string_view price_str, size_str, side_str, time_str;
+
+            // Wire order: "trade_id", "product_id", "price", "size", "side", "time"
+            if (trade["price"].raw_json_token().get(price_str) != simdjson::SUCCESS) return;
+            if (trade["size"].raw_json_token().get(size_str) != simdjson::SUCCESS) return;
+            if (trade["side"].get_string().get(side_str) != simdjson::SUCCESS) return;
+            if (trade["time"].get_string().get(time_str) != simdjson::SUCCESS) time_str = {};
 
-            // 10. Buffer Push (Spin-wait)
-            while (!output_buffer_.push(t)) {
-                utils::cpu_relax(); // Intel intrinsic for spin-loop hint
+            int64_t price = 0, quantity = 0;
+            if (!decimal::parse_fixed(unquote(price_str), price)) return;
+            if (!decimal::parse_fixed(unquote(size_str), quantity)) return;
+
+            // "side" is the aggressor: BUY lifted an offer, SELL hit a bid. is_bid follows the
+            // converter's is_buyer_maker convention and marks a resting bid.
+            bool aggressor_buy = (!side_str.empty() && side_str[0] == 'B');
+
+            BinaryTick t;
+            t.id = message_sequence_;
+            t.timestamp = utils::rdtsc();
+            t.price = price;
+            t.quantity = quantity;
+            t.is_bid = !aggressor_buy;
+            t.symbol = 0; // Hardcoded ID for BTC-USD
+            t.is_trade = true;
+            t.is_snapshot = false;
+            t.end_of_message = false;
+            uint64_t trade_ns = time_str.empty() ? 0 : utils::parse_iso8601_ns(time_str);
+            t.exchange_timestamp = trade_ns != 0 ? trade_ns : message_exchange_ns_;
+            t.set_rx(message_rx_tsc_, message_stamp_tsc_);
+
+            batch_.push_back(t);
+        }
+
+        // Strips the surrounding quotes (and any trailing whitespace) from a raw string token
+        static std::string_view unquote(std::string_view token) {
+            while (!token.empty() && token.back() != '"') token.remove_suffix(1);
+            if (token.size() < 2 || token.front() != '"') return {};
+            return token.substr(1, token.size() - 2);
+        }
+
+        void end_message() {
+            bool has_snapshot = message_has_snapshot_;
+            message_has_snapshot_ = false;
+            if (batch_.empty() && !has_snapshot) return;
+            if (!batch_.empty()) batch_.back().end_of_message = true;
+
+            if (recovering_) {
+                if (has_snapshot) {
+                    end_recovery();
+                } else if (recovery_buffer_.size() + batch_.size() > RECOVERY_BUFFER_LIMIT) {
+                    std::cerr << log_prefix(recovery_line_) << " Recovery buffer full. Reconnecting." << std::endl;
+                    disconnect(recovery_line_);
+                } else {
+                    for (const auto& t : batch_) {
+                        if (t.is_trade) recovery_buffer_.push_back(t);
+                        else ++recovery_stats_.ticks_superseded;
+                    }
+                }
+                batch_.clear();
+                return;
+            }
+
+            publish(batch_.data(), batch_.size());
+            batch_.clear();
+        }
+
+        // Clears per-session state; the next snapshot resynchronizes the book.
+        void reset_session() {
+            synchronized_ = false;
+            recovering_ = false;
+            recovery_buffer_.clear();
+        }
+
+        // Clears a line's session state. The book stays synchronized while another line
+        // that has its snapshot keeps it current.
+        void reset_line(size_t line) {
+            lines_[line]->synced = false;
+            lines_[line]->last_sequence_num = -1;
+            if (!other_line_synced(line)) reset_session();
+        }
+
+        // Function: begin_recovery
+        // Description: Marks the book stale and asks the live session for a fresh level2
+        //              snapshot (unsubscribe + subscribe). Ticks are buffered until it lands.
+        //              A gap while already recovering only adds to the loss count.
+        void begin_recovery(size_t line, int64_t last_seq, int64_t seq) {
+            uint64_t lost = static_cast<uint64_t>(seq - last_seq - 1);
+            ++recovery_stats_.gaps;
+            recovery_stats_.messages_lost += lost;
+            std::cerr << log_prefix(line) << " Gap detected: " << last_seq << " -> " << seq << " (" << lost
+                      << " lost)." << (recovering_ || !synchronized_ ? "" : " Resyncing in-session.") << std::endl;
+            if (recovering_ || !synchronized_) return;
+
+            synchronized_ = false;
+            recovering_ = true;
+            recovery_line_ = line;
+            recovery_start_tsc_ = message_rx_tsc_;
+            send(line, R"({"type": "unsubscribe", "product_ids": ["BTC-USD"], "channel": "level2"})");
+            send(line, R"({"type": "subscribe", "product_ids": ["BTC-USD"], "channel": "level2"})");
+        }
+
+        // Function: end_recovery
+        // Description: Publishes, as one batch: the buffered trades, then the snapshot
+        //              message. The snapshot is requested on the session that had the gap,
+        //              so everything buffered is older than it and only trades are replayed.
+        void end_recovery() {
+            size_t replayed = recovery_buffer_.size();
+            recovery_buffer_.insert(recovery_buffer_.end(), batch_.begin(), batch_.end());
+            publish(recovery_buffer_.data(), recovery_buffer_.size());
+
+            uint64_t ns = static_cast<uint64_t>((message_rx_tsc_ - recovery_start_tsc_) / utils::CYCLES_PER_NS);
+            recovery_stats_.recoveries++;
+            recovery_stats_.ticks_replayed += replayed;
+            recovery_stats_.last_ns = ns;
+            recovery_stats_.max_ns = std::max(recovery_stats_.max_ns, ns);
+            recovery_stats_.total_ns += ns;
+            std::cout << "[Coinbase] Snapshot received. Recovered in-session in " << ns / 1000 << " us ("
+                      << replayed << " buffered trades replayed)." << std::endl;
+
+            recovering_ = false;
+            recovery_buffer_.clear();
+        }
+
+        // Function: publish
+        // Description: Spin-waits until the ring has room for the whole batch, then makes it
+        //              visible with one release store. A snapshot deeper than the ring goes
+        //              out in ring-sized pieces.
+        void publish(const BinaryTick* ticks, size_t count) {
+            TRACE_SCOPE(RING_PUSH);
+            while (count > 0) {
+                size_t n = std::min(count, output_buffer_.capacity());
+                while (!output_buffer_.push_batch(ticks, n)) {
+                    utils::cpu_relax(); // Intel intrinsic for spin-loop hint
+                }
+                ticks += n;
+                count -= n;
             }
         }
 
         // Helper to send subscription JSON
-        void subscribe() {
+        void subscribe(size_t line) {
             // Subscription payload for Level 2 data.
             std::string sub_msg = R"({
                 "type": "subscribe",
                 "product_ids": ["BTC-USD"],
                 "channel": "level2"
             })";
-            webSocket_.send(sub_msg);
+            send(line, sub_msg);
 
             // Separate subscription for heartbeats
             std::string hb_msg = R"({
@@ -247,7 +709,15 @@ namespace hft {
                 "product_ids": ["BTC-USD"],
                 "channel": "heartbeats"
             })";
-            webSocket_.send(hb_msg);
+            send(line, hb_msg);
+
+            // Trade prints, sequenced with the book on the same connection
+            std::string trades_msg = R"({
+                "type": "subscribe",
+                "product_ids": ["BTC-USD"],
+                "channel": "market_trades"
+            })";
+            send(line, trades_msg);
         }
     };
 }
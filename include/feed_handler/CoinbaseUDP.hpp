@@ -3,9 +3,16 @@
 #include "common/Types.hpp"
 #include "common/RingBuffer.hpp"
 #include "common/Utils.hpp"
-#include <iostream>
+#include "common/DecimalParser.hpp"
+#include "sbe/CoinbaseMarketData.hpp" // Generated from schema/coinbase_market_data.xml
+#include "LineArbiter.hpp"
+#include "RecoveryStats.hpp"
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cstring>
+#include <iostream>
+#include <vector>
 
 // Compiler hint for branch prediction
 #define likely(x)       __builtin_expect(!!(x), 1)
@@ -13,125 +20,495 @@
 
 namespace hft {
 
-    // ==========================================================
-    // 1. Define Wire Protocol (SBE Layout)
-    // ==========================================================
-    #pragma pack(push, 1)
-
-    struct SbeHeader {
-        uint16_t block_length;
-        uint16_t template_id;
-        uint16_t schema_id;
-        uint16_t version;
+    // Decoder and sequencing counters. Gap and recovery counts are in RecoveryStats, per
+    // line arbitration in LineArbiter. A malformed or unknown message ends its packet: SBE
+    // messages carry no total length, so nothing after one can be located.
+    struct UDPFeedStats {
+        uint64_t packets = 0;     // Packets decoded, after arbitration
+        uint64_t messages = 0;
+        uint64_t entries = 0;     // Group entries decoded
+        uint64_t heartbeats = 0;
+        uint64_t malformed = 0;   // Messages (or packets) failing length validation
+        uint64_t unknown = 0;     // Messages of another schema or an unhandled template
+        uint64_t bad_decimal = 0; // Entries whose price or size overflows fixed point
+        uint64_t reordered = 0;   // Packets held in the window until the hole before them filled
+        uint64_t stale = 0;       // Packets older than the next expected one (already given up on)
+        uint64_t snapshots_skipped = 0; // Snapshot messages arriving while the book is in sync
     };
 
-    // Example Message: MDIncrementalRefreshBook (ID: 202)
-    struct MDUpdateHeader {
-        uint64_t transact_time;
-        uint32_t match_event_indicator;
-        // ... other fixed fields ...
-    };
+    // Function: CoinbaseUDPHandler
+    // Description: Decodes SBE market data packets with the generated flyweights and
+    //              publishes every group entry as a BinaryTick, prices and sizes rescaled
+    //              from their wire exponent to 1e-8 fixed point.
+    //              Packets may arrive on redundant lines (A/B) carrying identical packet
+    //              sequence numbers: the first copy wins, packets ahead of a hole wait in a
+    //              small reorder window, and a hole no line fills in time is a gap. A gap
+    //              (or a jump in the entries' RptSeq) makes the book stale: ticks are
+    //              buffered until a snapshot (template 201) that they continue, then
+    //              published after it, as on the WebSocket feed. The book starts stale, so
+    //              the first snapshot is also the late-join image.
+    //              A packet's ticks reach the ring in one batch; the last tick of each
+    //              message carries end_of_message. Single-threaded: poll every line from
+    //              one thread.
+    class CoinbaseUDPHandler {
+    public:
+        static constexpr uint64_t SYMBOL = 0x42544355534454; // "BTCUSDT" in hex
 
-    struct MDEntry {
-        int64_t price_mantissa;
-        uint32_t order_qty;
-        int8_t  price_exponent; 
-        uint8_t side; // 0=Buy, 1=Sell
-        // ... padding or other fields
-    };
+        // A 64 KB datagram of the smallest entries (snapshot levels)
+        static constexpr size_t MAX_PACKET_TICKS =
+            UINT16_MAX / sbe::coinbase::MDSnapshotFullRefresh::NoMDEntries::BLOCK_LENGTH + 1;
 
-    #pragma pack(pop)
+        // Packets that may wait behind a hole, each up to a jumbo frame
+        static constexpr size_t REORDER_WINDOW = 32;
+        static constexpr size_t SLOT_BYTES = 9216;
+        static constexpr uint64_t DEFAULT_REORDER_TIMEOUT_NS = 500000;
 
-    // ==========================================================
-    // 2. Hot Path Handler
-    // ==========================================================
+        static constexpr size_t RECOVERY_BUFFER_LIMIT = 1 << 18; // Ticks (16 MB)
 
-    class CoinbaseUDPHandler {
-    public:
-        // Use an initialization list for references
-        explicit CoinbaseUDPHandler(RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& buffer)
-            : buffer_(buffer) {}
+        explicit CoinbaseUDPHandler(RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& buffer, size_t lines = 1)
+            : buffer_(buffer), arbiter_(lines), slot_bytes_(REORDER_WINDOW * SLOT_BYTES) {
+            batch_.reserve(MAX_PACKET_TICKS);
+        }
+
+        // How long a hole may hold back the packets after it before it is declared lost.
+        // Should cover the A/B skew; one line's loss is then never a gap.
+        void set_reorder_timeout_ns(uint64_t ns) { reorder_timeout_ns_ = ns; }
 
+        // Function: on_packet
+        // Description: Arbitrates, sequences and decodes one incremental feed packet.
+        // Inputs: data, len - UDP payload (packet header, then SBE messages).
+        //         line - Line it arrived on (0 = A, 1 = B, ...).
+        //         rx_tsc - TSC when the packet was read.
+        //         stamp_tsc - Its kernel/NIC receive timestamp on the TSC timebase (0 = none).
         // Mark as always_inline to ensure the compiler embeds this in the DPDK polling loop
         __attribute__((always_inline))
-        void on_packet(const uint8_t* data, uint16_t len) {
-            
-            // 1. Bounds Check (Cheap sanity check)
-            if (unlikely(len < sizeof(SbeHeader))) return;
-
-            // 2. Cast Header (Zero-Copy)
-            // In HFT, we trust the pointer cast. 
-            // 'data' is the raw memory address from the NIC.
-            const auto* header = reinterpret_cast<const SbeHeader*>(data);
-
-            // 3. Filter by Message Type (Template ID)
-            // Example: We only care about Book Updates (ID 202), ignore Heartbeats (ID 0)
-            switch (header->template_id) {
-                case 202: // MDIncrementalRefresh
-                    process_book_update(data, len, header->block_length);
-                    break;
-                
-                case 201: // MDSnapshot (Handle heavy logic elsewhere)
-                case 0:   // Heartbeat
-                default:
-                    break;
+        void on_packet(const uint8_t* data, uint16_t len, size_t line = 0, uint64_t rx_tsc = utils::rdtsc(),
+                       uint64_t stamp_tsc = 0) {
+            using namespace sbe::coinbase;
+            if (unlikely(len < PacketHeader::ENCODED_LENGTH)) {
+                ++stats_.malformed;
+                return;
+            }
+            uint64_t seq = PacketHeader(data).msg_seq_num();
+
+            uint64_t& line_seq = line_seq_[line];
+            if (unlikely(line_seq != 0 && seq > line_seq + 1)) ++arbiter_.stats(line).gaps;
+            if (seq > line_seq) line_seq = seq;
+
+            // The other line already delivered it
+            if (!arbiter_.first_arrival(seq, line, rx_tsc)) return;
+
+            if (unlikely(next_seq_ == 0)) next_seq_ = seq;
+            if (likely(seq == next_seq_)) {
+                decode_packet(data, len, rx_tsc, stamp_tsc);
+                ++next_seq_;
+                if (unlikely(held_ > 0)) release_held(rx_tsc);
+                return;
             }
+            if (seq < next_seq_) {
+                ++stats_.stale;
+                return;
+            }
+            hold(seq, data, len, rx_tsc, stamp_tsc);
+        }
+
+        // Function: on_snapshot_packet
+        // Description: A packet from the snapshot line (its own sequence, not arbitrated).
+        //              Ignored unless the book is stale, so the line can stay subscribed.
+        void on_snapshot_packet(const uint8_t* data, uint16_t len, uint64_t rx_tsc = utils::rdtsc(), uint64_t stamp_tsc = 0) {
+            if (!recovering_) return;
+            if (unlikely(len < sbe::coinbase::PacketHeader::ENCODED_LENGTH)) {
+                ++stats_.malformed;
+                return;
+            }
+            decode_packet(data, len, rx_tsc, stamp_tsc);
+        }
+
+        // Function: poll
+        // Description: Declares the oldest hole lost once it has waited past the reorder
+        //              timeout. Call on every pass of the receive loop.
+        void poll(uint64_t now_tsc) {
+            if (held_ > 0 && now_tsc - hold_tsc_ > reorder_timeout_ns_ * utils::CYCLES_PER_NS) {
+                skip_hole(now_tsc);
+            }
+        }
+
+        // True while the book is stale and a snapshot is needed (join the snapshot line)
+        bool recovering() const { return recovering_; }
+
+        const UDPFeedStats& stats() const { return stats_; }
+        const RecoveryStats& recovery_stats() const { return recovery_stats_; }
+        const LineArbiter& arbiter() const { return arbiter_; }
+        void print_line_stats() const {
+            if (arbiter_.lines() > 1) arbiter_.print("[CoinbaseUDP]");
         }
 
     private:
+        struct Slot {
+            uint64_t seq = 0;
+            uint64_t rx_tsc = 0;
+            uint64_t stamp_tsc = 0;
+            uint16_t len = 0;
+        };
+
         RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& buffer_;
+        std::vector<BinaryTick> batch_;
+        UDPFeedStats stats_;
+
+        // Sequencing
+        LineArbiter arbiter_;
+        std::array<uint64_t, LineArbiter::MAX_LINES> line_seq_{};
+        uint64_t next_seq_ = 0; // 0 until the first packet
+        std::array<Slot, REORDER_WINDOW> slots_{};
+        std::vector<uint8_t> slot_bytes_;
+        size_t held_ = 0;
+        uint64_t hold_tsc_ = 0;
+        uint64_t reorder_timeout_ns_ = DEFAULT_REORDER_TIMEOUT_NS;
+
+        // Book state
+        bool recovering_ = true;
+        uint64_t last_rpt_seq_ = 0;
+        uint64_t recovery_start_tsc_ = 0;
+        std::vector<BinaryTick> recovery_buffer_;
+        std::vector<BinaryTick> snapshot_;
+        RecoveryStats recovery_stats_;
+
+        // Function: hold
+        // Description: Parks a packet that arrived ahead of a hole. One too far ahead to
+        //              fit the window (or too large for a slot) gives up on the holes below
+        //              it first and is then decoded in place.
+        void hold(uint64_t seq, const uint8_t* data, uint16_t len, uint64_t rx_tsc, uint64_t stamp_tsc) {
+            if (seq - next_seq_ >= REORDER_WINDOW) skip_hole(rx_tsc, seq - REORDER_WINDOW + 1, seq);
+            if (len > SLOT_BYTES && next_seq_ < seq) skip_hole(rx_tsc, seq, seq); // Too big to hold
+            if (seq == next_seq_) {
+                decode_packet(data, len, rx_tsc, stamp_tsc);
+                ++next_seq_;
+                if (held_ > 0) release_held(rx_tsc);
+                return;
+            }
+            // skip_hole stops at seq, so neither happens; a slot must still never overflow
+            if (unlikely(seq < next_seq_)) {
+                ++stats_.stale;
+                return;
+            }
+            if (unlikely(len > SLOT_BYTES)) {
+                ++stats_.malformed;
+                return;
+            }
+
+            Slot& slot = slots_[seq % REORDER_WINDOW];
+            if (slot.seq == seq) return; // Already held (a repeated datagram)
+            std::memcpy(slot_bytes_.data() + (seq % REORDER_WINDOW) * SLOT_BYTES, data, len);
+            slot = {seq, rx_tsc, stamp_tsc, len};
+            if (held_++ == 0) hold_tsc_ = rx_tsc;
+            ++stats_.reordered;
+        }
+
+        // Decodes held packets that are next in sequence
+        void release_held(uint64_t now_tsc) {
+            for (;;) {
+                Slot& slot = slots_[next_seq_ % REORDER_WINDOW];
+                if (slot.seq != next_seq_) break;
+                decode_packet(slot_bytes_.data() + (next_seq_ % REORDER_WINDOW) * SLOT_BYTES, slot.len, slot.rx_tsc, slot.stamp_tsc);
+                slot.seq = 0;
+                --held_;
+                ++next_seq_;
+            }
+            if (held_ > 0) hold_tsc_ = now_tsc; // The next hole gets its own timeout
+        }
+
+        // Function: skip_hole
+        // Description: Gives up on a hole: the missing packets before the oldest held one, or
+        //              all the way to until when the window has to move, and on to next_present
+        //              (the packet that forced it) when nothing is held past until. It never
+        //              passes next_present, which the caller holds and decodes itself. Held
+        //              packets on the way are decoded. Counts the gap, marks the book stale, and
+        //              releases what follows.
+        void skip_hole(uint64_t now_tsc, uint64_t until = 0, uint64_t next_present = 0) {
+            uint64_t first = next_seq_;
+            uint64_t lost = 0;
+            bool was_recovering = recovering_;
+            if (until <= next_seq_) until = next_seq_ + 1;
+            for (;;) {
+                if (held_ > 0 && slots_[next_seq_ % REORDER_WINDOW].seq == next_seq_) {
+                    release_held(now_tsc);
+                    if (next_seq_ >= until) break;
+                    continue;
+                }
+                if (next_seq_ >= until && next_seq_ >= next_present && (held_ == 0 || next_present != 0)) break;
+                ++next_seq_;
+                if (lost++ == 0) begin_recovery(now_tsc); // What follows goes to the recovery buffer
+            }
+
+            ++recovery_stats_.gaps;
+            recovery_stats_.messages_lost += lost;
+            std::cerr << "[CoinbaseUDP] Gap detected at packet " << first << ": " << lost
+                      << " lost on every line." << (was_recovering ? "" : " Recovering from snapshot.") << std::endl;
+            release_held(now_tsc);
+        }
 
-        // Force inline this specific handler too
+        void begin_recovery(uint64_t now_tsc) {
+            if (recovering_) return;
+            recovering_ = true;
+            recovery_start_tsc_ = now_tsc;
+        }
+
+        // Function: decode_packet
+        // Description: Decodes every message of a packet (after its header) and publishes
+        //              the ticks that are live; ticks of a stale book go to the recovery
+        //              buffer instead.
+        void decode_packet(const uint8_t* data, uint16_t len, uint64_t rx_tsc, uint64_t stamp_tsc) {
+            using namespace sbe::coinbase;
+            ++stats_.packets;
+            batch_.clear();
+
+            size_t pos = PacketHeader::ENCODED_LENGTH;
+            while (len - pos >= MessageHeader::ENCODED_LENGTH) {
+                const uint8_t* message = data + pos;
+                size_t remaining = len - pos;
+                MessageHeader header(message);
+                if (unlikely(header.schema_id() != SCHEMA_ID)) {
+                    ++stats_.unknown;
+                    break;
+                }
+
+                size_t batch_start = batch_.size();
+                size_t buffer_start = recovery_buffer_.size();
+                size_t consumed = 0;
+                switch (header.template_id()) {
+                    case MDIncrementalRefreshBook::TEMPLATE_ID:
+                        consumed = decode_book(message, remaining, rx_tsc, stamp_tsc);
+                        break;
+                    case MDIncrementalRefreshTrade::TEMPLATE_ID:
+                        consumed = decode_trades(message, remaining, rx_tsc, stamp_tsc);
+                        break;
+                    case MDSnapshotFullRefresh::TEMPLATE_ID:
+                        consumed = decode_snapshot(message, remaining, rx_tsc, stamp_tsc);
+                        break;
+                    case Heartbeat::TEMPLATE_ID: {
+                        Heartbeat heartbeat;
+                        if (heartbeat.wrap(message, remaining)) {
+                            consumed = heartbeat.encoded_length();
+                            ++stats_.heartbeats;
+                        }
+                        break;
+                    }
+                    default:
+                        // Its length is unknown, so the rest of the packet is lost with it
+                        ++stats_.unknown;
+                        pos = len;
+                        continue;
+                }
+                if (unlikely(consumed == 0)) {
+                    ++stats_.malformed;
+                    break;
+                }
+
+                ++stats_.messages;
+                if (batch_.size() > batch_start) batch_.back().end_of_message = true;
+                if (recovery_buffer_.size() > buffer_start) recovery_buffer_.back().end_of_message = true;
+                pos += consumed;
+            }
+
+            if (!batch_.empty()) publish(batch_.data(), batch_.size());
+        }
+
+        // Function: stage
+        // Description: Routes a decoded incremental tick: published if it continues the
+        //              book's RptSeq, buffered while the book is stale. A jump in RptSeq
+        //              means entries were lost even if no packet was (e.g. a restarted
+        //              line) and makes the book stale.
         __attribute__((always_inline))
-        void process_book_update(const uint8_t* base_ptr, uint16_t len, uint16_t block_len) {
-            (void)len; // Suppress unused parameter warning
-            // SBE format: Header -> RootBlock -> RepeatingGroup
-
-            // Pointer Arithmetic: Skip Header
-            const uint8_t* ptr = base_ptr + sizeof(SbeHeader);
-
-            // Cast the Root Block (Fixed fields)
-            // const auto* root = reinterpret_cast<const MDUpdateHeader*>(ptr);
-            
-            // Optimization: If we only need price/size, we can calculate the offset 
-            // to the repeating group directly if the schema is fixed version.
-            
-            // [Pseudo-logic for skipping to entries]
-            ptr += block_len; 
-
-            // Assuming first byte after root block is 'NumInGroup' (SBE standard)
-            // SBE Group Header: blockLength (uint16) + numInGroup (uint8 or uint16)
-            // *NOTE: Check your specific schema.xml for group header format*
-            
-            // Simple Parsing Example:
-            // SbeGroupHeader* group = (SbeGroupHeader*)ptr;
-            // ptr += sizeof(SbeGroupHeader);
-            
-            // Fake extraction for demo:
-            const auto* entry = reinterpret_cast<const MDEntry*>(ptr);
-
-            // 4. Construct internal BinaryTick
-            BinaryTick tick;
-            
-            // 5. Normalization
-            tick.price = entry->price_mantissa; 
-            tick.quantity = entry->order_qty;
-            tick.symbol = 0x42544355534454; // "BTCUSDT" in hex
-            
-            // Map Side: 0=Buy (Bid), 1=Sell (Ask)
-            tick.is_bid = (entry->side == 0);
-            tick.is_trade = false;    // This is a book update
-            tick.is_snapshot = false; // Incremental update
-            
-            // Use transaction time from the root block (we need to pass it down or just use 0 for now)
-            // For this hot-path demo, we'll skip passing the root header down to save registers
-            tick.timestamp = 0; 
-            tick.id = 0;
-
-            // 6. Lock-Free Push
-            // Using `write` if your ringbuffer supports zero-copy writing is better
-            // buffer_.write([&](BinaryTick& t) { t = tick; });
-            buffer_.push(tick);
+        void stage(const BinaryTick& t) {
+            ++stats_.entries;
+            if (likely(!recovering_)) {
+                if (likely(t.id == last_rpt_seq_ + 1)) {
+                    last_rpt_seq_ = t.id;
+                    batch_.push_back(t);
+                    return;
+                }
+                if (t.id <= last_rpt_seq_) {
+                    // Held behind a hole while a snapshot that covers it was applied
+                    ++recovery_stats_.ticks_superseded;
+                    return;
+                }
+                std::cerr << "[CoinbaseUDP] RptSeq gap: " << last_rpt_seq_ << " -> " << t.id
+                          << ". Recovering from snapshot." << std::endl;
+                ++recovery_stats_.gaps;
+                begin_recovery(t.rx_timestamp + t.rx_read_delta); // Recovery is timed read to read
+            }
+            if (unlikely(recovery_buffer_.size() >= RECOVERY_BUFFER_LIMIT)) {
+                // No snapshot continues a buffer this old any more; start over
+                recovery_buffer_.clear();
+                ++recovery_stats_.reconnects;
+            }
+            recovery_buffer_.push_back(t);
+        }
+
+        // Function: make_tick
+        // Description: Common fields of a tick from one group entry. Entries of one message
+        //              share its decode TSC: a TSC read per entry would cost more than the
+        //              rest of the entry's decode.
+        // Outputs: False if price or size does not fit fixed point (entry dropped).
+        __attribute__((always_inline))
+        bool make_tick(sbe::coinbase::Decimal64 price, sbe::coinbase::Decimal64 size,
+                       uint64_t transact_time, uint64_t decode_tsc, uint64_t rx_tsc, uint64_t stamp_tsc,
+                       BinaryTick& t) {
+            if (unlikely(!decimal::scale_decimal(price.mantissa(), price.exponent(), t.price) ||
+                         !decimal::scale_decimal(size.mantissa(), size.exponent(), t.quantity))) {
+                ++stats_.bad_decimal;
+                return false;
+            }
+            t.timestamp = decode_tsc;
+            t.symbol = SYMBOL;
+            t.is_trade = false;
+            t.is_snapshot = false;
+            t.end_of_message = false;
+            t.exchange_timestamp = transact_time;
+            t.set_rx(rx_tsc, stamp_tsc);
+            return true;
+        }
+
+        // Outputs: Bytes consumed, 0 if the message is malformed.
+        __attribute__((always_inline))
+        size_t decode_book(const uint8_t* message, size_t len, uint64_t rx_tsc, uint64_t stamp_tsc) {
+            using namespace sbe::coinbase;
+            MDIncrementalRefreshBook book;
+            if (unlikely(!book.wrap(message, len))) return 0;
+
+            uint64_t transact_time = book.transact_time();
+            uint64_t decode_tsc = utils::rdtsc();
+            for (auto entry : book.no_md_entries()) {
+                BinaryTick t;
+                if (unlikely(!make_tick(entry.price(), entry.size(), transact_time, decode_tsc, rx_tsc, stamp_tsc, t))) continue;
+                t.id = entry.rpt_seq();
+                t.is_bid = entry.side() == Side::BUY;
+                if (entry.update_action() == UpdateAction::DELETE) t.quantity = 0;
+                stage(t);
+            }
+            return book.encoded_length();
+        }
+
+        __attribute__((always_inline))
+        size_t decode_trades(const uint8_t* message, size_t len, uint64_t rx_tsc, uint64_t stamp_tsc) {
+            using namespace sbe::coinbase;
+            MDIncrementalRefreshTrade trades;
+            if (unlikely(!trades.wrap(message, len))) return 0;
+
+            uint64_t transact_time = trades.transact_time();
+            uint64_t decode_tsc = utils::rdtsc();
+            for (auto entry : trades.no_md_entries()) {
+                BinaryTick t;
+                if (unlikely(!make_tick(entry.price(), entry.size(), transact_time, decode_tsc, rx_tsc, stamp_tsc, t))) continue;
+                t.id = entry.rpt_seq();
+                // Aggressor SELL hit a resting bid (is_buyer_maker convention, as on the live feed)
+                t.is_bid = entry.aggressor_side() == Side::SELL;
+                t.is_trade = true;
+                stage(t);
+            }
+            return trades.encoded_length();
+        }
+
+        // Function: decode_snapshot
+        // Description: Applies a snapshot to a stale book if the buffered ticks continue it
+        //              (no RptSeq missing after LastRptSeq); otherwise waits for a later one.
+        size_t decode_snapshot(const uint8_t* message, size_t len, uint64_t rx_tsc, uint64_t stamp_tsc) {
+            using namespace sbe::coinbase;
+            MDSnapshotFullRefresh snapshot;
+            if (unlikely(!snapshot.wrap(message, len))) return 0;
+            if (!recovering_) {
+                ++stats_.snapshots_skipped;
+                return snapshot.encoded_length();
+            }
+
+            uint64_t last_rpt_seq = snapshot.last_rpt_seq();
+            uint64_t expected = last_rpt_seq + 1;
+            for (const auto& t : recovery_buffer_) {
+                if (t.id <= last_rpt_seq) continue;
+                if (t.id != expected) return snapshot.encoded_length(); // Too old: a hole follows it
+                ++expected;
+            }
+
+            uint64_t transact_time = snapshot.transact_time();
+            uint64_t decode_tsc = utils::rdtsc();
+            snapshot_.clear();
+            for (auto entry : snapshot.no_md_entries()) {
+                BinaryTick t;
+                if (unlikely(!make_tick(entry.price(), entry.size(), transact_time, decode_tsc, rx_tsc, stamp_tsc, t))) continue;
+                t.id = last_rpt_seq;
+                t.is_bid = entry.side() == Side::BUY;
+                t.is_snapshot = true; // Flag to tell engine to Reset book
+                snapshot_.push_back(t);
+            }
+            if (snapshot_.empty()) {
+                // An empty book still has to reach the engine as a reset
+                BinaryTick t{};
+                t.id = last_rpt_seq;
+                t.timestamp = decode_tsc;
+                t.symbol = SYMBOL;
+                t.is_snapshot = true;
+                t.exchange_timestamp = transact_time;
+                t.set_rx(rx_tsc, stamp_tsc);
+                snapshot_.push_back(t);
+            }
+            end_recovery(last_rpt_seq, rx_tsc);
+            return snapshot.encoded_length();
+        }
+
+        // Function: end_recovery
+        // Description: Stages, in RptSeq order: buffered trades older than the snapshot, the
+        //              snapshot, then every buffered tick newer than it. Buffered depth older
+        //              than the snapshot is dropped, the snapshot already reflects it.
+        void end_recovery(uint64_t last_rpt_seq, uint64_t rx_tsc) {
+            size_t superseded = 0;
+            size_t replayed = 0;
+            for (const auto& t : recovery_buffer_) {
+                if (t.id <= last_rpt_seq && t.is_trade) {
+                    batch_.push_back(t);
+                    ++replayed;
+                } else if (t.id <= last_rpt_seq) {
+                    ++superseded;
+                }
+            }
+            snapshot_.back().end_of_message = true;
+            batch_.insert(batch_.end(), snapshot_.begin(), snapshot_.end());
+            last_rpt_seq_ = last_rpt_seq;
+            for (const auto& t : recovery_buffer_) {
+                if (t.id > last_rpt_seq) {
+                    batch_.push_back(t);
+                    last_rpt_seq_ = t.id;
+                    ++replayed;
+                }
+            }
+            recovery_buffer_.clear();
+            recovering_ = false;
+
+            // The initial snapshot (late join) is not a recovery
+            if (recovery_start_tsc_ == 0) return;
+            uint64_t ns = rx_tsc > recovery_start_tsc_ ? static_cast<uint64_t>((rx_tsc - recovery_start_tsc_) / utils::CYCLES_PER_NS) : 0;
+            recovery_start_tsc_ = 0;
+            recovery_stats_.recoveries++;
+            recovery_stats_.ticks_replayed += replayed;
+            recovery_stats_.ticks_superseded += superseded;
+            recovery_stats_.last_ns = ns;
+            recovery_stats_.max_ns = std::max(recovery_stats_.max_ns, ns);
+            recovery_stats_.total_ns += ns;
+            std::cout << "[CoinbaseUDP] Snapshot applied. Recovered in " << ns / 1000 << " us (" << replayed
+                      << " buffered ticks replayed, " << superseded << " superseded)." << std::endl;
+        }
+
+        // Function: publish
+        // Description: Spin-waits until the ring has room for the whole batch, then makes it
+        //              visible with one release store.
+        void publish(const BinaryTick* ticks, size_t count) {
+            while (count > 0) {
+                size_t n = std::min(count, buffer_.capacity());
+                while (!buffer_.push_batch(ticks, n)) {
+                    utils::cpu_relax();
+                }
+                ticks += n;
+                count -= n;
+            }
         }
     };
 }
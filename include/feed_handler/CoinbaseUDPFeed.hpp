@@ -0,0 +1,139 @@
+#pragma once
+
+#include "CoinbaseUDP.hpp"
+#include "../common/RingBuffer.hpp"
+#include "../common/Types.hpp"
+#include "../common/Utils.hpp"
+#include "../network/UdpSocket.hpp"
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hft {
+
+    // Function: CoinbaseUDPFeed
+    // Description: Socket front end for CoinbaseUDPHandler: busy-polls the redundant
+    //              incremental lines (A, B, ...) and the snapshot line on one pinned
+    //              thread, draining each line with recvmmsg() batches. The snapshot group
+    //              is joined only while the handler needs a snapshot and left once the
+    //              book is back in sync. Needs no NIC setup, unlike DPDKPoller.
+    //              With receive timestamps on, ticks carry the kernel (or NIC) receive time
+    //              of their datagram, so socket queueing shows up in tick-to-trade latency.
+    class CoinbaseUDPFeed {
+    public:
+        // Datagrams read from one line (one recvmmsg call) before moving to the next
+        static constexpr size_t LINE_BURST = 32;
+
+        explicit CoinbaseUDPFeed(RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& output_buffer)
+            : output_buffer_(output_buffer) {}
+
+        ~CoinbaseUDPFeed() { stop(); }
+
+        // Line configuration. Call before start().
+        void add_line(const std::string& address, uint16_t port) { line_addresses_.push_back({address, port}); }
+        void set_snapshot_line(const std::string& address, uint16_t port) { snapshot_address_ = {address, port}; }
+        void set_interface(const std::string& interface) { interface_ = interface; }
+        void set_reorder_timeout_ns(uint64_t ns) { reorder_timeout_ns_ = ns; }
+        void set_busy_poll_us(int usecs) { busy_poll_us_ = usecs; }
+        // SO_TIMESTAMPING on the incremental lines (hardware: NIC stamps, see enable_rx_timestamping)
+        void set_rx_timestamps(bool enable, bool hardware = false) {
+            rx_timestamps_ = enable;
+            hw_timestamps_ = hardware;
+        }
+
+        bool start() {
+            if (line_addresses_.empty() || line_addresses_.size() > LineArbiter::MAX_LINES) {
+                std::cerr << "[CoinbaseUDP] Need 1 to " << LineArbiter::MAX_LINES << " lines." << std::endl;
+                return false;
+            }
+            handler_ = std::make_unique<CoinbaseUDPHandler>(output_buffer_, line_addresses_.size());
+            handler_->set_reorder_timeout_ns(reorder_timeout_ns_);
+
+            lines_.clear();
+            for (const auto& [address, port] : line_addresses_) {
+                lines_.push_back(std::make_unique<network::UdpSocket>());
+                if (!lines_.back()->open(address, port, interface_)) return false;
+                if (busy_poll_us_ > 0) lines_.back()->set_busy_poll(busy_poll_us_);
+                if (rx_timestamps_) lines_.back()->enable_rx_timestamps(hw_timestamps_);
+                std::cout << "[CoinbaseUDP] Line " << lines_.size() - 1 << ": " << address << ":" << port << std::endl;
+            }
+            if (!snapshot_address_.first.empty() &&
+                !snapshot_.open(snapshot_address_.first, snapshot_address_.second, interface_, false)) {
+                return false;
+            }
+
+            running_ = true;
+            feed_thread_ = std::thread(&CoinbaseUDPFeed::run, this);
+            return true;
+        }
+
+        void stop() {
+            running_ = false;
+            if (feed_thread_.joinable()) feed_thread_.join();
+            for (auto& line : lines_) line->close();
+            snapshot_.close();
+        }
+
+        // Counters; read after stop()
+        const CoinbaseUDPHandler& handler() const { return *handler_; }
+
+    private:
+        void run() {
+            utils::pin_thread_to_core(constants::FEED_HANDLER_CORE);
+            std::vector<uint8_t> buf(65536);
+            network::ReceiveBatch batch(LINE_BURST);
+
+            while (running_.load(std::memory_order_relaxed)) {
+                bool idle = true;
+                for (size_t i = 0; i < lines_.size(); ++i) {
+                    if (lines_[i]->receive_batch(batch) <= 0) continue;
+                    uint64_t rx_tsc = utils::rdtsc();
+                    // One clock pair per batch moves the receive timestamps onto the TSC
+                    const bool stamped = lines_[i]->rx_timestamps();
+                    uint64_t now_ns = stamped ? utils::realtime_ns() : 0;
+                    for (size_t n = 0; n < batch.size(); ++n) {
+                        // A cut datagram would lose its tail silently; treat it as lost
+                        if (unlikely(batch.truncated(n))) continue;
+                        uint64_t stamp_tsc = stamped && batch.rx_ns(n) != 0 ? utils::realtime_to_tsc(batch.rx_ns(n), rx_tsc, now_ns) : 0;
+                        handler_->on_packet(batch.data(n), batch.length(n), i, rx_tsc, stamp_tsc);
+                    }
+                    idle = false;
+                }
+
+                if (snapshot_.is_open()) {
+                    bool wanted = handler_->recovering();
+                    if (wanted != snapshot_.joined()) wanted ? snapshot_.join() : snapshot_.leave();
+                    ssize_t len = snapshot_.receive(buf.data(), buf.size());
+                    if (len > 0) {
+                        handler_->on_snapshot_packet(buf.data(), static_cast<uint16_t>(len), utils::rdtsc());
+                        idle = false;
+                    }
+                }
+
+                handler_->poll(utils::rdtsc());
+                if (idle) utils::cpu_relax();
+            }
+        }
+
+        RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& output_buffer_;
+        std::unique_ptr<CoinbaseUDPHandler> handler_;
+
+        std::vector<std::pair<std::string, uint16_t>> line_addresses_;
+        std::pair<std::string, uint16_t> snapshot_address_;
+        std::string interface_ = "0.0.0.0";
+        uint64_t reorder_timeout_ns_ = CoinbaseUDPHandler::DEFAULT_REORDER_TIMEOUT_NS;
+        int busy_poll_us_ = 0;
+        bool rx_timestamps_ = false;
+        bool hw_timestamps_ = false;
+
+        std::vector<std::unique_ptr<network::UdpSocket>> lines_;
+        network::UdpSocket snapshot_;
+
+        std::atomic<bool> running_{false};
+        std::thread feed_thread_;
+    };
+
+}
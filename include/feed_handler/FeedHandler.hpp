@@ -3,6 +3,7 @@
 #include "common/RingBuffer.hpp"
 #include "common/Types.hpp"
 #include "common/Utils.hpp"
+#include "storage/TickDataset.hpp"
 #include <atomic>
 #include <vector>
 #include <string>
@@ -31,21 +32,27 @@ namespace hft {
         void stop();
 
         // Function: init
-        // Description: Maps the binary market data file into memory.
-        // Inputs: filename - Path to the binary file.
+        // Description: Opens the market data to replay: one tick file (raw BinaryTick records
+        //              or a columnar tick store) or a directory of them, read as one dataset.
+        //              Files are mapped lazily; nothing is read up front but the indexes.
+        // Inputs: filename - Path to the tick file or dataset directory.
         void init(const std::string& filename);
 
+        // Function: set_range
+        // Description: Replays only ticks with from <= timestamp <= to (microseconds, as in
+        //              the tick files). Call before start().
+        void set_range(uint64_t from, uint64_t to);
+
     private:
         void run();
 
         RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& output_buffer_;
         std::atomic<bool> running_{false};
         std::thread thread_;
-        
-        int fd_ = -1;
-        size_t file_size_ = 0;
-        void* mapped_addr_ = nullptr;
-        std::span<const BinaryTick> ticks_;
+
+        storage::TickDataset dataset_;
+        uint64_t from_ = 0;
+        uint64_t to_ = UINT64_MAX;
     };
 
 }
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "../common/Utils.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace hft {
+
+    // Per-line arbitration counters. Times are TSC cycles of the receiving thread.
+    struct LineStats {
+        uint64_t messages = 0;     // Arbitrated messages received on the line
+        uint64_t wins = 0;         // First copies (published from this line)
+        uint64_t duplicates = 0;   // Later copies (dropped)
+        uint64_t lead_cycles = 0;  // Sum over wins of how far ahead of the next copy it was
+        uint64_t lag_cycles = 0;   // Sum over duplicates of how far behind the first copy it was
+        uint64_t max_lag_cycles = 0;
+        uint64_t gaps = 0;         // Sequence gaps on this line (covered or not)
+    };
+
+    // Function: LineArbiter
+    // Description: First-arrival arbitration across redundant lines carrying the same
+    //              messages. Each message is identified by a 64-bit key (a sequence number,
+    //              or a payload hash when lines are numbered independently) plus an optional
+    //              check word from an independent hash; the first copy wins and later copies
+    //              are dropped with one probe of a 2-way set associative table. Two messages
+    //              with the same key but different check words are a key collision: both
+    //              are published and the collision is counted. An entry is freed once every line has delivered it, so
+    //              the table only holds messages still in flight on some line.
+    //              Single-threaded: all lines must be polled from one thread.
+    class LineArbiter {
+    public:
+        static constexpr size_t MAX_LINES = 4;
+        static constexpr size_t SETS = 1 << 14; // 1 MB, 32K messages in flight
+
+        explicit LineArbiter(size_t lines = 1) : sets_(SETS) { reset(lines); }
+
+        void reset(size_t lines) {
+            lines_ = lines < 1 ? 1 : (lines > MAX_LINES ? MAX_LINES : lines);
+            std::memset(static_cast<void*>(sets_.data()), 0, sets_.size() * sizeof(Set));
+            stats_ = {};
+            unique_ = 0;
+            collisions_ = 0;
+        }
+
+        // Function: first_arrival
+        // Description: Records a copy of message key (with its check word) received on line
+        //              at rx_tsc.
+        // Outputs: True if this is the first copy (publish it), false for a duplicate.
+        bool first_arrival(uint64_t key, size_t line, uint64_t rx_tsc, uint64_t check = 0) {
+            if (key == 0) key = 1; // 0 marks a free way
+            LineStats& stats = stats_[line];
+            ++stats.messages;
+
+            Set& set = sets_[(key ^ (key >> 29)) & (SETS - 1)];
+            bool collided = false;
+            for (Entry& entry : set.ways) {
+                if (entry.key != key) continue;
+                if (entry.check != check) {
+                    collided = true;
+                    continue;
+                }
+                uint64_t lag = rx_tsc > entry.rx_tsc ? rx_tsc - entry.rx_tsc : 0;
+                ++stats.duplicates;
+                stats.lag_cycles += lag;
+                if (lag > stats.max_lag_cycles) stats.max_lag_cycles = lag;
+                // The winner's lead is how long it beat the runner-up by
+                if (entry.copies == 1) stats_[entry.line].lead_cycles += lag;
+                if (++entry.copies >= lines_) entry.key = 0;
+                return false;
+            }
+
+            if (collided) ++collisions_;
+
+            // New message: take a free way, else evict the older one
+            Entry& way = set.ways[0].key == 0 ? set.ways[0]
+                       : set.ways[1].key == 0 ? set.ways[1]
+                       : (set.ways[0].rx_tsc <= set.ways[1].rx_tsc ? set.ways[0] : set.ways[1]);
+            way.key = lines_ > 1 ? key : 0;
+            way.check = check;
+            way.rx_tsc = rx_tsc;
+            way.line = static_cast<uint32_t>(line);
+            way.copies = 1;
+            ++stats.wins;
+            ++unique_;
+            return true;
+        }
+
+        size_t lines() const { return lines_; }
+        uint64_t unique() const { return unique_; }
+        uint64_t collisions() const { return collisions_; }
+        LineStats& stats(size_t line) { return stats_[line]; }
+        const LineStats& stats(size_t line) const { return stats_[line]; }
+
+        // Function: print
+        // Description: Per-line win rate, lead when winning and lag (latency saved by not
+        //              depending on that line alone) when losing.
+        void print(const char* prefix) const {
+            for (size_t i = 0; i < lines_; ++i) {
+                const LineStats& s = stats_[i];
+                double win_rate = unique_ ? 100.0 * static_cast<double>(s.wins) / static_cast<double>(unique_) : 0.0;
+                double lead_us = s.wins ? s.lead_cycles / utils::CYCLES_PER_NS / 1000.0 / static_cast<double>(s.wins) : 0.0;
+                double lag_us = s.duplicates ? s.lag_cycles / utils::CYCLES_PER_NS / 1000.0 / static_cast<double>(s.duplicates) : 0.0;
+                std::cout << prefix << " line " << i << ": " << s.messages << " msgs, won " << s.wins << " ("
+                          << win_rate << "%), mean lead " << lead_us << " us, " << s.duplicates
+                          << " duplicates, mean lag " << lag_us << " us (max "
+                          << s.max_lag_cycles / utils::CYCLES_PER_NS / 1000.0 << " us, saved "
+                          << s.lag_cycles / utils::CYCLES_PER_NS / 1e6 << " ms total), " << s.gaps << " gaps" << std::endl;
+            }
+            if (collisions_ != 0) std::cout << prefix << " " << collisions_ << " key collisions" << std::endl;
+        }
+
+        // Key of a payload for lines that number messages independently.
+        struct PayloadKey {
+            uint64_t key;
+            uint64_t check;
+        };
+
+        // Function: payload_key
+        // Description: Key for lines that number messages independently (Coinbase's
+        //              sequence_num is per connection): CRC32C of the whole payload in the
+        //              high half and its length in the low half, plus a multiplicative hash
+        //              of the same bytes as the check word. The two hashes are unrelated, so
+        //              distinct messages sharing a key are told apart and counted instead
+        //              of being dropped as duplicates.
+        static PayloadKey payload_key(std::string_view payload) {
+            const char* p = payload.data();
+            size_t n = payload.size();
+            uint64_t check = 0x9E3779B97F4A7C15ULL ^ n;
+#if defined(__SSE4_2__)
+            uint64_t crc = 0;
+            for (; n >= 8; n -= 8, p += 8) {
+                uint64_t word;
+                std::memcpy(&word, p, 8);
+                crc = _mm_crc32_u64(crc, word);
+                check = std::rotl((check ^ word) * 0xFF51AFD7ED558CCDULL, 29);
+            }
+            uint32_t crc32 = static_cast<uint32_t>(crc);
+            for (; n > 0; --n, ++p) {
+                crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*p));
+                check = (check ^ static_cast<uint8_t>(*p)) * 0x100000001B3ULL;
+            }
+#else
+            uint32_t crc32 = 2166136261u; // FNV-1a
+            for (; n >= 8; n -= 8, p += 8) {
+                uint64_t word;
+                std::memcpy(&word, p, 8);
+                for (int i = 0; i < 8; ++i) crc32 = (crc32 ^ static_cast<uint8_t>(p[i])) * 16777619u;
+                check = std::rotl((check ^ word) * 0xFF51AFD7ED558CCDULL, 29);
+            }
+            for (; n > 0; --n, ++p) {
+                crc32 = (crc32 ^ static_cast<uint8_t>(*p)) * 16777619u;
+                check = (check ^ static_cast<uint8_t>(*p)) * 0x100000001B3ULL;
+            }
+#endif
+            return {(static_cast<uint64_t>(crc32) << 32) | static_cast<uint32_t>(payload.size()), check};
+        }
+
+    private:
+        struct Entry {
+            uint64_t key;
+            uint64_t check;
+            uint64_t rx_tsc;
+            uint32_t line;
+            uint32_t copies;
+        };
+        struct alignas(64) Set {
+            Entry ways[2];
+        };
+
+        size_t lines_ = 1;
+        std::vector<Set> sets_;
+        std::array<LineStats, MAX_LINES> stats_{};
+        uint64_t unique_ = 0;
+        uint64_t collisions_ = 0; // Distinct messages that shared a key
+
+    };
+
+}
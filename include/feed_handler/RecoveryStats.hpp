@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace hft {
+
+    // In-session gap recovery counters (read them after stop())
+    struct RecoveryStats {
+        uint64_t gaps = 0;            // Sequence gaps detected
+        uint64_t messages_lost = 0;   // Sequence numbers never received
+        uint64_t recoveries = 0;      // Gaps healed by an in-session snapshot
+        uint64_t reconnects = 0;      // Recoveries abandoned for a full reconnect
+        uint64_t ticks_replayed = 0;  // Buffered ticks published with the snapshot (WebSocket: trades only)
+        uint64_t ticks_superseded = 0; // Depth ticks during the gap already reflected in the snapshot
+        uint64_t last_ns = 0;         // Gap detection to book usable again
+        uint64_t max_ns = 0;
+        uint64_t total_ns = 0;
+    };
+
+}
@@ -4,43 +4,288 @@
 #include <rte_eal.h>
 #include <rte_ethdev.h>
 #include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
 #include <rte_cycles.h>
 #include <rte_ether.h>
 #include <rte_ip.h>
 #include <rte_udp.h>
+#include <rte_prefetch.h>
 #endif
 
+#include "UdpFlowFilter.hpp"
+#include "UdpHeaderTemplate.hpp"
+#include "../common/Utils.hpp"
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <string>
 #include <vector>
-#include <functional>
 
 namespace hft::network {
 
+    // Function: DPDKPoller
+    // Description: Kernel-bypass receive on one DPDK port. poll<Handler>() reads a burst from
+    //              an RX queue, prefetches packet headers ahead of the parse, hands the UDP
+    //              payload of every datagram that matches a flow (UdpFlowFilter: destination
+    //              group and port) to the handler, and frees the burst in bulk. The handler is a template
+    //              parameter so CoinbaseUDPHandler::on_packet inlines into the loop.
+    //              With several RX queues the NIC spreads flows over them by RSS hash; run
+    //              one pinned poller thread per queue, each with its own handler (the lines
+    //              of one feed must land on the same queue for arbitration).
+    //              send() writes a prebuilt header (UdpHeaderTemplate, one per destination)
+    //              and the payload straight into an mbuf and queues it on TX queue 0; the
+    //              queue goes out in one rte_eth_tx_burst when it fills, when the oldest
+    //              packet is older than the flush deadline, or on flush(). TX is for one
+    //              thread (the one running queue 0).
+    //              With set_rx_timestamps the NIC stamps each packet on arrival (the mbuf
+    //              timestamp dynfield) and the stamp reaches the handler on the TSC timebase.
     class DPDKPoller {
     public:
+        static constexpr uint16_t BURST_SIZE = 32;
+        // Packets ahead of the one being parsed whose first cache line is prefetched
+        static constexpr uint16_t PREFETCH_OFFSET = 4;
+        // Longest a queued TX packet waits for company before it is sent
+        static constexpr uint64_t DEFAULT_TX_FLUSH_NS = 2000;
+        static constexpr size_t MAX_DESTINATIONS = 16;
+        // NIC clock against TSC: first rate from pairs this far apart, then re-anchored
+        // (and the rate refined over the longer span) at most this often per queue
+        static constexpr uint64_t NIC_CLOCK_CALIBRATION_MS = 100;
+        static constexpr uint64_t NIC_CLOCK_RESYNC_NS = 100000000;
+
+        struct TxStats {
+            uint64_t packets = 0;   // Handed to the NIC
+            uint64_t bursts = 0;    // rte_eth_tx_burst calls that sent something
+            uint64_t dropped = 0;   // Unknown destination, too long, no mbuf, or the TX ring stayed full
+        };
+
         DPDKPoller(uint16_t port_id = 0);
         ~DPDKPoller();
 
-        // Initialize EAL and Port
+        // Initialize EAL and Port, with rx_queues RX queues (RSS over IP/UDP when > 1)
         // Returns number of arguments consumed
-        int init(int argc, char** argv);
-        
+        int init(int argc, char** argv, uint16_t rx_queues = 1);
+
+        // Ask the NIC for RX timestamps (RTE_ETH_RX_OFFLOAD_TIMESTAMP). Call before init();
+        // ports without the offload run without, handlers then get stamp_tsc 0.
+        void set_rx_timestamps(bool enable) { rx_timestamps_requested_ = enable; }
+        bool rx_timestamps() const { return rx_timestamp_flag_ != 0; }
+
         // Start the device
         void start();
-        
-        // Poll for packets (burst read)
-        // Callback receives pointer to packet data and length
-        void poll(std::function<void(const uint8_t*, uint16_t)> callback);
 
-        // Send a packet (burst write)
-        void send(const uint8_t* data, uint16_t len);
+        // Accept UDP datagrams sent to address:port (a multicast group or a unicast address).
+        // Returns the flow index passed to the handler, or -1. With no flows every UDP
+        // datagram is delivered as flow 0.
+        int add_flow(const std::string& address, uint16_t port) { return filter_.add(address, port); }
+
+        uint16_t rx_queues() const { return rx_queues_; }
+
+        // Function: poll
+        // Description: One burst read from an RX queue. Calls
+        //              handler(const uint8_t* payload, uint16_t len, size_t flow, uint64_t rx_tsc,
+        //                      uint64_t stamp_tsc)
+        //              for each matching datagram; rx_tsc is read once per burst, stamp_tsc is
+        //              the NIC's arrival stamp on the TSC timebase (0 without RX timestamps).
+        // Outputs: Packets taken from the queue (matching or not).
+        template <typename Handler>
+        uint16_t poll(Handler&& handler, uint16_t queue = 0);
+
+        // Function: run
+        // Description: Pins the calling thread to core and polls one queue until running clears.
+        template <typename Handler>
+        void run(uint16_t queue, int core, Handler&& handler, const std::atomic<bool>& running) {
+            utils::pin_thread_to_core(core);
+#ifdef USE_DPDK
+            rte_thread_register(); // An lcore id gives this thread a mempool cache
+#endif
+            while (running.load(std::memory_order_relaxed)) {
+                if (poll(handler, queue) != 0) {
+                    // Whatever the burst made the handler send leaves together
+                    if (queue == 0) flush();
+                } else {
+                    if (queue == 0) flush_if_due(utils::rdtsc());
+                    utils::cpu_relax();
+                }
+            }
+        }
+
+        // Function: add_destination
+        // Description: Prebuilds the Ethernet/IPv4/UDP header for a destination (after init(),
+        //              which reads the port MAC). A unicast destination needs its next-hop MAC.
+        // Outputs: The destination index for send(), or -1.
+        int add_destination(const std::string& src_address, uint16_t src_port,
+                            const std::string& dst_address, uint16_t dst_port, const std::string& dst_mac = "");
+
+        // Function: send
+        // Description: Queues one datagram of len bytes to a destination. The payload is
+        //              written in place: write(uint8_t* payload) fills the len bytes inside
+        //              the mbuf, so nothing is staged and copied.
+        // Outputs: false if the datagram was dropped (unknown destination, too long, no mbuf,
+        //          TX ring full).
+        template <typename Writer>
+        bool send(size_t destination, uint16_t len, Writer&& write);
+
+        // Same, copying the payload from data
+        bool send(size_t destination, const uint8_t* data, uint16_t len) {
+            return send(destination, len, [data, len](uint8_t* payload) { std::memcpy(payload, data, len); });
+        }
+
+        // Function: flush
+        // Description: Hands the queued packets to the NIC in one burst. Packets the TX ring
+        //              has no room for stay queued for the next flush.
+        // Outputs: Packets sent.
+        uint16_t flush();
+
+        // Flush if the oldest queued packet has passed the deadline (for idle loops)
+        void flush_if_due(uint64_t now_tsc) {
+            if (tx_count_ != 0 && now_tsc - tx_first_tsc_ >= tx_flush_cycles_) flush();
+        }
+
+        // 0 sends every packet as it is queued (a burst of one)
+        void set_tx_flush_ns(uint64_t ns) {
+            tx_flush_ns_ = ns;
+            tx_flush_cycles_ = static_cast<uint64_t>(ns * utils::CYCLES_PER_NS);
+        }
+
+        const TxStats& tx_stats() const { return tx_stats_; }
+        bool tx_ip_checksum_offload() const { return tx_ip_offload_; }
+        bool tx_udp_checksum_offload() const { return tx_udp_offload_; }
 
     private:
+        // NIC clock to TSC for one RX queue (each queue's thread keeps its own)
+        struct NicClock {
+            uint64_t nic = 0;               // Anchor pair, read back to back
+            uint64_t tsc = 0;
+            double cycles_per_tick = 0;
+        };
+
+        // New anchor pair; the rate is refined from the span since the last one
+        void resync_clock(NicClock& clock);
+
+        uint64_t nic_to_tsc(uint64_t nic, const NicClock& clock) const {
+            const int64_t ticks = static_cast<int64_t>(nic - clock.nic);
+            return clock.tsc + static_cast<uint64_t>(static_cast<int64_t>(static_cast<double>(ticks) * clock.cycles_per_tick));
+        }
+
 #ifdef USE_DPDK
         uint16_t port_id_;
-        struct rte_mempool *mbuf_pool_;
+        struct rte_mempool *tx_pool_;
+        std::vector<struct rte_mempool*> rx_pools_; // One per RX queue: each poller refills from its own
         struct rte_eth_conf port_conf_;
+        struct rte_ether_addr mac_;
+        struct rte_mbuf* tx_queue_[BURST_SIZE];
 #endif
+        uint16_t rx_queues_ = 1;
+        UdpFlowFilter filter_;
+
+        bool rx_timestamps_requested_ = false;
+        int rx_timestamp_offset_ = -1;      // mbuf dynfield holding the stamp
+        uint64_t rx_timestamp_flag_ = 0;    // ol_flags bit of a stamped mbuf; 0 when off
+        std::vector<NicClock> nic_clocks_;  // Per RX queue
+        uint64_t nic_clock_resync_cycles_ = 0;
+
+        UdpHeaderTemplate destinations_[MAX_DESTINATIONS];
+        size_t destination_count_ = 0;
+        uint16_t tx_count_ = 0;
+        uint64_t tx_first_tsc_ = 0;         // When the oldest queued packet was queued
+        uint64_t tx_flush_ns_ = DEFAULT_TX_FLUSH_NS;
+        uint64_t tx_flush_cycles_ = 0;      // From tx_flush_ns_ once the TSC is calibrated (init)
+        bool tx_ip_offload_ = false;
+        bool tx_udp_offload_ = false;
+        TxStats tx_stats_;
     };
 
+    template <typename Handler>
+    inline uint16_t DPDKPoller::poll(Handler&& handler, uint16_t queue) {
+#ifdef USE_DPDK
+        struct rte_mbuf *bufs[BURST_SIZE];
+        // Burst read from the NIC
+        const uint16_t nb_rx = rte_eth_rx_burst(port_id_, queue, bufs, BURST_SIZE);
+        if (nb_rx == 0) return 0;
+        const uint64_t rx_tsc = utils::rdtsc();
+
+        NicClock* clock = nullptr;
+        if (rx_timestamp_flag_ != 0) {
+            clock = &nic_clocks_[queue];
+            if (unlikely(rx_tsc - clock->tsc > nic_clock_resync_cycles_)) resync_clock(*clock);
+        }
+
+        for (uint16_t i = 0; i < nb_rx && i < PREFETCH_OFFSET; ++i) {
+            rte_prefetch0(rte_pktmbuf_mtod(bufs[i], void*));
+        }
+        for (uint16_t i = 0; i < nb_rx; ++i) {
+            if (i + PREFETCH_OFFSET < nb_rx) rte_prefetch0(rte_pktmbuf_mtod(bufs[i + PREFETCH_OFFSET], void*));
+
+            const uint8_t* payload;
+            uint16_t len;
+            int flow = filter_.classify(rte_pktmbuf_mtod(bufs[i], const uint8_t*), bufs[i]->data_len, payload, len);
+            if (flow < 0) continue;
+            uint64_t stamp_tsc = 0;
+            if (clock != nullptr && (bufs[i]->ol_flags & rx_timestamp_flag_) != 0) {
+                stamp_tsc = nic_to_tsc(*RTE_MBUF_DYNFIELD(bufs[i], rx_timestamp_offset_, rte_mbuf_timestamp_t*), *clock);
+            }
+            handler(payload, len, static_cast<size_t>(flow), rx_tsc, stamp_tsc);
+        }
+
+        // Return the whole burst to the pool at once
+        rte_pktmbuf_free_bulk(bufs, nb_rx);
+        return nb_rx;
+#else
+        (void)handler;
+        (void)queue;
+        return 0;
+#endif
+    }
+
+    template <typename Writer>
+    inline bool DPDKPoller::send(size_t destination, uint16_t len, Writer&& write) {
+#ifdef USE_DPDK
+        if (unlikely(destination >= destination_count_ || len > UdpHeaderTemplate::MAX_PAYLOAD)) {
+            ++tx_stats_.dropped;
+            return false;
+        }
+        if (unlikely(tx_count_ == BURST_SIZE) && flush() == 0) {
+            ++tx_stats_.dropped;
+            return false;
+        }
+        struct rte_mbuf* m = rte_pktmbuf_alloc(tx_pool_);
+        if (unlikely(m == nullptr)) {
+            ++tx_stats_.dropped;
+            return false;
+        }
+
+        // Header from the template, payload written where it will be sent from
+        uint8_t* frame = rte_pktmbuf_mtod(m, uint8_t*);
+        destinations_[destination].write(frame, len, !tx_ip_offload_);
+        write(frame + UdpHeaderTemplate::HEADER_LEN);
+        m->data_len = static_cast<uint16_t>(UdpHeaderTemplate::HEADER_LEN + len);
+        m->pkt_len = m->data_len;
+
+        if (tx_ip_offload_ || tx_udp_offload_) {
+            m->l2_len = UdpHeaderTemplate::ETH_LEN;
+            m->l3_len = UdpHeaderTemplate::IP_LEN;
+            m->ol_flags |= RTE_MBUF_F_TX_IPV4;
+            if (tx_ip_offload_) m->ol_flags |= RTE_MBUF_F_TX_IP_CKSUM;
+            if (tx_udp_offload_) {
+                // The NIC expects the pseudo-header checksum in place
+                m->ol_flags |= RTE_MBUF_F_TX_UDP_CKSUM;
+                auto* ip = reinterpret_cast<struct rte_ipv4_hdr*>(frame + UdpHeaderTemplate::IP_OFFSET);
+                auto* udp = reinterpret_cast<struct rte_udp_hdr*>(frame + UdpHeaderTemplate::UDP_OFFSET);
+                udp->dgram_cksum = rte_ipv4_phdr_cksum(ip, m->ol_flags);
+            }
+        }
+
+        const uint64_t now = utils::rdtsc();
+        if (tx_count_ == 0) tx_first_tsc_ = now;
+        tx_queue_[tx_count_++] = m;
+        if (tx_count_ == BURST_SIZE || now - tx_first_tsc_ >= tx_flush_cycles_) flush();
+        return true;
+#else
+        (void)destination;
+        (void)len;
+        (void)write;
+        return false;
+#endif
+    }
+
 }
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <time.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace hft::network {
+
+    // Room for one SCM_TIMESTAMPING control message (software, legacy and hardware times)
+    constexpr size_t RX_TIMESTAMP_CONTROL_BYTES = CMSG_SPACE(sizeof(scm_timestamping));
+
+    // Function: enable_rx_timestamping
+    // Description: Turns on SO_TIMESTAMPING receive timestamps for a UDP or TCP socket. The
+    //              kernel stamps each packet as the driver hands it up (software); with
+    //              hardware set it also reports the NIC's stamp, which needs the interface's
+    //              hardware timestamping enabled (hwstamp_ctl -r 1) and its PHC synchronized to
+    //              CLOCK_REALTIME (phc2sys), as receive times are read as wall clock.
+    //              log_prefix names the caller in the error message.
+    // Outputs: False if the socket option was refused.
+    inline bool enable_rx_timestamping(int fd, bool hardware, const char* log_prefix) {
+        int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (hardware) flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+        if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0) {
+            std::cerr << log_prefix << " SO_TIMESTAMPING failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Function: rx_timestamp_ns
+    // Description: The receive time carried by a recvmsg() result: the hardware stamp when
+    //              there is one, else the software stamp.
+    // Outputs: ns since epoch, 0 if the message carries none.
+    inline uint64_t rx_timestamp_ns(msghdr& msg) {
+        for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c != nullptr; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_TIMESTAMPING) continue;
+            scm_timestamping stamps;
+            std::memcpy(&stamps, CMSG_DATA(c), sizeof(stamps));
+            const timespec& ts = (stamps.ts[2].tv_sec != 0 || stamps.ts[2].tv_nsec != 0) ? stamps.ts[2] : stamps.ts[0];
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+        }
+        return 0;
+    }
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <openssl/ssl.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hft::network {
+
+    // Function: TlsSocket
+    // Description: A TCP socket with optional TLS on top (ssl_ctx == nullptr means plain TCP).
+    //              Owns the fd and the SSL handle. Reads and writes work in both blocking
+    //              and non-blocking mode; in non-blocking mode read() returns 0 instead of waiting.
+    class TlsSocket {
+    public:
+        TlsSocket() = default;
+        ~TlsSocket();
+
+        TlsSocket(const TlsSocket&) = delete;
+        TlsSocket& operator=(const TlsSocket&) = delete;
+
+        // Client side: blocking TCP connect, then TLS handshake (with SNI and, if
+        // verify is set, hostname verification) when ssl_ctx is given.
+        bool connect(const std::string& host, uint16_t port, SSL_CTX* ssl_ctx, bool verify);
+
+        // Server side: takes ownership of an accepted fd, then TLS accept when ssl_ctx is given.
+        bool accept(int fd, SSL_CTX* ssl_ctx);
+
+        void set_nonblocking(bool nonblocking);
+
+        // Function: enable_rx_timestamps
+        // Description: SO_TIMESTAMPING receive times (see RxTimestamps.hpp) for what read()
+        //              returns. Call after connect()/accept(): on TLS the handshake ran
+        //              through OpenSSL's socket BIO, and from here on ciphertext is received
+        //              with recvmsg() (which carries the stamp) and fed to OpenSSL through a
+        //              memory BIO.
+        // Outputs: False if the socket refused the option (reads carry no stamps then).
+        bool enable_rx_timestamps(bool hardware = false);
+
+        // Receive time of the last segment read (ns since epoch), 0 without timestamps.
+        // With TLS a record may span segments; this is the latest of them.
+        uint64_t last_rx_ns() const { return last_rx_ns_; }
+
+        // Returns bytes read, 0 if nothing is available (non-blocking), -1 on close or error.
+        ssize_t read(char* buf, size_t len);
+
+        // Writes everything, waiting for POLLOUT if the socket is non-blocking.
+        bool write_all(const char* data, size_t len);
+
+        // Waits until data can be read (or TLS already holds decrypted bytes).
+        // Outputs: False on timeout or error.
+        bool wait_readable(int timeout_ms);
+
+        // Unblocks a thread waiting on this socket without releasing the fd.
+        void shutdown();
+
+        void close();
+
+        bool is_open() const { return fd_ >= 0; }
+        int fd() const { return fd_; }
+
+    private:
+        // recvmsg() into buf, keeping the receive time. Same returns as read().
+        ssize_t receive_stamped(char* buf, size_t len);
+
+        int fd_ = -1;
+        SSL* ssl_ = nullptr;
+        bool nonblocking_ = false;
+
+        // Receive timestamps
+        bool rx_timestamps_ = false;
+        BIO* rbio_ = nullptr;          // Memory BIO OpenSSL reads ciphertext from (owned by ssl_)
+        std::vector<char> cipher_;     // recvmsg() buffer for ciphertext
+        uint64_t last_rx_ns_ = 0;
+    };
+
+}
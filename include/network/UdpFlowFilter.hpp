@@ -0,0 +1,135 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace hft::network {
+
+    // Link-layer header types (pcap LINKTYPE_* values)
+    enum class LinkType : uint16_t {
+        ETHERNET = 1,
+        RAW = 101,        // Bare IPv4/IPv6
+        LINUX_SLL = 113,  // tcpdump -i any
+        IPV4 = 228,
+        LINUX_SLL2 = 276,
+    };
+
+    // Function: UdpFlowFilter
+    // Description: Picks the UDP datagrams of wanted flows (destination address and port)
+    //              out of raw frames and returns their payload. One parse shared by the
+    //              DPDK receive path and pcap replay, so a capture exercises the same code
+    //              as the wire. Unfragmented IPv4 only; an 802.1Q tag is stepped over.
+    class UdpFlowFilter {
+    public:
+        static constexpr size_t MAX_FLOWS = 8;
+
+        // Accept UDP datagrams sent to address:port (a multicast group or a unicast address).
+        // Returns the flow index, or -1. With no flows every UDP datagram is flow 0.
+        int add(const std::string& address, uint16_t port) {
+            in_addr addr{};
+            if (count_ == MAX_FLOWS || inet_pton(AF_INET, address.c_str(), &addr) != 1) {
+                std::cerr << "[UdpFlowFilter] Cannot add flow " << address << ":" << port << std::endl;
+                return -1;
+            }
+            flows_[count_] = {addr.s_addr, htons(port)};
+            return static_cast<int>(count_++);
+        }
+
+        size_t size() const { return count_; }
+
+        // Returns the flow of a frame (-1 if not wanted) and its UDP payload
+        __attribute__((always_inline))
+        int classify(const uint8_t* frame, size_t len, const uint8_t*& payload, uint16_t& payload_len,
+                     LinkType link = LinkType::ETHERNET) const {
+            size_t l2 = 0;
+            uint16_t ether_type = ETHER_TYPE_IPV4;
+            switch (link) {
+            case LinkType::ETHERNET:
+                if (len < 14) return -1;
+                l2 = 14;
+                ether_type = load_be16(frame + 12);
+                if (ether_type == ETHER_TYPE_VLAN) {
+                    if (len < 18) return -1;
+                    l2 = 18;
+                    ether_type = load_be16(frame + 16);
+                }
+                break;
+            case LinkType::LINUX_SLL:
+                if (len < 16) return -1;
+                l2 = 16;
+                ether_type = load_be16(frame + 14);
+                break;
+            case LinkType::LINUX_SLL2:
+                if (len < 20) return -1;
+                l2 = 20;
+                ether_type = load_be16(frame);
+                break;
+            case LinkType::RAW:
+            case LinkType::IPV4:
+                break;
+            default:
+                return -1;
+            }
+            if (ether_type != ETHER_TYPE_IPV4) return -1;
+            return classify_ipv4(frame + l2, len - l2, payload, payload_len);
+        }
+
+        // Same, for a buffer that starts at the IPv4 header
+        __attribute__((always_inline))
+        int classify_ipv4(const uint8_t* ip, size_t len, const uint8_t*& payload, uint16_t& payload_len) const {
+            constexpr size_t UDP_HEADER = 8;
+            if (len < 20 + UDP_HEADER || (ip[0] >> 4) != 4) return -1;
+
+            // Fragments carry no (or only part of a) UDP datagram
+            if (ip[9] != IPPROTO_UDP || (load_be16(ip + 6) & (IP_MF | IP_OFFSET_MASK)) != 0) return -1;
+            size_t ip_header = (ip[0] & 0x0F) * 4;
+            if (ip_header < 20 || ip_header + UDP_HEADER > len) return -1;
+
+            const uint8_t* udp = ip + ip_header;
+            uint32_t dst_addr;
+            uint16_t dst_port;
+            std::memcpy(&dst_addr, ip + 16, sizeof(dst_addr));
+            std::memcpy(&dst_port, udp + 2, sizeof(dst_port));
+            int flow = match(dst_addr, dst_port);
+            if (flow < 0) return -1;
+
+            // UDP length includes its 8 byte header; the datagram must be all there
+            uint16_t udp_len = load_be16(udp + 4);
+            if (udp_len < UDP_HEADER || ip_header + udp_len > len) return -1;
+            payload = udp + UDP_HEADER;
+            payload_len = static_cast<uint16_t>(udp_len - UDP_HEADER);
+            return flow;
+        }
+
+    private:
+        static constexpr uint16_t ETHER_TYPE_IPV4 = 0x0800;
+        static constexpr uint16_t ETHER_TYPE_VLAN = 0x8100;
+        static constexpr uint16_t IP_MF = 0x2000;
+        static constexpr uint16_t IP_OFFSET_MASK = 0x1FFF;
+
+        // Destination address and port in network byte order, as they sit in the headers
+        struct Flow {
+            uint32_t address;
+            uint16_t port;
+        };
+
+        static uint16_t load_be16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+
+        __attribute__((always_inline))
+        int match(uint32_t address, uint16_t port) const {
+            if (count_ == 0) return 0;
+            for (size_t f = 0; f < count_; ++f) {
+                if (flows_[f].port == port && flows_[f].address == address) return static_cast<int>(f);
+            }
+            return -1;
+        }
+
+        Flow flows_[MAX_FLOWS] = {};
+        size_t count_ = 0;
+    };
+
+}
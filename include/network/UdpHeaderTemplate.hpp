@@ -0,0 +1,123 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace hft::network {
+
+    // Function: UdpHeaderTemplate
+    // Description: Prebuilt Ethernet/IPv4/UDP header for one destination, the send-side
+    //              counterpart of UdpFlowFilter. Everything but the two length fields and the
+    //              IPv4 checksum is fixed per destination, so a send copies HEADER_LEN bytes
+    //              and patches three fields. The IPv4 checksum is the stored sum of the fixed
+    //              words plus the total length (an incremental update, RFC 1624), unless the
+    //              NIC computes it. The UDP checksum is left zero (optional over IPv4) for
+    //              the NIC to fill in or not.
+    class UdpHeaderTemplate {
+    public:
+        static constexpr size_t ETH_LEN = 14;
+        static constexpr size_t IP_LEN = 20;
+        static constexpr size_t UDP_LEN = 8;
+        static constexpr size_t HEADER_LEN = ETH_LEN + IP_LEN + UDP_LEN;
+        static constexpr size_t IP_OFFSET = ETH_LEN;
+        static constexpr size_t UDP_OFFSET = ETH_LEN + IP_LEN;
+        // Largest payload in one unfragmented datagram on a 1500 byte MTU
+        static constexpr uint16_t MAX_PAYLOAD = 1500 - IP_LEN - UDP_LEN;
+
+        // Function: build
+        // Description: Fills the template. A multicast destination gets its group MAC
+        //              (01:00:5e + low 23 address bits); a unicast one needs dst_mac
+        //              ("aa:bb:cc:dd:ee:ff"), there being no ARP on a kernel-bypass port.
+        // Outputs: false on a bad address or MAC.
+        bool build(const uint8_t src_mac[6], const std::string& src_address, uint16_t src_port,
+                   const std::string& dst_address, uint16_t dst_port, const std::string& dst_mac = "",
+                   uint8_t ttl = 64) {
+            in_addr src{};
+            in_addr dst{};
+            if (inet_pton(AF_INET, src_address.c_str(), &src) != 1 || inet_pton(AF_INET, dst_address.c_str(), &dst) != 1) {
+                return false;
+            }
+            uint8_t* eth = header_;
+            const uint8_t* group = reinterpret_cast<const uint8_t*>(&dst.s_addr);
+            if ((group[0] & 0xF0) == 0xE0) {
+                const uint8_t mac[6] = {0x01, 0x00, 0x5e, static_cast<uint8_t>(group[1] & 0x7F), group[2], group[3]};
+                std::memcpy(eth, mac, 6);
+            } else if (!parse_mac(dst_mac, eth)) {
+                return false;
+            }
+            std::memcpy(eth + 6, src_mac, 6);
+            store_be16(eth + 12, ETHER_TYPE_IPV4);
+
+            uint8_t* ip = header_ + IP_OFFSET;
+            ip[0] = 0x45;                  // Version 4, 20 byte header
+            ip[1] = 0;
+            store_be16(ip + 2, 0);         // Total length: per packet
+            store_be16(ip + 4, 0);         // ID: unused with DF set (RFC 6864)
+            store_be16(ip + 6, IP_DF);
+            ip[8] = ttl;
+            ip[9] = IPPROTO_UDP;
+            store_be16(ip + 10, 0);        // Checksum: per packet
+            std::memcpy(ip + 12, &src.s_addr, 4);
+            std::memcpy(ip + 16, &dst.s_addr, 4);
+
+            uint8_t* udp = header_ + UDP_OFFSET;
+            store_be16(udp, src_port);
+            store_be16(udp + 2, dst_port);
+            store_be16(udp + 4, 0);        // Length: per packet
+            store_be16(udp + 6, 0);
+
+            partial_sum_ = 0;
+            for (size_t i = 0; i < IP_LEN; i += 2) partial_sum_ += load_be16(ip + i);
+            return true;
+        }
+
+        // Function: write
+        // Description: Header for a payload of payload_len bytes into frame (HEADER_LEN bytes).
+        //              ip_checksum false leaves the IPv4 checksum zero for the NIC.
+        __attribute__((always_inline))
+        void write(uint8_t* frame, uint16_t payload_len, bool ip_checksum = true) const {
+            std::memcpy(frame, header_, HEADER_LEN);
+            const uint16_t ip_len = static_cast<uint16_t>(IP_LEN + UDP_LEN + payload_len);
+            store_be16(frame + IP_OFFSET + 2, ip_len);
+            store_be16(frame + UDP_OFFSET + 4, static_cast<uint16_t>(UDP_LEN + payload_len));
+            if (ip_checksum) store_be16(frame + IP_OFFSET + 10, checksum(ip_len));
+        }
+
+        // IPv4 header checksum for a datagram of ip_len bytes
+        uint16_t checksum(uint16_t ip_len) const {
+            uint32_t sum = partial_sum_ + ip_len;
+            sum = (sum & 0xFFFF) + (sum >> 16);
+            sum = (sum & 0xFFFF) + (sum >> 16);
+            return static_cast<uint16_t>(~sum);
+        }
+
+        const uint8_t* header() const { return header_; }
+
+    private:
+        static constexpr uint16_t ETHER_TYPE_IPV4 = 0x0800;
+        static constexpr uint16_t IP_DF = 0x4000;
+
+        static uint16_t load_be16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+        static void store_be16(uint8_t* p, uint16_t v) {
+            p[0] = static_cast<uint8_t>(v >> 8);
+            p[1] = static_cast<uint8_t>(v);
+        }
+
+        static bool parse_mac(const std::string& text, uint8_t* mac) {
+            unsigned int b[6];
+            if (std::sscanf(text.c_str(), "%2x:%2x:%2x:%2x:%2x:%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) {
+                return false;
+            }
+            for (int i = 0; i < 6; ++i) mac[i] = static_cast<uint8_t>(b[i]);
+            return true;
+        }
+
+        alignas(64) uint8_t header_[HEADER_LEN] = {};
+        uint32_t partial_sum_ = 0; // Ones' complement sum of the IPv4 header, length and checksum zero
+    };
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hft::network {
+
+    // Function: ReceiveBatch
+    // Description: Buffers for one recvmmsg() call: up to capacity datagrams of up to
+    //              packet_bytes each, plus room for a kernel receive timestamp per datagram.
+    //              Valid until the next UdpSocket::receive_batch() with this batch.
+    class ReceiveBatch {
+    public:
+        explicit ReceiveBatch(size_t capacity = 32, size_t packet_bytes = 9216);
+
+        ReceiveBatch(const ReceiveBatch&) = delete;
+        ReceiveBatch& operator=(const ReceiveBatch&) = delete;
+
+        size_t size() const { return count_; }
+        size_t capacity() const { return msgs_.size(); }
+
+        const uint8_t* data(size_t i) const { return buffers_.data() + i * packet_bytes_; }
+        uint16_t length(size_t i) const { return static_cast<uint16_t>(msgs_[i].msg_len); }
+        // The datagram did not fit in packet_bytes and was cut
+        bool truncated(size_t i) const { return (msgs_[i].msg_hdr.msg_flags & MSG_TRUNC) != 0; }
+        // Kernel or NIC receive time (CLOCK_REALTIME ns), 0 unless timestamps are enabled
+        uint64_t rx_ns(size_t i) const { return rx_ns_[i]; }
+
+    private:
+        friend class UdpSocket;
+
+        std::vector<mmsghdr> msgs_;
+        std::vector<iovec> iovecs_;
+        std::vector<uint8_t> buffers_;
+        std::vector<uint8_t> control_;
+        std::vector<uint64_t> rx_ns_;
+        size_t packet_bytes_;
+        size_t count_ = 0;
+    };
+
+    // Function: UdpSocket
+    // Description: A non-blocking UDP receive socket bound to one feed line. A multicast
+    //              group address is joined on the given interface (join()/leave() switch
+    //              the membership at runtime); a unicast address (e.g. 127.0.0.1 for
+    //              loopback tests) is simply bound, and join()/leave() do nothing.
+    //              receive() reads one datagram per syscall; receive_batch() drains up to
+    //              a batch per recvmmsg() call.
+    class UdpSocket {
+    public:
+        UdpSocket() = default;
+        ~UdpSocket();
+
+        UdpSocket(const UdpSocket&) = delete;
+        UdpSocket& operator=(const UdpSocket&) = delete;
+
+        // Binds to address:port (address may be a multicast group) and joins a group
+        // unless join is false. interface is the local IPv4 address to join on
+        // ("0.0.0.0" lets the kernel pick).
+        bool open(const std::string& address, uint16_t port, const std::string& interface = "0.0.0.0",
+                  bool join = true);
+
+        bool join();
+        bool leave();
+
+        // Busy-polls the NIC queue for up to usecs inside receive calls (SO_BUSY_POLL,
+        // and SO_PREFER_BUSY_POLL where the kernel has it). Needs a NAPI device, so it is
+        // accepted but has no effect on loopback.
+        bool set_busy_poll(int usecs);
+
+        // Receive timestamps (SO_TIMESTAMPING), returned per datagram: the kernel's, or the
+        // NIC's with hardware set (see enable_rx_timestamping)
+        bool enable_rx_timestamps(bool hardware = false);
+
+        // Returns bytes received, 0 if nothing is waiting, -1 on error. rx_ns receives the
+        // receive timestamp when timestamps are enabled.
+        ssize_t receive(uint8_t* buf, size_t len, uint64_t* rx_ns = nullptr);
+
+        // Returns datagrams received into batch, 0 if nothing is waiting, -1 on error.
+        ssize_t receive_batch(ReceiveBatch& batch);
+
+        void close();
+
+        bool is_open() const { return fd_ >= 0; }
+        bool is_multicast() const { return multicast_; }
+        bool joined() const { return joined_; }
+        bool rx_timestamps() const { return timestamps_; }
+        int fd() const { return fd_; }
+
+    private:
+        bool membership(int option);
+
+        int fd_ = -1;
+        bool multicast_ = false;
+        bool joined_ = false;
+        bool timestamps_ = false;
+        ip_mreq mreq_{};
+    };
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "network/TlsSocket.hpp"
+#include "network/WebSocketProtocol.hpp"
+#include "common/Utils.hpp"
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hft::network {
+
+    // Function: WebSocketClient
+    // Description: Minimal RFC 6455 client (ws:// and wss://) for market data ingestion.
+    //              It owns no thread: the caller's pinned thread drives poll() in a busy loop
+    //              on a non-blocking socket. Data is decrypted straight into a ring of
+    //              reusable buffers and frames are handed out as string_views into them,
+    //              with at least PADDING readable bytes past every payload so simdjson can
+    //              parse in place.
+    //
+    //              A payload view stays valid until the ring wraps back to its buffer, i.e.
+    //              for at least (RING_SLOTS - 1) * SLOT_SIZE bytes of further traffic.
+    class WebSocketClient {
+    public:
+        static constexpr size_t RING_SLOTS = 4;
+        static constexpr size_t SLOT_SIZE = 1 << 20;   // Grows for larger frames (snapshots)
+        static constexpr size_t MIN_READ = 64 * 1024;  // Rotate when less space is left
+        static constexpr size_t PADDING = 64;          // >= simdjson::SIMDJSON_PADDING
+
+        WebSocketClient();
+        ~WebSocketClient();
+
+        WebSocketClient(const WebSocketClient&) = delete;
+        WebSocketClient& operator=(const WebSocketClient&) = delete;
+
+        // Verify the server certificate and hostname (default on). Off for self-signed test servers.
+        void set_tls_verify(bool verify) { tls_verify_ = verify; }
+
+        // Kernel (or, with hardware, NIC) receive timestamps on the socket, applied from the
+        // next connect(). Delivered to poll() handlers as stamp_tsc.
+        void set_rx_timestamps(bool enable, bool hardware = false) {
+            rx_timestamps_ = enable;
+            hardware_timestamps_ = hardware;
+        }
+
+        // Function: connect
+        // Description: Blocking TCP (+TLS) connect and HTTP upgrade, then switches the
+        //              socket to non-blocking. url: ws://host[:port][/path] or wss://...
+        // Outputs: True once the upgrade was accepted.
+        bool connect(const std::string& url);
+
+        void close();
+        bool is_open() const { return socket_.is_open(); }
+
+        // Sends one masked text frame (blocking until fully written).
+        bool send_text(std::string_view payload);
+
+        // Function: poll
+        // Description: One non-blocking read, then delivers every complete data message:
+        //              handler(std::string_view payload, size_t capacity, uint64_t rx_tsc,
+        //                      uint64_t stamp_tsc).
+        //              capacity is the number of readable bytes at payload.data(). stamp_tsc
+        //              is the socket receive time of the last segment read, on the TSC
+        //              timebase (0 without receive timestamps); a message completed by this
+        //              read may have started in earlier segments.
+        //              Ping/pong/close are handled internally.
+        // Outputs: Number of messages delivered. Check is_open() for disconnects.
+        template <typename Handler>
+        int poll(Handler&& handler) {
+            ssize_t n = read_some();
+            if (n < 0) {
+                close();
+                return 0;
+            }
+            if (n == 0 && !unparsed_) return 0;
+            unparsed_ = false;
+
+            uint64_t rx_tsc = utils::rdtsc();
+            uint64_t stamp_tsc = 0;
+            if (n > 0 && socket_.last_rx_ns() != 0) {
+                stamp_tsc = utils::realtime_to_tsc(socket_.last_rx_ns(), rx_tsc, utils::realtime_ns());
+            }
+            int delivered = 0;
+            std::string_view payload;
+            size_t capacity = 0;
+            while (is_open() && next_message(payload, capacity)) {
+                handler(payload, capacity, rx_tsc, stamp_tsc);
+                ++delivered;
+            }
+            return delivered;
+        }
+
+    private:
+        // Decrypts whatever is available into the current slot (rotating first if it is full).
+        // Outputs: Bytes read, 0 if none, -1 on disconnect.
+        ssize_t read_some();
+
+        // Moves the unparsed tail into the next slot, sized for at least `needed` bytes.
+        void rotate(size_t needed);
+
+        // Parses the next complete data message out of the current slot.
+        // Outputs: False when more bytes are needed (or the connection closed).
+        bool next_message(std::string_view& payload, size_t& capacity);
+
+        bool send_frame(ws::Opcode opcode, const char* data, size_t len);
+        bool handshake(const std::string& host, const std::string& path);
+
+        TlsSocket socket_;
+        SSL_CTX* ssl_ctx_ = nullptr;
+        bool tls_verify_ = true;
+        bool rx_timestamps_ = false;
+        bool hardware_timestamps_ = false;
+
+        std::array<std::vector<char>, RING_SLOTS> slots_;
+        size_t current_ = 0;
+        size_t read_pos_ = 0;       // Start of unparsed bytes in the current slot
+        size_t write_pos_ = 0;      // End of decrypted bytes in the current slot
+        size_t pending_frame_ = 0;  // Total size of a partially received frame, if known
+        bool unparsed_ = false;     // Bytes arrived with the handshake and are not parsed yet
+
+        // Fragmented messages are reassembled here (rare on market data feeds)
+        std::vector<char> assembly_;
+        size_t assembly_len_ = 0;
+        bool assembling_ = false;
+
+        std::string send_buffer_;
+        uint64_t mask_state_;
+    };
+
+}
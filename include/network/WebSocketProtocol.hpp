@@ -0,0 +1,176 @@
+#pragma once
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// RFC 6455 framing helpers shared by WebSocketClient and WebSocketServer.
+
+namespace hft::network::ws {
+
+    enum class Opcode : uint8_t {
+        CONTINUATION = 0x0,
+        TEXT = 0x1,
+        BINARY = 0x2,
+        CLOSE = 0x8,
+        PING = 0x9,
+        PONG = 0xA
+    };
+
+    // Largest possible frame header: 2 + 8 (64-bit length) + 4 (mask key)
+    constexpr size_t MAX_HEADER_SIZE = 14;
+
+    struct FrameHeader {
+        bool fin;
+        Opcode opcode;
+        bool masked;
+        uint8_t mask[4];
+        uint64_t payload_len;
+        size_t header_len;
+    };
+
+    // Function: parse_frame_header
+    // Description: Decodes a frame header from the start of data.
+    // Outputs: False if fewer than header_len bytes are available yet.
+    inline bool parse_frame_header(const char* data, size_t len, FrameHeader& header) {
+        if (len < 2) return false;
+        const auto* p = reinterpret_cast<const uint8_t*>(data);
+
+        header.fin = (p[0] & 0x80) != 0;
+        header.opcode = static_cast<Opcode>(p[0] & 0x0F);
+        header.masked = (p[1] & 0x80) != 0;
+
+        uint64_t payload_len = p[1] & 0x7F;
+        size_t offset = 2;
+        if (payload_len == 126) {
+            if (len < 4) return false;
+            payload_len = (static_cast<uint64_t>(p[2]) << 8) | p[3];
+            offset = 4;
+        } else if (payload_len == 127) {
+            if (len < 10) return false;
+            payload_len = 0;
+            for (size_t i = 0; i < 8; ++i) payload_len = (payload_len << 8) | p[2 + i];
+            offset = 10;
+        }
+
+        if (header.masked) {
+            if (len < offset + 4) return false;
+            std::memcpy(header.mask, p + offset, 4);
+            offset += 4;
+        }
+
+        header.payload_len = payload_len;
+        header.header_len = offset;
+        return true;
+    }
+
+    // Function: write_frame_header
+    // Description: Encodes a single frame header into out (>= MAX_HEADER_SIZE bytes).
+    //              mask is null for server frames, 4 bytes for client frames.
+    // Outputs: Header length in bytes.
+    inline size_t write_frame_header(char* out, Opcode opcode, uint64_t payload_len, const uint8_t* mask, bool fin = true) {
+        auto* p = reinterpret_cast<uint8_t*>(out);
+        p[0] = static_cast<uint8_t>((fin ? 0x80 : 0x00) | static_cast<uint8_t>(opcode));
+        uint8_t mask_bit = mask ? 0x80 : 0x00;
+
+        size_t offset;
+        if (payload_len < 126) {
+            p[1] = static_cast<uint8_t>(mask_bit | payload_len);
+            offset = 2;
+        } else if (payload_len <= 0xFFFF) {
+            p[1] = mask_bit | 126;
+            p[2] = static_cast<uint8_t>(payload_len >> 8);
+            p[3] = static_cast<uint8_t>(payload_len);
+            offset = 4;
+        } else {
+            p[1] = mask_bit | 127;
+            for (size_t i = 0; i < 8; ++i) p[2 + i] = static_cast<uint8_t>(payload_len >> (56 - 8 * i));
+            offset = 10;
+        }
+
+        if (mask) {
+            std::memcpy(p + offset, mask, 4);
+            offset += 4;
+        }
+        return offset;
+    }
+
+    // Function: apply_mask
+    // Description: XORs data with the 4-byte mask key (masking and unmasking are the same).
+    inline void apply_mask(char* data, size_t len, const uint8_t mask[4]) {
+        uint32_t key;
+        std::memcpy(&key, mask, 4);
+        uint64_t key64 = (static_cast<uint64_t>(key) << 32) | key;
+
+        size_t i = 0;
+        for (; i + 8 <= len; i += 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, data + i, 8);
+            chunk ^= key64;
+            std::memcpy(data + i, &chunk, 8);
+        }
+        for (; i < len; ++i) {
+            data[i] = static_cast<char>(data[i] ^ mask[i & 3]);
+        }
+    }
+
+    // Function: compute_accept_key
+    // Description: Sec-WebSocket-Accept for a given Sec-WebSocket-Key (base64(SHA1(key + GUID))).
+    inline std::string compute_accept_key(std::string_view key) {
+        static constexpr char GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        std::string input(key);
+        input += GUID;
+
+        unsigned char digest[SHA_DIGEST_LENGTH];
+        SHA1(reinterpret_cast<const unsigned char*>(input.data()), input.size(), digest);
+
+        unsigned char encoded[4 * ((SHA_DIGEST_LENGTH + 2) / 3) + 1];
+        int len = EVP_EncodeBlock(encoded, digest, SHA_DIGEST_LENGTH);
+        return std::string(reinterpret_cast<char*>(encoded), static_cast<size_t>(len));
+    }
+
+    // Function: make_client_key
+    // Description: Random base64 Sec-WebSocket-Key (16 bytes of entropy).
+    inline std::string make_client_key() {
+        unsigned char nonce[16];
+        RAND_bytes(nonce, sizeof(nonce));
+
+        unsigned char encoded[4 * ((sizeof(nonce) + 2) / 3) + 1];
+        int len = EVP_EncodeBlock(encoded, nonce, sizeof(nonce));
+        return std::string(reinterpret_cast<char*>(encoded), static_cast<size_t>(len));
+    }
+
+    // Function: find_header
+    // Description: Case-insensitive lookup of an HTTP header value in a raw request/response.
+    inline std::string_view find_header(std::string_view head, std::string_view name) {
+        size_t pos = head.find("\r\n");
+        while (pos != std::string_view::npos && pos + 2 < head.size()) {
+            size_t line_start = pos + 2;
+            size_t line_end = head.find("\r\n", line_start);
+            if (line_end == std::string_view::npos) line_end = head.size();
+            std::string_view line = head.substr(line_start, line_end - line_start);
+
+            size_t colon = line.find(':');
+            if (colon == name.size()) {
+                bool match = true;
+                for (size_t i = 0; i < name.size() && match; ++i) {
+                    match = (std::tolower(static_cast<unsigned char>(line[i])) == std::tolower(static_cast<unsigned char>(name[i])));
+                }
+                if (match) {
+                    std::string_view value = line.substr(colon + 1);
+                    while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+                    while (!value.empty() && value.back() == ' ') value.remove_suffix(1);
+                    return value;
+                }
+            }
+            pos = line_end;
+        }
+        return {};
+    }
+
+}
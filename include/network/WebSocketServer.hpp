@@ -0,0 +1,87 @@
+#pragma once
+
+#include "network/TlsSocket.hpp"
+#include "network/WebSocketProtocol.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace hft::network {
+
+    // Function: WebSocketServer
+    // Description: Small blocking RFC 6455 server (ws:// or wss://) for tests, benchmarks and
+    //              local exchange stand-ins. Not on any hot path: one thread per connection,
+    //              and a Connection must only be used from its handler thread.
+    class WebSocketServer {
+    public:
+        class Connection {
+        public:
+            // Request path of the upgrade (e.g. "/" or "/ws?x=1")
+            const std::string& path() const { return path_; }
+
+            bool send_text(std::string_view payload) { return send_frame(ws::Opcode::TEXT, payload); }
+            // fin = false starts/continues a fragmented message (finish with CONTINUATION, fin = true)
+            bool send_frame(ws::Opcode opcode, std::string_view payload, bool fin = true);
+
+            // Function: read_message
+            // Description: Reads the next text/binary message, answering pings on the way.
+            // Outputs: 1 if a message was read into out, 0 on timeout, -1 once closed.
+            int read_message(std::string& out, int timeout_ms);
+
+            // Sends a close frame and drops the TCP connection (abrupt disconnect if code == 0).
+            void close(uint16_t code = 1000);
+            bool is_open() const { return socket_.is_open(); }
+
+        private:
+            friend class WebSocketServer;
+            bool handshake();
+
+            TlsSocket socket_;
+            std::string path_;
+            std::string rx_;
+            std::string tx_;
+            std::string fragments_;
+            bool closing_ = false;
+        };
+
+        using Handler = std::function<void(Connection&)>;
+
+        WebSocketServer() = default;
+        ~WebSocketServer();
+
+        // Function: listen
+        // Description: Binds 127.0.0.1:port (0 = ephemeral). With tls, serves wss:// using the
+        //              given PEM files, or a freshly generated self-signed certificate if empty.
+        bool listen(uint16_t port, bool tls, const std::string& cert_file = "", const std::string& key_file = "",
+                    const std::string& bind_address = "127.0.0.1");
+
+        uint16_t port() const { return port_; }
+        bool running() const { return running_.load(std::memory_order_relaxed); }
+
+        // Accepts connections on a background thread; handler runs on a per-connection thread
+        // and should return once the connection closes or running() turns false.
+        void start(Handler handler);
+        void stop();
+
+    private:
+        void accept_loop();
+        void serve(int fd);
+
+        int listen_fd_ = -1;
+        uint16_t port_ = 0;
+        SSL_CTX* ssl_ctx_ = nullptr;
+        Handler handler_;
+        std::atomic<bool> running_{false};
+        std::thread accept_thread_;
+
+        std::mutex mutex_;
+        std::vector<std::thread> connection_threads_;
+        std::vector<Connection*> connections_;
+    };
+
+}
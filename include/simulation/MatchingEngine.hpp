@@ -1,7 +1,7 @@
 #pragma once
 #include "common/Types.hpp"
 #include <vector>
-#include <list>
+#include <deque>
 #include <algorithm>
 
 namespace hft {
@@ -12,7 +12,7 @@ public:
         uint64_t id;
         bool is_buy;
         int64_t price;
-        int64_t quantity;
+        int64_t quantity; // Remaining (unfilled) quantity
         uint64_t timestamp;
         uint64_t live_at; // Timestamp when order becomes active (latency simulation)
     };
@@ -23,80 +23,167 @@ public:
         int64_t price;
         int64_t quantity;
         double fee;
+        bool is_complete; // True if this fill exhausted the order
     };
 
     // Configurable Fee and Latency
     double fee_rate_ = 0.004; // 0.4%
     uint64_t latency_ns_ = 50000000; // 50ms
 
-    // Returns a list of filled orders
-    std::vector<Fill> on_trade_update(int64_t trade_price, uint64_t current_ts) {
-        // 1. Move pending orders to open if latency passed
-        auto p_it = pending_orders_.begin();
-        while (p_it != pending_orders_.end()) {
-            if (current_ts >= p_it->live_at) {
-                open_orders_.push_back(*p_it);
-                p_it = pending_orders_.erase(p_it);
-            } else {
-                ++p_it;
-            }
-        }
+    // Function: on_trade_update
+    // Description: Activates actions whose latency has elapsed, then matches the trade print
+    //              against resting orders in time priority. The trade quantity is consumed
+    //              as orders fill, so a small print only partially fills a large quote.
+    // Inputs: trade_price, trade_quantity - The print (fixed point).
+    //         current_ts - Timestamp of the print.
+    //         fills - Output; new fills are appended.
+    // Outputs: Number of fills appended.
+    size_t on_trade_update(int64_t trade_price, int64_t trade_quantity, uint64_t current_ts, std::vector<Fill>& fills) {
+        advance(current_ts);
 
-        std::vector<Fill> fills;
+        size_t fill_count = 0;
+        int64_t remaining = trade_quantity;
         auto it = open_orders_.begin();
-        while (it != open_orders_.end()) {
-            bool filled = false;
+        while (it != open_orders_.end() && remaining > 0) {
             // Conservative Fill Logic:
             // Buy Order at P is filled if Trade Price <= P
             // Sell Order at P is filled if Trade Price >= P
-            
-            if (it->is_buy && trade_price <= it->price) {
-                filled = true;
-            } else if (!it->is_buy && trade_price >= it->price) {
-                filled = true;
+            bool crossed = it->is_buy ? (trade_price <= it->price) : (trade_price >= it->price);
+            if (!crossed) {
+                ++it;
+                continue;
             }
 
-            if (filled) {
-                // Calculate Fee (assuming price/quantity are in fixed point, we return raw fee)
-                // Fee = Price * Quantity * Rate
-                // Note: We need to be careful with units. 
-                // If Price is 1e2 and Quantity is 1e8, P*Q is 1e10.
-                // Let's just return the fee as a double relative to the notional value.
-                double notional = (double)it->price * (double)it->quantity;
-                double fee = notional * fee_rate_;
-                
-                fills.push_back({it->id, it->is_buy, it->price, it->quantity, fee});
+            int64_t fill_qty = std::min(remaining, it->quantity);
+            remaining -= fill_qty;
+            it->quantity -= fill_qty;
+
+            // Fee is returned relative to the raw fixed point notional (Price * Quantity)
+            double notional = (double)it->price * (double)fill_qty;
+            double fee = notional * fee_rate_;
+            bool complete = (it->quantity == 0);
+
+            fills.push_back({it->id, it->is_buy, it->price, fill_qty, fee, complete});
+            ++fill_count;
+
+            if (complete) {
                 it = open_orders_.erase(it);
             } else {
                 ++it;
             }
         }
-        return fills;
+        return fill_count;
+    }
+
+    // Function: submit
+    // Description: Routes an Order to place/cancel/replace based on its action.
+    void submit(const Order& order, uint64_t current_ts) {
+        switch (order.action) {
+            case OrderAction::NEW:     place_order(order, current_ts); break;
+            case OrderAction::CANCEL:  cancel_order(order.id, current_ts); break;
+            case OrderAction::REPLACE: replace_order(order, current_ts); break;
+        }
     }
 
     void place_order(const Order& order, uint64_t current_ts) {
-        pending_orders_.push_back({
-            order.id, 
-            order.is_buy, 
-            order.price, 
-            order.quantity, 
-            order.origin_timestamp,
-            current_ts + latency_ns_
-        });
+        enqueue(Action::PLACE, order, current_ts);
+    }
+
+    // Function: cancel_order
+    // Description: Cancels a resting order once the simulated latency has elapsed.
+    //              Fills that happen before the cancel arrives still stand.
+    void cancel_order(uint64_t order_id, uint64_t current_ts) {
+        Order order{};
+        order.id = order_id;
+        enqueue(Action::CANCEL, order, current_ts);
+    }
+
+    // Function: replace_order
+    // Description: Amends price/quantity of order.id once the simulated latency has elapsed.
+    //              The amended order goes to the back of the queue. No-op if already gone.
+    void replace_order(const Order& order, uint64_t current_ts) {
+        enqueue(Action::REPLACE, order, current_ts);
     }
-    
+
+    // Function: advance
+    // Description: Applies every queued action whose live_at has been reached.
+    //              Latency is constant, so the queue is already ordered by live_at.
+    void advance(uint64_t current_ts) {
+        while (!pending_.empty() && current_ts >= pending_.front().order.live_at) {
+            const PendingAction& action = pending_.front();
+            switch (action.type) {
+                case Action::PLACE:
+                    open_orders_.push_back(action.order);
+                    --pending_places_;
+                    break;
+                case Action::CANCEL: {
+                    auto it = find_open(action.order.id);
+                    if (it != open_orders_.end()) open_orders_.erase(it);
+                    break;
+                }
+                case Action::REPLACE: {
+                    auto it = find_open(action.order.id);
+                    if (it != open_orders_.end()) {
+                        open_orders_.erase(it);
+                        if (action.order.quantity > 0) open_orders_.push_back(action.order);
+                    }
+                    break;
+                }
+            }
+            pending_.pop_front();
+        }
+    }
+
     void cancel_all() {
         open_orders_.clear();
-        pending_orders_.clear();
+        pending_.clear();
+        pending_places_ = 0;
     }
 
+    // Function: is_open
+    // Description: True if the order is resting on the simulated book.
+    bool is_open(uint64_t order_id) const {
+        for (const auto& o : open_orders_) {
+            if (o.id == order_id) return true;
+        }
+        return false;
+    }
+
+    // Resting orders plus places still in flight (queued cancels/amends are not orders)
     size_t open_order_count() const {
-        return open_orders_.size() + pending_orders_.size();
+        return open_orders_.size() + pending_places_;
     }
 
 private:
-    std::list<OpenOrder> open_orders_;
-    std::list<OpenOrder> pending_orders_;
+    enum class Action : uint8_t { PLACE, CANCEL, REPLACE };
+
+    struct PendingAction {
+        Action type;
+        OpenOrder order;
+    };
+
+    void enqueue(Action type, const Order& order, uint64_t current_ts) {
+        if (type == Action::PLACE) ++pending_places_;
+        pending_.push_back({type, {
+            order.id,
+            order.is_buy,
+            order.price,
+            order.quantity,
+            order.origin_timestamp,
+            current_ts + latency_ns_
+        }});
+    }
+
+    std::vector<OpenOrder>::iterator find_open(uint64_t order_id) {
+        return std::find_if(open_orders_.begin(), open_orders_.end(),
+                            [order_id](const OpenOrder& o) { return o.id == order_id; });
+    }
+
+    // Resting orders in time priority. A strategy keeps a handful of quotes,
+    // so a flat vector beats a node-based container for scan and erase.
+    std::vector<OpenOrder> open_orders_;
+    std::deque<PendingAction> pending_;
+    size_t pending_places_ = 0;
 };
 
 }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Block-indexed capture file (market_data.bin)
+//
+//   [FileHeader, padded to ALIGNMENT]
+//   [BlockHeader | records (raw or zlib) | zero pad to ALIGNMENT] ...
+//   [BlockIndexEntry x block_count | zero pad | FileFooter]   <- footer ends the file
+//
+// Every block starts on an ALIGNMENT boundary so it can be written with O_DIRECT and
+// located without the index (a capture cut short by a crash has no footer; readers then
+// walk block headers). Inside a block the records keep the original capture layout:
+//   uint64_t rx_tsc | uint32_t length | length bytes of WebSocket payload
+// Files that start with anything other than FILE_MAGIC are that bare record stream
+// (pre-block captures). Those are made seekable by a side index, <capture>.idx:
+//   [SideIndexHeader | BlockIndexEntry x entry_count]
+// where each entry describes a ~SIDE_INDEX_SPAN run of whole records in the stream.
+
+namespace hft::storage {
+
+    constexpr size_t ALIGNMENT = 4096;
+    constexpr char FILE_MAGIC[8] = {'H', 'F', 'T', 'C', 'A', 'P', '0', '1'};
+    constexpr char FOOTER_MAGIC[8] = {'H', 'F', 'T', 'I', 'D', 'X', '0', '1'};
+    constexpr uint32_t BLOCK_MAGIC = 0x4B4C4243; // "CBLK"
+    constexpr uint32_t FORMAT_VERSION = 1;
+    constexpr char SIDE_INDEX_MAGIC[8] = {'H', 'F', 'T', 'S', 'I', 'D', 'X', '1'};
+    constexpr size_t SIDE_INDEX_SPAN = 1 << 20;
+
+    enum class Compression : uint8_t {
+        NONE = 0,
+        ZLIB = 1
+    };
+
+    // Per-record prefix, identical to the pre-block stream format
+    struct __attribute__((packed)) RecordHeader {
+        uint64_t timestamp; // rx TSC
+        uint32_t length;
+    };
+    static_assert(sizeof(RecordHeader) == 12);
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t block_size;       // Nominal raw bytes per block
+        uint8_t compression;       // Compression of blocks written by this file's writer
+        uint8_t reserved[7];
+        // TSC calibration at capture time, so readers can map rx TSC to wall-clock time
+        double cycles_per_ns;
+        uint64_t tsc_anchor;
+        int64_t unix_ns_anchor;
+        uint8_t pad[16];
+    };
+    static_assert(sizeof(FileHeader) == 64);
+
+    struct BlockHeader {
+        uint32_t magic;
+        uint32_t record_count;
+        uint32_t raw_bytes;        // Record bytes after decompression
+        uint32_t stored_bytes;     // Record bytes as written after this header
+        uint64_t first_timestamp;
+        uint64_t last_timestamp;
+        uint32_t checksum;         // crc32 of the stored bytes
+        uint8_t compression;
+        uint8_t pad[27];
+    };
+    static_assert(sizeof(BlockHeader) == 64);
+
+    struct BlockIndexEntry {
+        uint64_t offset;           // File offset of the BlockHeader
+        uint64_t first_timestamp;
+        uint64_t last_timestamp;
+        uint32_t record_count;
+        uint32_t stored_bytes;
+    };
+    static_assert(sizeof(BlockIndexEntry) == 32);
+
+    struct FileFooter {
+        uint64_t index_offset;
+        uint64_t block_count;
+        uint64_t record_count;
+        char magic[8];
+    };
+    static_assert(sizeof(FileFooter) == 32);
+
+    struct SideIndexHeader {
+        char magic[8];
+        uint64_t source_size;      // Capture size when indexed; a mismatch means rebuild
+        uint64_t entry_count;
+        uint64_t record_count;
+    };
+    static_assert(sizeof(SideIndexHeader) == 32);
+
+    constexpr size_t align_up(size_t n) {
+        return (n + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    constexpr size_t align_down(size_t n) {
+        return n & ~(ALIGNMENT - 1);
+    }
+
+    // On-disk size of a block: header plus stored records, padded to ALIGNMENT
+    constexpr size_t block_span(uint32_t stored_bytes) {
+        return align_up(sizeof(BlockHeader) + stored_bytes);
+    }
+
+}
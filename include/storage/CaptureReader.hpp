@@ -0,0 +1,123 @@
+#pragma once
+
+#include "storage/CaptureFormat.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hft::storage {
+
+    struct CaptureRecord {
+        uint64_t timestamp; // rx TSC
+        std::string_view data;
+    };
+
+    // Function: CaptureReader
+    // Description: Memory-mapped reader for capture files, block-indexed or the older bare
+    //              record stream. Records are returned as views into the mapping (or into
+    //              the current inflated block for zlib captures) and stay valid until the
+    //              next call that moves to another block.
+    //              The cursor streams: pages a window ahead are requested with
+    //              MADV_WILLNEED, the next couple of MB are prefaulted in one call, and
+    //              pages a window behind are dropped, so resident memory stays bounded by
+    //              the window, not by the capture size.
+    class CaptureReader {
+    public:
+        static constexpr size_t DEFAULT_WINDOW = 16 << 20;
+        static constexpr size_t PREFAULT_SPAN = 1 << 20;
+
+        CaptureReader() = default;
+        ~CaptureReader();
+
+        CaptureReader(const CaptureReader&) = delete;
+        CaptureReader& operator=(const CaptureReader&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        // Function: next
+        // Description: Reads the next record.
+        // Outputs: false at the end of the file (or at the first truncated record).
+        bool next(CaptureRecord& out) {
+            if (static_cast<size_t>(end_ - cursor_) >= sizeof(RecordHeader)) {
+                RecordHeader header;
+                std::memcpy(&header, cursor_, sizeof(header));
+                if (header.length <= static_cast<size_t>(end_ - cursor_) - sizeof(header)) {
+                    out.timestamp = header.timestamp;
+                    out.data = std::string_view(cursor_ + sizeof(header), header.length);
+                    cursor_ += sizeof(header) + header.length;
+                    // Next record's header and first lines; the window keeps the pages in
+                    __builtin_prefetch(cursor_);
+                    __builtin_prefetch(cursor_ + 64);
+                    if (!block_format_ && static_cast<size_t>(cursor_ - base_) >= advise_mark_) {
+                        advance_window(static_cast<size_t>(cursor_ - base_));
+                    }
+                    return true;
+                }
+            }
+            return next_slow(out);
+        }
+
+        void rewind();
+
+        // Function: seek
+        // Description: Positions the cursor on the first record with timestamp >= ts, using
+        //              the block index (or, for bare streams, the side index, built and saved
+        //              on first use) and then a scan of a single block.
+        // Outputs: false if no such record exists.
+        bool seek(uint64_t ts);
+
+        // Function: ensure_index
+        // Description: Loads <path>.idx for a bare stream, or builds and writes it (one
+        //              sequential pass). Block-format files carry their index already.
+        bool ensure_index();
+
+        bool is_open() const { return base_ != nullptr; }
+        bool block_format() const { return block_format_; }
+        // Footer was missing (capture cut short) and blocks were found by walking headers
+        bool recovered() const { return recovered_; }
+        const FileHeader& header() const { return header_; }
+        // Blocks (block format) or side index spans (bare stream, after ensure_index)
+        const std::vector<BlockIndexEntry>& blocks() const { return blocks_; }
+        size_t file_size() const { return size_; }
+        const std::string& path() const { return path_; }
+
+        // Check block crc32 when entering each block (off by default)
+        void set_verify(bool verify) { verify_ = verify; }
+        // Read-ahead / release window in bytes (0 disables both)
+        void set_window(size_t bytes) { window_ = bytes; }
+
+    private:
+        bool next_slow(CaptureRecord& out);
+        bool load_index();
+        bool load_side_index();
+        bool build_side_index();
+        bool enter_block(size_t index);
+        void advance_window(size_t position);
+        void reset_window(size_t position);
+
+        std::string path_;
+        const char* base_ = nullptr;
+        size_t size_ = 0;
+        bool block_format_ = false;
+        bool recovered_ = false;
+        bool verify_ = false;
+        FileHeader header_{};
+        std::vector<BlockIndexEntry> blocks_;
+
+        size_t next_block_ = 0;
+        const char* cursor_ = nullptr;
+        const char* end_ = nullptr;
+        std::vector<char> inflated_;
+
+        // Streaming window over the mapping
+        size_t window_ = DEFAULT_WINDOW;
+        size_t advise_mark_ = 0;   // Mapping offset at which to slide the window again
+        size_t advised_ = 0;       // Readahead requested up to here
+        size_t populated_ = 0;     // Page tables filled up to here
+        size_t released_ = 0;      // Dropped from our mapping below here
+    };
+
+}
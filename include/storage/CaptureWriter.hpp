@@ -0,0 +1,103 @@
+#pragma once
+
+#include "common/ByteRing.hpp"
+#include "storage/CaptureFormat.hpp"
+#include "storage/DirectFile.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace hft::storage {
+
+    // Function: CaptureWriter
+    // Description: Market data capture off the receive path. The feed thread copies each
+    //              frame into a ByteRing (one memcpy, one release store); a writer thread
+    //              packs records into aligned blocks, optionally zlib-compresses them and
+    //              hands them to a DirectFile. Two block buffers alternate so the next block
+    //              fills while the previous one is in flight to disk. stop() seals the last
+    //              block and appends the block index (see CaptureFormat.hpp).
+    class CaptureWriter {
+    public:
+        struct Options {
+            size_t ring_bytes = 64 << 20;   // Absorbs disk stalls; records are dropped (and counted) when full
+            size_t block_bytes = 1 << 20;   // Raw record bytes per block
+            Compression compression = Compression::NONE;
+            int zlib_level = 1;
+            uint32_t flush_interval_ms = 100; // Seal a partly filled block after this much idle time
+        };
+
+        explicit CaptureWriter(std::string path) : CaptureWriter(std::move(path), Options{}) {}
+        CaptureWriter(std::string path, const Options& options);
+        ~CaptureWriter();
+
+        CaptureWriter(const CaptureWriter&) = delete;
+        CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+        // Opens the file and starts the writer thread
+        bool start();
+        // Drains the ring, writes the index and closes the file
+        void stop();
+
+        // Function: record
+        // Description: Receive-path entry point (single producer). Never blocks or allocates.
+        // Inputs: rx_tsc - Receive timestamp, frame - Raw WebSocket payload.
+        // Outputs: false if the ring was full and the record was dropped.
+        bool record(uint64_t rx_tsc, std::string_view frame) {
+            RecordHeader header{rx_tsc, static_cast<uint32_t>(frame.size())};
+            if (ring_.write(&header, sizeof(header), frame.data(), frame.size())) return true;
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Records dropped at a full ring plus records lost to failed block writes
+        uint64_t dropped() const {
+            return dropped_.load(std::memory_order_relaxed) + lost_.load(std::memory_order_relaxed);
+        }
+        uint64_t records_written() const { return records_written_.load(std::memory_order_relaxed); }
+        uint64_t raw_bytes() const { return raw_bytes_.load(std::memory_order_relaxed); }
+        uint64_t file_bytes() const { return file_bytes_.load(std::memory_order_relaxed); }
+
+    private:
+        // Aligned block buffer; BlockHeader followed by the records
+        struct Block {
+            char* data = nullptr;
+            size_t capacity = 0;
+            size_t used = 0;             // Record bytes after the header
+            uint32_t record_count = 0;
+            uint64_t first_timestamp = 0;
+            uint64_t last_timestamp = 0;
+        };
+
+        void run();
+        bool drain();
+        void seal();
+        void settle();
+        void write_index();
+        static bool reserve(Block& block, size_t bytes);
+
+        std::string path_;
+        Options options_;
+        ByteRing ring_;
+        DirectFile file_;
+
+        Block blocks_[2];
+        Block compressed_[2];
+        int current_ = 0;
+        std::chrono::steady_clock::time_point block_started_;
+        uint64_t file_offset_ = 0;
+        size_t in_flight_raw_ = 0;       // Raw bytes of the last queued block, backed out if it fails
+        std::vector<BlockIndexEntry> index_;
+
+        std::atomic<bool> running_{false};
+        std::thread thread_;
+        std::atomic<uint64_t> dropped_{0};   // Producer-side only
+        std::atomic<uint64_t> lost_{0};      // Writer-side only
+        std::atomic<uint64_t> records_written_{0};
+        std::atomic<uint64_t> raw_bytes_{0};
+        std::atomic<uint64_t> file_bytes_{0};
+    };
+
+}
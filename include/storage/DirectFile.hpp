@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace hft::storage {
+
+    // Function: DirectFile
+    // Description: Write-only file for large aligned blocks. Opens with O_DIRECT (bypassing
+    //              the page cache) and submits writes through a small io_uring, keeping at
+    //              most one write in flight so the caller can fill a second buffer meanwhile.
+    //              Falls back to buffered I/O where O_DIRECT is refused (tmpfs, some overlay
+    //              filesystems) and to synchronous pwrite where io_uring is unavailable.
+    //              Buffers, lengths and offsets must be multiples of ALIGNMENT.
+    class DirectFile {
+    public:
+        DirectFile() = default;
+        ~DirectFile();
+
+        DirectFile(const DirectFile&) = delete;
+        DirectFile& operator=(const DirectFile&) = delete;
+
+        bool open(const std::string& path);
+
+        // Function: write
+        // Description: Waits for the previous write, then queues this one. buffer must stay
+        //              untouched until the next write() or wait() returns.
+        // Outputs: false if the previous write failed or this one could not be queued.
+        bool write(const void* buffer, size_t len, uint64_t offset);
+
+        // Function: wait
+        // Description: Blocks until the in-flight write (if any) has completed.
+        bool wait();
+
+        void close();
+
+        bool is_open() const { return fd_ >= 0; }
+        bool direct() const { return direct_; }
+        bool async() const { return ring_fd_ >= 0; }
+
+    private:
+        bool setup_ring();
+        void teardown_ring();
+        bool write_sync(const void* buffer, size_t len, uint64_t offset);
+
+        int fd_ = -1;
+        bool direct_ = false;
+
+        // io_uring (raw syscalls; no liburing dependency)
+        int ring_fd_ = -1;
+        void* sq_ring_ = nullptr;
+        void* cq_ring_ = nullptr;
+        size_t sq_ring_size_ = 0;
+        size_t cq_ring_size_ = 0;
+        io_uring_sqe* sqes_ = nullptr;
+        size_t sqes_size_ = 0;
+        unsigned* sq_head_ = nullptr;
+        unsigned* sq_tail_ = nullptr;
+        unsigned* sq_mask_ = nullptr;
+        unsigned* sq_array_ = nullptr;
+        unsigned* cq_head_ = nullptr;
+        unsigned* cq_tail_ = nullptr;
+        unsigned* cq_mask_ = nullptr;
+        io_uring_cqe* cqes_ = nullptr;
+
+        // The write in flight, kept so a short or refused async write can be finished synchronously
+        bool in_flight_ = false;
+        const void* pending_buffer_ = nullptr;
+        size_t pending_len_ = 0;
+        uint64_t pending_offset_ = 0;
+    };
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hft::storage {
+
+    struct PcapFrame {
+        uint64_t timestamp_ns; // Capture time, ns since epoch
+        const uint8_t* data;
+        uint32_t caplen;       // Bytes present in data
+        uint32_t len;          // Length on the wire
+        uint16_t link_type;    // LINKTYPE_* of the capturing interface
+    };
+
+    // Function: PcapReader
+    // Description: Memory-mapped reader for packet captures: classic pcap (microsecond or
+    //              nanosecond timestamps, either byte order) and pcapng (enhanced, simple and
+    //              obsolete packet blocks, per-interface link type and timestamp resolution,
+    //              several sections). Frames are views into the mapping, valid until close().
+    class PcapReader {
+    public:
+        enum class Format { NONE, PCAP, PCAPNG };
+
+        PcapReader() = default;
+        ~PcapReader();
+
+        PcapReader(const PcapReader&) = delete;
+        PcapReader& operator=(const PcapReader&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        // Function: next
+        // Description: Reads the next frame, skipping non-packet blocks.
+        // Outputs: false at the end of the file (or at the first truncated record).
+        bool next(PcapFrame& out);
+
+        void rewind();
+
+        Format format() const { return format_; }
+        bool is_open() const { return base_ != nullptr; }
+        size_t file_size() const { return size_; }
+
+    private:
+        struct Interface {
+            uint16_t link_type;
+            uint32_t snaplen;
+            uint64_t units_per_second; // Timestamp resolution
+        };
+
+        bool next_pcap(PcapFrame& out);
+        bool next_pcapng(PcapFrame& out);
+        bool read_section_header(const uint8_t* block, size_t available);
+        void read_interface(const uint8_t* body, size_t body_len);
+        uint64_t to_ns(uint64_t units, uint64_t units_per_second) const;
+
+        uint16_t load16(const uint8_t* p) const;
+        uint32_t load32(const uint8_t* p) const;
+
+        const uint8_t* base_ = nullptr;
+        size_t size_ = 0;
+        const uint8_t* cursor_ = nullptr;
+        const uint8_t* end_ = nullptr;
+        Format format_ = Format::NONE;
+        bool swapped_ = false;
+
+        // Classic pcap
+        uint16_t link_type_ = 0;
+        uint64_t units_per_second_ = 1000000;
+
+        // pcapng: interfaces of the current section
+        std::vector<Interface> interfaces_;
+    };
+
+}
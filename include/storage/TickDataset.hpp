@@ -0,0 +1,121 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include "storage/TickStore.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Tick dataset: a directory of time-partitioned tick files (e.g. one per day) read as one
+// time-ordered stream. Files are found recursively and may be raw BinaryTick records
+// (*.ticks) or columnar tick stores (*.tcol); a single file path works too.
+//
+// Raw files get a sparse index, <file>.tidx, holding the timestamp of every
+// TICK_INDEX_STRIDE-th tick:
+//   [TickIndexHeader | uint64_t timestamp x entry_count]
+// It is built with strided reads on first use and reloaded after that. Columnar files seek
+// through their own block index. Timestamps are in the units of BinaryTick::timestamp.
+
+namespace hft::storage {
+
+    constexpr char TICK_INDEX_MAGIC[8] = {'H', 'F', 'T', 'T', 'I', 'D', 'X', '1'};
+    constexpr uint64_t TICK_INDEX_STRIDE = 4096; // 256 KB of raw ticks per entry
+
+    struct TickIndexHeader {
+        char magic[8];
+        uint64_t source_size;      // Tick file size when indexed; a mismatch means rebuild
+        uint64_t stride;
+        uint64_t entry_count;
+    };
+    static_assert(sizeof(TickIndexHeader) == 32);
+
+    struct TickFileInfo {
+        std::string path;
+        bool columnar = false;
+        uint64_t tick_count = 0;
+        uint64_t first_timestamp = 0;
+        uint64_t last_timestamp = 0;
+    };
+
+    // Function: TickDataset
+    // Description: Seeks to a start time with two binary searches (over the files, then over
+    //              the file's sparse or block index) and streams ticks up to an end time.
+    //              Nothing is prefaulted at open: files are mapped when the cursor enters
+    //              them, the next window of the file is requested with MADV_WILLNEED as the
+    //              cursor moves, and pages a window behind are dropped.
+    //              Files are replayed in order of first timestamp and are expected not to
+    //              overlap in time.
+    class TickDataset {
+    public:
+        static constexpr size_t DEFAULT_WINDOW = 16 << 20;
+        static constexpr size_t BATCH_TICKS = 4096;
+
+        TickDataset() = default;
+        ~TickDataset();
+
+        TickDataset(const TickDataset&) = delete;
+        TickDataset& operator=(const TickDataset&) = delete;
+
+        // Function: open
+        // Description: Collects the tick files under path (or path itself) and loads or
+        //              builds their indexes. Positions the cursor at the first tick.
+        // Outputs: false if no readable tick file was found.
+        bool open(const std::string& path);
+        void close();
+
+        // Function: seek
+        // Description: Restricts the stream to ticks with from <= timestamp <= to and
+        //              positions the cursor on the first of them.
+        // Outputs: false if the range holds no ticks.
+        bool seek(uint64_t from, uint64_t to = UINT64_MAX);
+
+        // Function: next
+        // Description: Next run of ticks in the range, in file order. The span points into
+        //              the mapping (raw files) or a decoded block (columnar files) and stays
+        //              valid until the next call.
+        // Outputs: Empty span at the end of the range.
+        std::span<const BinaryTick> next();
+
+        const std::vector<TickFileInfo>& files() const { return files_; }
+        uint64_t tick_count() const;
+        uint64_t first_timestamp() const { return files_.empty() ? 0 : files_.front().first_timestamp; }
+        uint64_t last_timestamp() const { return files_.empty() ? 0 : files_.back().last_timestamp; }
+
+        // Read-ahead / release window in bytes (0 disables both)
+        void set_window(size_t bytes) { window_ = bytes; }
+
+    private:
+        bool add_file(const std::string& path);
+        bool load_index(const std::string& path, size_t size, std::vector<uint64_t>& index) const;
+        bool build_index(const std::string& path, size_t size, std::vector<uint64_t>& index) const;
+
+        bool enter(size_t file);
+        bool enter_next();
+        void leave();
+        std::span<const BinaryTick> next_run();
+        void advance_window();
+
+        std::vector<TickFileInfo> files_;
+        std::vector<std::vector<uint64_t>> indexes_; // Sparse index per raw file (empty for columnar)
+
+        // Cursor
+        uint64_t from_ = 0;
+        uint64_t to_ = UINT64_MAX;
+        size_t file_ = 0;
+        bool done_ = false;
+        const BinaryTick* ticks_ = nullptr; // Raw file mapping
+        size_t mapped_bytes_ = 0;
+        std::unique_ptr<TickStoreReader> store_;
+        std::vector<BinaryTick> block_;      // Decoded columnar block
+        uint64_t position_ = 0;              // Next tick (raw) or block (columnar)
+        std::span<const BinaryTick> pending_; // First run, read ahead by seek()
+
+        // Streaming window over the current file, in bytes
+        size_t window_ = DEFAULT_WINDOW;
+        size_t advised_ = 0;
+        size_t released_ = 0;
+    };
+
+}
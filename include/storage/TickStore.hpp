@@ -0,0 +1,180 @@
+#pragma once
+
+#include "common/Types.hpp"
+#include "storage/CaptureFormat.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Columnar tick store (*.tcol)
+//
+//   [TickFileHeader, 64 B]
+//   [TickBlockHeader | column data ...] ...          blocks start on 64-byte boundaries
+//   [BlockIndexEntry x block_count | FileFooter]     <- footer ends the file
+//
+// A block holds up to block_ticks ticks, one bit-packed column per BinaryTick field. Each
+// integer column is coded, per block, whichever way needs fewer bits:
+//   DELTA_ZIGZAG        zigzagged difference from the previous tick (timestamps, prices, ids)
+//   FRAME_OF_REFERENCE  value minus the block minimum (quantities; constants such as symbol
+//                       pack to 0 bits)
+// The four flags are 1-bit columns. Block headers and index entries carry the block's min
+// and max timestamp for seeking; the index and footer reuse the capture file layout.
+
+namespace hft::storage {
+
+    constexpr char TICK_FILE_MAGIC[8] = {'H', 'F', 'T', 'T', 'C', 'K', '0', '1'};
+    constexpr uint32_t TICK_BLOCK_MAGIC = 0x4B435454; // "TTCK"
+    constexpr uint32_t TICK_FORMAT_VERSION = 1;
+    constexpr uint32_t DEFAULT_BLOCK_TICKS = 1024;
+    constexpr uint32_t MAX_BLOCK_TICKS = 1 << 16;
+
+    enum class TickColumn : uint8_t {
+        ID,
+        TIMESTAMP,
+        PRICE,
+        QUANTITY,
+        SYMBOL,
+        EXCHANGE_TIMESTAMP,
+        RX_TIMESTAMP,
+        IS_BID,
+        IS_TRADE,
+        IS_SNAPSHOT,
+        END_OF_MESSAGE,
+        COUNT
+    };
+    constexpr size_t TICK_COLUMNS = static_cast<size_t>(TickColumn::COUNT);
+
+    enum class ColumnCoding : uint8_t {
+        FRAME_OF_REFERENCE = 0,
+        DELTA_ZIGZAG = 1
+    };
+
+    struct TickFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t block_ticks;      // Ticks per full block
+        uint8_t pad[48];
+    };
+    static_assert(sizeof(TickFileHeader) == 64);
+
+    struct ColumnHeader {
+        uint64_t base;             // First value (delta) or block minimum (frame of reference)
+        uint32_t offset;           // Byte offset of the packed codes from the block header
+        uint8_t width;             // Bits per code, 0-64
+        uint8_t coding;            // ColumnCoding
+        uint8_t pad[2];
+    };
+    static_assert(sizeof(ColumnHeader) == 16);
+
+    struct TickBlockHeader {
+        uint32_t magic;
+        uint32_t tick_count;
+        uint32_t bytes;            // Header plus column data, before alignment padding
+        uint32_t reserved;
+        uint64_t min_timestamp;
+        uint64_t max_timestamp;
+        ColumnHeader columns[TICK_COLUMNS];
+    };
+    static_assert(sizeof(TickBlockHeader) == 32 + 16 * TICK_COLUMNS);
+
+    // Packed size of n codes of width bits. Rounded to whole words plus one word of slack,
+    // so decoders may always load 8 bytes at a code's first byte.
+    constexpr size_t packed_bytes(size_t n, unsigned width) {
+        return (n * width + 63) / 64 * 8 + 8;
+    }
+
+    // Function: TickStoreWriter
+    // Description: Buffers ticks and writes them out one encoded block at a time. Offline
+    //              tool side (converters, dataset builds); not meant for the receive path.
+    class TickStoreWriter {
+    public:
+        explicit TickStoreWriter(const std::string& path, uint32_t block_ticks = DEFAULT_BLOCK_TICKS);
+        ~TickStoreWriter();
+
+        TickStoreWriter(const TickStoreWriter&) = delete;
+        TickStoreWriter& operator=(const TickStoreWriter&) = delete;
+
+        // Function: open
+        // Description: Creates the file and writes its header.
+        bool open();
+
+        void append(const BinaryTick& tick) {
+            pending_.push_back(tick);
+            if (pending_.size() == block_ticks_) flush_block();
+        }
+
+        // Function: close
+        // Description: Writes the last partial block, the index and the footer.
+        // Outputs: false if any write failed along the way.
+        bool close();
+
+        uint64_t tick_count() const { return tick_count_; }
+        uint64_t file_bytes() const { return offset_; }
+
+    private:
+        void flush_block();
+        bool write(const void* data, size_t len);
+
+        std::string path_;
+        uint32_t block_ticks_;
+        std::FILE* file_ = nullptr;
+        bool ok_ = true;
+        uint64_t offset_ = 0;
+        uint64_t tick_count_ = 0;
+        std::vector<BinaryTick> pending_;
+        std::vector<BlockIndexEntry> index_;
+        std::vector<uint64_t> codes_;
+        std::vector<uint8_t> block_;
+    };
+
+    // Function: TickStoreReader
+    // Description: Memory-mapped reader. Blocks are decoded whole into a caller buffer of
+    //              block_ticks() ticks; the unpack, zigzag and prefix-sum steps run four
+    //              codes at a time with AVX2 where available.
+    class TickStoreReader {
+    public:
+        TickStoreReader() = default;
+        ~TickStoreReader();
+
+        TickStoreReader(const TickStoreReader&) = delete;
+        TickStoreReader& operator=(const TickStoreReader&) = delete;
+
+        // Function: open
+        // Description: Maps path and loads its index.
+        // Outputs: false if the file is missing, not a tick store, or has no valid footer.
+        bool open(const std::string& path);
+        void close();
+
+        // Function: decode
+        // Description: Decodes block into out, which must hold block_ticks() ticks.
+        // Outputs: Number of ticks written (0 for a damaged block).
+        size_t decode(size_t block, BinaryTick* out);
+
+        // Function: find
+        // Description: First block whose max timestamp is >= ts (blocks().size() if none).
+        //              Assumes timestamps do not decrease across blocks.
+        size_t find(uint64_t ts) const;
+
+        // Function: prefetch
+        // Description: MADV_WILLNEED over up to bytes of blocks starting at block.
+        void prefetch(size_t block, size_t bytes) const;
+
+        bool is_open() const { return base_ != nullptr; }
+        uint32_t block_ticks() const { return header_.block_ticks; }
+        // first_timestamp / last_timestamp hold each block's min / max timestamp
+        const std::vector<BlockIndexEntry>& blocks() const { return blocks_; }
+        uint64_t tick_count() const { return tick_count_; }
+        size_t file_size() const { return size_; }
+
+    private:
+        const uint8_t* base_ = nullptr;
+        size_t size_ = 0;
+        TickFileHeader header_{};
+        std::vector<BlockIndexEntry> blocks_;
+        uint64_t tick_count_ = 0;
+        static constexpr size_t DECODE_CHUNK = 256;
+        std::vector<uint64_t> columns_; // Decode scratch: TICK_COLUMNS x DECODE_CHUNK
+    };
+
+}
@@ -44,6 +44,23 @@ namespace hft {
               bid_masks_((BOOK_SIZE + 63) / 64, 0),
               ask_masks_((BOOK_SIZE + 63) / 64, 0) {}
 
+        // Empties both sides (a snapshot follows). Only levels flagged in the bitmasks are
+        // touched, so this costs a pass over the masks rather than over the whole book.
+        void clear() {
+            for (int side = 0; side < 2; ++side) {
+                std::vector<Level>& book = side == 0 ? bids_ : asks_;
+                std::vector<uint64_t>& masks = side == 0 ? bid_masks_ : ask_masks_;
+                for (size_t chunk = 0; chunk < masks.size(); ++chunk) {
+                    for (uint64_t bits = masks[chunk]; bits != 0; bits &= bits - 1) {
+                        book[chunk * 64 + __builtin_ctzll(bits)] = {};
+                    }
+                    masks[chunk] = 0;
+                }
+            }
+            best_bid_idx_ = -1;
+            best_ask_idx_ = BOOK_SIZE;
+        }
+
         void on_update(bool is_bid, int64_t price, int64_t quantity) {
             int64_t delta = price - center_price_;
             int64_t index = CENTER_INDEX + (delta / TICK_SIZE);
@@ -4,11 +4,22 @@
 #include "common/Types.hpp"
 #include "common/Utils.hpp"
 #include "simulation/MatchingEngine.hpp"
+#include "strategy/OrderBook.hpp"
 #include <atomic>
+#include <memory>
 #include <thread>
 
 namespace hft {
 
+    // Function: ConflationMode
+    // Description: How many ticks the strategy applies before evaluating its signal.
+    enum class ConflationMode : uint8_t {
+        NONE,   // Evaluate after every depth tick
+        DRAIN,  // Apply every tick currently in the ring, then evaluate once
+        MESSAGE // Apply ticks up to the end_of_message marker, then evaluate once
+                // (as DRAIN until the first marker: older tick files carry none)
+    };
+
     // Function: StrategyEngine
     // Description: Core logic engine. Processes ticks and generates orders.
     class StrategyEngine {
@@ -17,7 +28,9 @@ namespace hft {
         // Description: Constructor.
         // Inputs: input_buffer - Source of ticks.
         //         output_buffer - Destination for orders.
-        StrategyEngine(RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& input_buffer, RingBuffer<Order, constants::RING_BUFFER_SIZE>& output_buffer);
+        //         conflation - Opt-in burst conflation (see ConflationMode).
+        StrategyEngine(RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& input_buffer, RingBuffer<Order, constants::RING_BUFFER_SIZE>& output_buffer,
+                       ConflationMode conflation = ConflationMode::NONE);
 
         // Function: start
         // Description: Starts the strategy thread.
@@ -29,20 +42,58 @@ namespace hft {
 
     private:
         void run();
+        void run_conflated();
+
+        // Applies one tick to the book / simulator. Returns true for depth updates.
+        bool apply_tick(const BinaryTick& tick);
+        // OFI, EWMA and the quoting state machine. 'tick' is the last tick applied.
+        void evaluate_signal(const BinaryTick& tick);
+        bool push_order(Order& order, const BinaryTick& tick);
 
         enum class State { FLAT, LONG, SHORT };
         State current_state_ = State::FLAT;
 
         RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& input_buffer_;
         RingBuffer<Order, constants::RING_BUFFER_SIZE>& output_buffer_;
+        ConflationMode conflation_;
         std::atomic<bool> running_{false};
         std::thread thread_;
         MatchingEngine matching_engine_;
 
+        // Lazy initialization to center around current market price
+        std::unique_ptr<DenseOrderBook> order_book_;
+        bool in_snapshot_ = false; // Inside a snapshot message (its first tick cleared the book)
+
+        // Strategy State
+        uint64_t order_id_ = 0;
+        uint64_t pop_tsc_ = 0; // When the tick being evaluated was popped
+        int64_t smoothed_ofi_ = 0;
+        int64_t position_ = 0;     // Lots
+        int64_t position_qty_ = 0; // Satoshis, accumulated from (partial) fills
+
+        // Working quote: the last order we placed that has not completely filled.
+        // Its quantity tracks the unfilled remainder. Reprices go out as REPLACE and
+        // stale quotes are cancelled instead of being stacked.
+        Order working_order_{};
+        bool has_working_order_ = false;
+
+        // MESSAGE conflation: the stream has carried an end_of_message marker
+        bool seen_message_marker_ = false;
+        bool warned_no_marker_ = false;
+
         // Benchmarking
         utils::LatencyRecorder latency_recorder_;
         std::vector<MatchingEngine::Fill> fills_;
         void save_fills_to_csv(const std::string& filename);
+
+        // Per-burst metrics (conflation modes only)
+        struct BurstSample {
+            uint32_t ticks;
+            uint64_t queue_delay; // Cycles from the first tick's feed timestamp to its pop
+            uint64_t latency;     // Cycles from first pop to decision
+        };
+        std::vector<BurstSample> bursts_;
+        void save_bursts_to_csv(const std::string& filename);
     };
 
 }
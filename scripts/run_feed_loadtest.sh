@@ -0,0 +1,38 @@
+#!/bin/bash
+set -e
+
+# Points the feed handler at the local Coinbase stand-in and steps the message rate
+# up to find the max sustainable msgs/s for each WebSocket transport.
+# Usage: ./scripts/run_feed_loadtest.sh [seconds_per_step]
+BUILD_DIR="build"
+STEP_SECONDS=${1:-5}
+PORT=8089
+RATES=(10000 50000 100000 0)
+
+echo "--------------------------------------------------"
+echo "  Feed Load Test (local stand-in)"
+echo "--------------------------------------------------"
+
+# 1. Build
+echo "[1/2] Building..."
+mkdir -p $BUILD_DIR
+cd $BUILD_DIR
+cmake -DENABLE_DPDK=OFF .. > /dev/null
+make -j$(nproc) coinbase_standin integration_feed > /dev/null
+cd ..
+
+# 2. Step through rates (0 = as fast as the client drains)
+echo "[2/2] Running..."
+for TRANSPORT in "" "--native-ws"; do
+    for RATE in "${RATES[@]}"; do
+        echo ""
+        echo "=== transport: ${TRANSPORT:-ixwebsocket}  rate: $([ $RATE -eq 0 ] && echo max || echo $RATE) ==="
+        ./$BUILD_DIR/coinbase_standin --port $PORT --rate $RATE --duration $((STEP_SECONDS + 2)) > standin.log 2>&1 &
+        SERVER_PID=$!
+        sleep 0.5
+        ./$BUILD_DIR/integration_feed $STEP_SECONDS ws://127.0.0.1:$PORT $TRANSPORT | grep -E "msgs/s|complete"
+        wait $SERVER_PID || true
+        grep "done:" standin.log || true
+    done
+done
+rm -f standin.log
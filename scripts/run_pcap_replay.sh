@@ -0,0 +1,41 @@
+#!/bin/bash
+set -e
+
+# Writes a synthetic two-line SBE capture (both lines lossy, plus a snapshot line) and
+# replays it through the UDP receive path, first with capture timing, then at max speed.
+# Fails if the handler's published ticks break RptSeq continuity.
+# Usage: ./scripts/run_pcap_replay.sh [seconds] [rate] [drop] [capture.pcap|capture.pcapng]
+BUILD_DIR="build"
+SECONDS_TO_CAPTURE=${1:-5}
+RATE=${2:-1000}
+DROP=${3:-0.03}
+CAPTURE=${4:-/tmp/pcap_replay.pcap}
+GROUP=239.1.1.1
+PORT=1234
+SNAPSHOT_PORT=1236
+
+echo "--------------------------------------------------"
+echo "  Pcap Replay Test"
+echo "--------------------------------------------------"
+
+# 1. Build
+echo "[1/4] Building..."
+mkdir -p $BUILD_DIR
+cd $BUILD_DIR
+cmake -DENABLE_DPDK=OFF .. > /dev/null
+make -j$(nproc) pcap_replay > /dev/null
+cd ..
+
+# 2. Capture: fixed start time and seeds, so the same arguments give the same file
+echo "[2/4] Writing $CAPTURE ($SECONDS_TO_CAPTURE s at $RATE pps, drop $DROP on each line)..."
+python3 tools/udp_gen.py --ip $GROUP --port $PORT --rate $RATE --duration $SECONDS_TO_CAPTURE \
+    --pcap $CAPTURE --lines 2 --drop $DROP --drop-seed 1 --snapshot-port $SNAPSHOT_PORT \
+    --start-at 1700000000 > /dev/null
+
+# 3. Replay at capture speed
+echo "[3/4] Replaying with capture timing..."
+./$BUILD_DIR/pcap_replay --lines $GROUP:$PORT,$GROUP:$((PORT + 1)) --snapshot $GROUP:$SNAPSHOT_PORT $CAPTURE
+
+# 4. Replay as fast as possible
+echo "[4/4] Replaying at max speed..."
+./$BUILD_DIR/pcap_replay --max-speed --lines $GROUP:$PORT,$GROUP:$((PORT + 1)) --snapshot $GROUP:$SNAPSHOT_PORT $CAPTURE
@@ -0,0 +1,51 @@
+#!/bin/bash
+set -e
+
+# Replays market_data.bin at max speed once per conflation mode and reports
+# the strategy backlog, per-tick latency and per-burst latency for each.
+BUILD_DIR="build"
+MODES=("none" "drain" "message")
+
+echo "--------------------------------------------------"
+echo "  Replay Conflation Benchmark"
+echo "--------------------------------------------------"
+
+if [ ! -f "market_data.bin" ]; then
+    echo "Error: market_data.bin not found (run the engine with capture enabled first)."
+    exit 1
+fi
+
+# 1. Build
+echo "[1/2] Building Replay Engine..."
+mkdir -p $BUILD_DIR
+cd $BUILD_DIR
+cmake -DENABLE_DPDK=OFF .. > /dev/null
+make -j$(nproc) replay_engine > /dev/null
+cd ..
+
+# 2. Run each mode
+echo "[2/2] Replaying..."
+for MODE in "${MODES[@]}"; do
+    echo ""
+    echo "=== Conflation: $MODE ==="
+    rm -f strategy_bursts.csv
+    if [ "$MODE" == "none" ]; then
+        ./$BUILD_DIR/replay_engine --max-speed
+    else
+        ./$BUILD_DIR/replay_engine --max-speed --conflate $MODE
+    fi
+
+    python3 tools/analyze.py strategy_latencies.csv "Strategy Latency ($MODE)"
+    if [ -f strategy_bursts.csv ]; then
+        python3 - <<'PY'
+import csv
+rows = list(csv.DictReader(open("strategy_bursts.csv")))
+if rows:
+    ticks = sorted(int(r["ticks"]) for r in rows)
+    delay = sorted(float(r["queue_delay_ns"]) for r in rows)
+    p = lambda xs, q: xs[min(len(xs) - 1, int(q * len(xs)))]
+    print(f"Bursts: {len(rows)}  ticks/burst p50={p(ticks, .5)} p99={p(ticks, .99)} max={ticks[-1]}")
+    print(f"Queue delay: p50={p(delay, .5):.0f} ns p99={p(delay, .99):.0f} ns")
+PY
+    fi
+done
@@ -0,0 +1,38 @@
+#!/bin/bash
+set -e
+
+# Compares the socket receive paths of the UDP feed (one datagram per syscall vs recvmmsg
+# batches) on loopback: first the self-contained drain benchmark, then each mode receiving
+# tools/udp_gen.py traffic (packets/s and kernel-timestamp-to-handler latency).
+# Usage: ./scripts/run_udp_receive_benchmark.sh [seconds] [rate] [busy_poll_us]
+BUILD_DIR="build"
+SECONDS_TO_RUN=${1:-5}
+RATE=${2:-20000}
+BUSY_POLL=${3:-0}
+PORT=21300
+
+echo "--------------------------------------------------"
+echo "  UDP Receive Benchmark (loopback)"
+echo "--------------------------------------------------"
+
+# 1. Build
+echo "[1/3] Building..."
+mkdir -p $BUILD_DIR
+cd $BUILD_DIR
+cmake -DENABLE_DPDK=OFF .. > /dev/null
+make -j$(nproc) bench_udp_receive > /dev/null
+cd ..
+
+# 2. Drain (no generator)
+echo "[2/3] Drain..."
+./$BUILD_DIR/bench_udp_receive --port $PORT --busy-poll $BUSY_POLL
+
+# 3. Live traffic from udp_gen.py at RATE packets/s
+echo "[3/3] udp_gen.py at $RATE pps..."
+for MODE in recv recvmmsg; do
+    ./$BUILD_DIR/bench_udp_receive --port $PORT --listen $((SECONDS_TO_RUN + 2)) --mode $MODE --busy-poll $BUSY_POLL &
+    BENCH_PID=$!
+    sleep 0.5
+    python3 tools/udp_gen.py --ip 127.0.0.1 --port $PORT --rate $RATE --duration $SECONDS_TO_RUN > /dev/null
+    wait $BENCH_PID
+done
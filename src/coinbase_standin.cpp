@@ -0,0 +1,463 @@
+#include "network/WebSocketServer.hpp"
+#include "common/Utils.hpp"
+#include "storage/CaptureReader.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Coinbase Stand-in
+// Local WebSocket server speaking the Advanced Trade market data protocol (level2,
+// heartbeats, market_trades) so the feed path can be load- and fault-tested offline.
+// Usage: coinbase_standin [options]
+//   --port N                 Listen port (default 8080)
+//   --tls                    Serve wss:// with a self-signed certificate
+//   --replay FILE            Replay a market_data.bin capture instead of a synthetic book
+//   --loop                   Restart the replay from the beginning when it ends
+//   --rate N                 Messages per second (0 = as fast as the client drains, default 1000)
+//   --levels N               Synthetic book depth per side (default 500)
+//   --trade-every N          One market_trades message per N level2 updates (default 10, 0 = off)
+//   --gap-every N            Skip a sequence number every N messages
+//   --redundant              Every connection streams the same synthetic book and event
+//                            times, like redundant lines of one feed
+//   --stall-every N          Each connection stalls about once per N messages ...
+//   --stall-us N             ... for N microseconds (default 500), independently per connection
+//   --disconnect-every N     Drop the connection (no close frame) after N messages
+//   --storm-every N          Every N messages send a snapshot storm ...
+//   --storm-size N           ... of N back-to-back snapshots (default 20)
+//   --duration N             Stop after N seconds (default: run until SIGINT)
+
+namespace {
+
+    std::atomic<bool> keep_running{true};
+
+    void signal_handler(int) {
+        keep_running = false;
+    }
+
+    struct Options {
+        uint16_t port = 8080;
+        bool tls = false;
+        std::string replay_file;
+        bool loop = false;
+        uint64_t rate = 1000;
+        int levels = 500;
+        uint64_t trade_every = 10;
+        uint64_t gap_every = 0;
+        bool redundant = false;
+        uint64_t stall_every = 0;
+        uint64_t stall_us = 500;
+        uint64_t disconnect_every = 0;
+        uint64_t storm_every = 0;
+        uint64_t storm_size = 20;
+        int duration = 0;
+    };
+
+    // Function: format_iso8601_ns
+    // Description: Unix nanoseconds to "YYYY-MM-DDTHH:MM:SS.nnnnnnnnnZ" (civil-from-days).
+    std::string format_iso8601_ns(uint64_t unix_ns) {
+        int64_t secs = static_cast<int64_t>(unix_ns / 1000000000ULL);
+        uint64_t nanos = unix_ns % 1000000000ULL;
+        int64_t days = secs / 86400;
+        int64_t rem = secs % 86400;
+
+        days += 719468;
+        int64_t era = days / 146097;
+        int64_t doe = days - era * 146097;
+        int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int64_t y = yoe + era * 400;
+        int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int64_t mp = (5 * doy + 2) / 153;
+        int64_t d = doy - (153 * mp + 2) / 5 + 1;
+        int64_t m = mp < 10 ? mp + 3 : mp - 9;
+        if (m <= 2) ++y;
+
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%04ld-%02ld-%02ldT%02ld:%02ld:%02ld.%09luZ",
+                 y, m, d, rem / 3600, (rem / 60) % 60, rem % 60, nanos);
+        return buf;
+    }
+
+    uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    std::string format_price(int64_t cents) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%ld.%02ld", cents / 100, cents % 100);
+        return buf;
+    }
+
+    std::string format_quantity(int64_t sats) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%ld.%08ld", sats / 100000000, sats % 100000000);
+        return buf;
+    }
+
+    // Function: SyntheticBook
+    // Description: Random-walk BTC-USD book on a 1 cent grid. Produces Coinbase-shaped
+    //              snapshot, update and trade messages (without the envelope).
+    //              With a clock base, update and trade times advance 1 us per message from
+    //              it instead of following the wall clock, so books with the same seed and
+    //              base produce byte-identical updates and trades.
+    class SyntheticBook {
+    public:
+        SyntheticBook(int levels, uint64_t seed, uint64_t clock_base_ns = 0)
+            : levels_(levels), rng_(seed), snapshot_rng_(seed + 1), clock_base_ns_(clock_base_ns) {}
+
+        std::string snapshot_events() {
+            // Own generator: snapshots on demand leave the update stream unchanged
+            auto quantity = [&] { return 1000000 + static_cast<int64_t>(snapshot_rng_() % 200000000); };
+            std::string ts = format_iso8601_ns(now_ns());
+            std::string out = R"([{"type":"snapshot","product_id":"BTC-USD","updates":[)";
+            for (int i = 0; i < levels_; ++i) {
+                if (i) out += ',';
+                append_update(out, "bid", mid_ - 1 - i, quantity(), ts);
+            }
+            for (int i = 0; i < levels_; ++i) {
+                out += ',';
+                append_update(out, "offer", mid_ + i, quantity(), ts);
+            }
+            out += "]}]";
+            return out;
+        }
+
+        std::string update_events() {
+            // Mid drifts by a cent now and then
+            if (rng_() % 16 == 0) mid_ += (rng_() % 2) ? 1 : -1;
+
+            std::string ts = format_iso8601_ns(event_time_ns());
+            std::string out = R"([{"type":"update","product_id":"BTC-USD","updates":[)";
+            int count = 1 + static_cast<int>(rng_() % 8);
+            for (int i = 0; i < count; ++i) {
+                if (i) out += ',';
+                bool bid = rng_() % 2;
+                int64_t offset = static_cast<int64_t>(rng_() % static_cast<uint64_t>(levels_));
+                int64_t price = bid ? mid_ - 1 - offset : mid_ + offset;
+                int64_t quantity = (rng_() % 10 == 0) ? 0 : random_quantity(); // ~10% deletes
+                append_update(out, bid ? "bid" : "offer", price, quantity, ts);
+            }
+            out += "]}]";
+            return out;
+        }
+
+        std::string trade_events() {
+            bool buy = rng_() % 2;
+            int64_t price = buy ? mid_ : mid_ - 1;
+            std::string out = R"([{"type":"update","trades":[{"trade_id":")" + std::to_string(++trade_id_) +
+                              R"(","product_id":"BTC-USD","price":")" + format_price(price) +
+                              R"(","size":")" + format_quantity(random_quantity() / 10) +
+                              R"(","side":")" + (buy ? "BUY" : "SELL") +
+                              R"(","time":")" + format_iso8601_ns(event_time_ns()) + R"("}]}])";
+            return out;
+        }
+
+    private:
+        uint64_t event_time_ns() {
+            return clock_base_ns_ ? clock_base_ns_ + 1000 * ++events_ : now_ns();
+        }
+
+        int64_t random_quantity() {
+            return 1000000 + static_cast<int64_t>(rng_() % 200000000); // 0.01 .. 2.01 BTC
+        }
+
+        static void append_update(std::string& out, const char* side, int64_t price, int64_t quantity, const std::string& ts) {
+            out += R"({"side":")";
+            out += side;
+            out += R"(","event_time":")";
+            out += ts;
+            out += R"(","price_level":")";
+            out += format_price(price);
+            out += R"(","new_quantity":")";
+            out += format_quantity(quantity);
+            out += R"("})";
+        }
+
+        int levels_;
+        std::mt19937_64 rng_;
+        std::mt19937_64 snapshot_rng_;
+        uint64_t clock_base_ns_;
+        uint64_t events_ = 0;
+        int64_t mid_ = 10000000; // $100,000.00 in cents
+        uint64_t trade_id_ = 0;
+    };
+
+    std::string envelope(const char* channel, uint64_t sequence_num, const std::string& events) {
+        std::string out = R"({"channel":")";
+        out += channel;
+        out += R"(","client_id":"","timestamp":")";
+        out += format_iso8601_ns(now_ns());
+        out += R"(","sequence_num":)";
+        out += std::to_string(sequence_num);
+        out += R"(,"events":)";
+        out += events;
+        out += '}';
+        return out;
+    }
+
+    // Rewrites "sequence_num":<n> in a recorded message to this connection's sequence
+    std::string resequence(const std::string& message, uint64_t sequence_num) {
+        static constexpr char KEY[] = "\"sequence_num\":";
+        size_t pos = message.find(KEY);
+        if (pos == std::string::npos) return message;
+        size_t start = pos + sizeof(KEY) - 1;
+        size_t end = start;
+        while (end < message.size() && (std::isdigit(static_cast<unsigned char>(message[end])) || message[end] == ' ')) ++end;
+        return message.substr(0, start) + std::to_string(sequence_num) + message.substr(end);
+    }
+
+    std::vector<std::string> load_capture(const std::string& path) {
+        std::vector<std::string> messages;
+        hft::storage::CaptureReader reader;
+        if (!reader.open(path)) return messages;
+        hft::storage::CaptureRecord record;
+        while (reader.next(record)) messages.emplace_back(record.data);
+        return messages;
+    }
+
+    struct Subscriptions {
+        bool level2 = false;
+        bool heartbeats = false;
+        bool market_trades = false;
+    };
+
+    // Applies a {"type":"subscribe"|"unsubscribe","channel":...} request; answers with a
+    // subscriptions message
+    bool handle_request(const std::string& request, Subscriptions& subs) {
+        bool on = request.find("\"subscribe\"") != std::string::npos;
+        if (!on && request.find("\"unsubscribe\"") == std::string::npos) return false;
+        if (request.find("\"level2\"") != std::string::npos) subs.level2 = on;
+        if (request.find("\"heartbeats\"") != std::string::npos) subs.heartbeats = on;
+        if (request.find("\"market_trades\"") != std::string::npos) subs.market_trades = on;
+        return true;
+    }
+
+    std::string subscriptions_events(const Subscriptions& subs) {
+        std::string out = R"([{"subscriptions":{)";
+        bool first = true;
+        auto add = [&](bool on, const char* name) {
+            if (!on) return;
+            if (!first) out += ',';
+            out += '"';
+            out += name;
+            out += R"(":["BTC-USD"])";
+            first = false;
+        };
+        add(subs.level2, "level2");
+        add(subs.heartbeats, "heartbeats");
+        add(subs.market_trades, "market_trades");
+        out += "}}]";
+        return out;
+    }
+
+    // Function: serve_connection
+    // Description: Streams one client: waits for its subscriptions, then sends paced
+    //              level2 / market_trades / heartbeats with the configured faults.
+    //              Resubscribing to level2 (unsubscribe + subscribe) gets a fresh snapshot,
+    //              which is how the client recovers from a gap without reconnecting.
+    void serve_connection(const Options& options, const std::vector<std::string>& capture,
+                          hft::network::WebSocketServer& server, hft::network::WebSocketServer::Connection& connection) {
+        static std::atomic<uint64_t> connection_ids{0};
+        uint64_t connection_id = ++connection_ids;
+        std::cout << "[StandIn] Client " << connection_id << " connected (" << connection.path() << ")" << std::endl;
+
+        Subscriptions subs;
+        uint64_t sequence = 0;
+        std::string request;
+
+        // 1. Collect subscriptions (clients send them right after the upgrade)
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!subs.level2 && std::chrono::steady_clock::now() < deadline && connection.is_open()) {
+            int r = connection.read_message(request, 50);
+            if (r < 0) return;
+            if (r > 0 && handle_request(request, subs)) {
+                connection.send_text(envelope("subscriptions", sequence++, subscriptions_events(subs)));
+            }
+        }
+        // Give a trailing heartbeats/market_trades subscription a moment to land
+        while (connection.read_message(request, 20) > 0) {
+            if (handle_request(request, subs)) {
+                connection.send_text(envelope("subscriptions", sequence++, subscriptions_events(subs)));
+            }
+        }
+
+        // Redundant lines share the seed and clock; stalls are independent per connection
+        static const uint64_t shared_clock_ns = now_ns();
+        SyntheticBook book(options.levels, options.redundant ? 0 : connection_id,
+                           options.redundant ? shared_clock_ns : 0);
+        std::mt19937_64 fault_rng(connection_id * 7919);
+        size_t replay_index = 0;
+        std::string replay_snapshot;
+        if (!capture.empty()) {
+            for (const auto& message : capture) {
+                if (message.find("\"snapshot\"") != std::string::npos) {
+                    replay_snapshot = message;
+                    break;
+                }
+            }
+        }
+
+        auto send = [&](const std::string& message) {
+            if (options.gap_every && sequence > 0 && sequence % options.gap_every == 0) {
+                ++sequence; // Injected gap: this sequence number is never sent
+            }
+            return connection.send_text(message);
+        };
+        auto send_snapshot = [&] {
+            if (!capture.empty()) return replay_snapshot.empty() || send(resequence(replay_snapshot, sequence++));
+            return send(envelope("l2_data", sequence++, book.snapshot_events()));
+        };
+
+        if (subs.level2 && capture.empty()) send_snapshot();
+
+        // 2. Stream
+        const auto start = std::chrono::steady_clock::now();
+        auto next_heartbeat = start + std::chrono::seconds(1);
+        auto next_report = start + std::chrono::seconds(1);
+        uint64_t heartbeat_counter = 0;
+        uint64_t sent = 0;
+        uint64_t sent_at_report = 0;
+        double interval_ns = options.rate ? 1e9 / static_cast<double>(options.rate) : 0.0;
+
+        while (server.running() && keep_running && connection.is_open()) {
+            // Pace: message n is due at start + n * interval
+            if (interval_ns > 0) {
+                auto due = start + std::chrono::nanoseconds(static_cast<int64_t>(sent * interval_ns));
+                auto now = std::chrono::steady_clock::now();
+                if (due > now + std::chrono::microseconds(200)) {
+                    std::this_thread::sleep_until(due);
+                } else {
+                    while (std::chrono::steady_clock::now() < due) hft::utils::cpu_relax();
+                }
+            }
+
+            // Requests are checked every 16 messages so a resync is answered promptly
+            if ((sent & 15) == 0) {
+                while (connection.read_message(request, 0) > 0) {
+                    bool had_level2 = subs.level2;
+                    if (handle_request(request, subs)) {
+                        connection.send_text(envelope("subscriptions", sequence++, subscriptions_events(subs)));
+                        if (subs.level2 && !had_level2) {
+                            std::cout << "[StandIn] Client " << connection_id << ": level2 resubscribed, sending snapshot" << std::endl;
+                            send_snapshot();
+                        }
+                    }
+                }
+            }
+
+            bool ok = true;
+            if (!capture.empty()) {
+                if (replay_index >= capture.size()) {
+                    if (!options.loop) break;
+                    replay_index = 0;
+                }
+                ok = send(resequence(capture[replay_index++], sequence++));
+            } else if (subs.market_trades && options.trade_every && sent % options.trade_every == options.trade_every - 1) {
+                ok = send(envelope("market_trades", sequence++, book.trade_events()));
+            } else if (subs.level2) {
+                ok = send(envelope("l2_data", sequence++, book.update_events()));
+            }
+            if (!ok) break;
+            ++sent;
+
+            // Faults
+            if (options.storm_every && sent % options.storm_every == 0) {
+                for (uint64_t i = 0; i < options.storm_size && connection.is_open(); ++i) send_snapshot();
+            }
+            if (options.stall_every && fault_rng() % options.stall_every == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(options.stall_us));
+            }
+            if (options.disconnect_every && sent % options.disconnect_every == 0) {
+                std::cout << "[StandIn] Client " << connection_id << ": injected disconnect after " << sent << " messages" << std::endl;
+                connection.close(0);
+                break;
+            }
+
+            // Housekeeping once per 256 messages: heartbeats, stats
+            if ((sent & 255) == 0 || interval_ns > 1e6) {
+                auto now = std::chrono::steady_clock::now();
+                if (subs.heartbeats && now >= next_heartbeat) {
+                    std::string events = R"([{"current_time":")" + format_iso8601_ns(now_ns()) +
+                                         R"(","heartbeat_counter":)" + std::to_string(++heartbeat_counter) + "}]";
+                    send(envelope("heartbeats", sequence++, events));
+                    next_heartbeat += std::chrono::seconds(1);
+                }
+                if (now >= next_report) {
+                    std::cout << "[StandIn] Client " << connection_id << ": " << (sent - sent_at_report) << " msgs/s" << std::endl;
+                    sent_at_report = sent;
+                    next_report += std::chrono::seconds(1);
+                }
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[StandIn] Client " << connection_id << " done: " << sent << " messages in " << seconds
+                  << " s (" << sent / std::max(seconds, 1e-9) << " msgs/s)" << std::endl;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : "0"; };
+        if (std::strcmp(argv[i], "--port") == 0) options.port = static_cast<uint16_t>(std::atoi(next()));
+        else if (std::strcmp(argv[i], "--tls") == 0) options.tls = true;
+        else if (std::strcmp(argv[i], "--replay") == 0) options.replay_file = next();
+        else if (std::strcmp(argv[i], "--loop") == 0) options.loop = true;
+        else if (std::strcmp(argv[i], "--rate") == 0) options.rate = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(argv[i], "--levels") == 0) options.levels = std::max(1, std::atoi(next()));
+        else if (std::strcmp(argv[i], "--trade-every") == 0) options.trade_every = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(argv[i], "--gap-every") == 0) options.gap_every = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(argv[i], "--redundant") == 0) options.redundant = true;
+        else if (std::strcmp(argv[i], "--stall-every") == 0) options.stall_every = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(argv[i], "--stall-us") == 0) options.stall_us = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(argv[i], "--disconnect-every") == 0) options.disconnect_every = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(argv[i], "--storm-every") == 0) options.storm_every = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(argv[i], "--storm-size") == 0) options.storm_size = std::strtoull(next(), nullptr, 10);
+        else if (std::strcmp(argv[i], "--duration") == 0) options.duration = std::atoi(next());
+        else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    std::vector<std::string> capture;
+    if (!options.replay_file.empty()) {
+        capture = load_capture(options.replay_file);
+        if (capture.empty()) {
+            std::cerr << "[StandIn] No messages in " << options.replay_file << std::endl;
+            return 1;
+        }
+        std::cout << "[StandIn] Replaying " << capture.size() << " messages from " << options.replay_file << std::endl;
+    }
+
+    hft::network::WebSocketServer server;
+    if (!server.listen(options.port, options.tls)) return 1;
+    server.start([&](hft::network::WebSocketServer::Connection& connection) {
+        serve_connection(options, capture, server, connection);
+    });
+    std::cout << "[StandIn] Listening on " << (options.tls ? "wss" : "ws") << "://127.0.0.1:" << server.port()
+              << " at " << (options.rate ? std::to_string(options.rate) + " msgs/s" : std::string("max rate")) << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    while (keep_running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (options.duration > 0 && std::chrono::steady_clock::now() - start >= std::chrono::seconds(options.duration)) break;
+    }
+
+    server.stop();
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include "execution/ExecutionGateway.hpp"
 #include "common/Utils.hpp"
+#include "common/DecimalParser.hpp"
+#include "common/Trace.hpp"
 #include <iostream>
 #include <chrono>
 #include <fstream>
@@ -50,6 +52,10 @@ namespace hft {
         }
         file.close();
 
+        attribution_.save_to_csv("latency_attribution.csv");
+        std::cout << "[Exec] Tick-to-wire latency attribution:" << std::endl;
+        attribution_.print(stdout);
+
         std::ofstream trades_file("trades.csv");
         trades_file << "id,timestamp,price,quantity,is_buy\n";
         for (const auto& order : executed_orders_) {
@@ -62,17 +68,20 @@ namespace hft {
         trades_file.close();
     }
 
-    void ExecutionGateway::update_jwt() {
+    void ExecutionGateway::print_latency_attribution() const {
+        attribution_.print(stdout);
+    }
+
+    void ExecutionGateway::update_jwt(CachedJwt& jwt) {
         // Generate a new JWT valid for 2 minutes
         // We refresh it every 1 minute to be safe
         size_t jwt_len = 0;
-        const std::string request_path = "/api/v3/brokerage/orders";
         const std::string host = "api.coinbase.com";
         
-        auth_.generate_jwt_zero_copy("POST", request_path.c_str(), host.c_str(), jwt_buffer_, sizeof(jwt_buffer_), jwt_len);
+        auth_.generate_jwt_zero_copy("POST", jwt.path, host.c_str(), jwt_buffer_, sizeof(jwt_buffer_), jwt_len);
         
-        cached_jwt_ = std::string(jwt_buffer_, jwt_len);
-        jwt_expiry_ = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        jwt.token.assign(jwt_buffer_, jwt_len);
+        jwt.expiry = std::chrono::steady_clock::now() + std::chrono::seconds(60);
     }
 
     void ExecutionGateway::connect() {
@@ -103,18 +112,20 @@ namespace hft {
 
     void ExecutionGateway::run() {
         utils::pin_thread_to_core(constants::EXECUTION_GATEWAY_CORE);
+        TRACE_THREAD("execution");
 
         connect();
-        update_jwt(); // Initial JWT generation
+        update_jwt(order_jwt_); // Initial JWT generation
+        update_jwt(cancel_jwt_);
+        update_jwt(edit_jwt_);
 
         Order order;
-        const std::string request_path = "/api/v3/brokerage/orders";
         const std::string host = "api.coinbase.com";
         
         // Reusable request object to minimize allocations
         http::request<http::string_body> req;
         req.method(http::verb::post);
-        req.target(request_path);
+        req.target(order_jwt_.path);
         req.set(http::field::host, host);
         req.set(http::field::content_type, "application/json");
         req.set(http::field::user_agent, "HFT-Engine/1.0");
@@ -126,16 +137,34 @@ namespace hft {
             if (input_buffer_.pop(order)) {
                 std::cout << "[Exec] Order popped: " << order.id << std::endl;
                 uint64_t pop_time = utils::rdtsc();
+                OrderTimestamps stamps = OrderTimestamps::from(order);
+                stamps.gateway_pop = OrderTimestamps::delta(stamps.rx_tsc, pop_time);
+
+                // CANCEL/REPLACE address an order the exchange has already acknowledged
+                LiveOrder* live = nullptr;
+                if (order.action != OrderAction::NEW) {
+                    auto it = live_orders_.find(order.id);
+                    if (it == live_orders_.end()) {
+                        std::cerr << "[Exec] No live order " << order.id << " to cancel/replace" << std::endl;
+                        continue;
+                    }
+                    live = &it->second;
+                }
 
-                if (!risk_manager_.check_and_reserve(order)) {
+                // Cancels only release risk, so they skip the pre-trade check
+                TRACE_BEGIN(risk_begin);
+                bool risk_ok = order.action == OrderAction::CANCEL || risk_manager_.check_and_reserve(order);
+                TRACE_END(RISK, risk_begin);
+                if (!risk_ok) {
                     std::cerr << "[Exec] Risk check failed for order " << order.id << std::endl;
                     continue;
                 }
+                stamps.risk = OrderTimestamps::delta(stamps.rx_tsc, utils::rdtsc());
 
                 // Rate Limit Check (Token Bucket)
                 if (!rate_limiter_.consume(1.0)) {
                     std::cerr << "[Exec] Rate limit hit, dropping order " << order.id << std::endl;
-                    risk_manager_.rollback_order(order);
+                    if (order.action != OrderAction::CANCEL) risk_manager_.rollback_order(order);
                     continue;
                 }
 
@@ -143,27 +172,54 @@ namespace hft {
                 if (!stream_) {
                     connect();
                     if (!stream_) {
+                        if (order.action != OrderAction::CANCEL) risk_manager_.rollback_order(order);
                         std::this_thread::sleep_for(std::chrono::milliseconds(100));
                         continue;
                     }
                 }
 
+                CachedJwt& jwt = order.action == OrderAction::NEW    ? order_jwt_
+                               : order.action == OrderAction::CANCEL ? cancel_jwt_
+                                                                     : edit_jwt_;
+
                 // Check JWT Expiry
-                if (std::chrono::steady_clock::now() > jwt_expiry_) {
-                    update_jwt();
+                if (std::chrono::steady_clock::now() > jwt.expiry) {
+                    update_jwt(jwt);
                 }
 
                 // 3. Construct JSON Body (Zero-Copy)
-                int payload_len = snprintf(payload_buffer_, sizeof(payload_buffer_),
-                    "{\"client_order_id\":\"%lu\",\"product_id\":\"BTC-USDT\",\"side\":\"%s\",\"order_configuration\":{\"limit_limit_gtc\":{\"base_size\":\"%.8f\",\"limit_price\":\"%.2f\"}}}",
-                    order.id,
-                    order.is_buy ? "BUY" : "SELL",
-                    (double)order.quantity / 100000000.0,
-                    (double)order.price / 100000000.0
-                );
+                TRACE_BEGIN(json_begin);
+                int payload_len = 0;
+                switch (order.action) {
+                    case OrderAction::NEW:
+                        payload_len = snprintf(payload_buffer_, sizeof(payload_buffer_),
+                            "{\"client_order_id\":\"%lu\",\"product_id\":\"BTC-USDT\",\"side\":\"%s\",\"order_configuration\":{\"limit_limit_gtc\":{\"base_size\":\"%.8f\",\"limit_price\":\"%.2f\"}}}",
+                            order.id,
+                            order.is_buy ? "BUY" : "SELL",
+                            (double)order.quantity / 100000000.0,
+                            (double)order.price / 100000000.0
+                        );
+                        break;
+                    case OrderAction::CANCEL:
+                        payload_len = snprintf(payload_buffer_, sizeof(payload_buffer_),
+                            "{\"order_ids\":[\"%s\"]}",
+                            live->exchange_order_id.c_str()
+                        );
+                        break;
+                    case OrderAction::REPLACE:
+                        payload_len = snprintf(payload_buffer_, sizeof(payload_buffer_),
+                            "{\"order_id\":\"%s\",\"price\":\"%.2f\",\"size\":\"%.8f\"}",
+                            live->exchange_order_id.c_str(),
+                            (double)order.price / 100000000.0,
+                            (double)order.quantity / 100000000.0
+                        );
+                        break;
+                }
+                TRACE_END(JSON_BUILD, json_begin);
 
                 // 4. Setup Request
-                snprintf(auth_header_buffer_, sizeof(auth_header_buffer_), "Bearer %s", cached_jwt_.c_str());
+                req.target(jwt.path);
+                snprintf(auth_header_buffer_, sizeof(auth_header_buffer_), "Bearer %s", jwt.token.c_str());
                 req.set(http::field::authorization, auth_header_buffer_);
                 
                 req.body().assign(payload_buffer_, payload_len);
@@ -171,13 +227,20 @@ namespace hft {
 
                 // 5. Send
                 try {
+                    TRACE_BEGIN(write_begin);
                     http::write(*stream_, req);
+                    TRACE_END(HTTP_WRITE, write_begin);
+                    stamps.wire = OrderTimestamps::delta(stamps.rx_tsc, utils::rdtsc());
                     
                     // 6. Read Response
+                    TRACE_BEGIN(read_begin);
                     http::response<http::string_body> res;
                     http::read(*stream_, buffer, res);
+                    TRACE_END(HTTP_READ, read_begin);
                     
                     uint64_t end_time = utils::rdtsc();
+                    stamps.ack = OrderTimestamps::delta(stamps.rx_tsc, end_time);
+                    attribution_.record(stamps);
                     
                     std::cout << "[Exec] Sent order " << order.id << ". Status: " << res.result_int() << std::endl;
 
@@ -187,13 +250,34 @@ namespace hft {
                         stream_.reset();
                     }
 
-                    // Parse Response with simdjson
+                    // Parse Response with simdjson. Coinbase answers 200 even when it
+                    // refuses, so the verdict is in the body (per order for batch_cancel).
+                    std::string_view exchange_order_id;
+                    bool accepted = false;
                     try {
                         simdjson::dom::element doc = json_parser_.parse(res.body());
-                        (void)doc; // Suppress unused variable warning
                         if (res.result_int() == 200) {
-                            // Extract order_id if needed
-                            // std::string_view order_id = doc["order_id"];
+                            switch (order.action) {
+                                case OrderAction::NEW:
+                                    // Keep the exchange id so the order can be cancelled/amended later
+                                    accepted = doc["success_response"]["order_id"].get(exchange_order_id) == simdjson::SUCCESS &&
+                                               !exchange_order_id.empty();
+                                    break;
+                                case OrderAction::CANCEL: {
+                                    // One order per request: results[0]
+                                    bool success = false;
+                                    accepted = doc["results"].at(0)["success"].get(success) == simdjson::SUCCESS && success;
+                                    break;
+                                }
+                                case OrderAction::REPLACE: {
+                                    bool success = false;
+                                    accepted = doc["success"].get(success) == simdjson::SUCCESS && success;
+                                    break;
+                                }
+                            }
+                            if (!accepted) {
+                                std::cerr << "[Exec] Order " << order.id << " refused: " << res.body() << std::endl;
+                            }
                         } else {
                             std::cerr << "[Exec] Error response: " << res.body() << std::endl;
                         }
@@ -204,23 +288,60 @@ namespace hft {
                     uint64_t latency = end_time - pop_time;
                     if (latencies_.size() < latencies_.capacity()) latencies_.push_back(latency);
                     
-                    if (res.result_int() == 200) {
-                        executed_orders_.push_back(order);
-                    } else {
+                    if (accepted) {
+                        switch (order.action) {
+                            case OrderAction::NEW:
+                                executed_orders_.push_back(order);
+                                live_orders_[order.id] = {std::string(exchange_order_id), order, std::chrono::steady_clock::now()};
+                                break;
+                            case OrderAction::CANCEL:
+                                // Confirmed: nothing of it can fill any more
+                                risk_manager_.rollback_order(live->order);
+                                live_orders_.erase(order.id);
+                                break;
+                            case OrderAction::REPLACE:
+                                // The amended order now holds the reservation
+                                risk_manager_.rollback_order(live->order);
+                                live->order = order;
+                                break;
+                        }
+                    } else if (order.action != OrderAction::CANCEL) {
                         risk_manager_.rollback_order(order);
                     }
+                    // A refused cancel keeps the order and its reservation: most likely it
+                    // filled first, and reconciliation drops it once it is no longer open
 
                 } catch (std::exception const& e) {
                     std::cerr << "[Exec] Request failed: " << e.what() << std::endl;
                     stream_.reset();
-                    risk_manager_.rollback_order(order);
+                    if (order.action != OrderAction::CANCEL) risk_manager_.rollback_order(order);
                 }
             } else {
+                if (open_orders_ready_.load(std::memory_order_acquire)) prune_live_orders();
                 _mm_pause();
             }
         }
     }
 
+    void ExecutionGateway::prune_live_orders() {
+        OpenOrders open;
+        {
+            std::lock_guard<std::mutex> lock(open_orders_mutex_);
+            open = std::move(open_orders_);
+            open_orders_ready_.store(false, std::memory_order_relaxed);
+        }
+        // Orders acknowledged after the listing was requested may simply be missing from it
+        for (auto it = live_orders_.begin(); it != live_orders_.end();) {
+            if (it->second.acked_at < open.requested_at && open.ids.count(it->second.exchange_order_id) == 0) {
+                // Filled (or closed by the exchange): a fill consumes its reservation and the
+                // balance reconciliation settles the rest, so nothing is rolled back
+                it = live_orders_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
     void ExecutionGateway::reconcile_loop() {
         // Separate IO context and SSL context for reconciliation
         net::io_context ioc;
@@ -247,22 +368,49 @@ namespace hft {
                 beast::get_lowest_layer(stream).connect(results);
                 stream.handshake(ssl::stream_base::client);
 
-                // GET /api/v3/brokerage/accounts
-                std::string request_path = "/api/v3/brokerage/accounts";
                 std::string host = "api.coinbase.com";
-                
-                char jwt_buf[1024];
-                size_t jwt_len = 0;
-                auth.generate_jwt_zero_copy("GET", request_path.c_str(), host.c_str(), jwt_buf, sizeof(jwt_buf), jwt_len);
+                beast::flat_buffer buffer;
 
-                http::request<http::string_body> req{http::verb::get, request_path, 11};
-                req.set(http::field::host, host);
-                req.set(http::field::user_agent, "HFT-Engine/1.0");
-                req.set(http::field::authorization, std::string("Bearer ") + std::string(jwt_buf, jwt_len));
+                // Authenticated GET on the keep-alive stream (the JWT covers the path, not the query)
+                auto get = [&](const std::string& request_path, const std::string& query) {
+                    char jwt_buf[1024];
+                    size_t jwt_len = 0;
+                    auth.generate_jwt_zero_copy("GET", request_path.c_str(), host.c_str(), jwt_buf, sizeof(jwt_buf), jwt_len);
 
-                beast::flat_buffer buffer;
-                http::response<http::string_body> res;
-                http::read(stream, buffer, res);
+                    http::request<http::string_body> req{http::verb::get, request_path + query, 11};
+                    req.set(http::field::host, host);
+                    req.set(http::field::user_agent, "HFT-Engine/1.0");
+                    req.set(http::field::authorization, std::string("Bearer ") + std::string(jwt_buf, jwt_len));
+                    http::write(stream, req);
+
+                    http::response<http::string_body> res;
+                    http::read(stream, buffer, res);
+                    return res;
+                };
+
+                // Open orders first: anything acknowledged before this request and missing from
+                // the answer has filled, and the order thread drops it from live_orders_
+                auto listed_at = std::chrono::steady_clock::now();
+                auto orders = get("/api/v3/brokerage/orders/historical/batch", "?order_status=OPEN&product_ids=BTC-USDT");
+                if (orders.result() == http::status::ok) {
+                    simdjson::dom::element doc = parser.parse(orders.body());
+                    bool has_next = false;
+                    // A partial listing would make open orders look filled
+                    if (doc["has_next"].get(has_next) == simdjson::SUCCESS && !has_next) {
+                        OpenOrders open;
+                        open.requested_at = listed_at;
+                        for (simdjson::dom::element o : doc["orders"].get_array()) {
+                            std::string_view id;
+                            if (o["order_id"].get(id) == simdjson::SUCCESS) open.ids.emplace(id);
+                        }
+                        std::lock_guard<std::mutex> lock(open_orders_mutex_);
+                        open_orders_ = std::move(open);
+                        open_orders_ready_.store(true, std::memory_order_release);
+                    }
+                }
+
+                // GET /api/v3/brokerage/accounts
+                auto res = get("/api/v3/brokerage/accounts", "");
 
                 if (res.result() == http::status::ok) {
                     simdjson::dom::element doc = parser.parse(res.body());
@@ -273,13 +421,14 @@ namespace hft {
 
                     for (simdjson::dom::element account : accounts) {
                         std::string_view currency = account["currency"];
+                        // Parse available_balance.value straight to 1e8 fixed point (exact, no double)
+                        std::string_view value = account["available_balance"]["value"];
+                        int64_t val = 0;
+                        if (!decimal::parse_fixed(value, val)) continue;
                         if (currency == "USD" || currency == "USDC") {
-                            // Parse available_balance.value
-                            double val = std::stod(std::string(account["available_balance"]["value"]));
-                            usd_bal += static_cast<int64_t>(val * 100000000); // Convert to 1e8 fixed point
+                            usd_bal += val;
                         } else if (currency == "BTC") {
-                            double val = std::stod(std::string(account["available_balance"]["value"]));
-                            btc_bal += static_cast<int64_t>(val * 100000000);
+                            btc_bal += val;
                         }
                     }
                     
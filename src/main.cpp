@@ -5,6 +5,7 @@
 #include "common/RingBuffer.hpp"
 #include "common/Types.hpp"
 #include "common/Utils.hpp"
+#include "common/Trace.hpp"
 #include "common/Logger.hpp"
 #include <iostream>
 #include <memory>
@@ -13,6 +14,7 @@
 #include <sys/mman.h>
 #include <thread>
 #include <chrono>
+#include <cstring>
 
 // Helper for Hugepage Allocation
 template<typename T>
@@ -66,6 +68,9 @@ int main(int argc, char** argv) {
     // Calibrate TSC for accurate timing on this specific AWS instance
     hft::utils::calibrate_tsc();
 
+    // Hot-path spans (no-op unless built with ENABLE_TRACING)
+    TRACE_START("hft_trace.json");
+
     // Allocate large buffers in Hugepages to prevent TLB misses
     auto feed_to_strategy_queue = make_huge_unique<hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE>>();
     auto strategy_to_exec_queue = make_huge_unique<hft::RingBuffer<hft::Order, hft::constants::RING_BUFFER_SIZE>>();
@@ -78,29 +83,68 @@ int main(int argc, char** argv) {
     execution_gateway.start();
     strategy_engine.start();
 
-    // Use WebSocket Feed Handler (Kernel Ingest)
-    hft::CoinbaseFeedHandler feed_handler(*feed_to_strategy_queue, true);
-    feed_handler.start();
-
     // Run for specified duration (default 60s)
+    // Usage: hft_engine [--native-ws] [--capture-zlib] [--lines N] [--rx-timestamps [hw]] [duration_seconds]
+    //   --native-ws     Busy-polled in-house WebSocket client instead of IXWebSocket
+    //   --capture-zlib  zlib-compress market_data.bin blocks (on the capture writer thread)
+    //   --lines N       N redundant market data connections, first arrival wins
+    //   --rx-timestamps Kernel receive timestamps (hw: NIC ones) on the native transport;
+    //                   latency attribution then splits out the rx_to_read wait
     int duration = 60;
-    if (argc > 1) {
-        // The duration is the last argument passed
-        duration = std::atoi(argv[argc - 1]);
+    hft::WsTransport transport = hft::WsTransport::IXWEBSOCKET;
+    hft::storage::Compression capture_compression = hft::storage::Compression::NONE;
+    size_t lines = 1;
+    bool rx_timestamps = false;
+    bool hardware_timestamps = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--native-ws") == 0) {
+            transport = hft::WsTransport::NATIVE;
+        } else if (std::strcmp(argv[i], "--capture-zlib") == 0) {
+            capture_compression = hft::storage::Compression::ZLIB;
+        } else if (std::strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+            lines = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--rx-timestamps") == 0) {
+            rx_timestamps = true;
+            if (i + 1 < argc && std::strcmp(argv[i + 1], "hw") == 0) {
+                hardware_timestamps = true;
+                ++i;
+            }
+        } else {
+            duration = std::atoi(argv[i]);
+        }
     }
 
+    // Use WebSocket Feed Handler (Kernel Ingest)
+    hft::CoinbaseFeedHandler feed_handler(*feed_to_strategy_queue, true, transport, capture_compression);
+    feed_handler.set_lines(lines);
+    feed_handler.set_rx_timestamps(rx_timestamps, hardware_timestamps);
+    feed_handler.start();
+
     std::cout << "Running live trading engine for " << duration << " seconds..." << std::endl;
     
     // Standard Mode (WebSocket)
     for (int i = 0; i < duration && keep_running; ++i) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        // Live tick-to-wire attribution
+        if ((i + 1) % 30 == 0) {
+            execution_gateway.print_latency_attribution();
+        }
     }
     feed_handler.stop();
+    const auto& recovery = feed_handler.recovery_stats();
+    if (recovery.gaps > 0) {
+        std::cout << "[Coinbase] " << recovery.gaps << " gaps (" << recovery.messages_lost << " messages lost), "
+                  << recovery.recoveries << " recovered in-session (max " << recovery.max_ns / 1000 << " us), "
+                  << recovery.reconnects << " reconnects" << std::endl;
+    }
+    feed_handler.print_line_stats();
 
     std::cout << "Stopping engine..." << std::endl;
     LOG_INFO("Stopping engine...");
     strategy_engine.stop();
     execution_gateway.stop();
+    TRACE_STOP();
     hft::AsyncLogger::instance().stop();
 
     return 0;
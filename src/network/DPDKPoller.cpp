@@ -1,11 +1,15 @@
 #include "network/DPDKPoller.hpp"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <string>
+#include <thread>
 
 namespace hft::network {
 
     DPDKPoller::DPDKPoller(uint16_t port_id) 
 #ifdef USE_DPDK
-        : port_id_(port_id), mbuf_pool_(nullptr) 
+        : port_id_(port_id), tx_pool_(nullptr) 
 #endif
     {
 #ifdef USE_DPDK
@@ -13,16 +17,19 @@ namespace hft::network {
         // In a real HFT app, you would tune rxmode (e.g., RSS, Offloads)
         port_conf_ = {};
         port_conf_.rxmode.mq_mode = RTE_ETH_MQ_RX_NONE;
+#else
+        (void)port_id;
 #endif
     }
 
     DPDKPoller::~DPDKPoller() {
 #ifdef USE_DPDK
-        // Cleanup if needed
+        // Packets still queued for TX go back to the pool
+        if (tx_count_ != 0) rte_pktmbuf_free_bulk(tx_queue_, tx_count_);
 #endif
     }
 
-    int DPDKPoller::init(int argc, char** argv) {
+    int DPDKPoller::init(int argc, char** argv, uint16_t rx_queues) {
 #ifdef USE_DPDK
         // 1. Initialize EAL
         int ret = rte_eal_init(argc, argv);
@@ -30,13 +37,6 @@ namespace hft::network {
             rte_exit(EXIT_FAILURE, "Error with EAL initialization\n");
         }
 
-        // 2. Create mbuf pool
-        // 8191 elements, 250 cache size, 0 priv size, default data room size
-        mbuf_pool_ = rte_pktmbuf_pool_create("MBUF_POOL", 8191, 250, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
-        if (mbuf_pool_ == nullptr) {
-            rte_exit(EXIT_FAILURE, "Cannot create mbuf pool\n");
-        }
-
         // Check if any ports are available
         uint16_t nb_ports = rte_eth_dev_count_avail();
         if (nb_ports == 0) {
@@ -45,8 +45,7 @@ namespace hft::network {
             return 0; 
         }
 
-        // 3. Configure port
-        uint16_t nb_rx_q = 1;
+        // 2. Configure port
         uint16_t nb_tx_q = 1;
         struct rte_eth_dev_info dev_info;
         
@@ -54,16 +53,67 @@ namespace hft::network {
         if (ret != 0) {
             rte_exit(EXIT_FAILURE, "Error getting device info\n");
         }
+
+        rx_queues_ = std::max<uint16_t>(1, std::min(rx_queues, dev_info.max_rx_queues));
+        if (rx_queues_ > 1) {
+            // Spread flows over the queues by a hash of the IP/UDP header
+            port_conf_.rxmode.mq_mode = RTE_ETH_MQ_RX_RSS;
+            port_conf_.rx_adv_conf.rss_conf.rss_key = nullptr;
+            port_conf_.rx_adv_conf.rss_conf.rss_hf = (RTE_ETH_RSS_IP | RTE_ETH_RSS_UDP) & dev_info.flow_type_rss_offloads;
+        }
+        if (rx_queues_ != rx_queues) {
+            std::cout << "[DPDK] Port " << port_id_ << " supports " << rx_queues_ << " RX queues." << std::endl;
+        }
+
+        // Checksums in the NIC where it can; UdpHeaderTemplate covers the IPv4 one otherwise
+        tx_ip_offload_ = (dev_info.tx_offload_capa & RTE_ETH_TX_OFFLOAD_IPV4_CKSUM) != 0;
+        tx_udp_offload_ = (dev_info.tx_offload_capa & RTE_ETH_TX_OFFLOAD_UDP_CKSUM) != 0;
+        port_conf_.txmode.offloads = dev_info.tx_offload_capa & (RTE_ETH_TX_OFFLOAD_IPV4_CKSUM | RTE_ETH_TX_OFFLOAD_UDP_CKSUM);
+        std::cout << "[DPDK] TX checksum offload: IPv4 " << (tx_ip_offload_ ? "yes" : "no")
+                  << ", UDP " << (tx_udp_offload_ ? "yes" : "no") << std::endl;
+
+        // RX timestamps: the PMD writes them to a dynamic mbuf field and flags the mbuf
+        rx_timestamp_flag_ = 0;
+        if (rx_timestamps_requested_) {
+            if ((dev_info.rx_offload_capa & RTE_ETH_RX_OFFLOAD_TIMESTAMP) == 0) {
+                std::cout << "[DPDK] Port " << port_id_ << " has no RX timestamp offload." << std::endl;
+            } else if (rte_mbuf_dyn_rx_timestamp_register(&rx_timestamp_offset_, &rx_timestamp_flag_) != 0) {
+                std::cerr << "[DPDK] Cannot register the RX timestamp mbuf field." << std::endl;
+                rx_timestamp_flag_ = 0;
+            } else {
+                port_conf_.rxmode.offloads |= RTE_ETH_RX_OFFLOAD_TIMESTAMP;
+            }
+        }
         
-        ret = rte_eth_dev_configure(port_id_, nb_rx_q, nb_tx_q, &port_conf_);
+        ret = rte_eth_dev_configure(port_id_, rx_queues_, nb_tx_q, &port_conf_);
         if (ret != 0) {
             rte_exit(EXIT_FAILURE, "Error configuring device\n");
         }
 
-        // 4. Setup RX Queue
-        ret = rte_eth_rx_queue_setup(port_id_, 0, 1024, rte_eth_dev_socket_id(port_id_), NULL, mbuf_pool_);
-        if (ret < 0) {
-            rte_exit(EXIT_FAILURE, "Error setting up RX queue\n");
+        // 3. Create mbuf pools, one per RX queue
+        // 8191 elements, 250 cache size, 0 priv size, default data room size
+        rx_pools_.clear();
+        for (uint16_t q = 0; q < rx_queues_; ++q) {
+            std::string name = "MBUF_POOL_" + std::to_string(q);
+            struct rte_mempool* pool = rte_pktmbuf_pool_create(name.c_str(), 8191, 250, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+                                                               rte_eth_dev_socket_id(port_id_));
+            if (pool == nullptr) {
+                rte_exit(EXIT_FAILURE, "Cannot create mbuf pool\n");
+            }
+            rx_pools_.push_back(pool);
+        }
+        tx_pool_ = rte_pktmbuf_pool_create("TX_POOL", 8191, 250, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+                                           rte_eth_dev_socket_id(port_id_));
+        if (tx_pool_ == nullptr) {
+            rte_exit(EXIT_FAILURE, "Cannot create mbuf pool\n");
+        }
+
+        // 4. Setup RX Queues
+        for (uint16_t q = 0; q < rx_queues_; ++q) {
+            ret = rte_eth_rx_queue_setup(port_id_, q, 1024, rte_eth_dev_socket_id(port_id_), NULL, rx_pools_[q]);
+            if (ret < 0) {
+                rte_exit(EXIT_FAILURE, "Error setting up RX queue\n");
+            }
         }
         
         // 5. Setup TX Queue (even if we only read, we might need it)
@@ -72,8 +122,15 @@ namespace hft::network {
             rte_exit(EXIT_FAILURE, "Error setting up TX queue\n");
         }
 
+        // Source MAC of the header templates
+        rte_eth_macaddr_get(port_id_, &mac_);
+        set_tx_flush_ns(tx_flush_ns_);
+
         return ret;
 #else
+        (void)argc;
+        (void)argv;
+        (void)rx_queues;
         std::cout << "[DPDK] Not enabled. Skipping init." << std::endl;
         return 0;
 #endif
@@ -87,87 +144,77 @@ namespace hft::network {
         }
         rte_eth_promiscuous_enable(port_id_); 
         std::cout << "[DPDK] Port " << port_id_ << " started." << std::endl;
+
+        if (rx_timestamp_flag_ != 0) {
+            // The NIC counts in its own units; rate them against the TSC over a short sleep
+            NicClock clock;
+            if (rte_eth_read_clock(port_id_, &clock.nic) != 0) {
+                std::cerr << "[DPDK] Cannot read the port clock; RX timestamps disabled." << std::endl;
+                rx_timestamp_flag_ = 0;
+                return;
+            }
+            clock.tsc = utils::rdtsc();
+            std::this_thread::sleep_for(std::chrono::milliseconds(NIC_CLOCK_CALIBRATION_MS));
+            resync_clock(clock);
+            nic_clocks_.assign(rx_queues_, clock);
+            nic_clock_resync_cycles_ = static_cast<uint64_t>(NIC_CLOCK_RESYNC_NS * utils::CYCLES_PER_NS);
+            std::cout << "[DPDK] RX timestamps on (" << clock.cycles_per_tick << " TSC cycles per NIC tick)." << std::endl;
+        }
 #endif
     }
 
-    void DPDKPoller::poll(std::function<void(const uint8_t*, uint16_t)> callback) {
+    void DPDKPoller::resync_clock(NicClock& clock) {
 #ifdef USE_DPDK
-        struct rte_mbuf *bufs[32];
-        // Burst read from the NIC
-        const uint16_t nb_rx = rte_eth_rx_burst(port_id_, 0, bufs, 32);
-
-        for (int i = 0; i < nb_rx; i++) {
-            // Get pointer to packet data
-            uint8_t* pkt_data = rte_pktmbuf_mtod(bufs[i], uint8_t*);
-            
-            // Parse Ethernet Header
-            struct rte_ether_hdr *eth_hdr = (struct rte_ether_hdr *)pkt_data;
-            
-            // Check for IPv4
-            if (eth_hdr->ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4)) {
-                struct rte_ipv4_hdr *ip_hdr = (struct rte_ipv4_hdr *)(eth_hdr + 1);
-                
-                // Check for UDP
-                if (ip_hdr->next_proto_id == IPPROTO_UDP) {
-                    // Calculate payload offset: Eth + IP + UDP
-                    // Note: IP header length is in 32-bit words
-                    size_t ip_hdr_len = (ip_hdr->version_ihl & 0x0F) * 4;
-                    struct rte_udp_hdr *udp_hdr = (struct rte_udp_hdr *)((uint8_t *)ip_hdr + ip_hdr_len);
-                    
-                    // Payload follows UDP header
-                    uint8_t *payload = (uint8_t *)(udp_hdr + 1);
-                    
-                    // Calculate payload length
-                    // UDP length includes header (8 bytes)
-                    uint16_t udp_len = rte_be_to_cpu_16(udp_hdr->dgram_len);
-                    uint16_t payload_len = udp_len - sizeof(struct rte_udp_hdr);
-                    
-                    // Invoke callback with payload only
-                    callback(payload, payload_len);
-                }
-            }
-            
-            // Free the buffer back to the pool
-            rte_pktmbuf_free(bufs[i]);
+        uint64_t nic;
+        if (rte_eth_read_clock(port_id_, &nic) != 0) return;
+        const uint64_t tsc = utils::rdtsc();
+        if (nic > clock.nic && tsc > clock.tsc) {
+            clock.cycles_per_tick = static_cast<double>(tsc - clock.tsc) / static_cast<double>(nic - clock.nic);
         }
+        clock.nic = nic;
+        clock.tsc = tsc;
+#else
+        (void)clock;
 #endif
     }
 
-    void DPDKPoller::send(const uint8_t* data, uint16_t len) {
+    int DPDKPoller::add_destination(const std::string& src_address, uint16_t src_port,
+                                    const std::string& dst_address, uint16_t dst_port, const std::string& dst_mac) {
 #ifdef USE_DPDK
-        struct rte_mbuf *mbuf = rte_pktmbuf_alloc(mbuf_pool_);
-        if (unlikely(mbuf == nullptr)) {
-            return;
+        if (tx_pool_ == nullptr || destination_count_ == MAX_DESTINATIONS ||
+            !destinations_[destination_count_].build(mac_.addr_bytes, src_address, src_port, dst_address, dst_port, dst_mac)) {
+            std::cerr << "[DPDK] Cannot add destination " << dst_address << ":" << dst_port << std::endl;
+            return -1;
         }
+        return static_cast<int>(destination_count_++);
+#else
+        (void)src_address;
+        (void)src_port;
+        (void)dst_address;
+        (void)dst_port;
+        (void)dst_mac;
+        return -1;
+#endif
+    }
 
-        // 1. Prepend Headers (Ethernet + IP + UDP)
-        // For this demo, we will just construct a dummy Ethernet frame to ensure it leaves the NIC.
-        // In a real HFT system, you would use a pre-calculated template (Zero-Copy).
-        
-        size_t header_len = sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv4_hdr) + sizeof(struct rte_udp_hdr);
-        size_t total_len = header_len + len;
-
-        // Append data to mbuf
-        char *payload = rte_pktmbuf_append(mbuf, total_len);
-        if (unlikely(payload == nullptr)) {
-            rte_pktmbuf_free(mbuf);
-            return;
+    uint16_t DPDKPoller::flush() {
+#ifdef USE_DPDK
+        if (tx_count_ == 0) return 0;
+        const uint16_t nb_tx = rte_eth_tx_burst(port_id_, 0, tx_queue_, tx_count_);
+        if (nb_tx != 0) {
+            tx_stats_.packets += nb_tx;
+            ++tx_stats_.bursts;
         }
 
-        // Fill Headers (Dummy values for benchmark)
-        struct rte_ether_hdr *eth_hdr = (struct rte_ether_hdr *)payload;
-        eth_hdr->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
-        
-        // Copy payload after headers
-        rte_memcpy(payload + header_len, data, len);
-
-        // Send
-        uint16_t nb_tx = rte_eth_tx_burst(port_id_, 0, &mbuf, 1);
-        
-        // Free if not sent
-        if (unlikely(nb_tx < 1)) {
-            rte_pktmbuf_free(mbuf);
+        // Keep what the ring had no room for, oldest first
+        if (unlikely(nb_tx < tx_count_)) {
+            std::memmove(tx_queue_, tx_queue_ + nb_tx, (tx_count_ - nb_tx) * sizeof(tx_queue_[0]));
+            if (nb_tx != 0) tx_first_tsc_ = utils::rdtsc();
         }
+        tx_count_ = static_cast<uint16_t>(tx_count_ - nb_tx);
+        return nb_tx;
+#else
+        return 0;
 #endif
     }
 
@@ -0,0 +1,242 @@
+#include "network/TlsSocket.hpp"
+#include "network/RxTimestamps.hpp"
+#include <openssl/err.h>
+#include <openssl/x509v3.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <iostream>
+
+namespace hft::network {
+
+    namespace {
+        // OpenSSL writes through plain write(), so a peer reset would raise SIGPIPE
+        void ignore_sigpipe() {
+            static const bool once = [] {
+                std::signal(SIGPIPE, SIG_IGN);
+                return true;
+            }();
+            (void)once;
+        }
+    }
+
+    TlsSocket::~TlsSocket() {
+        close();
+    }
+
+    bool TlsSocket::connect(const std::string& host, uint16_t port, SSL_CTX* ssl_ctx, bool verify) {
+        close();
+        ignore_sigpipe();
+
+        // 1. Resolve and connect (blocking)
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        std::string port_str = std::to_string(port);
+        if (getaddrinfo(host.c_str(), port_str.c_str(), &hints, &result) != 0) {
+            std::cerr << "[TlsSocket] Cannot resolve " << host << std::endl;
+            return false;
+        }
+
+        for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+            int fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (fd < 0) continue;
+            if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+                fd_ = fd;
+                break;
+            }
+            ::close(fd);
+        }
+        freeaddrinfo(result);
+        if (fd_ < 0) {
+            std::cerr << "[TlsSocket] Cannot connect to " << host << ":" << port << std::endl;
+            return false;
+        }
+
+        // 2. Disable Nagle (subscriptions and pongs must leave immediately)
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (!ssl_ctx) return true;
+
+        // 3. TLS handshake
+        ssl_ = SSL_new(ssl_ctx);
+        SSL_set_fd(ssl_, fd_);
+        SSL_set_tlsext_host_name(ssl_, host.c_str());
+        if (verify) {
+            SSL_set_verify(ssl_, SSL_VERIFY_PEER, nullptr);
+            SSL_set1_host(ssl_, host.c_str());
+        }
+        if (SSL_connect(ssl_) != 1) {
+            std::cerr << "[TlsSocket] TLS handshake failed: " << ERR_reason_error_string(ERR_get_error()) << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool TlsSocket::accept(int fd, SSL_CTX* ssl_ctx) {
+        close();
+        ignore_sigpipe();
+        fd_ = fd;
+
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (!ssl_ctx) return true;
+
+        ssl_ = SSL_new(ssl_ctx);
+        SSL_set_fd(ssl_, fd_);
+        if (SSL_accept(ssl_) != 1) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void TlsSocket::set_nonblocking(bool nonblocking) {
+        if (fd_ < 0) return;
+        int flags = fcntl(fd_, F_GETFL, 0);
+        fcntl(fd_, F_SETFL, nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+        nonblocking_ = nonblocking;
+    }
+
+    bool TlsSocket::enable_rx_timestamps(bool hardware) {
+        if (fd_ < 0 || !enable_rx_timestamping(fd_, hardware, "[TlsSocket]")) return false;
+        if (ssl_ && !rbio_) {
+            // Without read-ahead OpenSSL takes no more from the fd than the record it is
+            // on, so nothing is stranded in the socket BIO. A drained memory BIO reports
+            // "retry" rather than end of file, so SSL_read returns WANT_READ exactly as on
+            // an empty non-blocking socket.
+            rbio_ = BIO_new(BIO_s_mem());
+            BIO_set_mem_eof_return(rbio_, -1);
+            SSL_set0_rbio(ssl_, rbio_);
+            cipher_.resize(64 * 1024);
+        }
+        rx_timestamps_ = true;
+        return true;
+    }
+
+    ssize_t TlsSocket::receive_stamped(char* buf, size_t len) {
+        iovec iov{buf, len};
+        alignas(cmsghdr) char control[RX_TIMESTAMP_CONTROL_BYTES];
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        ssize_t n = ::recvmsg(fd_, &msg, 0);
+        if (n > 0) {
+            uint64_t rx_ns = rx_timestamp_ns(msg);
+            if (rx_ns != 0) last_rx_ns_ = rx_ns;
+            return n;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+        return -1;
+    }
+
+    ssize_t TlsSocket::read(char* buf, size_t len) {
+        if (fd_ < 0) return -1;
+
+        if (!ssl_) {
+            if (rx_timestamps_) return receive_stamped(buf, len);
+            ssize_t n = ::recv(fd_, buf, len, 0);
+            if (n > 0) return n;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+            return -1;
+        }
+
+        int n = SSL_read(ssl_, buf, static_cast<int>(len));
+        if (n > 0) return n;
+
+        int err = SSL_get_error(ssl_, n);
+        if (rbio_ && err == SSL_ERROR_WANT_READ) {
+            // Buffered records are used up: receive more ciphertext and decrypt again
+            ssize_t got = receive_stamped(cipher_.data(), cipher_.size());
+            if (got <= 0) return got;
+            BIO_write(rbio_, cipher_.data(), static_cast<int>(got));
+            n = SSL_read(ssl_, buf, static_cast<int>(len));
+            if (n > 0) return n;
+            err = SSL_get_error(ssl_, n);
+        }
+
+        switch (err) {
+            case SSL_ERROR_WANT_READ:
+            case SSL_ERROR_WANT_WRITE:
+                return 0;
+            default:
+                return -1;
+        }
+    }
+
+    bool TlsSocket::write_all(const char* data, size_t len) {
+        size_t written = 0;
+        while (written < len) {
+            if (fd_ < 0) return false;
+
+            ssize_t n;
+            bool would_block = false;
+            if (!ssl_) {
+                n = ::send(fd_, data + written, len - written, MSG_NOSIGNAL);
+                if (n < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+                    would_block = true;
+                }
+            } else {
+                // A retried SSL_write must repeat the same buffer, which this loop does
+                n = SSL_write(ssl_, data + written, static_cast<int>(len - written));
+                if (n <= 0) {
+                    int err = SSL_get_error(ssl_, static_cast<int>(n));
+                    if (err != SSL_ERROR_WANT_WRITE && err != SSL_ERROR_WANT_READ) return false;
+                    would_block = true;
+                }
+            }
+
+            if (would_block) {
+                pollfd pfd{fd_, POLLOUT, 0};
+                ::poll(&pfd, 1, 100);
+                continue;
+            }
+            written += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool TlsSocket::wait_readable(int timeout_ms) {
+        if (fd_ < 0) return false;
+        if (ssl_ && SSL_pending(ssl_) > 0) return true;
+        if (rbio_ && BIO_ctrl_pending(rbio_) > 0) return true;
+        pollfd pfd{fd_, POLLIN, 0};
+        return ::poll(&pfd, 1, timeout_ms) > 0;
+    }
+
+    void TlsSocket::shutdown() {
+        if (fd_ >= 0) ::shutdown(fd_, SHUT_RDWR);
+    }
+
+    void TlsSocket::close() {
+        if (ssl_) {
+            // Best-effort close_notify; never block on it
+            if (!nonblocking_) set_nonblocking(true);
+            SSL_shutdown(ssl_);
+            SSL_free(ssl_);
+            ssl_ = nullptr;
+            rbio_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        nonblocking_ = false;
+        rx_timestamps_ = false;
+        last_rx_ns_ = 0;
+    }
+
+}
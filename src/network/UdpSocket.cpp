@@ -0,0 +1,160 @@
+#include "network/UdpSocket.hpp"
+#include "network/RxTimestamps.hpp"
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace hft::network {
+
+    namespace {
+        // Room for a burst of full-size packets while the feed thread is busy
+        constexpr int RECEIVE_BUFFER_BYTES = 8 << 20;
+
+        constexpr size_t CONTROL_BYTES = RX_TIMESTAMP_CONTROL_BYTES;
+    }
+
+    ReceiveBatch::ReceiveBatch(size_t capacity, size_t packet_bytes)
+        : msgs_(capacity), iovecs_(capacity), buffers_(capacity * packet_bytes), control_(capacity * CONTROL_BYTES),
+          rx_ns_(capacity, 0), packet_bytes_(packet_bytes) {
+        for (size_t i = 0; i < capacity; ++i) {
+            iovecs_[i] = {buffers_.data() + i * packet_bytes, packet_bytes};
+            msgs_[i].msg_hdr.msg_iov = &iovecs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    UdpSocket::~UdpSocket() {
+        close();
+    }
+
+    bool UdpSocket::open(const std::string& address, uint16_t port, const std::string& interface, bool join) {
+        close();
+
+        in_addr group{};
+        in_addr local{};
+        if (inet_pton(AF_INET, address.c_str(), &group) != 1 || inet_pton(AF_INET, interface.c_str(), &local) != 1) {
+            std::cerr << "[UdpSocket] Bad address " << address << " / " << interface << std::endl;
+            return false;
+        }
+        multicast_ = IN_MULTICAST(ntohl(group.s_addr));
+
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) return false;
+
+        // Several processes (or the A and B line) may listen on one port
+        int one = 1;
+        setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        int rcvbuf = RECEIVE_BUFFER_BYTES;
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL, 0) | O_NONBLOCK);
+
+        // Bind to the group itself so only this group's traffic arrives on the socket
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr = group;
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "[UdpSocket] Cannot bind " << address << ":" << port << ": " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+
+        mreq_.imr_multiaddr = group;
+        mreq_.imr_interface = local;
+        return !join || this->join();
+    }
+
+    bool UdpSocket::membership(int option) {
+        if (fd_ < 0) return false;
+        if (!multicast_) return true;
+        if (setsockopt(fd_, IPPROTO_IP, option, &mreq_, sizeof(mreq_)) != 0) {
+            std::cerr << "[UdpSocket] Multicast membership change failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool UdpSocket::join() {
+        if (joined_) return true;
+        joined_ = membership(IP_ADD_MEMBERSHIP);
+        return joined_;
+    }
+
+    bool UdpSocket::leave() {
+        if (!joined_) return true;
+        joined_ = !membership(IP_DROP_MEMBERSHIP);
+        return !joined_;
+    }
+
+    bool UdpSocket::set_busy_poll(int usecs) {
+        if (fd_ < 0) return false;
+        if (setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs)) != 0) {
+            std::cerr << "[UdpSocket] SO_BUSY_POLL failed (needs CAP_NET_ADMIN): " << strerror(errno) << std::endl;
+            return false;
+        }
+#ifdef SO_PREFER_BUSY_POLL
+        int prefer = usecs > 0;
+        setsockopt(fd_, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+#endif
+        return true;
+    }
+
+    bool UdpSocket::enable_rx_timestamps(bool hardware) {
+        if (fd_ < 0 || !enable_rx_timestamping(fd_, hardware, "[UdpSocket]")) return false;
+        timestamps_ = true;
+        return true;
+    }
+
+    ssize_t UdpSocket::receive(uint8_t* buf, size_t len, uint64_t* rx_ns) {
+        ssize_t n;
+        if (timestamps_ && rx_ns != nullptr) {
+            alignas(cmsghdr) uint8_t control[CONTROL_BYTES];
+            iovec iov{buf, len};
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            n = ::recvmsg(fd_, &msg, 0);
+            if (n >= 0) *rx_ns = rx_timestamp_ns(msg);
+        } else {
+            n = ::recv(fd_, buf, len, 0);
+        }
+        if (n >= 0) return n;
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+
+    ssize_t UdpSocket::receive_batch(ReceiveBatch& batch) {
+        batch.count_ = 0;
+        // The kernel rewrites the control length (and flags) of every message it fills
+        for (size_t i = 0; i < batch.msgs_.size(); ++i) {
+            msghdr& hdr = batch.msgs_[i].msg_hdr;
+            hdr.msg_control = timestamps_ ? batch.control_.data() + i * CONTROL_BYTES : nullptr;
+            hdr.msg_controllen = timestamps_ ? CONTROL_BYTES : 0;
+            hdr.msg_flags = 0;
+        }
+
+        int n = ::recvmmsg(fd_, batch.msgs_.data(), static_cast<unsigned>(batch.msgs_.size()), 0, nullptr);
+        if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+
+        batch.count_ = static_cast<size_t>(n);
+        if (timestamps_) {
+            for (size_t i = 0; i < batch.count_; ++i) batch.rx_ns_[i] = rx_timestamp_ns(batch.msgs_[i].msg_hdr);
+        }
+        return n;
+    }
+
+    void UdpSocket::close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        joined_ = false;
+        timestamps_ = false;
+    }
+
+}
@@ -0,0 +1,256 @@
+#include "network/WebSocketClient.hpp"
+#include <openssl/err.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace hft::network {
+
+    namespace {
+        struct ParsedUrl {
+            bool tls = false;
+            std::string host;
+            uint16_t port = 0;
+            std::string path = "/";
+        };
+
+        bool parse_url(const std::string& url, ParsedUrl& out) {
+            std::string_view rest = url;
+            if (rest.rfind("wss://", 0) == 0) {
+                out.tls = true;
+                rest.remove_prefix(6);
+            } else if (rest.rfind("ws://", 0) == 0) {
+                out.tls = false;
+                rest.remove_prefix(5);
+            } else {
+                return false;
+            }
+
+            size_t slash = rest.find('/');
+            std::string_view authority = rest.substr(0, slash);
+            if (slash != std::string_view::npos) out.path = std::string(rest.substr(slash));
+
+            size_t colon = authority.rfind(':');
+            if (colon != std::string_view::npos) {
+                out.host = std::string(authority.substr(0, colon));
+                out.port = static_cast<uint16_t>(std::stoi(std::string(authority.substr(colon + 1))));
+            } else {
+                out.host = std::string(authority);
+                out.port = out.tls ? 443 : 80;
+            }
+            return !out.host.empty();
+        }
+    }
+
+    WebSocketClient::WebSocketClient() : mask_state_(utils::rdtsc() | 1) {
+        for (auto& slot : slots_) {
+            slot.resize(SLOT_SIZE + PADDING);
+        }
+        send_buffer_.reserve(4096);
+    }
+
+    WebSocketClient::~WebSocketClient() {
+        close();
+        if (ssl_ctx_) SSL_CTX_free(ssl_ctx_);
+    }
+
+    bool WebSocketClient::connect(const std::string& url) {
+        close();
+
+        ParsedUrl target;
+        if (!parse_url(url, target)) {
+            std::cerr << "[WebSocket] Invalid URL: " << url << std::endl;
+            return false;
+        }
+
+        if (target.tls && !ssl_ctx_) {
+            ssl_ctx_ = SSL_CTX_new(TLS_client_method());
+            SSL_CTX_set_min_proto_version(ssl_ctx_, TLS1_2_VERSION);
+            SSL_CTX_set_default_verify_paths(ssl_ctx_);
+        }
+
+        if (!socket_.connect(target.host, target.port, target.tls ? ssl_ctx_ : nullptr, tls_verify_)) {
+            return false;
+        }
+
+        bool default_port = target.port == (target.tls ? 443 : 80);
+        std::string host_header = default_port ? target.host : target.host + ":" + std::to_string(target.port);
+        if (!handshake(host_header, target.path)) {
+            std::cerr << "[WebSocket] Upgrade rejected by " << target.host << std::endl;
+            socket_.close();
+            return false;
+        }
+
+        // Busy-polled from here on
+        socket_.set_nonblocking(true);
+        if (rx_timestamps_) socket_.enable_rx_timestamps(hardware_timestamps_);
+        return true;
+    }
+
+    void WebSocketClient::close() {
+        if (socket_.is_open()) {
+            socket_.close();
+        }
+        current_ = 0;
+        read_pos_ = 0;
+        write_pos_ = 0;
+        pending_frame_ = 0;
+        unparsed_ = false;
+        assembling_ = false;
+        assembly_len_ = 0;
+    }
+
+    bool WebSocketClient::send_text(std::string_view payload) {
+        return send_frame(ws::Opcode::TEXT, payload.data(), payload.size());
+    }
+
+    bool WebSocketClient::handshake(const std::string& host, const std::string& path) {
+        std::string key = ws::make_client_key();
+        std::string request = "GET " + path + " HTTP/1.1\r\n"
+                              "Host: " + host + "\r\n"
+                              "Upgrade: websocket\r\n"
+                              "Connection: Upgrade\r\n"
+                              "Sec-WebSocket-Key: " + key + "\r\n"
+                              "Sec-WebSocket-Version: 13\r\n\r\n";
+        if (!socket_.write_all(request.data(), request.size())) return false;
+
+        // Read the response head (blocking). Frames may already follow it.
+        char* buf = slots_[0].data();
+        size_t len = 0;
+        size_t head_end = std::string_view::npos;
+        while (head_end == std::string_view::npos) {
+            if (len >= 16 * 1024) return false;
+            ssize_t n = socket_.read(buf + len, SLOT_SIZE - len);
+            if (n <= 0) return false;
+            len += static_cast<size_t>(n);
+            head_end = std::string_view(buf, len).find("\r\n\r\n");
+        }
+
+        std::string_view head(buf, head_end + 4);
+        if (head.rfind("HTTP/1.1 101", 0) != 0) return false;
+        if (ws::find_header(head, "Sec-WebSocket-Accept") != ws::compute_accept_key(key)) return false;
+
+        current_ = 0;
+        read_pos_ = head_end + 4;
+        write_pos_ = len;
+        unparsed_ = write_pos_ > read_pos_;
+        return true;
+    }
+
+    ssize_t WebSocketClient::read_some() {
+        size_t capacity = slots_[current_].size() - PADDING;
+        size_t needed = std::max(pending_frame_, MIN_READ);
+        if (capacity - write_pos_ < MIN_READ || read_pos_ + needed > capacity) {
+            rotate(needed);
+            capacity = slots_[current_].size() - PADDING;
+        }
+        ssize_t n = socket_.read(slots_[current_].data() + write_pos_, capacity - write_pos_);
+        if (n > 0) write_pos_ += static_cast<size_t>(n);
+        return n;
+    }
+
+    void WebSocketClient::rotate(size_t needed) {
+        size_t next = (current_ + 1) % RING_SLOTS;
+        size_t partial = write_pos_ - read_pos_;
+        size_t size = std::max(SLOT_SIZE, needed + MIN_READ);
+        if (slots_[next].size() < size + PADDING) {
+            slots_[next].resize(size + PADDING);
+        }
+        std::memcpy(slots_[next].data(), slots_[current_].data() + read_pos_, partial);
+        current_ = next;
+        read_pos_ = 0;
+        write_pos_ = partial;
+    }
+
+    bool WebSocketClient::next_message(std::string_view& payload, size_t& capacity) {
+        std::vector<char>& slot = slots_[current_];
+        while (is_open()) {
+            char* base = slot.data();
+            size_t available = write_pos_ - read_pos_;
+
+            ws::FrameHeader header;
+            if (!ws::parse_frame_header(base + read_pos_, available, header)) {
+                pending_frame_ = 0;
+                return false;
+            }
+            size_t total = header.header_len + header.payload_len;
+            if (available < total) {
+                pending_frame_ = total;
+                return false;
+            }
+            pending_frame_ = 0;
+
+            char* data = base + read_pos_ + header.header_len;
+            size_t len = header.payload_len;
+            read_pos_ += total;
+
+            // Servers must not mask, but unmask in place if one does
+            if (header.masked) ws::apply_mask(data, len, header.mask);
+
+            switch (header.opcode) {
+                case ws::Opcode::PING:
+                    send_frame(ws::Opcode::PONG, data, len);
+                    continue;
+                case ws::Opcode::PONG:
+                    continue;
+                case ws::Opcode::CLOSE:
+                    send_frame(ws::Opcode::CLOSE, data, std::min<size_t>(len, 125));
+                    socket_.close();
+                    return false;
+                case ws::Opcode::TEXT:
+                case ws::Opcode::BINARY:
+                case ws::Opcode::CONTINUATION:
+                    break;
+                default:
+                    // Unknown opcode: protocol error
+                    socket_.close();
+                    return false;
+            }
+
+            // Fast path: a complete message in a single frame, handed out in place
+            if (header.fin && header.opcode != ws::Opcode::CONTINUATION && !assembling_) {
+                payload = std::string_view(data, len);
+                capacity = slot.size() - static_cast<size_t>(data - base);
+                return true;
+            }
+
+            // Fragmented message: accumulate into the assembly buffer
+            if (header.opcode != ws::Opcode::CONTINUATION) {
+                assembly_len_ = 0;
+            }
+            assembling_ = true;
+            if (assembly_.size() < assembly_len_ + len + PADDING) {
+                assembly_.resize(assembly_len_ + len + PADDING);
+            }
+            std::memcpy(assembly_.data() + assembly_len_, data, len);
+            assembly_len_ += len;
+
+            if (header.fin) {
+                assembling_ = false;
+                payload = std::string_view(assembly_.data(), assembly_len_);
+                capacity = assembly_.size();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool WebSocketClient::send_frame(ws::Opcode opcode, const char* data, size_t len) {
+        if (!is_open()) return false;
+
+        // Client frames must be masked (xorshift is plenty: masking is not a security boundary here)
+        mask_state_ ^= mask_state_ << 13;
+        mask_state_ ^= mask_state_ >> 7;
+        mask_state_ ^= mask_state_ << 17;
+        uint8_t mask[4];
+        std::memcpy(mask, &mask_state_, 4);
+
+        send_buffer_.resize(ws::MAX_HEADER_SIZE + len);
+        size_t header_len = ws::write_frame_header(send_buffer_.data(), opcode, len, mask);
+        std::memcpy(send_buffer_.data() + header_len, data, len);
+        ws::apply_mask(send_buffer_.data() + header_len, len, mask);
+
+        return socket_.write_all(send_buffer_.data(), header_len + len);
+    }
+
+}
@@ -0,0 +1,271 @@
+#include "network/WebSocketServer.hpp"
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+
+namespace hft::network {
+
+    namespace {
+        // Function: use_self_signed_certificate
+        // Description: Generates an EC P-256 key and a one-day self-signed "localhost"
+        //              certificate in memory and installs both into ctx.
+        bool use_self_signed_certificate(SSL_CTX* ctx) {
+            EVP_PKEY* key = nullptr;
+            EVP_PKEY_CTX* key_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+            if (!key_ctx) return false;
+            bool ok = EVP_PKEY_keygen_init(key_ctx) > 0 &&
+                      EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_ctx, NID_X9_62_prime256v1) > 0 &&
+                      EVP_PKEY_keygen(key_ctx, &key) > 0;
+            EVP_PKEY_CTX_free(key_ctx);
+            if (!ok) return false;
+
+            X509* cert = X509_new();
+            X509_set_version(cert, 2);
+            ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+            X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+            X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+            X509_set_pubkey(cert, key);
+
+            X509_NAME* name = X509_get_subject_name(cert);
+            X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                       reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+            X509_set_issuer_name(cert, name);
+
+            ok = X509_sign(cert, key, EVP_sha256()) > 0 &&
+                 SSL_CTX_use_certificate(ctx, cert) == 1 &&
+                 SSL_CTX_use_PrivateKey(ctx, key) == 1;
+
+            X509_free(cert);
+            EVP_PKEY_free(key);
+            return ok;
+        }
+    }
+
+    // --- Connection ---
+
+    bool WebSocketServer::Connection::handshake() {
+        char buf[4096];
+        std::string request;
+        size_t head_end = std::string::npos;
+        while (head_end == std::string::npos) {
+            if (request.size() > 16 * 1024) return false;
+            if (!socket_.wait_readable(5000)) return false;
+            ssize_t n = socket_.read(buf, sizeof(buf));
+            if (n <= 0) return false;
+            request.append(buf, static_cast<size_t>(n));
+            head_end = request.find("\r\n\r\n");
+        }
+
+        std::string_view head(request.data(), head_end + 4);
+        if (head.rfind("GET ", 0) != 0) return false;
+        size_t path_end = head.find(' ', 4);
+        if (path_end == std::string_view::npos) return false;
+        path_ = std::string(head.substr(4, path_end - 4));
+
+        std::string_view key = ws::find_header(head, "Sec-WebSocket-Key");
+        if (key.empty()) return false;
+
+        std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+                               "Upgrade: websocket\r\n"
+                               "Connection: Upgrade\r\n"
+                               "Sec-WebSocket-Accept: " + ws::compute_accept_key(key) + "\r\n\r\n";
+        if (!socket_.write_all(response.data(), response.size())) return false;
+
+        // Anything the client pipelined after the request is already frame data
+        rx_.assign(request, head_end + 4, std::string::npos);
+        return true;
+    }
+
+    bool WebSocketServer::Connection::send_frame(ws::Opcode opcode, std::string_view payload, bool fin) {
+        if (!socket_.is_open()) return false;
+        tx_.resize(ws::MAX_HEADER_SIZE + payload.size());
+        size_t header_len = ws::write_frame_header(tx_.data(), opcode, payload.size(), nullptr, fin);
+        std::memcpy(tx_.data() + header_len, payload.data(), payload.size());
+        if (!socket_.write_all(tx_.data(), header_len + payload.size())) {
+            socket_.close();
+            return false;
+        }
+        return true;
+    }
+
+    int WebSocketServer::Connection::read_message(std::string& out, int timeout_ms) {
+        char buf[16384];
+        while (socket_.is_open()) {
+            ws::FrameHeader header;
+            if (ws::parse_frame_header(rx_.data(), rx_.size(), header) &&
+                rx_.size() >= header.header_len + header.payload_len) {
+                char* data = rx_.data() + header.header_len;
+                size_t len = header.payload_len;
+                if (header.masked) ws::apply_mask(data, len, header.mask);
+
+                std::string_view payload(data, len);
+                bool fin = header.fin;
+                ws::Opcode opcode = header.opcode;
+
+                switch (opcode) {
+                    case ws::Opcode::PING:
+                        send_frame(ws::Opcode::PONG, payload);
+                        break;
+                    case ws::Opcode::PONG:
+                        break;
+                    case ws::Opcode::CLOSE:
+                        if (!closing_) send_frame(ws::Opcode::CLOSE, payload.substr(0, std::min<size_t>(len, 125)));
+                        socket_.close();
+                        return -1;
+                    default:
+                        if (opcode != ws::Opcode::CONTINUATION) fragments_.clear();
+                        fragments_.append(payload);
+                        break;
+                }
+                rx_.erase(0, header.header_len + len);
+
+                bool is_data = opcode == ws::Opcode::TEXT || opcode == ws::Opcode::BINARY || opcode == ws::Opcode::CONTINUATION;
+                if (is_data && fin) {
+                    out.swap(fragments_);
+                    fragments_.clear();
+                    return 1;
+                }
+                continue;
+            }
+
+            if (!socket_.wait_readable(timeout_ms)) return 0;
+            ssize_t n = socket_.read(buf, sizeof(buf));
+            if (n < 0) {
+                socket_.close();
+                return -1;
+            }
+            rx_.append(buf, static_cast<size_t>(n));
+        }
+        return -1;
+    }
+
+    void WebSocketServer::Connection::close(uint16_t code) {
+        if (!socket_.is_open()) return;
+        if (code != 0) {
+            char payload[2] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xFF)};
+            closing_ = true;
+            send_frame(ws::Opcode::CLOSE, std::string_view(payload, 2));
+
+            // Closing handshake: wait for the peer's close so unread bytes on our side
+            // don't turn the close into a RST that discards data still in flight to it
+            std::string ignored;
+            for (int i = 0; i < 10 && socket_.is_open(); ++i) {
+                if (read_message(ignored, 100) < 0) break;
+            }
+        }
+        socket_.close();
+    }
+
+    // --- Server ---
+
+    WebSocketServer::~WebSocketServer() {
+        stop();
+        if (ssl_ctx_) SSL_CTX_free(ssl_ctx_);
+    }
+
+    bool WebSocketServer::listen(uint16_t port, bool tls, const std::string& cert_file, const std::string& key_file,
+                                 const std::string& bind_address) {
+        if (tls) {
+            ssl_ctx_ = SSL_CTX_new(TLS_server_method());
+            bool ok;
+            if (cert_file.empty()) {
+                ok = use_self_signed_certificate(ssl_ctx_);
+            } else {
+                ok = SSL_CTX_use_certificate_chain_file(ssl_ctx_, cert_file.c_str()) == 1 &&
+                     SSL_CTX_use_PrivateKey_file(ssl_ctx_, key_file.c_str(), SSL_FILETYPE_PEM) == 1;
+            }
+            if (!ok) {
+                std::cerr << "[WebSocketServer] Failed to load TLS certificate" << std::endl;
+                return false;
+            }
+        }
+
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) return false;
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, bind_address.c_str(), &addr.sin_addr);
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listen_fd_, 16) != 0) {
+            std::cerr << "[WebSocketServer] Cannot listen on " << bind_address << ":" << port << std::endl;
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+            return false;
+        }
+
+        socklen_t addr_len = sizeof(addr);
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+        port_ = ntohs(addr.sin_port);
+        return true;
+    }
+
+    void WebSocketServer::start(Handler handler) {
+        handler_ = std::move(handler);
+        running_ = true;
+        accept_thread_ = std::thread(&WebSocketServer::accept_loop, this);
+    }
+
+    void WebSocketServer::stop() {
+        if (!running_.exchange(false)) return;
+        if (accept_thread_.joinable()) accept_thread_.join();
+
+        {
+            // Wake handlers blocked in reads or writes
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (Connection* connection : connections_) connection->socket_.shutdown();
+        }
+        for (auto& thread : connection_threads_) {
+            if (thread.joinable()) thread.join();
+        }
+        connection_threads_.clear();
+
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+        }
+    }
+
+    void WebSocketServer::accept_loop() {
+        while (running_) {
+            pollfd pfd{listen_fd_, POLLIN, 0};
+            if (::poll(&pfd, 1, 100) <= 0) continue;
+
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) continue;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            connection_threads_.emplace_back(&WebSocketServer::serve, this, fd);
+        }
+    }
+
+    void WebSocketServer::serve(int fd) {
+        Connection connection;
+        if (!connection.socket_.accept(fd, ssl_ctx_) || !connection.handshake()) {
+            connection.socket_.close();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connections_.push_back(&connection);
+        }
+
+        handler_(connection);
+        connection.close();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_.erase(std::find(connections_.begin(), connections_.end(), &connection));
+    }
+
+}
@@ -0,0 +1,252 @@
+#include "feed_handler/CoinbaseUDP.hpp"
+#include "network/DPDKPoller.hpp"
+#include "network/UdpFlowFilter.hpp"
+#include "storage/PcapReader.hpp"
+#include "common/RingBuffer.hpp"
+#include "common/Types.hpp"
+#include "common/Utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Pcap Replay
+// Drives recorded UDP market data (pcap or pcapng) through the live receive path: frames
+// are classified by UdpFlowFilter (the parse DPDKPoller runs on the wire) and handed to
+// CoinbaseUDPHandler, line by line, with the snapshot line feeding recovery. A consumer
+// checks the published ticks for RptSeq continuity, so a capture doubles as a decode
+// regression test (exit code 1 on any break), and reports ingest throughput.
+// The handler's clock follows the capture timestamps in both modes, so reorder timeouts
+// and arbitration decide the same way at any replay speed.
+// Usage: pcap_replay [--max-speed] [--dpdk] [--lines group:port,...] [--snapshot group:port]
+//                    [--reorder-us N] capture
+//   --lines      Incremental lines (A, B, ...) in line order; default 239.1.1.1:1234,239.1.1.1:1235
+//   --snapshot   Snapshot line (template 201); default 239.1.1.1:1236, "none" for none
+//   --max-speed  Ignore capture timing and push as fast as possible (ingest benchmark)
+//   --dpdk       Read the capture through a net_pcap vdev and DPDKPoller::poll (DPDK builds;
+//                the vdev does not keep capture timing, so this implies --max-speed)
+//   Make a capture with tools/udp_gen.py --pcap (see scripts/run_pcap_replay.sh).
+
+namespace {
+
+    using Ring = hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE>;
+
+    bool parse_endpoint(const std::string& text, std::string& address, uint16_t& port) {
+        size_t colon = text.rfind(':');
+        if (colon == std::string::npos) return false;
+        address = text.substr(0, colon);
+        port = static_cast<uint16_t>(std::atoi(text.c_str() + colon + 1));
+        return port != 0;
+    }
+
+    std::vector<std::string> split(const std::string& text, char separator) {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        for (size_t end; (end = text.find(separator, start)) != std::string::npos; start = end + 1) {
+            parts.push_back(text.substr(start, end - start));
+        }
+        parts.push_back(text.substr(start));
+        return parts;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    bool max_speed = false;
+    bool use_dpdk = false;
+    std::string lines_arg = "239.1.1.1:1234,239.1.1.1:1235";
+    std::string snapshot_arg = "239.1.1.1:1236";
+    uint64_t reorder_us = 0;
+    std::string path;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--max-speed") == 0) {
+            max_speed = true;
+        } else if (std::strcmp(argv[i], "--dpdk") == 0) {
+            use_dpdk = true;
+        } else if (std::strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+            lines_arg = argv[++i];
+        } else if (std::strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            snapshot_arg = argv[++i];
+        } else if (std::strcmp(argv[i], "--reorder-us") == 0 && i + 1 < argc) {
+            reorder_us = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: pcap_replay [--max-speed] [--dpdk] [--lines group:port,...] [--snapshot group:port] "
+                     "[--reorder-us N] capture" << std::endl;
+        return 1;
+    }
+
+    // Flows: one per line, then the snapshot line
+    std::vector<std::pair<std::string, uint16_t>> flows;
+    for (const auto& line : split(lines_arg, ',')) {
+        std::string address;
+        uint16_t port;
+        if (!parse_endpoint(line, address, port)) {
+            std::cerr << "Bad line " << line << std::endl;
+            return 1;
+        }
+        flows.push_back({address, port});
+    }
+    const size_t lines = flows.size();
+    if (lines == 0 || lines > hft::LineArbiter::MAX_LINES) {
+        std::cerr << "Need 1 to " << hft::LineArbiter::MAX_LINES << " lines" << std::endl;
+        return 1;
+    }
+    if (snapshot_arg != "none") {
+        std::string address;
+        uint16_t port;
+        if (!parse_endpoint(snapshot_arg, address, port)) {
+            std::cerr << "Bad snapshot line " << snapshot_arg << std::endl;
+            return 1;
+        }
+        flows.push_back({address, port});
+    }
+
+    hft::utils::calibrate_tsc();
+    auto buffer = std::make_unique<Ring>();
+    hft::CoinbaseUDPHandler handler(*buffer, lines);
+    if (reorder_us != 0) handler.set_reorder_timeout_ns(reorder_us * 1000);
+
+    // The same dispatch for both frame sources
+    uint64_t datagrams = 0;
+    auto dispatch = [&](const uint8_t* payload, uint16_t len, size_t flow, uint64_t rx_tsc, uint64_t stamp_tsc) {
+        ++datagrams;
+        if (flow < lines) {
+            handler.on_packet(payload, len, flow, rx_tsc, stamp_tsc);
+        } else {
+            handler.on_snapshot_packet(payload, len, rx_tsc, stamp_tsc);
+        }
+    };
+
+    // Drain the ring and check RptSeq continuity of what the handler publishes
+    std::atomic<bool> consuming{true};
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> breaks{0};
+    std::thread consumer([&] {
+        hft::BinaryTick tick;
+        uint64_t last = 0;
+        for (;;) {
+            if (!buffer->pop(tick)) {
+                if (!consuming.load(std::memory_order_acquire) && buffer->isEmpty()) break;
+                hft::utils::cpu_relax();
+                continue;
+            }
+            ticks.fetch_add(1, std::memory_order_relaxed);
+            if (tick.is_snapshot) {
+                last = tick.id;
+                continue;
+            }
+            // Trades older than a recovery snapshot are replayed ahead of it, past the
+            // hole, so trades only have to move forward; depth must continue exactly
+            if (tick.is_trade ? tick.id <= last : tick.id != last + 1) {
+                if (breaks.fetch_add(1, std::memory_order_relaxed) < 5) {
+                    std::cerr << "  RptSeq break: " << last << " -> " << tick.id << std::endl;
+                }
+            }
+            if (tick.id > last) last = tick.id;
+        }
+    });
+
+    hft::utils::pin_thread_to_core(hft::constants::FEED_HANDLER_CORE);
+    uint64_t frames = 0;
+    uint64_t start_tsc = hft::utils::rdtsc();
+    uint64_t end_tsc = 0;
+
+    if (use_dpdk) {
+#ifdef USE_DPDK
+        std::vector<std::string> eal_args = {"pcap_replay", "--no-pci", "--no-huge", "-m", "256",
+                                             "--vdev=net_pcap0,rx_pcap=" + path};
+        std::vector<char*> eal_argv;
+        for (auto& arg : eal_args) eal_argv.push_back(arg.data());
+        hft::network::DPDKPoller poller(0);
+        poller.init(static_cast<int>(eal_argv.size()), eal_argv.data());
+        for (const auto& [address, port] : flows) poller.add_flow(address, port);
+        poller.start();
+        start_tsc = hft::utils::rdtsc();
+
+        // net_pcap reports no end of file: stop once the queue stays empty
+        uint64_t idle_since = hft::utils::rdtsc();
+        const uint64_t idle_limit = static_cast<uint64_t>(100e6 * hft::utils::CYCLES_PER_NS);
+        for (;;) {
+            uint16_t rx = poller.poll(dispatch);
+            uint64_t now = hft::utils::rdtsc();
+            handler.poll(now);
+            if (rx > 0) {
+                frames += rx;
+                idle_since = now;
+            } else if (now - idle_since > idle_limit) {
+                end_tsc = idle_since; // The idle tail is not replay time
+                break;
+            }
+        }
+        std::cout << "[DPDK] Replayed through net_pcap (capture timing not kept)." << std::endl;
+#else
+        std::cerr << "Built without DPDK; --dpdk is not available." << std::endl;
+        consuming = false;
+        consumer.join();
+        return 1;
+#endif
+    } else {
+        hft::storage::PcapReader reader;
+        if (!reader.open(path)) {
+            std::cerr << "Failed to open " << path << std::endl;
+            consuming = false;
+            consumer.join();
+            return 1;
+        }
+        hft::network::UdpFlowFilter filter;
+        for (const auto& [address, port] : flows) filter.add(address, port);
+
+        std::cout << "Replaying " << path << (reader.format() == hft::storage::PcapReader::Format::PCAPNG ? " (pcapng)" : " (pcap)")
+                  << (max_speed ? " at max speed" : " with capture timing") << "..." << std::endl;
+        hft::storage::PcapFrame frame;
+        uint64_t first_ns = 0;
+        start_tsc = hft::utils::rdtsc();
+        while (reader.next(frame)) {
+            if (frames++ == 0) first_ns = frame.timestamp_ns;
+            // Capture clock on the TSC timebase (frames without a timestamp keep the last one)
+            uint64_t offset_ns = frame.timestamp_ns >= first_ns ? frame.timestamp_ns - first_ns : 0;
+            uint64_t capture_tsc = start_tsc + static_cast<uint64_t>(offset_ns * hft::utils::CYCLES_PER_NS);
+            if (!max_speed) {
+                while (hft::utils::rdtsc() < capture_tsc) hft::utils::cpu_relax();
+            }
+
+            const uint8_t* payload;
+            uint16_t len;
+            int flow = filter.classify(frame.data, frame.caplen, payload, len,
+                                       static_cast<hft::network::LinkType>(frame.link_type));
+            if (flow >= 0) dispatch(payload, len, static_cast<size_t>(flow), capture_tsc, 0);
+            handler.poll(capture_tsc);
+        }
+        end_tsc = hft::utils::rdtsc();
+    }
+
+    uint64_t replay_cycles = end_tsc - start_tsc;
+    consuming.store(false, std::memory_order_release);
+    consumer.join();
+
+    double seconds = replay_cycles / hft::utils::CYCLES_PER_NS / 1e9;
+    const auto& stats = handler.stats();
+    std::cout << "Replay complete." << std::endl;
+    std::cout << "  Frames:     " << frames << " (" << datagrams << " feed datagrams)" << std::endl;
+    std::cout << "  Time:       " << seconds * 1e3 << " ms, " << (seconds > 0 ? frames / seconds : 0) << " frames/s, "
+              << (seconds > 0 ? ticks.load() / seconds : 0) << " ticks/s" << std::endl;
+    std::cout << "  Decoded:    " << stats.packets << " packets, " << stats.entries << " entries, " << ticks.load()
+              << " ticks published" << std::endl;
+    std::cout << "  Rejected:   " << stats.malformed << " malformed, " << stats.unknown << " unknown, "
+              << stats.bad_decimal << " bad decimals" << std::endl;
+    std::cout << "  Sequencing: " << stats.reordered << " reordered, " << stats.stale << " stale" << std::endl;
+    handler.print_line_stats();
+    const auto& recovery = handler.recovery_stats();
+    std::cout << "  Gaps:       " << recovery.gaps << " (" << recovery.messages_lost << " packets lost on every line), "
+              << recovery.recoveries << " recovered from snapshots" << std::endl;
+    std::cout << "  RptSeq breaks: " << breaks.load() << std::endl;
+    return breaks.load() == 0 && stats.packets > 0 ? 0 : 1;
+}
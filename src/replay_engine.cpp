@@ -4,46 +4,91 @@
 #include "common/RingBuffer.hpp"
 #include "common/Types.hpp"
 #include "common/Utils.hpp"
+#include "common/Trace.hpp"
+#include "storage/CaptureReader.hpp"
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <memory>
 #include <thread>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <sys/resource.h>
 
 // Replay Engine
-// Reads market_data.bin and feeds the engine with precise timing.
-
-struct RecordedMessage {
-    uint64_t timestamp;
-    std::string data;
-};
-
-int main() {
-    std::cout << "Loading market_data.bin..." << std::endl;
-    std::ifstream file("market_data.bin", std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open market_data.bin" << std::endl;
-        return 1;
+// Streams one or more captures (mmapped, block-indexed or bare) into the engine with
+// the recorded timing. Nothing is loaded up front: records are parsed straight out of
+// the mapping, so startup is immediate and memory stays flat for any capture size.
+// Captures may come from different boots or hosts, so each one is paced on its own
+// TSC timebase: files play back to back, each timed from its own first record.
+// Usage: replay_engine [--conflate drain|message] [--max-speed] [--from S] [--to S] [capture...]
+//   capture      Capture files replayed in order, or @list (one path per line); default market_data.bin
+//   --conflate   Run the strategy in burst conflation mode
+//   --max-speed  Ignore recorded timing and push as fast as possible (load test)
+//   --from/--to  Replay window in seconds from the first record of each capture
+//                (seeks through the block index, or the <capture>.idx side index)
+
+namespace {
+
+    std::vector<std::string> expand_file_list(const std::vector<std::string>& args) {
+        std::vector<std::string> files;
+        for (const auto& arg : args) {
+            if (arg.size() > 1 && arg[0] == '@') {
+                std::ifstream list(arg.substr(1));
+                std::string line;
+                while (std::getline(list, line)) {
+                    if (!line.empty() && line[0] != '#') files.push_back(line);
+                }
+            } else {
+                files.push_back(arg);
+            }
+        }
+        return files;
     }
 
-    std::vector<RecordedMessage> messages;
-    messages.reserve(100000);
+    // TSC cycles per ns the capture was recorded with (block format), else this host's
+    double capture_cycles_per_ns(const hft::storage::CaptureReader& reader) {
+        return reader.block_format() && reader.header().cycles_per_ns > 0 ? reader.header().cycles_per_ns
+                                                                          : hft::utils::CYCLES_PER_NS;
+    }
 
-    while (file.peek() != EOF) {
-        uint64_t ts;
-        uint32_t len;
-        file.read(reinterpret_cast<char*>(&ts), sizeof(ts));
-        file.read(reinterpret_cast<char*>(&len), sizeof(len));
-        
-        if (file.gcount() != sizeof(len)) break;
+    double peak_rss_mb() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0;
+    }
 
-        std::string data(len, '\0');
-        file.read(&data[0], len);
-        messages.push_back({ts, std::move(data)});
+}
+
+int main(int argc, char** argv) {
+    hft::ConflationMode conflation = hft::ConflationMode::NONE;
+    bool max_speed = false;
+    double from_s = -1;
+    double to_s = -1;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--conflate") == 0 && i + 1 < argc) {
+            ++i;
+            if (std::strcmp(argv[i], "drain") == 0) conflation = hft::ConflationMode::DRAIN;
+            else if (std::strcmp(argv[i], "message") == 0) conflation = hft::ConflationMode::MESSAGE;
+        } else if (std::strcmp(argv[i], "--max-speed") == 0) {
+            max_speed = true;
+        } else if (std::strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            from_s = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            to_s = std::atof(argv[++i]);
+        } else {
+            args.push_back(argv[i]);
+        }
     }
-    std::cout << "Loaded " << messages.size() << " messages." << std::endl;
+    if (args.empty()) args.push_back("market_data.bin");
+    std::vector<std::string> files = expand_file_list(args);
+
+    hft::utils::calibrate_tsc();
+    TRACE_START("replay_trace.json");
 
-    if (messages.empty()) return 0;
+    uint64_t open_start = hft::utils::rdtsc();
+    hft::storage::CaptureReader reader;
 
     // Setup Engine
     auto feed_to_strategy_queue = std::make_unique<hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE>>();
@@ -52,7 +97,7 @@ int main() {
     // Note: We don't call start() on feed_handler because we don't want the WebSocket thread.
     // We only use it for parsing.
     hft::CoinbaseFeedHandler feed_handler(*feed_to_strategy_queue, false); 
-    hft::StrategyEngine strategy_engine(*feed_to_strategy_queue, *strategy_to_exec_queue);
+    hft::StrategyEngine strategy_engine(*feed_to_strategy_queue, *strategy_to_exec_queue, conflation);
     hft::ExecutionGateway execution_gateway(*strategy_to_exec_queue);
 
     execution_gateway.start();
@@ -62,32 +107,102 @@ int main() {
     
     // Pin Replay Thread
     hft::utils::pin_thread_to_core(hft::constants::FEED_HANDLER_CORE);
+    TRACE_THREAD("replay");
 
-    uint64_t start_tsc = hft::utils::rdtsc();
-    uint64_t first_msg_ts = messages[0].timestamp;
-
-    for (const auto& msg : messages) {
-        // Calculate target time
-        uint64_t target_delta = msg.timestamp - first_msg_ts;
-        
-        // Spin wait
-        while (true) {
-            uint64_t current_delta = hft::utils::rdtsc() - start_tsc;
-            if (current_delta >= target_delta) break;
-            _mm_pause();
+    uint64_t start_tsc = 0;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+
+    // Backlog: ticks waiting in the strategy's input ring right after each message
+    size_t max_backlog = 0;
+    uint64_t total_backlog = 0;
+
+    for (size_t f = 0; f < files.size(); ++f) {
+        if (!reader.open(files[f])) {
+            std::cerr << "Skipping " << files[f] << " (cannot open)" << std::endl;
+            continue;
+        }
+
+        // Time window, anchored at this capture's first record and scaled with its TSC rate
+        hft::storage::CaptureRecord first;
+        if (!reader.next(first)) {
+            std::cerr << "Skipping " << files[f] << " (no records)" << std::endl;
+            continue;
         }
+        double cycles_per_ns = capture_cycles_per_ns(reader);
+        uint64_t to_ts = to_s >= 0 ? first.timestamp + static_cast<uint64_t>(to_s * 1e9 * cycles_per_ns) : UINT64_MAX;
+        // Skip straight to the window; a capture that ends before it is passed over
+        if (from_s > 0) {
+            if (!reader.seek(first.timestamp + static_cast<uint64_t>(from_s * 1e9 * cycles_per_ns))) continue;
+        } else {
+            reader.rewind();
+        }
+
+        // Pacing base: this capture's first replayed record, on its own timebase
+        uint64_t file_start_tsc = 0;
+        uint64_t file_first_ts = 0;
+        double scale = hft::utils::CYCLES_PER_NS / cycles_per_ns; // Capture cycles -> our cycles
+
+        hft::storage::CaptureRecord msg;
+        while (reader.next(msg)) {
+            if (msg.timestamp > to_ts) break;
+
+            if (messages == 0) {
+                start_tsc = hft::utils::rdtsc();
+                std::cout << "First message after " << (start_tsc - open_start) / hft::utils::CYCLES_PER_NS / 1e3
+                          << " us" << std::endl;
+            }
+            if (file_start_tsc == 0) {
+                file_start_tsc = hft::utils::rdtsc();
+                file_first_ts = msg.timestamp;
+            }
+
+            if (!max_speed && msg.timestamp > file_first_ts) {
+                // Calculate target time
+                uint64_t target_delta = static_cast<uint64_t>((msg.timestamp - file_first_ts) * scale);
+
+                // Spin wait
+                while (true) {
+                    uint64_t current_delta = hft::utils::rdtsc() - file_start_tsc;
+                    if (current_delta >= target_delta) break;
+                    _mm_pause();
+                }
+            }
+
+            // Push (views into the mapping carry no padding, so the handler parses from its own buffer)
+            feed_handler.process_message(msg.data);
+            ++messages;
+            bytes += msg.data.size();
+
+            size_t backlog = feed_to_strategy_queue->size();
+            max_backlog = std::max(max_backlog, backlog);
+            total_backlog += backlog;
+        }
+    }
+    reader.close();
+    if (messages == 0) start_tsc = hft::utils::rdtsc();
 
-        // Push
-        feed_handler.process_message(msg.data);
+    uint64_t replay_cycles = hft::utils::rdtsc() - start_tsc;
+    while (!feed_to_strategy_queue->isEmpty()) {
+        _mm_pause();
     }
+    uint64_t drain_cycles = hft::utils::rdtsc() - start_tsc;
 
     std::cout << "Replay Complete." << std::endl;
+    std::cout << "  Files:         " << files.size() << std::endl;
+    std::cout << "  Messages:      " << messages << " (" << bytes / 1e6 << " MB)" << std::endl;
+    std::cout << "  Replay time:   " << (replay_cycles / hft::utils::CYCLES_PER_NS) / 1e6 << " ms" << std::endl;
+    std::cout << "  Drained after: " << (drain_cycles / hft::utils::CYCLES_PER_NS) / 1e6 << " ms" << std::endl;
+    std::cout << "  Backlog:       max " << max_backlog << " ticks, mean "
+              << static_cast<double>(total_backlog) / std::max<uint64_t>(messages, 1) << " ticks" << std::endl;
+    std::cout << "  Peak RSS:      " << peak_rss_mb() << " MB" << std::endl;
     
     // Allow strategy to finish processing
     std::this_thread::sleep_for(std::chrono::seconds(1));
     
     strategy_engine.stop();
     execution_gateway.stop();
+    TRACE_STOP();
 
     return 0;
 }
@@ -0,0 +1,295 @@
+#include "storage/CaptureReader.hpp"
+#include <zlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace hft::storage {
+
+    CaptureReader::~CaptureReader() {
+        close();
+    }
+
+    bool CaptureReader::open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            size_ = 0;
+            return false;
+        }
+        base_ = static_cast<const char*>(map);
+        path_ = path;
+
+        block_format_ = size_ >= ALIGNMENT && std::memcmp(base_, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0;
+        if (block_format_) {
+            std::memcpy(&header_, base_, sizeof(header_));
+            if (header_.version != FORMAT_VERSION) {
+                std::cerr << "[CaptureReader] Unsupported format version " << header_.version << std::endl;
+                close();
+                return false;
+            }
+            load_index();
+        } else {
+            // Cheap if present; otherwise built only when a seek needs it
+            load_side_index();
+        }
+        rewind();
+        return true;
+    }
+
+    void CaptureReader::close() {
+        if (base_) munmap(const_cast<char*>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+        path_.clear();
+        block_format_ = false;
+        recovered_ = false;
+        header_ = FileHeader{};
+        blocks_.clear();
+        cursor_ = end_ = nullptr;
+    }
+
+    bool CaptureReader::load_index() {
+        blocks_.clear();
+        recovered_ = false;
+
+        if (size_ >= 2 * ALIGNMENT) {
+            FileFooter footer;
+            std::memcpy(&footer, base_ + size_ - sizeof(footer), sizeof(footer));
+            size_t index_bytes = footer.block_count * sizeof(BlockIndexEntry);
+            if (std::memcmp(footer.magic, FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) == 0 &&
+                footer.index_offset + index_bytes + sizeof(footer) <= size_) {
+                blocks_.resize(footer.block_count);
+                std::memcpy(blocks_.data(), base_ + footer.index_offset, index_bytes);
+                return true;
+            }
+        }
+
+        // No footer: the writer never reached stop(). Walk the block headers instead.
+        recovered_ = true;
+        size_t offset = ALIGNMENT;
+        while (offset + sizeof(BlockHeader) <= size_) {
+            BlockHeader block;
+            std::memcpy(&block, base_ + offset, sizeof(block));
+            if (block.magic != BLOCK_MAGIC || offset + block_span(block.stored_bytes) > size_) break;
+            blocks_.push_back({offset, block.first_timestamp, block.last_timestamp, block.record_count, block.stored_bytes});
+            offset += block_span(block.stored_bytes);
+        }
+        madvise(const_cast<char*>(base_), size_, MADV_DONTNEED);
+        return false;
+    }
+
+    bool CaptureReader::load_side_index() {
+        FILE* f = fopen((path_ + ".idx").c_str(), "rb");
+        if (!f) return false;
+        SideIndexHeader side;
+        bool ok = fread(&side, sizeof(side), 1, f) == 1 &&
+                  std::memcmp(side.magic, SIDE_INDEX_MAGIC, sizeof(SIDE_INDEX_MAGIC)) == 0 &&
+                  side.source_size == size_;
+        if (ok) {
+            blocks_.resize(side.entry_count);
+            ok = fread(blocks_.data(), sizeof(BlockIndexEntry), blocks_.size(), f) == blocks_.size();
+            if (!ok) blocks_.clear();
+        }
+        fclose(f);
+        return ok;
+    }
+
+    bool CaptureReader::build_side_index() {
+        blocks_.clear();
+        uint64_t records = 0;
+        size_t offset = 0;
+        BlockIndexEntry span{};
+        while (offset + sizeof(RecordHeader) <= size_) {
+            RecordHeader header;
+            std::memcpy(&header, base_ + offset, sizeof(header));
+            size_t bytes = sizeof(RecordHeader) + header.length;
+            if (bytes > size_ - offset) break; // Truncated tail
+
+            if (span.record_count == 0) {
+                span.offset = offset;
+                span.first_timestamp = header.timestamp;
+            }
+            span.last_timestamp = header.timestamp;
+            span.stored_bytes += static_cast<uint32_t>(bytes);
+            ++span.record_count;
+            ++records;
+            offset += bytes;
+
+            if (span.stored_bytes >= SIDE_INDEX_SPAN) {
+                blocks_.push_back(span);
+                span = BlockIndexEntry{};
+            }
+        }
+        if (span.record_count > 0) blocks_.push_back(span);
+
+        // The scan touched every page; give them back before replay starts
+        madvise(const_cast<char*>(base_), size_, MADV_DONTNEED);
+        reset_window(static_cast<size_t>(cursor_ && !block_format_ ? cursor_ - base_ : 0));
+
+        SideIndexHeader side{};
+        std::memcpy(side.magic, SIDE_INDEX_MAGIC, sizeof(side.magic));
+        side.source_size = size_;
+        side.entry_count = blocks_.size();
+        side.record_count = records;
+
+        // Best effort: a read-only capture directory just means rebuilding next time
+        FILE* f = fopen((path_ + ".idx").c_str(), "wb");
+        if (!f) return true;
+        bool written = fwrite(&side, sizeof(side), 1, f) == 1 &&
+                       fwrite(blocks_.data(), sizeof(BlockIndexEntry), blocks_.size(), f) == blocks_.size();
+        fclose(f);
+        if (!written) std::remove((path_ + ".idx").c_str());
+        return true;
+    }
+
+    bool CaptureReader::ensure_index() {
+        if (!base_) return false;
+        if (block_format_ || !blocks_.empty()) return true;
+        return build_side_index();
+    }
+
+    void CaptureReader::reset_window(size_t position) {
+        advised_ = populated_ = released_ = align_down(position);
+        advise_mark_ = position;
+    }
+
+    void CaptureReader::advance_window(size_t position) {
+        if (window_ == 0) {
+            advise_mark_ = SIZE_MAX;
+            return;
+        }
+        char* base = const_cast<char*>(base_);
+        size_t from = align_down(position);
+
+        // Far ahead: start readahead from disk
+        size_t ahead = std::min(size_, align_up(position) + window_);
+        if (ahead > advised_ + window_ / 2 || (ahead == size_ && advised_ < size_)) {
+            size_t start = std::max(advised_, from);
+            madvise(base + start, ahead - start, MADV_WILLNEED);
+            advised_ = ahead;
+        }
+
+        // Near ahead: map the pages now, in one call, instead of one minor fault per 4 KB
+        size_t near = std::min(size_, align_up(position) + 2 * PREFAULT_SPAN);
+        if (near > populated_) {
+            size_t start = std::max(populated_, from);
+#ifdef MADV_POPULATE_READ
+            madvise(base + start, near - start, MADV_POPULATE_READ);
+#endif
+            populated_ = near;
+        }
+
+        // Keep one window behind the cursor for views the caller may still hold
+        if (position > released_ + 2 * window_) {
+            size_t upto = align_down(position - window_);
+            madvise(base + released_, upto - released_, MADV_DONTNEED);
+            released_ = upto;
+        }
+        advise_mark_ = position + PREFAULT_SPAN;
+    }
+
+    bool CaptureReader::enter_block(size_t index) {
+        const BlockIndexEntry& entry = blocks_[index];
+        if (entry.offset + sizeof(BlockHeader) > size_) return false;
+        if (entry.offset >= advise_mark_) advance_window(entry.offset);
+
+        BlockHeader block;
+        std::memcpy(&block, base_ + entry.offset, sizeof(block));
+        const char* stored = base_ + entry.offset + sizeof(BlockHeader);
+        if (block.magic != BLOCK_MAGIC || entry.offset + block_span(block.stored_bytes) > size_) {
+            std::cerr << "[CaptureReader] Bad block header at offset " << entry.offset << std::endl;
+            return false;
+        }
+        if (verify_ && crc32(0, reinterpret_cast<const Bytef*>(stored), block.stored_bytes) != block.checksum) {
+            std::cerr << "[CaptureReader] Checksum mismatch in block at offset " << entry.offset << std::endl;
+            return false;
+        }
+
+        if (block.compression == static_cast<uint8_t>(Compression::ZLIB)) {
+            inflated_.resize(block.raw_bytes);
+            uLongf raw_len = block.raw_bytes;
+            if (uncompress(reinterpret_cast<Bytef*>(inflated_.data()), &raw_len,
+                           reinterpret_cast<const Bytef*>(stored), block.stored_bytes) != Z_OK ||
+                raw_len != block.raw_bytes) {
+                std::cerr << "[CaptureReader] Corrupt zlib block at offset " << entry.offset << std::endl;
+                return false;
+            }
+            cursor_ = inflated_.data();
+            end_ = cursor_ + raw_len;
+        } else {
+            cursor_ = stored;
+            end_ = stored + block.raw_bytes;
+        }
+        return true;
+    }
+
+    void CaptureReader::rewind() {
+        next_block_ = 0;
+        if (block_format_) {
+            cursor_ = end_ = nullptr;
+            reset_window(blocks_.empty() ? 0 : blocks_[0].offset);
+        } else {
+            cursor_ = base_;
+            end_ = base_ + size_;
+            reset_window(0);
+        }
+    }
+
+    bool CaptureReader::next_slow(CaptureRecord& out) {
+        while (true) {
+            if (static_cast<size_t>(end_ - cursor_) >= sizeof(RecordHeader)) {
+                RecordHeader header;
+                std::memcpy(&header, cursor_, sizeof(header));
+                if (header.length <= static_cast<size_t>(end_ - cursor_) - sizeof(header)) return next(out);
+                cursor_ = end_; // Truncated tail
+            }
+            // Damaged blocks are skipped; the rest of the capture stays readable
+            if (!block_format_ || next_block_ >= blocks_.size()) return false;
+            if (!enter_block(next_block_++)) cursor_ = end_ = nullptr;
+        }
+    }
+
+    bool CaptureReader::seek(uint64_t ts) {
+        rewind();
+        if (ensure_index()) {
+            auto it = std::lower_bound(blocks_.begin(), blocks_.end(), ts,
+                                       [](const BlockIndexEntry& entry, uint64_t t) { return entry.last_timestamp < t; });
+            if (it == blocks_.end()) {
+                cursor_ = end_;
+                next_block_ = blocks_.size();
+                return false;
+            }
+            if (block_format_) {
+                next_block_ = static_cast<size_t>(it - blocks_.begin());
+                reset_window(it->offset);
+            } else {
+                cursor_ = base_ + it->offset;
+                reset_window(it->offset);
+            }
+        }
+
+        CaptureRecord record;
+        do {
+            if (!next(record)) return false;
+        } while (record.timestamp < ts);
+
+        // Step back onto that record; it lies in the block the cursor is now in
+        cursor_ = record.data.data() - sizeof(RecordHeader);
+        return true;
+    }
+
+}
@@ -0,0 +1,230 @@
+#include "storage/CaptureWriter.hpp"
+#include "common/Utils.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace hft::storage {
+
+    CaptureWriter::CaptureWriter(std::string path, const Options& options)
+        : path_(std::move(path)), options_(options), ring_(options.ring_bytes) {}
+
+    CaptureWriter::~CaptureWriter() {
+        stop();
+        for (int i = 0; i < 2; ++i) {
+            std::free(blocks_[i].data);
+            std::free(compressed_[i].data);
+        }
+    }
+
+    bool CaptureWriter::reserve(Block& block, size_t bytes) {
+        if (bytes <= block.capacity) return true;
+        size_t capacity = align_up(std::max(bytes, block.capacity * 2));
+        char* data = static_cast<char*>(std::aligned_alloc(ALIGNMENT, capacity));
+        if (!data) return false;
+        if (block.data) {
+            std::memcpy(data, block.data, sizeof(BlockHeader) + block.used);
+            std::free(block.data);
+        }
+        block.data = data;
+        block.capacity = capacity;
+        return true;
+    }
+
+    bool CaptureWriter::start() {
+        size_t initial = sizeof(BlockHeader) + options_.block_bytes;
+        for (int i = 0; i < 2; ++i) {
+            if (!reserve(blocks_[i], initial)) return false;
+            if (options_.compression != Compression::NONE &&
+                !reserve(compressed_[i], sizeof(BlockHeader) + compressBound(options_.block_bytes))) return false;
+        }
+
+        if (!file_.open(path_)) return false;
+
+        // File header occupies the first aligned page; blocks start after it
+        char* page = blocks_[0].data;
+        std::memset(page, 0, ALIGNMENT);
+        FileHeader header{};
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+        header.version = FORMAT_VERSION;
+        header.block_size = static_cast<uint32_t>(options_.block_bytes);
+        header.compression = static_cast<uint8_t>(options_.compression);
+        header.cycles_per_ns = utils::CYCLES_PER_NS;
+        header.tsc_anchor = utils::TSC_ANCHOR;
+        header.unix_ns_anchor = utils::UNIX_NS_ANCHOR;
+        std::memcpy(page, &header, sizeof(header));
+        if (!file_.write(page, ALIGNMENT, 0) || !file_.wait()) return false;
+        file_offset_ = ALIGNMENT;
+        file_bytes_.store(ALIGNMENT, std::memory_order_relaxed);
+
+        std::cout << "[Capture] Writing " << path_ << " ("
+                  << (file_.direct() ? "O_DIRECT" : "buffered") << ", "
+                  << (file_.async() ? "io_uring" : "pwrite") << ", "
+                  << (options_.compression == Compression::ZLIB ? "zlib" : "uncompressed") << ")" << std::endl;
+
+        running_ = true;
+        thread_ = std::thread(&CaptureWriter::run, this);
+        return true;
+    }
+
+    void CaptureWriter::stop() {
+        if (!running_.exchange(false)) return;
+        if (thread_.joinable()) thread_.join();
+
+        std::cout << "[Capture] " << records_written() << " records, " << raw_bytes() / 1e6 << " MB raw, "
+                  << file_bytes() / 1e6 << " MB on disk, " << dropped() << " dropped" << std::endl;
+    }
+
+    void CaptureWriter::run() {
+        utils::pin_thread_to_core(constants::LOGGER_CORE);
+
+        while (running_.load(std::memory_order_relaxed) || !ring_.isEmpty()) {
+            if (drain()) continue;
+
+            const Block& block = blocks_[current_];
+            if (block.record_count > 0 &&
+                std::chrono::steady_clock::now() - block_started_ > std::chrono::milliseconds(options_.flush_interval_ms)) {
+                seal();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        seal();
+        write_index();
+        file_.close();
+    }
+
+    bool CaptureWriter::drain() {
+        bool progressed = false;
+        while (ring_.readable() >= sizeof(RecordHeader)) {
+            RecordHeader header;
+            ring_.peek(&header, sizeof(header));
+            // The producer publishes whole records, so the payload is already readable
+            size_t bytes = sizeof(RecordHeader) + header.length;
+
+            if (blocks_[current_].record_count > 0 && blocks_[current_].used + bytes > options_.block_bytes) {
+                seal();
+            }
+
+            Block& block = blocks_[current_];
+            if (!reserve(block, sizeof(BlockHeader) + block.used + bytes)) {
+                std::cerr << "[Capture] Out of memory for a " << bytes << " byte record, skipping" << std::endl;
+                ring_.consume(bytes);
+                continue;
+            }
+
+            ring_.read(block.data + sizeof(BlockHeader) + block.used, bytes);
+            if (block.record_count == 0) {
+                block.first_timestamp = header.timestamp;
+                block_started_ = std::chrono::steady_clock::now();
+            }
+            block.last_timestamp = header.timestamp;
+            block.used += bytes;
+            ++block.record_count;
+            progressed = true;
+        }
+        return progressed;
+    }
+
+    void CaptureWriter::seal() {
+        Block& block = blocks_[current_];
+        if (block.record_count == 0) return;
+
+        BlockHeader header{};
+        header.magic = BLOCK_MAGIC;
+        header.record_count = block.record_count;
+        header.raw_bytes = static_cast<uint32_t>(block.used);
+        header.first_timestamp = block.first_timestamp;
+        header.last_timestamp = block.last_timestamp;
+        header.compression = static_cast<uint8_t>(Compression::NONE);
+
+        char* out = block.data;
+        size_t stored = block.used;
+        if (options_.compression == Compression::ZLIB) {
+            Block& packed = compressed_[current_];
+            uLongf packed_len = compressBound(block.used);
+            if (reserve(packed, sizeof(BlockHeader) + packed_len) &&
+                compress2(reinterpret_cast<Bytef*>(packed.data + sizeof(BlockHeader)), &packed_len,
+                          reinterpret_cast<const Bytef*>(block.data + sizeof(BlockHeader)), block.used,
+                          options_.zlib_level) == Z_OK &&
+                packed_len < block.used) {
+                // Incompressible blocks are stored raw
+                out = packed.data;
+                stored = packed_len;
+                header.compression = static_cast<uint8_t>(Compression::ZLIB);
+            }
+        }
+
+        header.stored_bytes = static_cast<uint32_t>(stored);
+        header.checksum = static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(out + sizeof(BlockHeader)),
+                                                      static_cast<uInt>(stored)));
+        std::memcpy(out, &header, sizeof(header));
+
+        size_t span = block_span(header.stored_bytes);
+        std::memset(out + sizeof(BlockHeader) + stored, 0, span - sizeof(BlockHeader) - stored);
+
+        // Waits for the other buffer's write, which frees it for the next block
+        settle();
+        if (file_.write(out, span, file_offset_)) {
+            index_.push_back({file_offset_, block.first_timestamp, block.last_timestamp, block.record_count, header.stored_bytes});
+            file_offset_ += span;
+            in_flight_raw_ = block.used;
+
+            records_written_.store(records_written_.load(std::memory_order_relaxed) + block.record_count, std::memory_order_relaxed);
+            raw_bytes_.store(raw_bytes_.load(std::memory_order_relaxed) + block.used, std::memory_order_relaxed);
+            file_bytes_.store(file_offset_, std::memory_order_relaxed);
+        } else {
+            std::cerr << "[Capture] Block write failed at offset " << file_offset_ << ", "
+                      << block.record_count << " records lost" << std::endl;
+            lost_.store(lost_.load(std::memory_order_relaxed) + block.record_count, std::memory_order_relaxed);
+        }
+
+        current_ ^= 1;
+        Block& next = blocks_[current_];
+        next.used = 0;
+        next.record_count = 0;
+    }
+
+    void CaptureWriter::settle() {
+        if (file_.wait() || index_.empty()) return;
+
+        // The block in flight is the last one indexed: unindex it and let the next block
+        // (or the index) take its place in the file
+        const BlockIndexEntry& entry = index_.back();
+        std::cerr << "[Capture] Block write failed at offset " << entry.offset << ", "
+                  << entry.record_count << " records lost" << std::endl;
+        lost_.store(lost_.load(std::memory_order_relaxed) + entry.record_count, std::memory_order_relaxed);
+        records_written_.store(records_written_.load(std::memory_order_relaxed) - entry.record_count, std::memory_order_relaxed);
+        raw_bytes_.store(raw_bytes_.load(std::memory_order_relaxed) - in_flight_raw_, std::memory_order_relaxed);
+        file_offset_ = entry.offset;
+        file_bytes_.store(file_offset_, std::memory_order_relaxed);
+        index_.pop_back();
+    }
+
+    void CaptureWriter::write_index() {
+        settle();
+
+        uint64_t record_count = 0;
+        for (const auto& entry : index_) record_count += entry.record_count;
+
+        size_t bytes = align_up(index_.size() * sizeof(BlockIndexEntry) + sizeof(FileFooter));
+        char* trailer = static_cast<char*>(std::aligned_alloc(ALIGNMENT, bytes));
+        if (!trailer) return;
+        std::memset(trailer, 0, bytes);
+        if (!index_.empty()) std::memcpy(trailer, index_.data(), index_.size() * sizeof(BlockIndexEntry));
+
+        FileFooter footer{file_offset_, index_.size(), record_count, {}};
+        std::memcpy(footer.magic, FOOTER_MAGIC, sizeof(footer.magic));
+        std::memcpy(trailer + bytes - sizeof(FileFooter), &footer, sizeof(footer));
+
+        if (!file_.write(trailer, bytes, file_offset_) || !file_.wait()) {
+            std::cerr << "[Capture] Index write failed" << std::endl;
+        }
+        file_offset_ += bytes;
+        file_bytes_.store(file_offset_, std::memory_order_relaxed);
+        std::free(trailer);
+    }
+
+}
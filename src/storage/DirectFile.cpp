@@ -0,0 +1,187 @@
+#include "storage/DirectFile.hpp"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace hft::storage {
+
+    namespace {
+        constexpr unsigned RING_ENTRIES = 4;
+
+        int io_uring_setup(unsigned entries, io_uring_params* params) {
+            return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+        }
+
+        int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+            return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+        }
+    }
+
+    DirectFile::~DirectFile() {
+        close();
+    }
+
+    bool DirectFile::open(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        direct_ = fd_ >= 0;
+        if (fd_ < 0 && errno == EINVAL) {
+            fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+        if (fd_ < 0) {
+            std::cerr << "[DirectFile] Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        if (!setup_ring()) teardown_ring();
+        return true;
+    }
+
+    bool DirectFile::setup_ring() {
+        io_uring_params params{};
+        ring_fd_ = io_uring_setup(RING_ENTRIES, &params);
+        if (ring_fd_ < 0) return false;
+
+        // IORING_OP_WRITE needs 5.6+, the same release that introduced this feature bit
+        if (!(params.features & IORING_FEAT_NODROP)) return false;
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            sq_ring_ = nullptr;
+            return false;
+        }
+        if (single_mmap) {
+            cq_ring_ = sq_ring_;
+        } else {
+            cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+            if (cq_ring_ == MAP_FAILED) {
+                cq_ring_ = nullptr;
+                return false;
+            }
+        }
+
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        char* cq = static_cast<char*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void DirectFile::teardown_ring() {
+        if (sqes_) munmap(sqes_, sqes_size_);
+        if (cq_ring_ && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+        if (sq_ring_) munmap(sq_ring_, sq_ring_size_);
+        if (ring_fd_ >= 0) ::close(ring_fd_);
+        sqes_ = nullptr;
+        sq_ring_ = cq_ring_ = nullptr;
+        ring_fd_ = -1;
+    }
+
+    bool DirectFile::write_sync(const void* buffer, size_t len, uint64_t offset) {
+        const char* p = static_cast<const char*>(buffer);
+        while (len > 0) {
+            ssize_t n = ::pwrite(fd_, p, len, static_cast<off_t>(offset));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EINVAL && direct_) {
+                    // Filesystem accepted O_DIRECT at open but refuses the I/O: go buffered
+                    fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+                    direct_ = false;
+                    continue;
+                }
+                std::cerr << "[DirectFile] Write failed: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+            p += n;
+            len -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    bool DirectFile::write(const void* buffer, size_t len, uint64_t offset) {
+        if (fd_ < 0) return false;
+        bool ok = wait();
+        if (ring_fd_ < 0) return write_sync(buffer, len, offset) && ok;
+
+        unsigned tail = *sq_tail_;
+        unsigned index = tail & *sq_mask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd_;
+        sqe->addr = reinterpret_cast<uint64_t>(buffer);
+        sqe->len = static_cast<uint32_t>(len);
+        sqe->off = offset;
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+        if (io_uring_enter(ring_fd_, 1, 0, 0) != 1) {
+            // Submission refused (seccomp, ENOMEM...): stop using the ring
+            __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+            teardown_ring();
+            return write_sync(buffer, len, offset) && ok;
+        }
+
+        in_flight_ = true;
+        pending_buffer_ = buffer;
+        pending_len_ = len;
+        pending_offset_ = offset;
+        return ok;
+    }
+
+    bool DirectFile::wait() {
+        if (!in_flight_) return true;
+        in_flight_ = false;
+
+        unsigned head = *cq_head_;
+        while (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            if (io_uring_enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                std::cerr << "[DirectFile] io_uring wait failed: " << std::strerror(errno) << std::endl;
+                return write_sync(pending_buffer_, pending_len_, pending_offset_);
+            }
+        }
+        int res = cqes_[head & *cq_mask_].res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+
+        if (res < 0) {
+            // e.g. EINVAL for O_DIRECT on this filesystem or an old kernel without OP_WRITE
+            return write_sync(pending_buffer_, pending_len_, pending_offset_);
+        }
+        size_t done = static_cast<size_t>(res);
+        if (done < pending_len_) {
+            return write_sync(static_cast<const char*>(pending_buffer_) + done, pending_len_ - done, pending_offset_ + done);
+        }
+        return true;
+    }
+
+    void DirectFile::close() {
+        if (fd_ < 0) return;
+        wait();
+        teardown_ring();
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+}
@@ -0,0 +1,234 @@
+#include "storage/PcapReader.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+
+namespace hft::storage {
+
+    namespace {
+        constexpr uint32_t PCAP_MAGIC_US = 0xa1b2c3d4;
+        constexpr uint32_t PCAP_MAGIC_NS = 0xa1b23c4d;
+        constexpr size_t PCAP_FILE_HEADER = 24;
+        constexpr size_t PCAP_RECORD_HEADER = 16;
+
+        constexpr uint32_t BLOCK_SECTION_HEADER = 0x0A0D0D0A;
+        constexpr uint32_t BLOCK_INTERFACE = 1;
+        constexpr uint32_t BLOCK_PACKET = 2;          // Obsolete packet block
+        constexpr uint32_t BLOCK_SIMPLE_PACKET = 3;
+        constexpr uint32_t BLOCK_ENHANCED_PACKET = 6;
+        constexpr uint32_t BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+        constexpr uint16_t OPTION_END = 0;
+        constexpr uint16_t OPTION_TSRESOL = 9;
+
+        uint32_t pad4(uint32_t n) { return (n + 3) & ~3u; }
+    }
+
+    PcapReader::~PcapReader() {
+        close();
+    }
+
+    bool PcapReader::open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(PCAP_FILE_HEADER)) {
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            size_ = 0;
+            return false;
+        }
+        madvise(map, size_, MADV_SEQUENTIAL);
+        base_ = static_cast<const uint8_t*>(map);
+
+        uint32_t magic;
+        std::memcpy(&magic, base_, sizeof(magic));
+        if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS ||
+            __builtin_bswap32(magic) == PCAP_MAGIC_US || __builtin_bswap32(magic) == PCAP_MAGIC_NS) {
+            format_ = Format::PCAP;
+            swapped_ = magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS;
+            uint32_t native = swapped_ ? __builtin_bswap32(magic) : magic;
+            units_per_second_ = native == PCAP_MAGIC_NS ? 1000000000 : 1000000;
+            // The upper bits of the link type field may carry FCS information
+            link_type_ = static_cast<uint16_t>(load32(base_ + 20) & 0xFFFF);
+        } else if (magic == BLOCK_SECTION_HEADER) {
+            format_ = Format::PCAPNG;
+        } else {
+            std::cerr << "[PcapReader] " << path << " is not a pcap or pcapng file" << std::endl;
+            close();
+            return false;
+        }
+        rewind();
+        return true;
+    }
+
+    void PcapReader::close() {
+        if (base_) munmap(const_cast<uint8_t*>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+        cursor_ = end_ = nullptr;
+        format_ = Format::NONE;
+        swapped_ = false;
+        interfaces_.clear();
+    }
+
+    void PcapReader::rewind() {
+        end_ = base_ + size_;
+        cursor_ = format_ == Format::PCAP ? base_ + PCAP_FILE_HEADER : base_;
+        interfaces_.clear();
+    }
+
+    bool PcapReader::next(PcapFrame& out) {
+        if (format_ == Format::PCAP) return next_pcap(out);
+        if (format_ == Format::PCAPNG) return next_pcapng(out);
+        return false;
+    }
+
+    bool PcapReader::next_pcap(PcapFrame& out) {
+        if (static_cast<size_t>(end_ - cursor_) < PCAP_RECORD_HEADER) return false;
+        uint32_t seconds = load32(cursor_);
+        uint32_t fraction = load32(cursor_ + 4);
+        uint32_t caplen = load32(cursor_ + 8);
+        uint32_t len = load32(cursor_ + 12);
+        if (caplen > static_cast<size_t>(end_ - cursor_) - PCAP_RECORD_HEADER) return false;
+
+        out.timestamp_ns = static_cast<uint64_t>(seconds) * 1000000000ULL + to_ns(fraction, units_per_second_);
+        out.data = cursor_ + PCAP_RECORD_HEADER;
+        out.caplen = caplen;
+        out.len = len;
+        out.link_type = link_type_;
+        cursor_ += PCAP_RECORD_HEADER + caplen;
+        return true;
+    }
+
+    bool PcapReader::next_pcapng(PcapFrame& out) {
+        for (;;) {
+            size_t available = static_cast<size_t>(end_ - cursor_);
+            if (available < 12) return false;
+            uint32_t type;
+            std::memcpy(&type, cursor_, sizeof(type)); // Same in either byte order for the SHB
+            if (type == BLOCK_SECTION_HEADER && !read_section_header(cursor_, available)) return false;
+            type = load32(cursor_);
+            uint32_t total = load32(cursor_ + 4);
+            if (total < 12 || total % 4 != 0 || total > available) return false;
+
+            const uint8_t* body = cursor_ + 8;
+            size_t body_len = total - 12;
+            cursor_ += total;
+
+            switch (type) {
+            case BLOCK_INTERFACE:
+                read_interface(body, body_len);
+                break;
+            case BLOCK_ENHANCED_PACKET:
+            case BLOCK_PACKET: {
+                if (body_len < 20) return false;
+                uint32_t interface = type == BLOCK_ENHANCED_PACKET ? load32(body) : load16(body);
+                if (interface >= interfaces_.size()) {
+                    std::cerr << "[PcapReader] Packet on undeclared interface " << interface << std::endl;
+                    return false;
+                }
+                uint64_t units = (static_cast<uint64_t>(load32(body + 4)) << 32) | load32(body + 8);
+                uint32_t caplen = load32(body + 12);
+                if (caplen > body_len - 20) return false;
+                const Interface& iface = interfaces_[interface];
+                out.timestamp_ns = to_ns(units, iface.units_per_second);
+                out.data = body + 20;
+                out.caplen = caplen;
+                out.len = load32(body + 16);
+                out.link_type = iface.link_type;
+                return true;
+            }
+            case BLOCK_SIMPLE_PACKET: {
+                // No timestamp; captured on the first interface, cut at its snaplen
+                if (body_len < 4 || interfaces_.empty()) return false;
+                uint32_t len = load32(body);
+                uint32_t caplen = len;
+                if (interfaces_[0].snaplen != 0 && caplen > interfaces_[0].snaplen) caplen = interfaces_[0].snaplen;
+                if (caplen > body_len - 4) return false;
+                out.timestamp_ns = 0;
+                out.data = body + 4;
+                out.caplen = caplen;
+                out.len = len;
+                out.link_type = interfaces_[0].link_type;
+                return true;
+            }
+            default:
+                break; // Name resolution, statistics, custom blocks
+            }
+        }
+    }
+
+    // A section header sets the byte order of everything up to the next one
+    bool PcapReader::read_section_header(const uint8_t* block, size_t available) {
+        if (available < 28) return false;
+        uint32_t byte_order;
+        std::memcpy(&byte_order, block + 8, sizeof(byte_order));
+        if (byte_order == BYTE_ORDER_MAGIC) {
+            swapped_ = false;
+        } else if (__builtin_bswap32(byte_order) == BYTE_ORDER_MAGIC) {
+            swapped_ = true;
+        } else {
+            std::cerr << "[PcapReader] Bad pcapng byte-order magic" << std::endl;
+            return false;
+        }
+        interfaces_.clear();
+        return true;
+    }
+
+    void PcapReader::read_interface(const uint8_t* body, size_t body_len) {
+        Interface iface{0, 0, 1000000};
+        if (body_len >= 8) {
+            iface.link_type = load16(body);
+            iface.snaplen = load32(body + 4);
+        }
+        // Options: code, length, value padded to 4 bytes
+        size_t pos = 8;
+        while (pos + 4 <= body_len) {
+            uint16_t code = load16(body + pos);
+            uint16_t length = load16(body + pos + 2);
+            if (code == OPTION_END || pos + 4 + length > body_len) break;
+            if (code == OPTION_TSRESOL && length >= 1) {
+                // High bit clear: 10^-n seconds, set: 2^-n seconds
+                uint8_t resolution = body[pos + 4];
+                uint32_t exponent = resolution & 0x7F;
+                if (resolution & 0x80) {
+                    iface.units_per_second = exponent < 64 ? 1ULL << exponent : 0;
+                } else {
+                    iface.units_per_second = 1;
+                    for (uint32_t i = 0; i < exponent && i < 19; ++i) iface.units_per_second *= 10;
+                }
+            }
+            pos += 4 + pad4(length);
+        }
+        if (iface.units_per_second == 0) iface.units_per_second = 1000000;
+        interfaces_.push_back(iface);
+    }
+
+    uint64_t PcapReader::to_ns(uint64_t units, uint64_t units_per_second) const {
+        if (units_per_second == 1000000000) return units;
+        if (units_per_second == 1000000) return units * 1000;
+        return static_cast<uint64_t>(static_cast<unsigned __int128>(units) * 1000000000 / units_per_second);
+    }
+
+    uint16_t PcapReader::load16(const uint8_t* p) const {
+        uint16_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return swapped_ ? __builtin_bswap16(v) : v;
+    }
+
+    uint32_t PcapReader::load32(const uint8_t* p) const {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return swapped_ ? __builtin_bswap32(v) : v;
+    }
+
+}
@@ -0,0 +1,332 @@
+#include "storage/TickDataset.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+
+namespace hft::storage {
+
+    namespace {
+
+        bool is_tick_file(const std::filesystem::path& path) {
+            return path.extension() == ".ticks" || path.extension() == ".tcol";
+        }
+
+        bool read_timestamp(int fd, uint64_t tick, uint64_t& ts) {
+            off_t offset = static_cast<off_t>(tick * sizeof(BinaryTick) + offsetof(BinaryTick, timestamp));
+            return pread(fd, &ts, sizeof(ts), offset) == static_cast<ssize_t>(sizeof(ts));
+        }
+
+        // First tick in ticks with timestamp >= ts (upper = false) or > ts (upper = true)
+        size_t search(std::span<const BinaryTick> ticks, uint64_t ts, bool upper) {
+            auto it = upper ? std::upper_bound(ticks.begin(), ticks.end(), ts,
+                                               [](uint64_t t, const BinaryTick& tick) { return t < tick.timestamp; })
+                            : std::lower_bound(ticks.begin(), ticks.end(), ts,
+                                               [](const BinaryTick& tick, uint64_t t) { return tick.timestamp < t; });
+            return static_cast<size_t>(it - ticks.begin());
+        }
+
+    }
+
+    TickDataset::~TickDataset() {
+        close();
+    }
+
+    bool TickDataset::open(const std::string& path) {
+        close();
+        std::error_code ec;
+        if (std::filesystem::is_directory(path, ec)) {
+            std::vector<std::string> paths;
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path, ec)) {
+                if (entry.is_regular_file(ec) && is_tick_file(entry.path())) paths.push_back(entry.path().string());
+            }
+            std::sort(paths.begin(), paths.end());
+            for (const auto& file : paths) add_file(file);
+        } else {
+            add_file(path);
+        }
+        if (files_.empty()) return false;
+
+        // Replay order is time order, whatever the partition names
+        std::vector<size_t> order(files_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return files_[a].first_timestamp < files_[b].first_timestamp;
+        });
+        std::vector<TickFileInfo> files;
+        std::vector<std::vector<uint64_t>> indexes;
+        for (size_t i : order) {
+            files.push_back(std::move(files_[i]));
+            indexes.push_back(std::move(indexes_[i]));
+        }
+        files_ = std::move(files);
+        indexes_ = std::move(indexes);
+        for (size_t i = 1; i < files_.size(); ++i) {
+            if (files_[i].first_timestamp < files_[i - 1].last_timestamp) {
+                std::cerr << "[Dataset] " << files_[i].path << " overlaps " << files_[i - 1].path
+                          << "; ticks are replayed file by file, not merged" << std::endl;
+            }
+        }
+
+        seek(0);
+        return true;
+    }
+
+    void TickDataset::close() {
+        leave();
+        files_.clear();
+        indexes_.clear();
+        pending_ = {};
+        done_ = true;
+    }
+
+    uint64_t TickDataset::tick_count() const {
+        uint64_t total = 0;
+        for (const auto& file : files_) total += file.tick_count;
+        return total;
+    }
+
+    bool TickDataset::add_file(const std::string& path) {
+        TickFileInfo info;
+        info.path = path;
+        std::vector<uint64_t> index;
+
+        TickStoreReader store;
+        if (store.open(path)) {
+            if (store.blocks().empty()) return false;
+            info.columnar = true;
+            info.tick_count = store.tick_count();
+            info.first_timestamp = store.blocks().front().first_timestamp;
+            info.last_timestamp = store.blocks().back().last_timestamp;
+        } else {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            bool ok = fstat(fd, &st) == 0 && st.st_size > 0 && st.st_size % sizeof(BinaryTick) == 0;
+            size_t size = ok ? static_cast<size_t>(st.st_size) : 0;
+            info.tick_count = size / sizeof(BinaryTick);
+            ok = ok && (load_index(path, size, index) || build_index(path, size, index)) &&
+                 read_timestamp(fd, info.tick_count - 1, info.last_timestamp);
+            ::close(fd);
+            if (!ok) {
+                std::cerr << "[Dataset] Skipping " << path << " (not a tick file)" << std::endl;
+                return false;
+            }
+            info.first_timestamp = index.front();
+        }
+        files_.push_back(std::move(info));
+        indexes_.push_back(std::move(index));
+        return true;
+    }
+
+    bool TickDataset::load_index(const std::string& path, size_t size, std::vector<uint64_t>& index) const {
+        FILE* f = fopen((path + ".tidx").c_str(), "rb");
+        if (!f) return false;
+        TickIndexHeader header;
+        uint64_t ticks = size / sizeof(BinaryTick);
+        bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+                  std::memcmp(header.magic, TICK_INDEX_MAGIC, sizeof(TICK_INDEX_MAGIC)) == 0 &&
+                  header.source_size == size && header.stride == TICK_INDEX_STRIDE &&
+                  header.entry_count == (ticks + TICK_INDEX_STRIDE - 1) / TICK_INDEX_STRIDE;
+        if (ok) {
+            index.resize(header.entry_count);
+            ok = fread(index.data(), sizeof(uint64_t), index.size(), f) == index.size();
+        }
+        fclose(f);
+        if (!ok) index.clear();
+        return ok;
+    }
+
+    bool TickDataset::build_index(const std::string& path, size_t size, std::vector<uint64_t>& index) const {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        // One 8-byte read per stride; the file itself is neither mapped nor read through
+        uint64_t ticks = size / sizeof(BinaryTick);
+        index.resize((ticks + TICK_INDEX_STRIDE - 1) / TICK_INDEX_STRIDE);
+        bool ok = true;
+        for (size_t k = 0; k < index.size() && ok; ++k) ok = read_timestamp(fd, k * TICK_INDEX_STRIDE, index[k]);
+        ::close(fd);
+        if (!ok) {
+            index.clear();
+            return false;
+        }
+
+        TickIndexHeader header{};
+        std::memcpy(header.magic, TICK_INDEX_MAGIC, sizeof(header.magic));
+        header.source_size = size;
+        header.stride = TICK_INDEX_STRIDE;
+        header.entry_count = index.size();
+
+        // Best effort: a read-only dataset directory just means rebuilding next time
+        FILE* f = fopen((path + ".tidx").c_str(), "wb");
+        if (!f) return true;
+        bool written = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                       fwrite(index.data(), sizeof(uint64_t), index.size(), f) == index.size();
+        fclose(f);
+        if (!written) std::remove((path + ".tidx").c_str());
+        return true;
+    }
+
+    bool TickDataset::enter(size_t file) {
+        leave();
+        file_ = file;
+        position_ = 0;
+        advised_ = released_ = 0;
+        const TickFileInfo& info = files_[file];
+
+        if (info.columnar) {
+            store_ = std::make_unique<TickStoreReader>();
+            if (!store_->open(info.path)) {
+                store_.reset();
+                return false;
+            }
+            block_.resize(store_->block_ticks());
+            return true;
+        }
+
+        int fd = ::open(info.path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        // No MAP_POPULATE: pages come in through the read-ahead window as the cursor reaches them
+        size_t bytes = info.tick_count * sizeof(BinaryTick);
+        void* map = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) return false;
+        ticks_ = static_cast<const BinaryTick*>(map);
+        mapped_bytes_ = bytes;
+        return true;
+    }
+
+    bool TickDataset::enter_next() {
+        for (size_t f = file_ + 1; f < files_.size(); ++f) {
+            if (enter(f)) return true;
+            std::cerr << "[Dataset] Skipping " << files_[f].path << " (cannot open)" << std::endl;
+        }
+        leave();
+        return false;
+    }
+
+    void TickDataset::leave() {
+        if (ticks_) munmap(const_cast<BinaryTick*>(ticks_), mapped_bytes_);
+        ticks_ = nullptr;
+        mapped_bytes_ = 0;
+        store_.reset();
+    }
+
+    void TickDataset::advance_window() {
+        if (window_ == 0) return;
+        if (store_) {
+            const auto& blocks = store_->blocks();
+            if (position_ < blocks.size() && blocks[position_].offset + window_ / 2 >= advised_) {
+                store_->prefetch(position_, window_);
+                advised_ = blocks[position_].offset + window_;
+            }
+            return;
+        }
+
+        char* base = reinterpret_cast<char*>(const_cast<BinaryTick*>(ticks_));
+        size_t position = position_ * sizeof(BinaryTick);
+        size_t ahead = std::min(mapped_bytes_, align_up(position) + window_);
+        if (ahead > advised_ + window_ / 2 || (ahead == mapped_bytes_ && advised_ < mapped_bytes_)) {
+            size_t start = std::max(advised_, align_down(position));
+            madvise(base + start, ahead - start, MADV_WILLNEED);
+            advised_ = ahead;
+        }
+        // Keep one window behind the cursor for spans the caller may still hold
+        if (position > released_ + 2 * window_) {
+            size_t upto = align_down(position - window_);
+            madvise(base + released_, upto - released_, MADV_DONTNEED);
+            released_ = upto;
+        }
+    }
+
+    bool TickDataset::seek(uint64_t from, uint64_t to) {
+        leave();
+        from_ = from;
+        to_ = to;
+        pending_ = {};
+        done_ = false;
+
+        // File: the first one that reaches from
+        auto it = std::lower_bound(files_.begin(), files_.end(), from,
+                                   [](const TickFileInfo& info, uint64_t ts) { return info.last_timestamp < ts; });
+        file_ = static_cast<size_t>(it - files_.begin());
+        if (file_ >= files_.size() || !(enter(file_) || enter_next())) {
+            done_ = true;
+            return false;
+        }
+
+        // Position within the file
+        if (store_) {
+            position_ = store_->find(from);
+        } else if (from > files_[file_].first_timestamp) {
+            // Sparse index narrows the search to one stride; only that stride is faulted in
+            const std::vector<uint64_t>& index = indexes_[file_];
+            size_t k = static_cast<size_t>(std::lower_bound(index.begin(), index.end(), from) - index.begin());
+            size_t lo = k == 0 ? 0 : (k - 1) * TICK_INDEX_STRIDE;
+            size_t hi = std::min<size_t>(files_[file_].tick_count, k * TICK_INDEX_STRIDE + 1);
+            char* base = reinterpret_cast<char*>(const_cast<BinaryTick*>(ticks_));
+            size_t start = align_down(lo * sizeof(BinaryTick));
+            madvise(base + start, align_up(hi * sizeof(BinaryTick)) - start, MADV_WILLNEED);
+            position_ = lo + search(std::span<const BinaryTick>(ticks_ + lo, hi - lo), from, false);
+        }
+        advised_ = released_ = store_ ? 0 : align_down(position_ * sizeof(BinaryTick));
+
+        // Read the first run now: it answers whether the range is empty, and a caller timing
+        // the seek sees the cost of reaching the first tick
+        pending_ = next_run();
+        return !pending_.empty();
+    }
+
+    std::span<const BinaryTick> TickDataset::next() {
+        if (!pending_.empty()) {
+            std::span<const BinaryTick> run = pending_;
+            pending_ = {};
+            return run;
+        }
+        return next_run();
+    }
+
+    std::span<const BinaryTick> TickDataset::next_run() {
+        while (!done_) {
+            std::span<const BinaryTick> run;
+            if (store_) {
+                const auto& blocks = store_->blocks();
+                if (position_ >= blocks.size()) {
+                    if (!enter_next()) break;
+                    continue;
+                }
+                advance_window();
+                bool before_range = blocks[position_].first_timestamp < from_;
+                size_t n = store_->decode(position_++, block_.data());
+                run = std::span<const BinaryTick>(block_.data(), n);
+                if (before_range) run = run.subspan(search(run, from_, false));
+            } else {
+                uint64_t count = files_[file_].tick_count;
+                if (position_ >= count) {
+                    if (!enter_next()) break;
+                    continue;
+                }
+                size_t n = static_cast<size_t>(std::min<uint64_t>(BATCH_TICKS, count - position_));
+                run = std::span<const BinaryTick>(ticks_ + position_, n);
+                position_ += n;
+                advance_window();
+            }
+
+            if (!run.empty() && run.back().timestamp > to_) {
+                run = run.first(search(run, to_, true));
+                done_ = true;
+            }
+            if (!run.empty()) return run;
+        }
+        done_ = true;
+        return {};
+    }
+
+}
@@ -0,0 +1,386 @@
+#include "storage/TickStore.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace hft::storage {
+
+    namespace {
+
+        // Widest code the 4-lane decoder handles: one unaligned 8-byte load must hold the
+        // code plus up to 7 bits of lead-in.
+        constexpr unsigned MAX_LANE_WIDTH = 57;
+
+        uint64_t field(const BinaryTick& t, size_t column) {
+            switch (static_cast<TickColumn>(column)) {
+                case TickColumn::ID: return t.id;
+                case TickColumn::TIMESTAMP: return t.timestamp;
+                case TickColumn::PRICE: return static_cast<uint64_t>(t.price);
+                case TickColumn::QUANTITY: return static_cast<uint64_t>(t.quantity);
+                case TickColumn::SYMBOL: return t.symbol;
+                case TickColumn::EXCHANGE_TIMESTAMP: return t.exchange_timestamp;
+                case TickColumn::RX_TIMESTAMP: return t.rx_timestamp;
+                case TickColumn::IS_BID: return t.is_bid;
+                case TickColumn::IS_TRADE: return t.is_trade;
+                case TickColumn::IS_SNAPSHOT: return t.is_snapshot;
+                case TickColumn::END_OF_MESSAGE: return t.end_of_message;
+                default: return 0;
+            }
+        }
+
+        uint64_t zigzag(uint64_t delta) {
+            return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+        }
+
+        uint64_t unzigzag(uint64_t code) {
+            return (code >> 1) ^ (0 - (code & 1));
+        }
+
+        // Function: pack
+        // Description: ORs n codes of width bits, LSB first, into out (zeroed, packed_bytes long).
+        void pack(const uint64_t* codes, size_t n, unsigned width, uint8_t* out) {
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t bit = i * width;
+                uint8_t* p = out + (bit >> 3);
+                unsigned shift = bit & 7;
+                uint64_t word;
+                std::memcpy(&word, p, sizeof(word));
+                word |= codes[i] << shift;
+                std::memcpy(p, &word, sizeof(word));
+                if (shift + width > 64) p[8] |= static_cast<uint8_t>(codes[i] >> (64 - shift));
+            }
+        }
+
+        uint64_t extract(const uint8_t* data, uint64_t bit, unsigned width, uint64_t mask) {
+            const uint8_t* p = data + (bit >> 3);
+            unsigned shift = bit & 7;
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            uint64_t code = word >> shift;
+            if (shift + width > 64) code |= static_cast<uint64_t>(p[8]) << (64 - shift);
+            return code & mask;
+        }
+
+        // Function: unpack
+        // Description: Decodes codes [first, first + n) into out: base + code, or for delta
+        //              columns a running sum of unzigzagged codes continuing from base (the
+        //              value before first; the column base when first is 0).
+        template<bool Delta>
+        void unpack(const uint8_t* data, unsigned width, size_t first, size_t n, uint64_t base, uint64_t* out) {
+            if (width == 0) {
+                std::fill(out, out + n, base);
+                return;
+            }
+            uint64_t mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+            size_t i = 0;
+            uint64_t sum = base;
+#ifdef __AVX2__
+            if (width <= MAX_LANE_WIDTH) {
+                const __m256i lane_mask = _mm256_set1_epi64x(static_cast<long long>(mask));
+                const __m256i step = _mm256_set1_epi64x(4LL * width);
+                const __m256i seven = _mm256_set1_epi64x(7);
+                const __m256i one = _mm256_set1_epi64x(1);
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i base_vec = _mm256_set1_epi64x(static_cast<long long>(base));
+                __m256i bits = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(first * width)),
+                                                _mm256_setr_epi64x(0, width, 2LL * width, 3LL * width));
+                __m256i carry = base_vec;
+                for (; i + 4 <= n; i += 4) {
+                    // Four codes: load the 8 bytes each starts in, shift out the lead-in bits.
+                    // Plain loads: gathers are microcoded (and slower still under the GDS fix).
+                    uint64_t bit = (first + i) * width;
+                    long long w0, w1, w2, w3;
+                    std::memcpy(&w0, data + (bit >> 3), 8);
+                    std::memcpy(&w1, data + ((bit + width) >> 3), 8);
+                    std::memcpy(&w2, data + ((bit + 2 * width) >> 3), 8);
+                    std::memcpy(&w3, data + ((bit + 3 * width) >> 3), 8);
+                    __m256i words = _mm256_setr_epi64x(w0, w1, w2, w3);
+                    __m256i v = _mm256_and_si256(_mm256_srlv_epi64(words, _mm256_and_si256(bits, seven)), lane_mask);
+                    bits = _mm256_add_epi64(bits, step);
+                    if constexpr (Delta) {
+                        v = _mm256_xor_si256(_mm256_srli_epi64(v, 1), _mm256_sub_epi64(zero, _mm256_and_si256(v, one)));
+                        // In-register prefix sum: add the lanes shifted up by one, then by two
+                        v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+                        v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+                        v = _mm256_add_epi64(v, carry);
+                        carry = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+                    } else {
+                        v = _mm256_add_epi64(v, base_vec);
+                    }
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+                }
+                if (i > 0) sum = out[i - 1];
+            }
+#endif
+            for (; i < n; ++i) {
+                uint64_t code = extract(data, (first + i) * width, width, mask);
+                if constexpr (Delta) {
+                    sum += unzigzag(code);
+                    out[i] = sum;
+                } else {
+                    out[i] = base + code;
+                }
+            }
+        }
+
+    }
+
+    // ---------------------------------------------------------------- Writer
+
+    TickStoreWriter::TickStoreWriter(const std::string& path, uint32_t block_ticks)
+        : path_(path), block_ticks_(std::clamp<uint32_t>(block_ticks, 1, MAX_BLOCK_TICKS)) {
+        pending_.reserve(block_ticks_);
+    }
+
+    TickStoreWriter::~TickStoreWriter() {
+        close();
+    }
+
+    bool TickStoreWriter::open() {
+        file_ = std::fopen(path_.c_str(), "wb");
+        if (!file_) {
+            std::cerr << "[TickStore] Cannot create " << path_ << std::endl;
+            return false;
+        }
+        TickFileHeader header{};
+        std::memcpy(header.magic, TICK_FILE_MAGIC, sizeof(header.magic));
+        header.version = TICK_FORMAT_VERSION;
+        header.block_ticks = block_ticks_;
+        return write(&header, sizeof(header));
+    }
+
+    bool TickStoreWriter::write(const void* data, size_t len) {
+        if (ok_ && std::fwrite(data, 1, len, file_) != len) {
+            std::cerr << "[TickStore] Write failed: " << path_ << std::endl;
+            ok_ = false;
+        }
+        offset_ += len;
+        return ok_;
+    }
+
+    void TickStoreWriter::flush_block() {
+        if (pending_.empty() || !file_) return;
+        size_t n = pending_.size();
+
+        TickBlockHeader header{};
+        header.magic = TICK_BLOCK_MAGIC;
+        header.tick_count = static_cast<uint32_t>(n);
+        header.min_timestamp = UINT64_MAX;
+        for (const auto& t : pending_) {
+            header.min_timestamp = std::min(header.min_timestamp, t.timestamp);
+            header.max_timestamp = std::max(header.max_timestamp, t.timestamp);
+        }
+
+        block_.assign(sizeof(header), 0);
+        codes_.resize(n);
+        for (size_t c = 0; c < TICK_COLUMNS; ++c) {
+            // Both codings' widths from one pass; the delta of the first tick is always 0
+            uint64_t first = field(pending_[0], c);
+            uint64_t lo = first, hi = first, max_zigzag = 0, prev = first;
+            for (size_t i = 1; i < n; ++i) {
+                uint64_t v = field(pending_[i], c);
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+                max_zigzag = std::max(max_zigzag, zigzag(v - prev));
+                prev = v;
+            }
+            unsigned reference_width = static_cast<unsigned>(std::bit_width(hi - lo));
+            unsigned delta_width = static_cast<unsigned>(std::bit_width(max_zigzag));
+
+            ColumnHeader& column = header.columns[c];
+            bool delta = delta_width < reference_width; // Ties go to the cheaper decode
+            column.coding = static_cast<uint8_t>(delta ? ColumnCoding::DELTA_ZIGZAG : ColumnCoding::FRAME_OF_REFERENCE);
+            column.width = static_cast<uint8_t>(delta ? delta_width : reference_width);
+            column.base = delta ? first : lo;
+            column.offset = static_cast<uint32_t>(block_.size());
+            if (column.width == 0) continue;
+
+            prev = first;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t v = field(pending_[i], c);
+                codes_[i] = delta ? zigzag(v - prev) : v - lo;
+                prev = v;
+            }
+            block_.resize(block_.size() + packed_bytes(n, column.width), 0);
+            pack(codes_.data(), n, column.width, block_.data() + column.offset);
+        }
+
+        header.bytes = static_cast<uint32_t>(block_.size());
+        std::memcpy(block_.data(), &header, sizeof(header));
+        block_.resize((block_.size() + 63) & ~size_t{63}, 0);
+
+        index_.push_back({offset_, header.min_timestamp, header.max_timestamp, header.tick_count, header.bytes});
+        write(block_.data(), block_.size());
+        tick_count_ += n;
+        pending_.clear();
+    }
+
+    bool TickStoreWriter::close() {
+        if (!file_) return ok_;
+        flush_block();
+
+        FileFooter footer{};
+        footer.index_offset = offset_;
+        footer.block_count = index_.size();
+        footer.record_count = tick_count_;
+        std::memcpy(footer.magic, FOOTER_MAGIC, sizeof(footer.magic));
+        write(index_.data(), index_.size() * sizeof(BlockIndexEntry));
+        write(&footer, sizeof(footer));
+
+        if (std::fclose(file_) != 0) ok_ = false;
+        file_ = nullptr;
+        return ok_;
+    }
+
+    // ---------------------------------------------------------------- Reader
+
+    TickStoreReader::~TickStoreReader() {
+        close();
+    }
+
+    bool TickStoreReader::open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TickFileHeader) + sizeof(FileFooter)) {
+            ::close(fd);
+            return false;
+        }
+        // Not ours: leave the file to other readers without mapping it
+        char magic[sizeof(TICK_FILE_MAGIC)];
+        if (pread(fd, magic, sizeof(magic), 0) != static_cast<ssize_t>(sizeof(magic)) ||
+            std::memcmp(magic, TICK_FILE_MAGIC, sizeof(magic)) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        size_ = static_cast<size_t>(st.st_size);
+        void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            size_ = 0;
+            return false;
+        }
+        base_ = static_cast<const uint8_t*>(map);
+        madvise(map, size_, MADV_SEQUENTIAL);
+
+        std::memcpy(&header_, base_, sizeof(header_));
+        FileFooter footer;
+        std::memcpy(&footer, base_ + size_ - sizeof(footer), sizeof(footer));
+        size_t index_bytes = footer.block_count * sizeof(BlockIndexEntry);
+        if (header_.version != TICK_FORMAT_VERSION || header_.block_ticks == 0 || header_.block_ticks > MAX_BLOCK_TICKS ||
+            std::memcmp(footer.magic, FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) != 0 ||
+            footer.index_offset + index_bytes + sizeof(footer) != size_) {
+            std::cerr << "[TickStore] " << path << " is truncated or from an unsupported version" << std::endl;
+            close();
+            return false;
+        }
+        blocks_.resize(footer.block_count);
+        std::memcpy(blocks_.data(), base_ + footer.index_offset, index_bytes);
+        tick_count_ = footer.record_count;
+        columns_.resize(TICK_COLUMNS * DECODE_CHUNK);
+        return true;
+    }
+
+    void TickStoreReader::close() {
+        if (base_) munmap(const_cast<uint8_t*>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+        header_ = TickFileHeader{};
+        blocks_.clear();
+        tick_count_ = 0;
+    }
+
+    size_t TickStoreReader::find(uint64_t ts) const {
+        auto it = std::lower_bound(blocks_.begin(), blocks_.end(), ts,
+                                   [](const BlockIndexEntry& entry, uint64_t t) { return entry.last_timestamp < t; });
+        return static_cast<size_t>(it - blocks_.begin());
+    }
+
+    void TickStoreReader::prefetch(size_t block, size_t bytes) const {
+        if (block >= blocks_.size()) return;
+        size_t start = align_down(blocks_[block].offset);
+        size_t end = std::min(size_, static_cast<size_t>(blocks_[block].offset) + bytes);
+        if (end > start) madvise(const_cast<uint8_t*>(base_) + start, end - start, MADV_WILLNEED);
+    }
+
+    size_t TickStoreReader::decode(size_t block, BinaryTick* out) {
+        const BlockIndexEntry& entry = blocks_[block];
+        TickBlockHeader header;
+        if (entry.offset + sizeof(header) > size_) return 0;
+        std::memcpy(&header, base_ + entry.offset, sizeof(header));
+        if (header.magic != TICK_BLOCK_MAGIC || header.tick_count > header_.block_ticks ||
+            entry.offset + header.bytes > size_) {
+            std::cerr << "[TickStore] Bad block header at offset " << entry.offset << std::endl;
+            return 0;
+        }
+
+        size_t n = header.tick_count;
+        const uint8_t* data = base_ + entry.offset;
+        for (const ColumnHeader& column : header.columns) {
+            if (column.width > 64 || (column.width && column.offset + packed_bytes(n, column.width) > header.bytes)) {
+                std::cerr << "[TickStore] Bad column in block at offset " << entry.offset << std::endl;
+                return 0;
+            }
+        }
+
+        // Columns are decoded DECODE_CHUNK ticks at a time so the scratch columns and the
+        // ticks they are assembled into stay in L1
+        uint64_t carry[TICK_COLUMNS];
+        for (size_t c = 0; c < TICK_COLUMNS; ++c) carry[c] = header.columns[c].base;
+        auto column = [&](TickColumn c) { return columns_.data() + static_cast<size_t>(c) * DECODE_CHUNK; };
+
+        for (size_t first = 0; first < n; first += DECODE_CHUNK) {
+            size_t count = std::min<size_t>(DECODE_CHUNK, n - first);
+            for (size_t c = 0; c < TICK_COLUMNS; ++c) {
+                const ColumnHeader& col = header.columns[c];
+                uint64_t* values = columns_.data() + c * DECODE_CHUNK;
+                if (col.coding == static_cast<uint8_t>(ColumnCoding::DELTA_ZIGZAG)) {
+                    unpack<true>(data + col.offset, col.width, first, count, carry[c], values);
+                    carry[c] = values[count - 1];
+                } else {
+                    unpack<false>(data + col.offset, col.width, first, count, col.base, values);
+                }
+            }
+
+            const uint64_t* id = column(TickColumn::ID);
+            const uint64_t* timestamp = column(TickColumn::TIMESTAMP);
+            const uint64_t* price = column(TickColumn::PRICE);
+            const uint64_t* quantity = column(TickColumn::QUANTITY);
+            const uint64_t* symbol = column(TickColumn::SYMBOL);
+            const uint64_t* exchange_timestamp = column(TickColumn::EXCHANGE_TIMESTAMP);
+            const uint64_t* rx_timestamp = column(TickColumn::RX_TIMESTAMP);
+            const uint64_t* is_bid = column(TickColumn::IS_BID);
+            const uint64_t* is_trade = column(TickColumn::IS_TRADE);
+            const uint64_t* is_snapshot = column(TickColumn::IS_SNAPSHOT);
+            const uint64_t* end_of_message = column(TickColumn::END_OF_MESSAGE);
+            BinaryTick* ticks = out + first;
+            for (size_t i = 0; i < count; ++i) {
+                BinaryTick& t = ticks[i];
+                t.id = id[i];
+                t.timestamp = timestamp[i];
+                t.price = static_cast<int64_t>(price[i]);
+                t.quantity = static_cast<int64_t>(quantity[i]);
+                t.symbol = symbol[i];
+                t.is_bid = is_bid[i] != 0;
+                t.is_trade = is_trade[i] != 0;
+                t.is_snapshot = is_snapshot[i] != 0;
+                t.end_of_message = end_of_message[i] != 0;
+                t.exchange_timestamp = exchange_timestamp[i];
+                t.rx_timestamp = rx_timestamp[i];
+                t.rx_read_delta = 0; // Not stored: the receive time is
+            }
+        }
+        return n;
+    }
+
+}
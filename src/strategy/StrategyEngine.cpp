@@ -1,17 +1,47 @@
 #include "strategy/StrategyEngine.hpp"
 #include "strategy/OrderBook.hpp"
 #include "common/Utils.hpp"
+#include "common/Trace.hpp"
 #include <iostream>
 #include <fstream>
 #include <immintrin.h> // For _mm_pause
 #include <cstring>
 #include <memory>
 #include <cmath>
+#include <algorithm>
 
 namespace hft {
 
-    StrategyEngine::StrategyEngine(RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& input_buffer, RingBuffer<Order, constants::RING_BUFFER_SIZE>& output_buffer)
-        : input_buffer_(input_buffer), output_buffer_(output_buffer) {}
+    namespace {
+        // Strategy Configuration (Integer Optimized)
+        // EWMA Alpha = 0.15 (~154/1024)
+        constexpr int64_t ALPHA_NUM = 174;
+        constexpr int64_t ALPHA_SHIFT = 10;
+        
+        constexpr int64_t MAX_POSITION = 100;      // Max inventory (Lots)
+        
+        // Threshold in raw quantity units (Satoshis)
+        // 100,000 sats = 0.001 BTC.
+        constexpr int64_t OFI_THRESHOLD = 1241630; 
+        
+        // Skew divisor. Impact = OFI / SKEW_DIVISOR
+        // If OFI = 1,000,000 (0.01 BTC), and we want 100 sats skew, Divisor = 10,000
+        constexpr int64_t SKEW_DIVISOR = 13758; 
+
+        // Inventory Skew: Price adjustment per lot of position
+        constexpr int64_t INVENTORY_SKEW = 783; // 2 sats per lot 
+
+        constexpr int64_t ORDER_QTY = static_cast<int64_t>(constants::DEFAULT_ORDER_QTY * constants::PRICE_SCALE);
+
+        // Upper bound on ticks conflated into one decision, so a flood cannot starve the signal
+        constexpr uint32_t MAX_BURST_TICKS = 4096;
+    }
+
+    StrategyEngine::StrategyEngine(RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>& input_buffer, RingBuffer<Order, constants::RING_BUFFER_SIZE>& output_buffer,
+                                   ConflationMode conflation)
+        : input_buffer_(input_buffer), output_buffer_(output_buffer), conflation_(conflation) {
+        if (conflation_ != ConflationMode::NONE) bursts_.reserve(1000000);
+    }
 
     // Function: start
     // Description: Starts the strategy engine thread.
@@ -19,7 +49,11 @@ namespace hft {
     // Outputs: None.
     void StrategyEngine::start() {
         running_ = true;
-        thread_ = std::thread(&StrategyEngine::run, this);
+        if (conflation_ == ConflationMode::NONE) {
+            thread_ = std::thread(&StrategyEngine::run, this);
+        } else {
+            thread_ = std::thread(&StrategyEngine::run_conflated, this);
+        }
     }
 
     // Function: stop
@@ -33,6 +67,9 @@ namespace hft {
         }
         latency_recorder_.save_to_csv("strategy_latencies.csv");
         save_fills_to_csv("simulated_fills.csv");
+        if (conflation_ != ConflationMode::NONE) {
+            save_bursts_to_csv("strategy_bursts.csv");
+        }
     }
 
     // Function: run
@@ -41,139 +78,295 @@ namespace hft {
     // Outputs: None.
     void StrategyEngine::run() {
         utils::pin_thread_to_core(constants::STRATEGY_ENGINE_CORE);
-
-        // Lazy initialization to center around current market price
-        std::unique_ptr<DenseOrderBook> order_book;
+        TRACE_THREAD("strategy");
 
         BinaryTick tick;
-        uint64_t order_id = 0;
-        
-        // Strategy Configuration (Integer Optimized)
-        // EWMA Alpha = 0.15 (~154/1024)
-        constexpr int64_t ALPHA_NUM = 174;
-        constexpr int64_t ALPHA_SHIFT = 10;
-        
-        constexpr int64_t MAX_POSITION = 100;      // Max inventory (Lots)
-        
-        // Threshold in raw quantity units (Satoshis)
-        // 100,000 sats = 0.001 BTC.
-        constexpr int64_t OFI_THRESHOLD = 1241630; 
-        
-        // Skew divisor. Impact = OFI / SKEW_DIVISOR
-        // If OFI = 1,000,000 (0.01 BTC), and we want 100 sats skew, Divisor = 10,000
-        constexpr int64_t SKEW_DIVISOR = 13758; 
+        while (running_) {
+            TRACE_BEGIN(pop_begin);
+            if (input_buffer_.pop(tick)) {
+                TRACE_END(RING_POP, pop_begin);
+                uint64_t start_tsc = utils::rdtsc();
+                pop_tsc_ = start_tsc;
 
-        // Inventory Skew: Price adjustment per lot of position
-        constexpr int64_t INVENTORY_SKEW = 783; // 2 sats per lot 
+                if (apply_tick(tick)) {
+                    evaluate_signal(tick);
+                }
+                latency_recorder_.record(start_tsc, utils::rdtsc());
+            } else {
+                _mm_pause(); 
+            }
+        }
+    }
 
-        // Strategy State
-        int64_t smoothed_ofi = 0;
-        int64_t position = 0;
+    // Function: run_conflated
+    // Description: Burst loop. Applies a whole burst of ticks to the book, then evaluates
+    //              the signal once on the final state instead of on every intermediate one.
+    // Inputs: None.
+    // Outputs: None.
+    void StrategyEngine::run_conflated() {
+        utils::pin_thread_to_core(constants::STRATEGY_ENGINE_CORE);
+        TRACE_THREAD("strategy");
 
+        BinaryTick tick;
         while (running_) {
-            if (input_buffer_.pop(tick)) {
-                uint64_t start_tsc = utils::rdtsc();
+            TRACE_BEGIN(pop_begin);
+            if (!input_buffer_.pop(tick)) {
+                _mm_pause();
+                continue;
+            }
+            TRACE_END(RING_POP, pop_begin);
+
+            uint64_t start_tsc = utils::rdtsc();
+            uint64_t queue_delay = start_tsc > tick.timestamp ? start_tsc - tick.timestamp : 0;
+            uint32_t burst_ticks = 1;
+            bool book_changed = apply_tick(tick);
 
-                // Handle Initialization
-                if (!order_book) {
-                    order_book = std::make_unique<DenseOrderBook>(tick.price);
-                    std::cout << "[Strategy] OrderBook initialized at price: " << tick.price << std::endl;
+            if (conflation_ == ConflationMode::DRAIN) {
+                // Everything the producer has published so far
+                while (burst_ticks < MAX_BURST_TICKS && input_buffer_.pop(tick)) {
+                    book_changed |= apply_tick(tick);
+                    ++burst_ticks;
+                }
+            } else {
+                // The rest of this feed message. The producer publishes a message
+                // back to back, so waiting for the marker is a short spin.
+                while (!tick.end_of_message && burst_ticks < MAX_BURST_TICKS && running_) {
+                    if (input_buffer_.pop(tick)) {
+                        book_changed |= apply_tick(tick);
+                        ++burst_ticks;
+                    } else if (!seen_message_marker_) {
+                        // No marker so far (a tick file from before they were written):
+                        // waiting could hold a signal back for MAX_BURST_TICKS, so the
+                        // burst ends where the ring runs empty, as in DRAIN
+                        if (!warned_no_marker_) {
+                            std::cerr << "[Strategy] No end_of_message markers in the tick stream; "
+                                         "conflating on ring drain until one arrives" << std::endl;
+                            warned_no_marker_ = true;
+                        }
+                        break;
+                    } else {
+                        _mm_pause();
+                    }
                 }
+                if (tick.end_of_message) seen_message_marker_ = true;
+            }
 
-                if (tick.is_trade) {
-                    // Process Fills via Matching Engine
-                    auto filled_orders = matching_engine_.on_trade_update(tick.price, tick.timestamp);
-                    for (const auto& fill : filled_orders) {
-                        position += (fill.is_buy ? 1 : -1);
-                        fills_.push_back(fill);
+            if (book_changed) {
+                // Orders are attributed to the last tick of the burst, popped just now
+                pop_tsc_ = utils::rdtsc();
+                evaluate_signal(tick);
+            }
+
+            uint64_t end_tsc = utils::rdtsc();
+            latency_recorder_.record(start_tsc, end_tsc);
+            if (bursts_.size() < bursts_.capacity()) {
+                bursts_.push_back({burst_ticks, queue_delay, end_tsc - start_tsc});
+            }
+        }
+    }
+
+    // Function: apply_tick
+    // Description: Applies one tick. Trades are matched against the simulated exchange,
+    //              depth updates go into the order book.
+    // Inputs: tick - The tick to apply.
+    // Outputs: True if the order book changed.
+    bool StrategyEngine::apply_tick(const BinaryTick& tick) {
+        // Handle Initialization (an empty snapshot carries no price to center on)
+        if (!order_book_) {
+            if (tick.price <= 0) return false;
+            order_book_ = std::make_unique<DenseOrderBook>(tick.price);
+            std::cout << "[Strategy] OrderBook initialized at price: " << tick.price << std::endl;
+        }
+
+        if (tick.is_trade) {
+            // Process Fills via Matching Engine (sized by the print quantity)
+            size_t first_fill = fills_.size();
+            matching_engine_.on_trade_update(tick.price, tick.quantity, tick.timestamp, fills_);
+            for (size_t i = first_fill; i < fills_.size(); ++i) {
+                const auto& fill = fills_[i];
+                position_qty_ += fill.is_buy ? fill.quantity : -fill.quantity;
+                if (has_working_order_ && fill.order_id == working_order_.id) {
+                    working_order_.quantity -= fill.quantity;
+                    if (fill.is_complete) has_working_order_ = false;
+                }
+            }
+            // Round away from zero so a partial fill still counts as a lot of inventory
+            position_ = (position_qty_ + (position_qty_ > 0 ? ORDER_QTY - 1 : position_qty_ < 0 ? 1 - ORDER_QTY : 0)) / ORDER_QTY;
+            return false; // Skip OFI calculation for Trade ticks
+        }
+
+        // Process Depth Update. A snapshot replaces the book: levels deleted while the
+        // feed was recovering would otherwise never be removed.
+        TRACE_SCOPE(BOOK_UPDATE);
+        if (tick.is_snapshot && !in_snapshot_) order_book_->clear();
+        in_snapshot_ = tick.is_snapshot && !tick.end_of_message;
+        order_book_->on_update(tick.is_bid, tick.price, tick.quantity);
+        return true;
+    }
+
+    // Function: evaluate_signal
+    // Description: Computes OFI on the current book, smooths it and runs the quoting state machine.
+    // Inputs: tick - The last tick applied (origin timestamp / symbol for new orders).
+    // Outputs: None.
+    void StrategyEngine::evaluate_signal(const BinaryTick& tick) {
+        // 1. Alpha Calculation: Order Flow Imbalance (OFI)
+        TRACE_BEGIN(ofi_begin);
+        int64_t ofi = order_book_->compute_ofi();
+        
+        // 2. Signal Smoothing (EWMA) - Integer Arithmetic
+        // smoothed_t = alpha * x_t + (1-alpha) * smoothed_{t-1}
+        smoothed_ofi_ = (ALPHA_NUM * ofi + ((1LL << ALPHA_SHIFT) - ALPHA_NUM) * smoothed_ofi_) >> ALPHA_SHIFT;
+        TRACE_END(OFI, ofi_begin);
+
+        // 3. Execution Logic: Market Making with State Machine
+        TRACE_SCOPE(DECISION);
+        if (std::abs(smoothed_ofi_) > OFI_THRESHOLD) {
+            bool is_buy_signal = smoothed_ofi_ > OFI_THRESHOLD;
+            bool is_sell_signal = smoothed_ofi_ < -OFI_THRESHOLD;
+            
+            bool trade_signal = false;
+            bool close_signal = false;
+            bool reprice_signal = false;
+            bool is_buy_order = false;
+
+            // State Transitions
+            if (current_state_ == State::FLAT) {
+                if (has_working_order_) {
+                    // Close still resting: follow the signal on its side, never pull it for a new entry
+                    if (working_order_.is_buy == is_buy_signal) {
+                        reprice_signal = true;
+                        is_buy_order = working_order_.is_buy;
                     }
-                    latency_recorder_.record(start_tsc, utils::rdtsc());
-                    continue; // Skip OFI calculation for Trade ticks
+                } else if (is_buy_signal) {
+                    trade_signal = true;
+                    is_buy_order = true;
+                } else if (is_sell_signal) {
+                    trade_signal = true;
+                    is_buy_order = false;
+                }
+            } else if (current_state_ == State::LONG) {
+                if (is_sell_signal) {
+                    close_signal = true;
+                    is_buy_order = false;
+                } else if (has_working_order_ && working_order_.is_buy) {
+                    // Entry bid still resting: follow the signal
+                    reprice_signal = true;
+                    is_buy_order = true;
+                }
+            } else if (current_state_ == State::SHORT) {
+                if (is_buy_signal) {
+                    close_signal = true;
+                    is_buy_order = true;
+                } else if (has_working_order_ && !working_order_.is_buy) {
+                    reprice_signal = true;
+                    is_buy_order = false;
                 }
+            }
 
-                // Process Depth Update
-                order_book->on_update(tick.is_bid, tick.price, tick.quantity);
-                
-                // 1. Alpha Calculation: Order Flow Imbalance (OFI)
-                int64_t ofi = order_book->compute_ofi();
-                
-                // 2. Signal Smoothing (EWMA) - Integer Arithmetic
-                // smoothed_t = alpha * x_t + (1-alpha) * smoothed_{t-1}
-                smoothed_ofi = (ALPHA_NUM * ofi + ((1LL << ALPHA_SHIFT) - ALPHA_NUM) * smoothed_ofi) >> ALPHA_SHIFT;
-
-                // 3. Execution Logic: Market Making with State Machine
-                if (std::abs(smoothed_ofi) > OFI_THRESHOLD) {
-                    bool is_buy_signal = smoothed_ofi > OFI_THRESHOLD;
-                    bool is_sell_signal = smoothed_ofi < -OFI_THRESHOLD;
+            if (trade_signal || close_signal || reprice_signal) {
+                // Risk Check: Position Limits
+                if ((is_buy_order && position_ < MAX_POSITION) || (!is_buy_order && position_ > -MAX_POSITION)) {
+                    
+                    // Pricing Logic: Skewed Quotes
+                    int64_t mid_price = order_book_->get_mid_price();
+                    int64_t spread = order_book_->get_best_ask() - order_book_->get_best_bid();
+                    int64_t fair_price = mid_price + (smoothed_ofi_ / SKEW_DIVISOR) - (position_ * INVENTORY_SKEW);
+                    
+                    // Passive Execution: Quote at Fair Price +/- Half Spread
+                    int64_t execution_price = is_buy_order ? (fair_price - spread / 2) : (fair_price + spread / 2);
                     
-                    bool trade_signal = false;
-                    bool close_signal = false;
-                    bool is_buy_order = false;
-
-                    // State Transitions
-                    if (current_state_ == State::FLAT) {
-                        if (is_buy_signal) {
-                            trade_signal = true;
-                            is_buy_order = true;
-                        } else if (is_sell_signal) {
-                            trade_signal = true;
-                            is_buy_order = false;
+                    // Safety: Prevent crossing the book aggressively
+                    if (is_buy_order && execution_price >= order_book_->get_best_ask()) execution_price = order_book_->get_best_ask() - constants::PRICE_SCALE;
+                    if (!is_buy_order && execution_price <= order_book_->get_best_bid()) execution_price = order_book_->get_best_bid() + constants::PRICE_SCALE;
+
+                    if (execution_price > 0 && reprice_signal) {
+                        // Amend the resting quote rather than stacking a second one
+                        if (execution_price != working_order_.price) {
+                            Order amend = working_order_;
+                            amend.action = OrderAction::REPLACE;
+                            amend.origin_timestamp = tick.timestamp;
+                            amend.price = execution_price;
+
+                            if (push_order(amend, tick)) {
+                                matching_engine_.submit(amend, tick.timestamp);
+                                working_order_.price = execution_price;
+                            }
                         }
-                    } else if (current_state_ == State::LONG && is_sell_signal) {
-                        close_signal = true;
-                        is_buy_order = false;
-                    } else if (current_state_ == State::SHORT && is_buy_signal) {
-                        close_signal = true;
-                        is_buy_order = true;
-                    }
+                    } else if (execution_price > 0) {
+                        // Pull the stale quote before changing direction
+                        if (has_working_order_) {
+                            Order cancel = working_order_;
+                            cancel.action = OrderAction::CANCEL;
+                            cancel.origin_timestamp = tick.timestamp;
+
+                            if (!push_order(cancel, tick)) {
+                                // Gateway queue full: the quote is still live, so neither
+                                // stack a new one nor go FLAT. The next signal retries.
+                                return;
+                            }
+                            matching_engine_.submit(cancel, tick.timestamp);
+                            has_working_order_ = false;
+                        }
+
+                        if (close_signal && position_qty_ == 0) {
+                            // Entry never filled: cancelling it already flattened us
+                            current_state_ = State::FLAT;
+                        } else {
+                            Order order;
+                            order.id = ++order_id_;
+                            order.origin_timestamp = tick.timestamp; 
+                            order.is_buy = is_buy_order;
+                            order.price = execution_price;
+                            // Closing only unwinds what actually filled (entries can fill partially)
+                            order.quantity = close_signal ? std::min(ORDER_QTY, std::abs(position_qty_)) : ORDER_QTY;
+                            order.symbol = tick.symbol;
+                            order.action = OrderAction::NEW;
 
-                    if (trade_signal || close_signal) {
-                        // Risk Check: Position Limits
-                        if ((is_buy_order && position < MAX_POSITION) || (!is_buy_order && position > -MAX_POSITION)) {
-                            
-                            // Pricing Logic: Skewed Quotes
-                            int64_t mid_price = order_book->get_mid_price();
-                            int64_t spread = order_book->get_best_ask() - order_book->get_best_bid();
-                            int64_t fair_price = mid_price + (smoothed_ofi / SKEW_DIVISOR) - (position * INVENTORY_SKEW);
-                            
-                            // Passive Execution: Quote at Fair Price +/- Half Spread
-                            int64_t execution_price = is_buy_order ? (fair_price - spread / 2) : (fair_price + spread / 2);
-                            
-                            // Safety: Prevent crossing the book aggressively
-                            if (is_buy_order && execution_price >= order_book->get_best_ask()) execution_price = order_book->get_best_ask() - constants::PRICE_SCALE;
-                            if (!is_buy_order && execution_price <= order_book->get_best_bid()) execution_price = order_book->get_best_bid() + constants::PRICE_SCALE;
-
-                            if (execution_price > 0) {
-                                Order order;
-                                order.id = ++order_id;
-                                order.origin_timestamp = tick.timestamp; 
-                                order.is_buy = is_buy_order;
-                                order.price = execution_price;
-                                order.quantity = constants::DEFAULT_ORDER_QTY * constants::PRICE_SCALE; 
-                                order.symbol = tick.symbol;
-
-                                if (output_buffer_.push(order)) {
-                                    // Place order in Matching Engine for simulation
-                                    matching_engine_.place_order(order, tick.timestamp);
-                                    
-                                    // Update State
-                                    if (trade_signal) {
-                                        current_state_ = is_buy_order ? State::LONG : State::SHORT;
-                                    } else if (close_signal) {
-                                        current_state_ = State::FLAT;
-                                    }
+                            if (push_order(order, tick)) {
+                                // Place order in Matching Engine for simulation
+                                matching_engine_.submit(order, tick.timestamp);
+                                working_order_ = order;
+                                has_working_order_ = true;
+                                
+                                // Update State
+                                if (trade_signal) {
+                                    current_state_ = is_buy_order ? State::LONG : State::SHORT;
+                                } else if (close_signal) {
+                                    current_state_ = State::FLAT;
                                 }
                             }
                         }
                     }
                 }
-                latency_recorder_.record(start_tsc, utils::rdtsc());
-            } else {
-                _mm_pause(); 
             }
         }
     }
 
+    // Function: push_order
+    // Description: Stamps the tick-to-wire timestamp vector and hands the order to the gateway.
+    // Inputs: order - The order to push.
+    //         tick - The tick that triggered it.
+    // Outputs: False if the gateway queue is full.
+    bool StrategyEngine::push_order(Order& order, const BinaryTick& tick) {
+        TRACE_SCOPE(ORDER_PUSH);
+        uint64_t rx = tick.rx_timestamp != 0 ? tick.rx_timestamp : tick.timestamp;
+        order.stamps = {};
+        if (tick.exchange_timestamp != 0) {
+            // Wall clock, so it includes the offset to the exchange's clock
+            int64_t d = utils::tsc_to_unix_ns(rx) - static_cast<int64_t>(tick.exchange_timestamp);
+            if (d > 0) order.stamps.exchange_to_rx_ns = d > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(d);
+        }
+        order.stamps.read = tick.rx_timestamp != 0 ? tick.rx_read_delta : 0;
+        // The gateway recovers the receive time as origin_timestamp - parse; later hops
+        // are measured from that same time
+        order.origin_timestamp = tick.timestamp;
+        order.stamps.parse = OrderTimestamps::delta(rx, tick.timestamp);
+        rx = tick.timestamp - order.stamps.parse;
+        order.stamps.strategy_pop = OrderTimestamps::delta(rx, pop_tsc_);
+        order.stamps.decision = OrderTimestamps::delta(rx, utils::rdtsc());
+        return output_buffer_.push(order);
+    }
+
     void StrategyEngine::save_fills_to_csv(const std::string& filename) {
         std::ofstream file(filename);
         file << "order_id,is_buy,price,quantity,fee\n";
@@ -188,4 +381,16 @@ namespace hft {
         std::cout << "[Strategy] Saved " << fills_.size() << " fills to " << filename << std::endl;
     }
 
+    void StrategyEngine::save_bursts_to_csv(const std::string& filename) {
+        std::ofstream file(filename);
+        file << "ticks,queue_delay_ns,latency_ns\n";
+        for (const auto& burst : bursts_) {
+            file << burst.ticks << ","
+                 << (burst.queue_delay / utils::CYCLES_PER_NS) << ","
+                 << (burst.latency / utils::CYCLES_PER_NS) << "\n";
+        }
+        file.close();
+        std::cout << "[Strategy] Saved " << bursts_.size() << " bursts to " << filename << std::endl;
+    }
+
 }
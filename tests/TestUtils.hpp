@@ -0,0 +1,16 @@
+#pragma once
+
+#include <iostream>
+
+namespace hft::test {
+
+    // Function: expect
+    // Description: Prints a [PASS]/[FAIL] line for one check.
+    // Inputs: condition - Check result, name - What was checked.
+    // Outputs: condition, so results can be folded with ok &= expect(...).
+    inline bool expect(bool condition, const char* name) {
+        std::cout << (condition ? "[PASS] " : "[FAIL] ") << name << std::endl;
+        return condition;
+    }
+
+}
@@ -0,0 +1,229 @@
+#include "storage/TickDataset.hpp"
+#include "storage/TickStore.hpp"
+#include "common/Types.hpp"
+#include "TestUtils.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Dataset Benchmark
+// Builds (or reuses) a directory of day partitions and measures time to first tick for
+// seeks into the middle of it:
+//   populate   the old FeedHandler::init path: mmap the day's file with MAP_POPULATE, then
+//              binary-search it for the start time
+//   dataset    TickDataset::seek on the whole directory (sparse index, lazy prefault)
+// Both are timed with a cold page cache (files evicted with POSIX_FADV_DONTNEED) and warm.
+// A range crossing partitions, one of them columnar, is streamed and checked tick by tick.
+// Usage: bench_dataset [dir] [days] [ticks_per_day]
+//   Default: ./bench_dataset, 8 days x 4M ticks (2 GB raw); every 4th day is written columnar
+
+namespace {
+
+    using hft::test::expect;
+
+    constexpr uint64_t DAY0_US = 1735689600000000ULL; // 2025-01-01
+    constexpr uint64_t DAY_US = 86400000000ULL;
+
+    struct Layout {
+        uint64_t days;
+        uint64_t ticks_per_day;
+        uint64_t step_us() const { return DAY_US / ticks_per_day; }
+        uint64_t timestamp(uint64_t g) const {
+            return DAY0_US + (g / ticks_per_day) * DAY_US + (g % ticks_per_day) * step_us();
+        }
+        // Global index of the first tick with timestamp >= ts
+        uint64_t first_at(uint64_t ts) const {
+            if (ts <= DAY0_US) return 0;
+            uint64_t day = (ts - DAY0_US) / DAY_US;
+            if (day >= days) return days * ticks_per_day;
+            uint64_t offset = ts - DAY0_US - day * DAY_US;
+            uint64_t in_day = std::min(ticks_per_day, (offset + step_us() - 1) / step_us());
+            return day * ticks_per_day + in_day;
+        }
+    };
+
+    hft::BinaryTick make_tick(const Layout& layout, uint64_t g) {
+        hft::BinaryTick t{};
+        t.id = g;
+        t.timestamp = layout.timestamp(g);
+        t.price = 10000000000000LL + static_cast<int64_t>((g * 2654435761ULL) % 20000) * 1000000;
+        t.quantity = static_cast<int64_t>((g * 40503ULL) % 100000000);
+        t.is_bid = g & 1;
+        t.end_of_message = g % 3 == 0;
+        t.exchange_timestamp = t.timestamp * 1000;
+        t.rx_timestamp = g * 2100;
+        return t;
+    }
+
+    bool columnar_day(uint64_t day) { return day % 4 == 3; }
+
+    std::string day_path(const std::string& dir, uint64_t day) {
+        char name[64];
+        snprintf(name, sizeof(name), "/2025-01-%02lu/BTC-USD.%s", static_cast<unsigned long>(day + 1),
+                 columnar_day(day) ? "tcol" : "ticks");
+        return dir + name;
+    }
+
+    void generate(const std::string& dir, const Layout& layout) {
+        std::vector<hft::BinaryTick> chunk(1 << 16);
+        for (uint64_t day = 0; day < layout.days; ++day) {
+            std::string path = day_path(dir, day);
+            std::error_code ec;
+            uint64_t expected = layout.ticks_per_day * sizeof(hft::BinaryTick);
+            if (std::filesystem::exists(path, ec) && (columnar_day(day) || std::filesystem::file_size(path, ec) == expected)) {
+                continue;
+            }
+            std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+            std::remove((path + ".tidx").c_str());
+            uint64_t first = day * layout.ticks_per_day;
+            if (columnar_day(day)) {
+                hft::storage::TickStoreWriter writer(path);
+                writer.open();
+                for (uint64_t g = first; g < first + layout.ticks_per_day; ++g) writer.append(make_tick(layout, g));
+                writer.close();
+                continue;
+            }
+            FILE* f = fopen(path.c_str(), "wb");
+            for (uint64_t g = first; g < first + layout.ticks_per_day; g += chunk.size()) {
+                size_t n = std::min<uint64_t>(chunk.size(), first + layout.ticks_per_day - g);
+                for (size_t i = 0; i < n; ++i) chunk[i] = make_tick(layout, g + i);
+                fwrite(chunk.data(), sizeof(hft::BinaryTick), n, f);
+            }
+            fclose(f);
+        }
+    }
+
+    // Drops the dataset's pages (and index files) from the page cache
+    void evict(const std::string& dir) {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir, ec)) {
+            if (!entry.is_regular_file(ec)) continue;
+            int fd = open(entry.path().c_str(), O_RDONLY);
+            if (fd < 0) continue;
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+
+    double ms_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Function: populate_seek
+    // Description: Time to first tick the way FeedHandler::init used to get there.
+    double populate_seek(const std::string& path, uint64_t ts, uint64_t& id) {
+        auto start = std::chrono::steady_clock::now();
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat st;
+        fstat(fd, &st);
+        void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        close(fd);
+        const auto* ticks = static_cast<const hft::BinaryTick*>(map);
+        size_t count = st.st_size / sizeof(hft::BinaryTick);
+        const auto* it = std::lower_bound(ticks, ticks + count, ts,
+                                          [](const hft::BinaryTick& t, uint64_t v) { return t.timestamp < v; });
+        id = it->id;
+        double ms = ms_since(start);
+        munmap(map, st.st_size);
+        return ms;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    std::string dir = argc > 1 ? argv[1] : "bench_dataset";
+    Layout layout{argc > 2 ? std::stoul(argv[2]) : 8, argc > 3 ? std::stoul(argv[3]) : 4000000};
+    if (layout.days < 4) layout.days = 4;
+
+    std::cout << "Dataset: " << layout.days << " days x " << layout.ticks_per_day << " ticks ("
+              << layout.days * layout.ticks_per_day * sizeof(hft::BinaryTick) / 1e9 << " GB raw) in " << dir << std::endl;
+    generate(dir, layout);
+    bool ok = true;
+
+    // Open: first time builds the sparse indexes, after that they are loaded
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir, ec)) {
+        if (entry.path().extension() == ".tidx") std::filesystem::remove(entry.path(), ec);
+    }
+    evict(dir);
+    hft::storage::TickDataset dataset;
+    auto start = std::chrono::steady_clock::now();
+    if (!expect(dataset.open(dir), "Dataset opens")) return 1;
+    double open_build_ms = ms_since(start);
+    evict(dir);
+    start = std::chrono::steady_clock::now();
+    dataset.open(dir);
+    double open_load_ms = ms_since(start);
+    ok &= expect(dataset.files().size() == layout.days && dataset.tick_count() == layout.days * layout.ticks_per_day,
+                 "All partitions found");
+
+    // Seeks into raw days, away from partition edges
+    std::vector<uint64_t> targets;
+    for (uint64_t day = 0; day < layout.days; ++day) {
+        if (columnar_day(day)) continue;
+        for (double frac : {0.37, 0.71}) targets.push_back(DAY0_US + day * DAY_US + static_cast<uint64_t>(frac * DAY_US) + 7);
+    }
+
+    double populate_cold = 0, populate_warm = 0, dataset_cold = 0, dataset_warm = 0;
+    bool landed = true;
+    for (uint64_t ts : targets) {
+        uint64_t expected = layout.first_at(ts);
+        std::string path = day_path(dir, (ts - DAY0_US) / DAY_US);
+        uint64_t id = 0;
+
+        evict(dir);
+        populate_cold += populate_seek(path, ts, id);
+        landed &= id == expected;
+        populate_warm += populate_seek(path, ts, id);
+
+        for (bool warm : {false, true}) {
+            if (!warm) evict(dir);
+            start = std::chrono::steady_clock::now();
+            bool found = dataset.seek(ts);
+            auto first = dataset.next();
+            (warm ? dataset_warm : dataset_cold) += ms_since(start);
+            landed &= found && !first.empty() && first.front().id == expected;
+        }
+    }
+    ok &= expect(landed, "Every seek lands on the first tick at or after the target");
+
+    // A range from the middle of one day into a columnar day, streamed end to end
+    uint64_t day = 2;
+    uint64_t from = DAY0_US + day * DAY_US + DAY_US / 2 + 13;
+    uint64_t to = DAY0_US + (day + 1) * DAY_US + DAY_US / 3;
+    uint64_t expected_first = layout.first_at(from);
+    uint64_t expected_end = layout.first_at(to + 1);
+    evict(dir);
+    start = std::chrono::steady_clock::now();
+    uint64_t next_id = expected_first;
+    uint64_t streamed = 0;
+    bool in_order = dataset.seek(from, to);
+    for (auto ticks = dataset.next(); !ticks.empty(); ticks = dataset.next()) {
+        for (const auto& t : ticks) {
+            in_order &= t.id == next_id++ && t.timestamp >= from && t.timestamp <= to && t.timestamp == layout.timestamp(t.id);
+        }
+        streamed += ticks.size();
+    }
+    double stream_ms = ms_since(start);
+    ok &= expect(in_order && streamed == expected_end - expected_first, "Range streams every tick in order, across a columnar partition");
+    ok &= expect(!dataset.seek(DAY0_US + layout.days * DAY_US), "Seek past the end finds nothing");
+
+    size_t n = targets.size();
+    printf("\nopen: %.1f ms building indexes, %.1f ms loading them (cold)\n", open_build_ms, open_load_ms);
+    printf("\nTime to first tick, mid-partition seeks (ms, mean of %zu)\n", n);
+    printf("%-10s %10s %10s\n", "path", "cold", "warm");
+    printf("%-10s %10.3f %10.3f\n", "populate", populate_cold / n, populate_warm / n);
+    printf("%-10s %10.3f %10.3f\n", "dataset", dataset_cold / n, dataset_warm / n);
+    printf("\nstream: %lu ticks across 2 partitions in %.1f ms cold (%.1f M ticks/s)\n",
+           static_cast<unsigned long>(streamed), stream_ms, streamed / stream_ms / 1e3);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+#include "network/DPDKPoller.hpp"
+#include "common/Utils.hpp"
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// DPDK Poll Benchmark
+// Cycles per packet of DPDKPoller::poll on a DPDK virtual device (no NIC or hugepages):
+//   pcap   net_pcap replays a generated capture of Coinbase SBE datagrams in a loop
+//          (infinite_rx); every 8th frame goes to another port and is filtered out
+//   null   net_null returns zero-filled frames, all rejected by the parse: the floor cost
+//          of rx burst, prefetch, classification and bulk free
+// The device is timed with a handler inlined through poll<Handler> and with the same
+// handler behind a std::function (the previous poll signature: one indirect call per packet).
+// Usage: bench_dpdk_poll [packets] [--vdev pcap|null]
+
+namespace {
+
+    constexpr uint16_t FEED_PORT = 1234;
+    constexpr const char* FEED_GROUP = "239.1.1.1";
+    constexpr size_t FRAMES = 1024;
+    constexpr size_t ENTRIES = 4;
+    constexpr const char* PCAP_PATH = "/tmp/bench_dpdk_poll.pcap";
+
+    template <typename T>
+    void put(std::vector<uint8_t>& out, T value) {
+        uint8_t raw[sizeof(T)];
+        std::memcpy(raw, &value, sizeof(T));
+        out.insert(out.end(), raw, raw + sizeof(T));
+    }
+
+    template <typename T>
+    void put_be(std::vector<uint8_t>& out, T value) {
+        if constexpr (sizeof(T) == 2) put<uint16_t>(out, htons(value));
+        else put<uint32_t>(out, htonl(value));
+    }
+
+    // packetHeader + MDIncrementalRefreshBook (202), as tools/udp_gen.py encodes it
+    std::vector<uint8_t> book_packet(uint32_t seq) {
+        std::vector<uint8_t> out;
+        put<uint32_t>(out, seq);
+        put<uint64_t>(out, 0);
+        for (uint16_t v : {uint16_t(9), uint16_t(202), uint16_t(1), uint16_t(1)}) put(out, v);
+        put<uint64_t>(out, 0);
+        put<uint8_t>(out, 0x80);
+        put<uint16_t>(out, 28);
+        put<uint16_t>(out, ENTRIES);
+        for (size_t i = 0; i < ENTRIES; ++i) {
+            put<int64_t>(out, 9600000 + static_cast<int64_t>(i));
+            put<int8_t>(out, -2);
+            put<int64_t>(out, 100000000);
+            put<int8_t>(out, -8);
+            put<int32_t>(out, 1);
+            put<uint32_t>(out, seq * ENTRIES + static_cast<uint32_t>(i));
+            put<uint8_t>(out, static_cast<uint8_t>(i & 1));
+            put<uint8_t>(out, 1);
+        }
+        return out;
+    }
+
+    // Ethernet / IPv4 / UDP frame to group:port
+    std::vector<uint8_t> udp_frame(const std::vector<uint8_t>& payload, uint16_t port) {
+        std::vector<uint8_t> frame = {0x01, 0x00, 0x5e, 0x01, 0x01, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+        put_be<uint16_t>(frame, 0x0800);
+        in_addr src{};
+        in_addr dst{};
+        inet_pton(AF_INET, "10.0.0.1", &src);
+        inet_pton(AF_INET, FEED_GROUP, &dst);
+        put<uint8_t>(frame, 0x45);
+        put<uint8_t>(frame, 0);
+        put_be<uint16_t>(frame, static_cast<uint16_t>(20 + 8 + payload.size()));
+        put_be<uint16_t>(frame, 0);
+        put_be<uint16_t>(frame, 0x4000); // Don't fragment
+        put<uint8_t>(frame, 64);
+        put<uint8_t>(frame, 17);
+        put_be<uint16_t>(frame, 0);
+        put<uint32_t>(frame, src.s_addr);
+        put<uint32_t>(frame, dst.s_addr);
+        put_be<uint16_t>(frame, 40000);
+        put_be<uint16_t>(frame, port);
+        put_be<uint16_t>(frame, static_cast<uint16_t>(8 + payload.size()));
+        put_be<uint16_t>(frame, 0);
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        return frame;
+    }
+
+    // Classic pcap (microsecond timestamps, Ethernet link type)
+    bool write_pcap(const char* path) {
+        FILE* file = std::fopen(path, "wb");
+        if (file == nullptr) return false;
+        std::vector<uint8_t> out;
+        put<uint32_t>(out, 0xa1b2c3d4);
+        put<uint16_t>(out, 2);
+        put<uint16_t>(out, 4);
+        put<uint32_t>(out, 0);
+        put<uint32_t>(out, 0);
+        put<uint32_t>(out, 65535);
+        put<uint32_t>(out, 1);
+        for (uint32_t i = 0; i < FRAMES; ++i) {
+            auto frame = udp_frame(book_packet(i + 1), i % 8 == 7 ? FEED_PORT + 1 : FEED_PORT);
+            put<uint32_t>(out, 0);
+            put<uint32_t>(out, i);
+            put<uint32_t>(out, static_cast<uint32_t>(frame.size()));
+            put<uint32_t>(out, static_cast<uint32_t>(frame.size()));
+            out.insert(out.end(), frame.begin(), frame.end());
+        }
+        bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+        std::fclose(file);
+        return ok;
+    }
+
+    struct Sink {
+        uint64_t delivered = 0;
+        uint64_t bytes = 0;
+        uint8_t check = 0;
+    };
+
+    template <typename Handler>
+    void run(const char* name, hft::network::DPDKPoller& poller, size_t packets, Handler&& handler, Sink& sink) {
+        sink = {};
+        // Warm up the pools and queue
+        for (size_t rx = 0; rx < packets / 10;) rx += poller.poll(handler);
+
+        sink = {};
+        size_t rx = 0;
+        uint64_t start = hft::utils::rdtsc();
+        while (rx < packets) rx += poller.poll(handler);
+        uint64_t cycles = hft::utils::rdtsc() - start;
+
+        printf("%-16s %12zu %12lu %14.1f %12.1f\n", name, rx, static_cast<unsigned long>(sink.delivered),
+               static_cast<double>(cycles) / rx, static_cast<double>(cycles) / rx / hft::utils::CYCLES_PER_NS);
+    }
+
+}
+
+int main(int argc, char** argv) {
+#ifndef USE_DPDK
+    printf("bench_dpdk_poll needs a DPDK build (ENABLE_DPDK with libdpdk found).\n");
+    return 0;
+#endif
+    size_t packets = 10000000;
+    std::string vdev = "pcap";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--vdev") == 0 && i + 1 < argc) {
+            vdev = argv[++i];
+        } else {
+            packets = std::stoul(argv[i]);
+        }
+    }
+
+    std::string vdev_arg;
+    if (vdev == "null") {
+        vdev_arg = "--vdev=net_null0";
+    } else {
+        if (!write_pcap(PCAP_PATH)) {
+            fprintf(stderr, "Cannot write %s\n", PCAP_PATH);
+            return 1;
+        }
+        vdev_arg = std::string("--vdev=net_pcap0,rx_pcap=") + PCAP_PATH + ",infinite_rx=1";
+    }
+    std::vector<std::string> eal_args = {"bench_dpdk_poll", "--no-pci", "--no-huge", "-m", "256", "-l", "0", vdev_arg};
+    std::vector<char*> eal_argv;
+    for (auto& arg : eal_args) eal_argv.push_back(arg.data());
+
+    hft::utils::calibrate_tsc();
+    hft::network::DPDKPoller poller(0);
+    poller.init(static_cast<int>(eal_argv.size()), eal_argv.data());
+    poller.add_flow(FEED_GROUP, FEED_PORT);
+    poller.start();
+
+    Sink sink;
+    auto handler = [&sink](const uint8_t* payload, uint16_t len, size_t, uint64_t, uint64_t) {
+        ++sink.delivered;
+        sink.bytes += len;
+        sink.check ^= payload[0];
+    };
+    std::function<void(const uint8_t*, uint16_t, size_t, uint64_t, uint64_t)> indirect = handler;
+
+    printf("net_%s, %zu packets per run\n", vdev.c_str(), packets);
+    printf("%-16s %12s %12s %14s %12s\n", "handler", "rx", "delivered", "cycles/packet", "ns/packet");
+    run("poll<Handler>", poller, packets, handler, sink);
+    run("std::function", poller, packets, indirect, sink);
+    printf("(check %u)\n", sink.check);
+    return 0;
+}
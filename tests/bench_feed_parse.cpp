@@ -0,0 +1,157 @@
+#include "feed_handler/CoinbaseLive.hpp"
+#include "common/RingBuffer.hpp"
+#include "common/Types.hpp"
+#include "common/Utils.hpp"
+#include "storage/CaptureReader.hpp"
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <string>
+
+// Feed Parse Benchmark
+// Replays captured market_data.bin through CoinbaseFeedHandler::process_message as fast
+// as possible and reports parse throughput in MB/s and messages/s, plus feed-thread TSC
+// cycles per message (parse and ring publication), for both the
+// in-place path (buffers carry SIMDJSON_PADDING slack) and the copying fallback.
+// Then prices one event in isolation: synthetic messages carrying a single market_trades
+// print, or a single level2 update for comparison, reported as ns per event.
+// Usage: bench_feed_parse [market_data.bin] [passes]
+
+namespace {
+
+    struct PassResult {
+        double seconds;
+        uint64_t cycles;
+        uint64_t ticks;
+    };
+
+    // Function: run_pass
+    // Description: One pass over all messages with a fresh handler (sequence and snapshot
+    //              state start clean). A consumer thread drains the ring so large snapshots
+    //              never block the publisher.
+    PassResult run_pass(const std::vector<std::string>& messages, bool in_place) {
+        auto ring = std::make_unique<hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE>>();
+        hft::CoinbaseFeedHandler handler(*ring, false);
+
+        std::atomic<bool> done{false};
+        uint64_t ticks = 0;
+        std::thread consumer([&] {
+            hft::BinaryTick tick;
+            while (true) {
+                if (ring->pop(tick)) {
+                    ++ticks;
+                } else if (done.load(std::memory_order_acquire)) {
+                    break;
+                } else {
+                    hft::utils::cpu_relax();
+                }
+            }
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t start_tsc = hft::utils::rdtsc();
+        for (const auto& msg : messages) {
+            handler.process_message(msg, 0, in_place ? msg.capacity() : 0);
+        }
+        uint64_t cycles = hft::utils::rdtsc() - start_tsc;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        done.store(true, std::memory_order_release);
+        consumer.join();
+        return {seconds, cycles, ticks};
+    }
+
+    std::string envelope(const char* channel, uint64_t sequence_num, const std::string& events) {
+        return std::string(R"({"channel":")") + channel +
+               R"(","client_id":"","timestamp":"2025-01-01T00:00:00.123456789Z","sequence_num":)" +
+               std::to_string(sequence_num) + R"(,"events":)" + events + "}";
+    }
+
+    // Function: single_event_messages
+    // Description: A one-level snapshot (to synchronize the handler) followed by count
+    //              messages of one trade print, or of one level2 update, in sequence.
+    std::vector<std::string> single_event_messages(size_t count, bool trades) {
+        std::vector<std::string> messages;
+        messages.push_back(envelope("l2_data", 0,
+            R"([{"type":"snapshot","product_id":"BTC-USD","updates":[{"side":"bid","event_time":"2025-01-01T00:00:00.123456Z","price_level":"99999.99","new_quantity":"1.5"}]}])"));
+        for (size_t i = 0; i < count; ++i) {
+            std::string price = std::to_string(99990 + i % 20) + "." + std::to_string(10 + i % 90);
+            std::string size = "0." + std::to_string(10000000 + (i * 7919) % 90000000);
+            bool buy = i & 1;
+            if (trades) {
+                messages.push_back(envelope("market_trades", i + 1,
+                    R"([{"type":"update","trades":[{"trade_id":")" + std::to_string(700000000 + i) +
+                    R"(","product_id":"BTC-USD","price":")" + price + R"(","size":")" + size +
+                    R"(","side":")" + (buy ? "BUY" : "SELL") + R"(","time":"2025-01-01T00:00:00.123456Z"}]}])"));
+            } else {
+                messages.push_back(envelope("l2_data", i + 1,
+                    R"([{"type":"update","product_id":"BTC-USD","updates":[{"side":")" + std::string(buy ? "bid" : "offer") +
+                    R"(","event_time":"2025-01-01T00:00:00.123456Z","price_level":")" + price +
+                    R"(","new_quantity":")" + size + R"("}]}])"));
+            }
+        }
+        for (auto& m : messages) m.reserve(m.size() + simdjson::SIMDJSON_PADDING);
+        return messages;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "market_data.bin";
+    int passes = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    hft::storage::CaptureReader reader;
+    if (!reader.open(path)) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> messages;
+    uint64_t total_bytes = 0;
+    hft::storage::CaptureRecord record;
+    while (reader.next(record)) {
+        std::string data;
+        data.reserve(record.data.size() + simdjson::SIMDJSON_PADDING);
+        data.assign(record.data);
+        total_bytes += data.size();
+        messages.push_back(std::move(data));
+    }
+    std::cout << "Loaded " << messages.size() << " messages (" << total_bytes / 1e6 << " MB)" << std::endl;
+    if (messages.empty()) return 1;
+
+    for (bool in_place : {true, false}) {
+        double best = 1e30;
+        uint64_t best_cycles = UINT64_MAX;
+        uint64_t ticks = 0;
+        for (int i = 0; i < passes; ++i) {
+            PassResult r = run_pass(messages, in_place);
+            best = std::min(best, r.seconds);
+            best_cycles = std::min(best_cycles, r.cycles);
+            ticks = r.ticks;
+        }
+        std::cout << (in_place ? "  in-place: " : "  copy:     ")
+                  << total_bytes / 1e6 / best << " MB/s, "
+                  << messages.size() / best / 1e6 << " M msgs/s, "
+                  << ticks / best / 1e6 << " M ticks/s, "
+                  << best_cycles / messages.size() << " cycles/msg" << std::endl;
+    }
+
+    // Per-event cost (in place, best pass; the snapshot is one message in 200k)
+    constexpr size_t EVENTS = 200000;
+    for (bool trades : {true, false}) {
+        std::vector<std::string> events = single_event_messages(EVENTS, trades);
+        double best = 1e30;
+        uint64_t ticks = 0;
+        for (int i = 0; i < passes; ++i) {
+            PassResult r = run_pass(events, true);
+            best = std::min(best, r.seconds);
+            ticks = r.ticks;
+        }
+        std::cout << (trades ? "  trade:    " : "  l2 update:") << " " << best * 1e9 / EVENTS << " ns/event ("
+                  << ticks - 1 << " of " << EVENTS << " published)" << std::endl;
+    }
+
+    return 0;
+}
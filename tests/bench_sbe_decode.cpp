@@ -0,0 +1,476 @@
+#include "feed_handler/CoinbaseUDP.hpp"
+#include "strategy/OrderBook.hpp"
+#include "common/RingBuffer.hpp"
+#include "common/Types.hpp"
+#include "common/Utils.hpp"
+#include "TestUtils.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// SBE Decode Benchmark
+// Encodes synthetic packets in the layout tools/udp_gen.py sends (schema
+// coinbase_market_data.xml) and runs them through CoinbaseUDPHandler::on_packet:
+//   checks   every entry of every message is published, exponents are normalized to 1e-8,
+//            deletes carry quantity 0, end_of_message closes each message, and truncated,
+//            foreign or extended (larger blockLength) messages are handled
+//   A/B      duplicates are dropped, one line's losses are filled by the other through the
+//            reorder window, a loss on both lines is a gap healed by a snapshot, a packet
+//            too large to hold is decoded in place, payload keys that collide are counted
+//            and both messages published, and a level deleted inside a hole is gone from
+//            the book once the recovery snapshot is applied
+//   timing   ns per entry and per packet for book updates of 1..64 entries per message,
+//            ring publication included (the ring is drained between chunks), then the
+//            per-packet cost of arbitrating two lines against one
+// Usage: bench_sbe_decode [packets]
+
+namespace {
+
+    using hft::test::expect;
+
+    using Ring = hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE>;
+
+    constexpr uint64_t TRANSACT_NS = 1735689600123456789ULL;
+
+    struct Level {
+        int64_t price_mantissa;
+        int8_t price_exponent;
+        int64_t size_mantissa;
+        int8_t size_exponent;
+        uint8_t side;
+        uint8_t action;
+        uint32_t rpt_seq;
+    };
+
+    // Little endian packet encoder (mirrors tools/udp_gen.py)
+    class Encoder {
+    public:
+        template <typename T>
+        void put(T value) {
+            uint8_t raw[sizeof(T)];
+            std::memcpy(raw, &value, sizeof(T));
+            bytes.insert(bytes.end(), raw, raw + sizeof(T));
+        }
+        void pad(size_t n) { bytes.resize(bytes.size() + n, 0); }
+
+        void packet(uint32_t seq) {
+            put<uint32_t>(seq);
+            put<uint64_t>(TRANSACT_NS);
+        }
+
+        void header(uint16_t block, uint16_t template_id, uint16_t schema = 1) {
+            put<uint16_t>(block);
+            put<uint16_t>(template_id);
+            put<uint16_t>(schema);
+            put<uint16_t>(1);
+        }
+        void decimal(int64_t mantissa, int8_t exponent) {
+            put<int64_t>(mantissa);
+            put<int8_t>(exponent);
+        }
+
+        // extra: bytes appended to the root block and to every entry (newer schema version)
+        void book(const std::vector<Level>& levels, size_t extra = 0) {
+            header(static_cast<uint16_t>(9 + extra), 202);
+            put<uint64_t>(TRANSACT_NS);
+            put<uint8_t>(0x80);
+            pad(extra);
+            put<uint16_t>(static_cast<uint16_t>(28 + extra));
+            put<uint16_t>(static_cast<uint16_t>(levels.size()));
+            for (const Level& l : levels) {
+                decimal(l.price_mantissa, l.price_exponent);
+                decimal(l.size_mantissa, l.size_exponent);
+                put<int32_t>(1);
+                put<uint32_t>(l.rpt_seq);
+                put<uint8_t>(l.side);
+                put<uint8_t>(l.action);
+                pad(extra);
+            }
+        }
+        void trade(int64_t price, int8_t exponent, int64_t size, uint8_t aggressor, uint32_t rpt_seq) {
+            header(9, 203);
+            put<uint64_t>(TRANSACT_NS + 1);
+            put<uint8_t>(0x80);
+            put<uint16_t>(35);
+            put<uint16_t>(1);
+            decimal(price, exponent);
+            decimal(size, -8);
+            put<int32_t>(1);
+            put<uint32_t>(rpt_seq);
+            put<uint64_t>(777);
+            put<uint8_t>(aggressor);
+        }
+        // A packet carrying one snapshot message
+        static std::vector<uint8_t> snapshot_packet(size_t levels, uint32_t last_rpt_seq) {
+            Encoder e;
+            e.packet(1);
+            e.snapshot(levels, last_rpt_seq);
+            return e.bytes;
+        }
+        void snapshot(size_t levels, uint32_t last_rpt_seq) {
+            header(16, 201);
+            put<uint64_t>(TRANSACT_NS);
+            put<int32_t>(1);
+            put<uint32_t>(last_rpt_seq);
+            put<uint16_t>(19);
+            put<uint16_t>(static_cast<uint16_t>(levels));
+            for (size_t i = 0; i < levels; ++i) {
+                decimal(10000000 + static_cast<int64_t>(i), -2);
+                decimal(5, -1);
+                put<uint8_t>(i % 2);
+            }
+        }
+        void heartbeat() {
+            header(8, 0);
+            put<uint64_t>(TRANSACT_NS);
+        }
+
+        std::vector<uint8_t> bytes;
+    };
+
+    // Consecutive book packets of N entries from seq (and RptSeq) 1
+    std::vector<std::vector<uint8_t>> book_packets(std::mt19937_64& rng, size_t count, size_t entries, uint32_t& seq,
+                                                   uint32_t& rpt_seq);
+
+    std::vector<hft::BinaryTick> drain(Ring& ring) {
+        std::vector<hft::BinaryTick> ticks;
+        hft::BinaryTick t;
+        while (ring.pop(t)) ticks.push_back(t);
+        return ticks;
+    }
+
+    std::unique_ptr<hft::CoinbaseUDPHandler> synced_handler(Ring& ring, size_t lines = 1) {
+        auto handler = std::make_unique<hft::CoinbaseUDPHandler>(ring, lines);
+        auto packet = Encoder::snapshot_packet(0, 0);
+        handler->on_snapshot_packet(packet.data(), static_cast<uint16_t>(packet.size()));
+        drain(ring);
+        return handler;
+    }
+
+    Level random_level(std::mt19937_64& rng, uint32_t seq) {
+        // Exchange-style mixed precision: cents, or sub-cent ticks, sizes to 1e-8 or 1e-10
+        bool fine = rng() % 4 == 0;
+        return Level{static_cast<int64_t>(9000000 + rng() % 2000000) * (fine ? 10 : 1), static_cast<int8_t>(fine ? -3 : -2),
+                     static_cast<int64_t>(1 + rng() % 500000000), static_cast<int8_t>(rng() % 8 == 0 ? -10 : -8),
+                     static_cast<uint8_t>(rng() % 2), static_cast<uint8_t>(rng() % 3), seq};
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t packets = argc > 1 ? std::stoul(argv[1]) : 200000;
+    auto ring = std::make_unique<Ring>();
+    bool ok = true;
+
+    // 1. One packet: snapshot, book update (mixed exponents, a delete), trade, heartbeat
+    auto handler = std::make_unique<hft::CoinbaseUDPHandler>(*ring);
+    Encoder enc;
+    enc.packet(1);
+    enc.snapshot(4, 40);
+    enc.book({{10960001, -2, 6317902, -8, 0, 0, 41},
+              {1096000150, -4, 123456785, -9, 1, 1, 42},
+              {10960500, -2, 1, 0, 1, 2, 43}});
+    enc.trade(109600, 0, 25000000, 1, 44);
+    enc.heartbeat();
+    handler->on_packet(enc.bytes.data(), static_cast<uint16_t>(enc.bytes.size()), 0, 1234);
+    auto ticks = drain(*ring);
+
+    ok &= expect(ticks.size() == 4 + 3 + 1, "Every entry of every message is published");
+    if (ticks.size() == 8) {
+        bool snapshot = true;
+        for (size_t i = 0; i < 4; ++i) snapshot &= ticks[i].is_snapshot && ticks[i].id == 40 && ticks[i].quantity == 50000000;
+        ok &= expect(snapshot, "Snapshot levels flagged");
+        ok &= expect(ticks[4].price == 10960001000000LL && ticks[4].quantity == 6317902 && ticks[4].is_bid &&
+                     ticks[4].id == 41, "Book entry decoded");
+        ok &= expect(ticks[5].price == 10960001500000LL && ticks[5].quantity == 12345679 && !ticks[5].is_bid,
+                     "Exponents normalized to 1e-8 (rounded half away from zero)");
+        ok &= expect(ticks[6].quantity == 0 && ticks[6].price == 10960500000000LL, "Delete carries quantity 0");
+        ok &= expect(ticks[7].is_trade && ticks[7].price == 10960000000000LL && ticks[7].quantity == 25000000 &&
+                     ticks[7].is_bid && ticks[7].exchange_timestamp == TRANSACT_NS + 1,
+                     "Trade entry decoded (aggressor SELL hit a bid)");
+        ok &= expect(!ticks[2].end_of_message && ticks[3].end_of_message && !ticks[4].end_of_message &&
+                     !ticks[5].end_of_message && ticks[6].end_of_message && ticks[7].end_of_message,
+                     "end_of_message closes each message");
+        ok &= expect(ticks[4].exchange_timestamp == TRANSACT_NS && ticks[4].rx_timestamp == 1234 && ticks[4].timestamp != 0,
+                     "Transact time and receive TSC carried");
+    }
+    ok &= expect(handler->stats().messages == 4 && handler->stats().heartbeats == 1 && !handler->recovering(),
+                 "Message counters, book in sync");
+
+    // 2. Truncations: any cut inside a message drops it (and nothing before it)
+    Encoder pair;
+    pair.trade(100, 0, 1, 0, 1);
+    size_t first_len = pair.bytes.size();
+    pair.book({{100, 0, 1, 0, 0, 0, 2}, {101, 0, 1, 0, 0, 0, 3}});
+    bool truncations = true;
+    uint32_t seq = 0;
+    for (size_t cut = first_len + 1; cut < pair.bytes.size(); ++cut) {
+        handler = synced_handler(*ring);
+        Encoder e;
+        e.packet(++seq);
+        size_t header = e.bytes.size();
+        e.bytes.insert(e.bytes.end(), pair.bytes.begin(), pair.bytes.begin() + static_cast<long>(cut));
+        handler->on_packet(e.bytes.data(), static_cast<uint16_t>(e.bytes.size()));
+        auto got = drain(*ring);
+        bool header_only = cut - first_len < hft::sbe::coinbase::MessageHeader::ENCODED_LENGTH;
+        truncations &= e.bytes.size() - header == cut && got.size() == 1 && got[0].is_trade &&
+                       handler->stats().malformed == (header_only ? 0u : 1u);
+    }
+    ok &= expect(truncations, "Truncated messages rejected without losing earlier ones");
+
+    // 3. A group count that overruns the packet
+    handler = synced_handler(*ring);
+    Encoder overrun;
+    overrun.packet(1);
+    overrun.book({{100, 0, 1, 0, 0, 0, 1}});
+    overrun.bytes[12 + 8 + 9 + 2] = 200; // numInGroup
+    handler->on_packet(overrun.bytes.data(), static_cast<uint16_t>(overrun.bytes.size()));
+    ok &= expect(drain(*ring).empty() && handler->stats().malformed == 1, "Group count beyond the packet rejected");
+
+    // 4. Newer schema version: larger root and entry blocks are stepped over
+    handler = synced_handler(*ring);
+    Encoder extended;
+    extended.packet(1);
+    extended.book({{100, 0, 1, 0, 0, 0, 1}, {200, 0, 2, 0, 1, 0, 2}}, 6);
+    handler->on_packet(extended.bytes.data(), static_cast<uint16_t>(extended.bytes.size()));
+    ticks = drain(*ring);
+    ok &= expect(ticks.size() == 2 && ticks[1].price == 20000000000LL && ticks[1].quantity == 200000000 && !ticks[1].is_bid,
+                 "Extended blockLength decoded with the wire stride");
+
+    // 5. Another schema / an unknown template
+    Encoder foreign;
+    foreign.packet(2);
+    foreign.header(9, 202, 7);
+    foreign.pad(13);
+    handler->on_packet(foreign.bytes.data(), static_cast<uint16_t>(foreign.bytes.size()));
+    Encoder unknown;
+    unknown.packet(3);
+    unknown.header(4, 999);
+    unknown.pad(4);
+    unknown.trade(100, 0, 1, 0, 3);
+    handler->on_packet(unknown.bytes.data(), static_cast<uint16_t>(unknown.bytes.size()));
+    ok &= expect(drain(*ring).empty() && handler->stats().unknown == 2, "Foreign schema and unknown templates skipped");
+
+    // 6. A/B: B lags A by 3 packets; A loses 10% (B fills the holes), B loses a disjoint 10%
+    std::mt19937_64 rng(42);
+    uint32_t rpt_seq = 0;
+    seq = 0;
+    auto stream = book_packets(rng, 2000, 2, seq, rpt_seq);
+    handler = synced_handler(*ring, 2);
+    handler->set_reorder_timeout_ns(UINT64_MAX / 4);
+    auto feed = [&](size_t line, size_t i) {
+        handler->on_packet(stream[i].data(), static_cast<uint16_t>(stream[i].size()), line);
+    };
+    for (size_t i = 0; i < stream.size() + 3; ++i) {
+        if (i < stream.size() && i % 10 != 3) feed(0, i);
+        if (i >= 3 && (i - 3) % 10 != 7) feed(1, i - 3);
+    }
+    ticks = drain(*ring);
+    bool in_order = ticks.size() == stream.size() * 2;
+    for (size_t i = 0; i < ticks.size() && in_order; ++i) in_order = ticks[i].id == i + 1;
+    ok &= expect(in_order && handler->recovery_stats().gaps == 0 && handler->stats().reordered > 0,
+                 "One line's losses filled by the other, in order");
+    ok &= expect(handler->arbiter().stats(0).wins + handler->arbiter().stats(1).wins == stream.size() &&
+                 handler->arbiter().stats(1).duplicates > 0, "Duplicates dropped");
+
+    // 7. Both lines lose packet 5 (timeout) and packets 40..79 (window overflow): gap, then a snapshot heals it
+    handler = synced_handler(*ring, 2);
+    handler->set_reorder_timeout_ns(1000);
+    for (size_t i = 0; i < 10; ++i) {
+        if (i == 4) continue;
+        feed(0, i);
+        feed(1, i);
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    handler->poll(hft::utils::rdtsc());
+    bool stale = handler->recovering() && handler->recovery_stats().gaps == 1;
+    auto healing = Encoder::snapshot_packet(3, 20); // Packets 6..10 carry RptSeq 11..20
+    handler->on_snapshot_packet(healing.data(), static_cast<uint16_t>(healing.size()));
+    ticks = drain(*ring);
+    ok &= expect(stale && !handler->recovering() && ticks.size() == 8 + 3 && ticks[8].is_snapshot && ticks[8].id == 20,
+                 "Loss on both lines (timeout): book stale until a snapshot continues the buffer");
+    for (size_t i = 10; i < 120; ++i) {
+        if (i >= 40 && i < 80) continue;
+        feed(0, i);
+    }
+    stale = handler->recovering() && handler->recovery_stats().gaps == 2;
+    auto old_snapshot = Encoder::snapshot_packet(3, 60); // Older than the hole: a gap would remain
+    handler->on_snapshot_packet(old_snapshot.data(), static_cast<uint16_t>(old_snapshot.size()));
+    stale &= handler->recovering();
+    auto new_snapshot = Encoder::snapshot_packet(3, 170);
+    handler->on_snapshot_packet(new_snapshot.data(), static_cast<uint16_t>(new_snapshot.size()));
+    ticks = drain(*ring);
+    ok &= expect(stale && !handler->recovering() && handler->recovery_stats().recoveries == 2 &&
+                 ticks.back().id == 240 && handler->recovery_stats().ticks_replayed > 0,
+                 "Window overflow: a snapshot older than the hole is passed over, a newer one heals it");
+
+    // 8. A packet too large for a reorder slot arrives ahead of a hole with a later one held:
+    //    only the hole below it is lost, it is decoded in place and the held packet follows
+    rpt_seq = 0;
+    seq = 0;
+    stream = book_packets(rng, 30, 2, seq, rpt_seq);
+    const uint32_t hole_rpt_seq = rpt_seq;
+    auto jumbo = book_packets(rng, 1, 400, seq, rpt_seq);
+    auto tail = book_packets(rng, 2, 2, seq, rpt_seq);
+    handler = synced_handler(*ring);
+    handler->set_reorder_timeout_ns(1000);
+    const uint64_t decoded_before = handler->stats().packets;
+    for (size_t i = 0; i < 29; ++i) feed(0, i);
+    handler->on_packet(tail[0].data(), static_cast<uint16_t>(tail[0].size()));  // 32
+    handler->on_packet(jumbo[0].data(), static_cast<uint16_t>(jumbo[0].size())); // 31, 30 never arrives
+    handler->on_packet(tail[1].data(), static_cast<uint16_t>(tail[1].size()));  // 33
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    handler->poll(hft::utils::rdtsc()); // Nothing may be left held
+    bool skipped = jumbo[0].size() > hft::CoinbaseUDPHandler::SLOT_BYTES && handler->recovery_stats().gaps == 1 &&
+                   handler->recovery_stats().messages_lost == 1 && handler->stats().packets - decoded_before == 32;
+    auto jumbo_snapshot = Encoder::snapshot_packet(3, hole_rpt_seq);
+    handler->on_snapshot_packet(jumbo_snapshot.data(), static_cast<uint16_t>(jumbo_snapshot.size()));
+    ticks = drain(*ring);
+    ok &= expect(skipped && !handler->recovering() && ticks.back().id == rpt_seq &&
+                 handler->recovery_stats().ticks_replayed == 400 + 2 + 2,
+                 "Oversized packet ahead of a hole: decoded in place, later held packet released");
+
+    // 9. Payload keys: distinct messages sharing a key are both published and counted,
+    //    copies of each are still dropped
+    hft::LineArbiter keyed(2);
+    const std::string_view first_payload = R"([{"type":"update","trades":[{"trade_id":"1"}]}])";
+    const std::string_view second_payload = R"([{"type":"update","trades":[{"trade_id":"2"}]}])";
+    auto first_key = hft::LineArbiter::payload_key(first_payload);
+    auto second_key = hft::LineArbiter::payload_key(second_payload);
+    bool keyed_ok = first_key.key != second_key.key && first_key.check != second_key.check &&
+                    hft::LineArbiter::payload_key(first_payload).check == first_key.check;
+    keyed_ok &= keyed.first_arrival(first_key.key, 0, 1, first_key.check);
+    keyed_ok &= keyed.first_arrival(first_key.key, 0, 2, second_key.check); // Forced collision
+    keyed_ok &= !keyed.first_arrival(first_key.key, 1, 3, first_key.check);
+    keyed_ok &= !keyed.first_arrival(first_key.key, 1, 4, second_key.check);
+    ok &= expect(keyed_ok && keyed.collisions() == 1 && keyed.unique() == 2 && keyed.stats(1).duplicates == 2,
+                 "Payload key collision: both messages published, collision counted");
+
+    // 10. A level deleted inside a hole: the recovery snapshot replaces the book, so the
+    //     level is gone once the ticks are applied as StrategyEngine::apply_tick does
+    //     (the first tick of a snapshot message clears the book)
+    auto book_packet = [](uint32_t packet_seq, const std::vector<Level>& levels) {
+        Encoder e;
+        e.packet(packet_seq);
+        e.book(levels);
+        return e.bytes;
+    };
+    handler = synced_handler(*ring);
+    handler->set_reorder_timeout_ns(1000);
+    auto opened = book_packet(1, {{9999900, -2, 1, 0, 0, 0, 1}, {9999999, -2, 1, 0, 1, 0, 2}}); // Bid 99999.00, ask 99999.99
+    // Packet 2 (RptSeq 3) deletes the ask at 99999.99 and never arrives
+    auto added = book_packet(3, {{10000005, -2, 1, 0, 1, 0, 4}});                             // Ask 100000.05
+    auto pulled = book_packet(4, {{10000000, -2, 0, 0, 0, 2, 5}});                            // Snapshot's bid deleted
+    handler->on_packet(opened.data(), static_cast<uint16_t>(opened.size()));
+    handler->on_packet(added.data(), static_cast<uint16_t>(added.size()));
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    handler->poll(hft::utils::rdtsc());
+    auto recovery = Encoder::snapshot_packet(2, 3); // Bid 100000.00, ask 100000.01
+    handler->on_snapshot_packet(recovery.data(), static_cast<uint16_t>(recovery.size()));
+    handler->on_packet(pulled.data(), static_cast<uint16_t>(pulled.size()));
+    hft::DenseOrderBook book(10000000 * hft::constants::PRICE_SCALE / 100);
+    bool in_snapshot = false;
+    for (const auto& t : drain(*ring)) {
+        if (t.is_trade) continue;
+        if (t.is_snapshot && !in_snapshot) book.clear();
+        in_snapshot = t.is_snapshot && !t.end_of_message;
+        book.on_update(t.is_bid, t.price, t.quantity);
+    }
+    ok &= expect(handler->recovery_stats().recoveries == 1 && book.get_best_bid() == 0 &&
+                 book.get_best_ask() == 10000001 * hft::constants::PRICE_SCALE / 100,
+                 "Level deleted during a gap is gone from the book after recovery");
+
+    // 11. Timing: book updates of N entries, one message per packet
+    printf("\nDecode + publish, %zu packets per size\n", packets);
+    printf("%-8s %10s %12s %12s\n", "entries", "bytes", "ns/packet", "ns/entry");
+    bool all_decoded = true;
+    constexpr size_t CHUNK = 4096;
+    for (size_t entries : {1, 4, 16, 64}) {
+        handler = synced_handler(*ring);
+        seq = 0;
+        rpt_seq = 0;
+        double ns = 0;
+        size_t bytes = 0;
+        hft::BinaryTick sink{};
+        for (size_t done = 0; done < packets; done += CHUNK) {
+            auto chunk = book_packets(rng, std::min(CHUNK, packets - done), entries, seq, rpt_seq);
+            bytes = chunk[0].size();
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& packet : chunk) {
+                handler->on_packet(packet.data(), static_cast<uint16_t>(packet.size()));
+                if (ring->size() > ring->capacity() / 2) while (ring->pop(sink)) {}
+            }
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            while (ring->pop(sink)) {}
+        }
+        uint64_t decoded = handler->stats().entries;
+        all_decoded &= decoded == packets * entries && handler->stats().bad_decimal == 0 && !handler->recovering();
+        printf("%-8zu %10zu %12.1f %12.2f\n", entries, bytes, ns / packets, ns / decoded);
+    }
+    ok &= expect(all_decoded, "Every synthetic entry decoded");
+
+    // 12. Arbitration: the same 4-entry packets on one line, then on A and B (B 3 packets
+    //     behind), then with 5% of A lost so B's copies fill holes through the window
+    printf("\nArbitration, %zu packets of 4 entries\n", packets);
+    printf("%-28s %12s %14s\n", "lines", "ns/packet", "vs one line");
+    double single_ns = 0;
+    bool arbitrated = true;
+    for (int mode = 0; mode < 3; ++mode) {
+        handler = synced_handler(*ring, mode == 0 ? 1 : 2);
+        handler->set_reorder_timeout_ns(UINT64_MAX / 4);
+        seq = 0;
+        rpt_seq = 0;
+        double ns = 0;
+        hft::BinaryTick sink{};
+        std::mt19937_64 loss(7);
+        for (size_t done = 0; done < packets; done += CHUNK) {
+            auto chunk = book_packets(rng, std::min(CHUNK, packets - done), 4, seq, rpt_seq);
+            std::vector<uint8_t> lost_on_a(chunk.size());
+            for (auto& lost : lost_on_a) lost = mode == 2 && loss() % 20 == 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < chunk.size() + 3; ++i) {
+                if (i < chunk.size() && !lost_on_a[i]) {
+                    handler->on_packet(chunk[i].data(), static_cast<uint16_t>(chunk[i].size()), 0);
+                }
+                if (mode > 0 && i >= 3) {
+                    handler->on_packet(chunk[i - 3].data(), static_cast<uint16_t>(chunk[i - 3].size()), 1);
+                }
+                if (ring->size() > ring->capacity() / 2) while (ring->pop(sink)) {}
+            }
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            while (ring->pop(sink)) {}
+        }
+        arbitrated &= handler->stats().entries == packets * 4 && handler->recovery_stats().gaps == 0;
+        double per_packet = ns / packets;
+        if (mode == 0) single_ns = per_packet;
+        const char* name = mode == 0 ? "A only" : mode == 1 ? "A + B" : "A (5% lost) + B";
+        printf("%-28s %12.1f %+13.1f\n", name, per_packet, per_packet - single_ns);
+    }
+    ok &= expect(arbitrated, "Arbitrated streams complete, no gaps");
+    return ok ? 0 : 1;
+}
+
+namespace {
+
+    std::vector<std::vector<uint8_t>> book_packets(std::mt19937_64& rng, size_t count, size_t entries, uint32_t& seq,
+                                                   uint32_t& rpt_seq) {
+        std::vector<std::vector<uint8_t>> packets(count);
+        for (auto& packet : packets) {
+            std::vector<Level> levels;
+            for (size_t i = 0; i < entries; ++i) levels.push_back(random_level(rng, ++rpt_seq));
+            Encoder e;
+            e.packet(++seq);
+            e.book(levels);
+            packet = std::move(e.bytes);
+        }
+        return packets;
+    }
+
+}
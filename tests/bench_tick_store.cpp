@@ -0,0 +1,166 @@
+#include "storage/TickStore.hpp"
+#include "common/RingBuffer.hpp"
+#include "common/Types.hpp"
+#include "common/Utils.hpp"
+#include "TestUtils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Tick Store Benchmark
+// Encodes BinaryTick records into the columnar tick store and reports:
+//   size     raw BinaryTick bytes vs columnar bytes (disk and page cache footprint)
+//   decode   ns per tick to decode every block back into BinaryTick
+//   ring     ns per tick to push and pop the same ticks through the feed RingBuffer,
+//            the rate decode has to stay ahead of
+// The decoded ticks are compared field by field with the input, and block seeking is
+// checked against the index.
+// Usage: bench_tick_store [ticks.bin] [block_ticks]
+//   ticks.bin  Raw BinaryTick file (converter / capture_converter output); synthetic if omitted
+
+namespace {
+
+    using hft::test::expect;
+
+    // Level2-like stream: clustered timestamps, a random-walk price in cent steps, 8-decimal quantities
+    std::vector<hft::BinaryTick> synthetic_ticks(size_t count) {
+        std::mt19937_64 rng(42);
+        std::vector<hft::BinaryTick> ticks(count);
+        uint64_t us = 1735689600000000ULL;
+        uint64_t rx = 1000000000ULL;
+        int64_t mid = 10000000000000LL;
+        for (size_t i = 0; i < count; ++i) {
+            bool new_message = rng() % 4 == 0;
+            if (new_message) {
+                us += rng() % 2000;
+                rx += rng() % 4000000;
+                mid += (static_cast<int64_t>(rng() % 5) - 2) * 1000000;
+            }
+            hft::BinaryTick& t = ticks[i];
+            t.id = i;
+            t.timestamp = us;
+            t.is_bid = rng() & 1;
+            t.price = mid + (t.is_bid ? -1 : 1) * static_cast<int64_t>(1 + rng() % 50) * 1000000;
+            t.quantity = (rng() % 8 == 0) ? 0 : static_cast<int64_t>(rng() % 200000000);
+            t.symbol = 0;
+            t.is_trade = false;
+            t.is_snapshot = false;
+            t.end_of_message = rng() % 4 == 0;
+            t.exchange_timestamp = us * 1000 + rng() % 1000;
+            t.rx_timestamp = rx;
+        }
+        return ticks;
+    }
+
+    bool same(const hft::BinaryTick& a, const hft::BinaryTick& b) {
+        return a.id == b.id && a.timestamp == b.timestamp && a.price == b.price && a.quantity == b.quantity &&
+               a.symbol == b.symbol && a.is_bid == b.is_bid && a.is_trade == b.is_trade &&
+               a.is_snapshot == b.is_snapshot && a.end_of_message == b.end_of_message &&
+               a.exchange_timestamp == b.exchange_timestamp && a.rx_timestamp == b.rx_timestamp;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    std::string source = argc > 1 ? argv[1] : "";
+    uint32_t block_ticks = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : hft::storage::DEFAULT_BLOCK_TICKS;
+
+    std::vector<hft::BinaryTick> ticks;
+    if (!source.empty()) {
+        std::ifstream in(source, std::ios::binary | std::ios::ate);
+        if (!in) {
+            std::cerr << "Failed to open " << source << std::endl;
+            return 1;
+        }
+        ticks.resize(static_cast<size_t>(in.tellg()) / sizeof(hft::BinaryTick));
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(ticks.data()), ticks.size() * sizeof(hft::BinaryTick));
+    } else {
+        ticks = synthetic_ticks(4000000);
+    }
+    if (ticks.empty()) return 1;
+
+    const char* path = "bench_tick_store.tcol";
+    bool ok = true;
+
+    hft::storage::TickStoreWriter writer(path, block_ticks);
+    if (!expect(writer.open(), "TickStoreWriter opens")) return 1;
+    auto encode_start = std::chrono::steady_clock::now();
+    for (const auto& t : ticks) writer.append(t);
+    ok &= expect(writer.close(), "TickStoreWriter closes");
+    double encode_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - encode_start).count();
+
+    hft::storage::TickStoreReader reader;
+    if (!expect(reader.open(path), "TickStoreReader opens")) return 1;
+    ok &= expect(reader.tick_count() == ticks.size(), "Footer tick count matches");
+
+    // Round trip
+    std::vector<hft::BinaryTick> block(reader.block_ticks());
+    size_t decoded = 0;
+    bool intact = true;
+    for (size_t b = 0; b < reader.blocks().size(); ++b) {
+        size_t n = reader.decode(b, block.data());
+        for (size_t i = 0; i < n && intact; ++i) intact = decoded + i < ticks.size() && same(block[i], ticks[decoded + i]);
+        decoded += n;
+    }
+    ok &= expect(intact && decoded == ticks.size(), "Every field decodes back exactly");
+
+    // Seek through the index to the block holding a given tick
+    uint64_t target = ticks[ticks.size() * 3 / 4].timestamp;
+    size_t found = reader.find(target);
+    bool seek_ok = found < reader.blocks().size() && reader.blocks()[found].last_timestamp >= target &&
+                   (found == 0 || reader.blocks()[found - 1].last_timestamp < target);
+    ok &= expect(seek_ok, "find() lands on the first block reaching the timestamp");
+    ok &= expect(reader.find(UINT64_MAX) == reader.blocks().size(), "find() past the end");
+
+    // Decode throughput: best of several passes over the whole file
+    double decode_ns = 1e18;
+    uint64_t checksum = 0;
+    for (int pass = 0; pass < 5; ++pass) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t b = 0; b < reader.blocks().size(); ++b) {
+            size_t n = reader.decode(b, block.data());
+            checksum += block[n - 1].price;
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        decode_ns = std::min(decode_ns, ns / ticks.size());
+    }
+
+    // Ring cost per tick: push and pop through the feed ring in this thread (no contention,
+    // so a lower bound on what the strategy side can absorb)
+    auto ring = std::make_unique<hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE>>();
+    double ring_ns = 1e18;
+    for (int pass = 0; pass < 5; ++pass) {
+        auto start = std::chrono::steady_clock::now();
+        hft::BinaryTick out{};
+        for (size_t i = 0; i < ticks.size(); i += 256) {
+            size_t end = std::min(ticks.size(), i + 256);
+            for (size_t j = i; j < end; ++j) ring->push(ticks[j]);
+            for (size_t j = i; j < end; ++j) ring->pop(out);
+            checksum += out.price;
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        ring_ns = std::min(ring_ns, ns / ticks.size());
+    }
+
+    double raw_mb = ticks.size() * sizeof(hft::BinaryTick) / 1e6;
+    double tcol_mb = reader.file_size() / 1e6;
+    printf("\n%zu ticks, %zu blocks of %u (checksum %lu)\n", ticks.size(), reader.blocks().size(), reader.block_ticks(),
+           static_cast<unsigned long>(checksum));
+    printf("%-10s %12s %12s %10s\n", "format", "MB", "bytes/tick", "ratio");
+    printf("%-10s %12.2f %12.2f %9.2fx\n", "raw", raw_mb, static_cast<double>(sizeof(hft::BinaryTick)), 1.0);
+    printf("%-10s %12.2f %12.2f %9.2fx\n", "columnar", tcol_mb, reader.file_size() / static_cast<double>(ticks.size()),
+           raw_mb / tcol_mb);
+    printf("\nencode %.2f ns/tick, decode %.2f ns/tick (%.1f M ticks/s), ring push+pop %.2f ns/tick\n",
+           encode_s * 1e9 / ticks.size(), decode_ns, 1e3 / decode_ns, ring_ns);
+
+    std::remove(path);
+    return ok ? 0 : 1;
+}
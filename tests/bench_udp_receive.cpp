@@ -0,0 +1,260 @@
+#include "feed_handler/CoinbaseUDP.hpp"
+#include "network/UdpSocket.hpp"
+#include "common/RingBuffer.hpp"
+#include "common/Types.hpp"
+#include "common/Utils.hpp"
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+// UDP Receive Benchmark
+// Compares one datagram per syscall (recv, or recvmsg when reading kernel timestamps: the
+// recvfrom path) with recvmmsg batches, both feeding CoinbaseUDPHandler::on_packet on
+// loopback:
+//   drain    an in-process sender queues a burst, then the receiver drains it: ns and
+//            syscalls per packet with nothing competing for the CPU (runs anywhere, e.g. CI)
+//   listen   receives tools/udp_gen.py traffic for N seconds: packets/s and the latency
+//            from the kernel receive timestamp to on_packet (p50/p99/p99.9/max)
+// Usage: bench_udp_receive [packets] [--port P] [--listen SECONDS] [--mode recv|recvmmsg]
+//                          [--busy-poll US]
+//   scripts/run_udp_receive_benchmark.sh runs --listen in both modes against udp_gen.py.
+
+namespace {
+
+    using Ring = hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE>;
+
+    constexpr size_t BURST = 64;   // Datagrams queued per drain round (fits the default rmem_max)
+    constexpr size_t ENTRIES = 4;  // Book entries per packet, as udp_gen.py sends by default
+
+    enum class Mode { RECV, RECVMMSG };
+
+    const char* name(Mode mode) { return mode == Mode::RECV ? "recv" : "recvmmsg"; }
+
+    template <typename T>
+    void put(std::vector<uint8_t>& out, T value) {
+        uint8_t raw[sizeof(T)];
+        std::memcpy(raw, &value, sizeof(T));
+        out.insert(out.end(), raw, raw + sizeof(T));
+    }
+
+    // packetHeader + MDIncrementalRefreshBook (202), as tools/udp_gen.py encodes it
+    std::vector<uint8_t> book_packet(uint32_t seq, uint32_t& rpt_seq) {
+        std::vector<uint8_t> out;
+        put<uint32_t>(out, seq);
+        put<uint64_t>(out, 0);
+        for (uint16_t v : {uint16_t(9), uint16_t(202), uint16_t(1), uint16_t(1)}) put(out, v);
+        put<uint64_t>(out, 0);
+        put<uint8_t>(out, 0x80);
+        put<uint16_t>(out, 28);
+        put<uint16_t>(out, ENTRIES);
+        for (size_t i = 0; i < ENTRIES; ++i) {
+            put<int64_t>(out, 9600000 + static_cast<int64_t>(i));
+            put<int8_t>(out, -2);
+            put<int64_t>(out, 100000000);
+            put<int8_t>(out, -8);
+            put<int32_t>(out, 1);
+            put<uint32_t>(out, ++rpt_seq);
+            put<uint8_t>(out, static_cast<uint8_t>(i & 1));
+            put<uint8_t>(out, 1);
+        }
+        return out;
+    }
+
+    // A handler whose book is in sync from RptSeq 1 (an empty snapshot at LastRptSeq 0)
+    std::unique_ptr<hft::CoinbaseUDPHandler> synced_handler(Ring& ring) {
+        auto handler = std::make_unique<hft::CoinbaseUDPHandler>(ring);
+        std::vector<uint8_t> snapshot;
+        put<uint32_t>(snapshot, 1);
+        put<uint64_t>(snapshot, 0);
+        for (uint16_t v : {uint16_t(16), uint16_t(201), uint16_t(1), uint16_t(1)}) put(snapshot, v);
+        put<uint64_t>(snapshot, 0);
+        put<int32_t>(snapshot, 1);
+        put<uint32_t>(snapshot, 0);
+        put<uint16_t>(snapshot, 19);
+        put<uint16_t>(snapshot, 0);
+        handler->on_snapshot_packet(snapshot.data(), static_cast<uint16_t>(snapshot.size()));
+        return handler;
+    }
+
+    void drain(Ring& ring) {
+        hft::BinaryTick tick;
+        while (ring.pop(tick)) {}
+    }
+
+    uint64_t realtime_ns() {
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    // Reads what is waiting with the given mode; calls on_datagram(data, len, rx_ns) per datagram.
+    // Returns datagrams read and counts the syscalls that returned data.
+    template <typename OnDatagram>
+    size_t receive_all(Mode mode, hft::network::UdpSocket& socket, hft::network::ReceiveBatch& batch,
+                       std::vector<uint8_t>& buf, size_t& syscalls, OnDatagram&& on_datagram) {
+        size_t received = 0;
+        for (;; ++syscalls) {
+            if (mode == Mode::RECV) {
+                uint64_t rx_ns = 0;
+                ssize_t len = socket.receive(buf.data(), buf.size(), &rx_ns);
+                if (len <= 0) break;
+                on_datagram(buf.data(), static_cast<uint16_t>(len), rx_ns);
+                ++received;
+            } else {
+                if (socket.receive_batch(batch) <= 0) break;
+                for (size_t i = 0; i < batch.size(); ++i) on_datagram(batch.data(i), batch.length(i), batch.rx_ns(i));
+                received += batch.size();
+            }
+        }
+        return received;
+    }
+
+    void print_latency(std::vector<uint64_t>& samples) {
+        if (samples.empty()) return;
+        std::sort(samples.begin(), samples.end());
+        auto at = [&](double q) { return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))]; };
+        printf("  kernel rx -> on_packet: p50 %lu ns, p99 %lu ns, p99.9 %lu ns, max %lu ns\n",
+               static_cast<unsigned long>(at(0.5)), static_cast<unsigned long>(at(0.99)),
+               static_cast<unsigned long>(at(0.999)), static_cast<unsigned long>(samples.back()));
+    }
+
+    // Function: run_drain
+    // Description: Sends packets in bursts of BURST to the receive socket and times draining
+    //              each burst into the handler.
+    // Outputs: false if packets were lost or the handler saw a gap.
+    bool run_drain(Mode mode, size_t packets, hft::network::UdpSocket& socket, int sender, const sockaddr_in& target,
+                   Ring& ring) {
+        auto handler = synced_handler(ring);
+        drain(ring);
+        hft::network::ReceiveBatch batch(BURST);
+        std::vector<uint8_t> buf(65536);
+        std::vector<std::vector<uint8_t>> burst(BURST);
+
+        uint32_t seq = 0;
+        uint32_t rpt_seq = 0;
+        size_t sent = 0;
+        size_t received = 0;
+        size_t syscalls = 0;
+        double ns = 0;
+        while (sent < packets) {
+            size_t n = std::min(BURST, packets - sent);
+            for (size_t i = 0; i < n; ++i) burst[i] = book_packet(++seq, rpt_seq);
+            for (size_t i = 0; i < n; ++i) {
+                sendto(sender, burst[i].data(), burst[i].size(), 0, reinterpret_cast<const sockaddr*>(&target),
+                       sizeof(target));
+            }
+            sent += n;
+
+            auto start = std::chrono::steady_clock::now();
+            received += receive_all(mode, socket, batch, buf, syscalls, [&](const uint8_t* data, uint16_t len, uint64_t) {
+                handler->on_packet(data, len, 0, hft::utils::rdtsc());
+            });
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            drain(ring);
+        }
+
+        printf("%-10s %10zu %10zu %12.1f %14.3f %12.2f\n", name(mode), sent, received, ns / received,
+               static_cast<double>(syscalls) / received, received / (ns / 1e9) / 1e6);
+        return received == sent && handler->recovery_stats().gaps == 0 && handler->stats().entries == sent * ENTRIES;
+    }
+
+    // Function: run_listen
+    // Description: Receives external traffic (tools/udp_gen.py) for a number of seconds and
+    //              reports packets/s and kernel-timestamp-to-handler latency.
+    void run_listen(Mode mode, int seconds, hft::network::UdpSocket& socket, Ring& ring) {
+        auto handler = synced_handler(ring);
+        drain(ring);
+        hft::network::ReceiveBatch batch(BURST);
+        std::vector<uint8_t> buf(65536);
+        std::vector<uint64_t> latency;
+        latency.reserve(1 << 22);
+
+        size_t syscalls = 0;
+        size_t received = 0;
+        uint64_t first_ns = 0;
+        uint64_t last_ns = 0;
+        auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        while (std::chrono::steady_clock::now() < end) {
+            size_t n = receive_all(mode, socket, batch, buf, syscalls, [&](const uint8_t* data, uint16_t len, uint64_t rx_ns) {
+                handler->on_packet(data, len, 0, hft::utils::rdtsc());
+                uint64_t now = realtime_ns();
+                if (rx_ns != 0 && latency.size() < latency.capacity()) latency.push_back(now - rx_ns);
+                if (first_ns == 0) first_ns = rx_ns;
+                last_ns = rx_ns;
+            });
+            if (n == 0) {
+                hft::utils::cpu_relax();
+                continue;
+            }
+            received += n;
+            drain(ring);
+        }
+
+        double active_s = last_ns > first_ns ? static_cast<double>(last_ns - first_ns) / 1e9 : 0;
+        printf("[%s] %zu packets in %.2f s: %.0f packets/s, %.3f syscalls/packet, %lu packets lost\n", name(mode),
+               received, active_s, active_s > 0 ? received / active_s : 0.0,
+               received ? static_cast<double>(syscalls) / received : 0.0,
+               static_cast<unsigned long>(handler->recovery_stats().messages_lost));
+        print_latency(latency);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t packets = 200000;
+    uint16_t port = 21300;
+    int listen_seconds = 0;
+    int busy_poll_us = 0;
+    std::vector<Mode> modes = {Mode::RECV, Mode::RECVMMSG};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+            listen_seconds = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--busy-poll") == 0 && i + 1 < argc) {
+            busy_poll_us = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            ++i;
+            modes = {std::strcmp(argv[i], "recv") == 0 ? Mode::RECV : Mode::RECVMMSG};
+        } else {
+            packets = std::stoul(argv[i]);
+        }
+    }
+
+    hft::utils::calibrate_tsc();
+    auto ring = std::make_unique<Ring>();
+
+    hft::network::UdpSocket socket;
+    if (!socket.open("127.0.0.1", port)) return 1;
+    socket.enable_rx_timestamps();
+    if (busy_poll_us > 0) socket.set_busy_poll(busy_poll_us);
+
+    if (listen_seconds > 0) {
+        printf("Listening on 127.0.0.1:%u for %d s\n", port, listen_seconds);
+        run_listen(modes[0], listen_seconds, socket, *ring);
+        return 0;
+    }
+
+    int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in target{};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &target.sin_addr);
+
+    printf("Drain %zu packets in bursts of %zu (%zu entries each), on_packet included\n", packets, BURST, ENTRIES);
+    printf("%-10s %10s %10s %12s %14s %12s\n", "mode", "sent", "received", "ns/packet", "syscalls/pkt", "Mpps");
+    bool ok = true;
+    for (Mode mode : modes) ok &= run_drain(mode, packets, socket, sender, target, *ring);
+    ::close(sender);
+
+    printf("%s Every packet received and decoded in order\n", ok ? "[PASS]" : "[FAIL]");
+    return ok ? 0 : 1;
+}
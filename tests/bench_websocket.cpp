@@ -0,0 +1,176 @@
+#include "network/WebSocketClient.hpp"
+#include "network/WebSocketServer.hpp"
+#include "common/Utils.hpp"
+#include <ixwebsocket/IXWebSocket.h>
+#include <ixwebsocket/IXNetSystem.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// WebSocket Transport Benchmark
+// Starts a local wss:// echo server (self-signed certificate) and compares the in-house
+// busy-polled WebSocketClient with IXWebSocket on:
+//   - echo round-trip latency for level2-sized frames
+//   - flood throughput (server pushes frames as fast as TLS allows)
+// Usage: bench_websocket [round_trips] [flood_frames]
+
+namespace {
+
+    constexpr size_t FRAME_SIZE = 256;
+
+    std::string make_payload(size_t size) {
+        std::string payload = R"({"channel":"l2_data","timestamp":"2025-01-01T00:00:00.000000Z","events":[)";
+        while (payload.size() + 3 < size) payload += 'x';
+        payload += "]}";
+        return payload;
+    }
+
+    // Echoes every message, except "flood <count>" which answers with count frames then "done"
+    void echo_handler(hft::network::WebSocketServer& server, hft::network::WebSocketServer::Connection& connection) {
+        std::string message;
+        std::string payload = make_payload(FRAME_SIZE);
+        while (server.running() && connection.is_open()) {
+            int r = connection.read_message(message, 100);
+            if (r < 0) break;
+            if (r == 0) continue;
+
+            if (message.rfind("flood ", 0) == 0) {
+                size_t count = std::stoul(message.substr(6));
+                for (size_t i = 0; i < count && connection.is_open(); ++i) {
+                    connection.send_text(payload);
+                }
+                connection.send_text("done");
+            } else {
+                connection.send_text(message);
+            }
+        }
+    }
+
+    void print_latency(const char* name, std::vector<uint64_t>& samples) {
+        if (samples.empty()) return;
+        std::sort(samples.begin(), samples.end());
+        auto at = [&](double q) { return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))]; };
+        std::cout << "  " << name << " RTT: p50 " << at(0.5) << " ns, p99 " << at(0.99)
+                  << " ns, p99.9 " << at(0.999) << " ns, max " << samples.back() << " ns" << std::endl;
+    }
+
+    void print_flood(const char* name, size_t frames, double seconds) {
+        std::cout << "  " << name << " flood: " << frames / seconds / 1e3 << " k msgs/s, "
+                  << frames * FRAME_SIZE / seconds / 1e6 << " MB/s" << std::endl;
+    }
+
+    uint64_t cycles_to_ns(uint64_t cycles) {
+        return static_cast<uint64_t>(cycles / hft::utils::CYCLES_PER_NS);
+    }
+
+    void bench_native(const std::string& url, size_t round_trips, size_t flood_frames) {
+        hft::network::WebSocketClient client;
+        client.set_tls_verify(false);
+        if (!client.connect(url)) {
+            std::cerr << "[Bench] Native client failed to connect" << std::endl;
+            return;
+        }
+
+        std::string payload = make_payload(FRAME_SIZE);
+        std::vector<uint64_t> rtt;
+        rtt.reserve(round_trips);
+        for (size_t i = 0; i < round_trips; ++i) {
+            uint64_t start = hft::utils::rdtsc();
+            client.send_text(payload);
+            int received = 0;
+            while (received == 0 && client.is_open()) {
+                received = client.poll([](std::string_view, size_t, uint64_t, uint64_t) {});
+            }
+            rtt.push_back(cycles_to_ns(hft::utils::rdtsc() - start));
+        }
+        print_latency("native", rtt);
+
+        size_t frames = 0;
+        bool done = false;
+        auto start = std::chrono::steady_clock::now();
+        client.send_text("flood " + std::to_string(flood_frames));
+        while (!done && client.is_open()) {
+            client.poll([&](std::string_view frame, size_t, uint64_t, uint64_t) {
+                if (frame == "done") done = true;
+                else ++frames;
+            });
+        }
+        print_flood("native", frames, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        client.close();
+    }
+
+    void bench_ix(const std::string& url, size_t round_trips, size_t flood_frames) {
+        ix::WebSocket client;
+        client.setUrl(url);
+        client.disableAutomaticReconnection();
+        ix::SocketTLSOptions tls;
+        tls.caFile = "NONE"; // Self-signed server
+        client.setTLSOptions(tls);
+
+        std::atomic<bool> open{false};
+        std::atomic<uint64_t> received{0};
+        std::atomic<bool> done{false};
+        client.setOnMessageCallback([&](const ix::WebSocketMessagePtr& msg) {
+            if (msg->type == ix::WebSocketMessageType::Open) {
+                open = true;
+            } else if (msg->type == ix::WebSocketMessageType::Message) {
+                if (msg->str == "done") done = true;
+                else received.fetch_add(1, std::memory_order_release);
+            }
+        });
+        client.start();
+        for (int i = 0; i < 500 && !open; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (!open) {
+            std::cerr << "[Bench] IXWebSocket failed to connect" << std::endl;
+            client.stop();
+            return;
+        }
+
+        std::string payload = make_payload(FRAME_SIZE);
+        std::vector<uint64_t> rtt;
+        rtt.reserve(round_trips);
+        for (size_t i = 0; i < round_trips; ++i) {
+            uint64_t before = received.load(std::memory_order_acquire);
+            uint64_t start = hft::utils::rdtsc();
+            client.sendText(payload);
+            while (received.load(std::memory_order_acquire) == before) hft::utils::cpu_relax();
+            rtt.push_back(cycles_to_ns(hft::utils::rdtsc() - start));
+        }
+        print_latency("ixwebsocket", rtt);
+
+        uint64_t before = received.load();
+        auto start = std::chrono::steady_clock::now();
+        client.sendText("flood " + std::to_string(flood_frames));
+        while (!done) hft::utils::cpu_relax();
+        print_flood("ixwebsocket", received.load() - before, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        client.stop();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t round_trips = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t flood_frames = argc > 2 ? std::stoul(argv[2]) : 200000;
+
+    hft::utils::calibrate_tsc();
+    ix::initNetSystem();
+
+    hft::network::WebSocketServer server;
+    if (!server.listen(0, true)) return 1;
+    server.start([&server](hft::network::WebSocketServer::Connection& connection) {
+        echo_handler(server, connection);
+    });
+    std::string url = "wss://127.0.0.1:" + std::to_string(server.port()) + "/";
+    std::cout << "Echo server on " << url << " (" << FRAME_SIZE << " byte frames)" << std::endl;
+
+    bench_native(url, round_trips, flood_frames);
+    bench_ix(url, round_trips, flood_frames);
+
+    server.stop();
+    ix::uninitNetSystem();
+    return 0;
+}
@@ -4,32 +4,102 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <cstring>
 
+// Usage: integration_feed [duration_seconds] [url] [--native-ws] [--insecure] [--lines N]
+//   url          Endpoint override, e.g. ws://127.0.0.1:8080 for coinbase_standin
+//   --native-ws  Use the in-house WebSocket client instead of IXWebSocket
+//   --insecure   Accept the stand-in's self-signed certificate (wss://)
+//   --lines N    N redundant connections with first-arrival arbitration
+//                (against coinbase_standin --redundant [--stall-every N])
 int main(int argc, char* argv[]) {
     int duration = 30;
-    if (argc > 1) {
-        duration = std::atoi(argv[1]);
+    std::string url;
+    hft::WsTransport transport = hft::WsTransport::IXWEBSOCKET;
+    bool insecure = false;
+    size_t lines = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--native-ws") == 0) {
+            transport = hft::WsTransport::NATIVE;
+        } else if (std::strcmp(argv[i], "--insecure") == 0) {
+            insecure = true;
+        } else if (std::strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+            lines = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strstr(argv[i], "://") != nullptr) {
+            url = argv[i];
+        } else {
+            duration = std::atoi(argv[i]);
+        }
     }
 
     std::cout << "Starting Coinbase Feed Handler Test..." << std::endl;
 
     // Create a RingBuffer
-    hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE> buffer;
+    auto buffer = std::make_unique<hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE>>();
 
     // Instantiate the FeedHandler
-    hft::CoinbaseFeedHandler handler(buffer);
+    hft::CoinbaseFeedHandler handler(*buffer, false, transport);
+    if (!url.empty()) {
+        handler.set_url(url);
+    }
+    if (insecure) {
+        handler.set_tls_verify(false);
+    }
+    handler.set_lines(lines);
+
+    // Drain the ring and count what the handler publishes
+    std::atomic<bool> consuming{true};
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> messages{0};
+    std::thread consumer([&] {
+        hft::BinaryTick tick;
+        while (consuming.load(std::memory_order_relaxed)) {
+            if (buffer->pop(tick)) {
+                ticks.fetch_add(1, std::memory_order_relaxed);
+                if (tick.end_of_message) messages.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                hft::utils::cpu_relax();
+            }
+        }
+    });
 
     // Start the handler
     handler.start();
 
     std::cout << "Handler started. Running for " << duration << " seconds..." << std::endl;
 
-    // Let it run for a while to see if it connects and receives data
-    std::this_thread::sleep_for(std::chrono::seconds(duration));
+    // Report the sustained rate once per second
+    uint64_t last_ticks = 0;
+    uint64_t last_messages = 0;
+    for (int i = 0; i < duration; ++i) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        uint64_t t = ticks.load(std::memory_order_relaxed);
+        uint64_t m = messages.load(std::memory_order_relaxed);
+        std::cout << "  " << (m - last_messages) << " msgs/s, " << (t - last_ticks) << " ticks/s" << std::endl;
+        last_ticks = t;
+        last_messages = m;
+    }
 
     std::cout << "Stopping handler..." << std::endl;
     handler.stop();
+    consuming = false;
+    consumer.join();
 
-    std::cout << "Test complete." << std::endl;
+    std::cout << "Test complete. " << messages.load() << " book messages, " << ticks.load() << " ticks." << std::endl;
+
+    handler.print_line_stats();
+
+    // Gap recovery (exercise with coinbase_standin --gap-every N)
+    const auto& recovery = handler.recovery_stats();
+    if (recovery.gaps > 0) {
+        std::cout << "Gaps: " << recovery.gaps << " (" << recovery.messages_lost << " messages lost), "
+                  << recovery.recoveries << " recovered in-session, " << recovery.reconnects << " reconnects" << std::endl;
+        if (recovery.recoveries > 0) {
+            std::cout << "Recovery time: mean " << recovery.total_ns / recovery.recoveries / 1000 << " us, max "
+                      << recovery.max_ns / 1000 << " us; " << recovery.ticks_replayed << " buffered trades replayed, "
+                      << recovery.ticks_superseded << " superseded by the snapshot" << std::endl;
+        }
+    }
     return 0;
 }
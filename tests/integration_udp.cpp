@@ -0,0 +1,154 @@
+#include "feed_handler/CoinbaseUDPFeed.hpp"
+#include "common/RingBuffer.hpp"
+#include "common/Types.hpp"
+#include "common/LatencyHistogram.hpp"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstring>
+#include <string>
+
+// Usage: integration_udp [duration_seconds] [--ip 127.0.0.1] [--port 1234] [--lines N]
+//                        [--snapshot-port P] [--reorder-us N] [--busy-poll US] [--rx-timestamps [hw]]
+//   Listens on N consecutive ports from --port (line A, B, ...) and the snapshot port, and
+//   checks the published stream: RptSeq must be continuous except where a snapshot resets
+//   the book. Feed it with tools/udp_gen.py, one generator per line with the same --seed and
+//   --start-at (and --drop on one of them); see scripts/run_udp_ab_test.sh.
+//   --rx-timestamps turns on SO_TIMESTAMPING (hw: NIC stamps) and splits the latency from
+//   the kernel receive to the consumer into socket queue, decode and ring hops.
+int main(int argc, char* argv[]) {
+    int duration = 30;
+    std::string ip = "127.0.0.1";
+    uint16_t port = 1234;
+    uint16_t snapshot_port = 0;
+    size_t lines = 2;
+    uint64_t reorder_us = 0;
+    int busy_poll_us = 0;
+    bool rx_timestamps = false;
+    bool hw_timestamps = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ip") == 0 && i + 1 < argc) {
+            ip = argv[++i];
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--snapshot-port") == 0 && i + 1 < argc) {
+            snapshot_port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+            lines = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--reorder-us") == 0 && i + 1 < argc) {
+            reorder_us = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--busy-poll") == 0 && i + 1 < argc) {
+            busy_poll_us = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rx-timestamps") == 0) {
+            rx_timestamps = true;
+            if (i + 1 < argc && std::strcmp(argv[i + 1], "hw") == 0) {
+                hw_timestamps = true;
+                ++i;
+            }
+        } else {
+            duration = std::atoi(argv[i]);
+        }
+    }
+
+    std::cout << "Starting Coinbase UDP Feed Test..." << std::endl;
+    hft::utils::calibrate_tsc();
+
+    auto buffer = std::make_unique<hft::RingBuffer<hft::BinaryTick, hft::constants::RING_BUFFER_SIZE>>();
+    hft::CoinbaseUDPFeed feed(*buffer);
+    for (size_t i = 0; i < lines; ++i) feed.add_line(ip, static_cast<uint16_t>(port + i));
+    if (snapshot_port != 0) feed.set_snapshot_line(ip, snapshot_port);
+    if (reorder_us != 0) feed.set_reorder_timeout_ns(reorder_us * 1000);
+    feed.set_busy_poll_us(busy_poll_us);
+    feed.set_rx_timestamps(rx_timestamps, hw_timestamps);
+
+    // Drain the ring and check RptSeq continuity of what the handler publishes
+    std::atomic<bool> consuming{true};
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> snapshots{0};
+    std::atomic<uint64_t> breaks{0};
+    // Receive -> read (socket queue), read -> tick built (decode), tick -> popped here (ring)
+    hft::LatencyHistogram rx_to_read, read_to_decode, decode_to_pop;
+    std::thread consumer([&] {
+        hft::BinaryTick tick;
+        uint64_t last = 0;
+        bool in_snapshot = false;
+        while (consuming.load(std::memory_order_relaxed)) {
+            if (!buffer->pop(tick)) {
+                hft::utils::cpu_relax();
+                continue;
+            }
+            ticks.fetch_add(1, std::memory_order_relaxed);
+            if (tick.rx_read_delta != 0) {
+                uint64_t pop_tsc = hft::utils::rdtsc();
+                uint64_t read_tsc = tick.rx_timestamp + tick.rx_read_delta;
+                rx_to_read.record(static_cast<uint64_t>(tick.rx_read_delta / hft::utils::CYCLES_PER_NS));
+                if (tick.timestamp >= read_tsc) read_to_decode.record(static_cast<uint64_t>((tick.timestamp - read_tsc) / hft::utils::CYCLES_PER_NS));
+                if (pop_tsc >= tick.timestamp) decode_to_pop.record(static_cast<uint64_t>((pop_tsc - tick.timestamp) / hft::utils::CYCLES_PER_NS));
+            }
+            if (tick.is_snapshot) {
+                if (!in_snapshot) snapshots.fetch_add(1, std::memory_order_relaxed);
+                in_snapshot = !tick.end_of_message;
+                last = tick.id;
+                continue;
+            }
+            // Trades older than a recovery snapshot are replayed ahead of it, past the
+            // hole, so trades only have to move forward; depth must continue exactly
+            if (tick.is_trade ? tick.id <= last : tick.id != last + 1) {
+                if (breaks.fetch_add(1, std::memory_order_relaxed) < 5) {
+                    std::cerr << "  RptSeq break: " << last << " -> " << tick.id << std::endl;
+                }
+            }
+            if (tick.id > last) last = tick.id;
+        }
+    });
+
+    if (!feed.start()) {
+        consuming = false;
+        consumer.join();
+        return 1;
+    }
+    std::cout << "Feed started. Running for " << duration << " seconds..." << std::endl;
+
+    uint64_t last_ticks = 0;
+    for (int i = 0; i < duration; ++i) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        uint64_t t = ticks.load(std::memory_order_relaxed);
+        std::cout << "  " << (t - last_ticks) << " ticks/s" << std::endl;
+        last_ticks = t;
+    }
+
+    std::cout << "Stopping feed..." << std::endl;
+    feed.stop();
+    consuming = false;
+    consumer.join();
+
+    const auto& handler = feed.handler();
+    const auto& stats = handler.stats();
+    std::cout << "Test complete. " << stats.packets << " packets, " << ticks.load() << " ticks, "
+              << snapshots.load() << " snapshots applied, " << breaks.load() << " RptSeq breaks." << std::endl;
+    std::cout << "Reordered " << stats.reordered << ", stale " << stats.stale << ", malformed " << stats.malformed
+              << ", snapshots skipped " << stats.snapshots_skipped << std::endl;
+    handler.print_line_stats();
+
+    const auto& recovery = handler.recovery_stats();
+    std::cout << "Gaps: " << recovery.gaps << " (" << recovery.messages_lost << " packets lost on every line), "
+              << recovery.recoveries << " recovered from snapshots" << std::endl;
+    if (recovery.recoveries > 0) {
+        std::cout << "Recovery time: mean " << recovery.total_ns / recovery.recoveries / 1000 << " us, max "
+                  << recovery.max_ns / 1000 << " us; " << recovery.ticks_replayed << " buffered ticks replayed, "
+                  << recovery.ticks_superseded << " superseded by the snapshot" << std::endl;
+    }
+    if (rx_to_read.count() > 0) {
+        std::cout << "Receive timestamps (" << rx_to_read.count() << " ticks), p50 / p99 / max ns:" << std::endl;
+        const std::pair<const char*, const hft::LatencyHistogram*> hops[] = {
+            {"rx_to_read", &rx_to_read}, {"read_to_decode", &read_to_decode}, {"decode_to_pop", &decode_to_pop}};
+        for (const auto& [name, hist] : hops) {
+            std::cout << "  " << name << ": " << hist->percentile(0.5) << " / " << hist->percentile(0.99) << " / "
+                      << hist->max() << std::endl;
+        }
+    } else if (rx_timestamps) {
+        std::cout << "No receive timestamps arrived." << std::endl;
+    }
+    return breaks.load() == 0 ? 0 : 1;
+}
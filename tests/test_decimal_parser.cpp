@@ -0,0 +1,167 @@
+#include "common/DecimalParser.hpp"
+#include "common/Utils.hpp"
+#include "TestUtils.hpp"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    using hft::test::expect;
+
+    // Reference: digit-by-digit in 128-bit, round half away from zero on the 9th fractional digit
+    bool reference_parse(const std::string& s, int64_t& out) {
+        size_t i = 0;
+        bool negative = false;
+        if (i < s.size() && (s[i] == '-' || s[i] == '+')) negative = (s[i++] == '-');
+
+        __int128 value = 0;
+        size_t digits = 0;
+        while (i < s.size() && isdigit(static_cast<unsigned char>(s[i]))) {
+            value = value * 10 + (s[i++] - '0');
+            if (value > static_cast<__int128>(INT64_MAX)) return false;
+            ++digits;
+        }
+        value *= 100000000;
+
+        size_t frac = 0;
+        if (i < s.size() && s[i] == '.') {
+            ++i;
+            __int128 scale = 10000000;
+            while (i < s.size() && isdigit(static_cast<unsigned char>(s[i]))) {
+                if (frac < 8) value += (s[i] - '0') * scale;
+                else if (frac == 8 && s[i] >= '5') value += 1;
+                scale /= 10;
+                ++frac;
+                ++i;
+            }
+        }
+        if (i != s.size() || (digits == 0 && frac == 0)) return false;
+        if (value > static_cast<__int128>(INT64_MAX)) return false;
+        out = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+        return true;
+    }
+
+    std::string random_decimal(std::mt19937_64& rng) {
+        static const char alphabet[] = "0123456789";
+        std::string s;
+        switch (rng() % 8) {
+            case 0: s += '-'; break;
+            case 1: s += '+'; break;
+            default: break;
+        }
+        size_t int_len = rng() % 14;
+        for (size_t i = 0; i < int_len; ++i) s += alphabet[rng() % 10];
+        if (rng() % 4 != 0) {
+            s += '.';
+            size_t frac_len = rng() % 14;
+            for (size_t i = 0; i < frac_len; ++i) s += alphabet[rng() % 10];
+        }
+        // Occasionally corrupt a character
+        if (!s.empty() && rng() % 32 == 0) s[rng() % s.size()] = "x.-e "[rng() % 5];
+        return s;
+    }
+
+}
+
+int main() {
+    std::cout << "Running DecimalParser Unit Test..." << std::endl;
+    bool ok = true;
+
+    int64_t v = 0;
+    ok &= expect(hft::decimal::parse_fixed("0.1", v) && v == 10000000, "0.1 is exact");
+    ok &= expect(hft::decimal::parse_fixed("109600.01", v) && v == 10960001000000LL, "Price level");
+    ok &= expect(hft::decimal::parse_fixed("0.06317902", v) && v == 6317902, "Quantity");
+    ok &= expect(hft::decimal::parse_fixed("0.123456785", v) && v == 12345679, "Rounds half away from zero");
+    ok &= expect(hft::decimal::parse_fixed("-0.123456785", v) && v == -12345679, "Negative rounding");
+    ok &= expect(!hft::decimal::parse_fixed("", v) && !hft::decimal::parse_fixed(".", v) && !hft::decimal::parse_fixed("1e5", v), "Rejects malformed");
+    ok &= expect(!hft::decimal::parse_fixed("99999999999999", v), "Rejects overflow");
+
+    // Fuzz: equivalence against the reference
+    std::mt19937_64 rng(42);
+    constexpr size_t FUZZ_CASES = 5'000'000;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < FUZZ_CASES; ++i) {
+        std::string s = random_decimal(rng);
+        int64_t fast = 0, ref = 0;
+        bool fast_ok = hft::decimal::parse_fixed(s, fast);
+        bool ref_ok = reference_parse(s, ref);
+        if (fast_ok != ref_ok || (fast_ok && fast != ref)) {
+            if (mismatches++ < 5) std::cout << "  Mismatch on '" << s << "': " << fast << " vs " << ref << std::endl;
+        }
+    }
+    ok &= expect(mismatches == 0, "Fuzz equivalence with reference");
+
+    // scale_decimal: binary (SBE) decimals land on the same fixed point as their text form
+    ok &= expect(hft::decimal::scale_decimal(10960001, -2, v) && v == 10960001000000LL, "Decimal64 price level");
+    ok &= expect(hft::decimal::scale_decimal(123456785, -9, v) && v == 12345679, "Decimal64 rounds half away from zero");
+    ok &= expect(hft::decimal::scale_decimal(-123456785, -9, v) && v == -12345679, "Decimal64 negative rounding");
+    ok &= expect(hft::decimal::scale_decimal(5, 3, v) && v == 500000000000LL, "Decimal64 positive exponent");
+    ok &= expect(!hft::decimal::scale_decimal(INT64_MAX, 0, v) && !hft::decimal::scale_decimal(1, 12, v), "Decimal64 rejects overflow");
+    mismatches = 0;
+    for (size_t i = 0; i < FUZZ_CASES / 10; ++i) {
+        int64_t mantissa = static_cast<int64_t>(rng() % 100000000000000ULL) * (rng() % 4 == 0 ? -1 : 1);
+        int exponent = static_cast<int>(rng() % 19) - 16;
+        // Same value as text: digits with the point placed by the exponent
+        std::string digits = std::to_string(mantissa < 0 ? -mantissa : mantissa);
+        if (exponent < 0 && digits.size() <= static_cast<size_t>(-exponent)) {
+            digits.insert(0, static_cast<size_t>(-exponent) - digits.size() + 1, '0');
+        }
+        std::string text = (mantissa < 0 ? "-" : "") +
+                           (exponent >= 0 ? digits + std::string(static_cast<size_t>(exponent), '0')
+                                          : digits.insert(digits.size() - static_cast<size_t>(-exponent), "."));
+        int64_t scaled = 0, parsed = 0;
+        bool scaled_ok = hft::decimal::scale_decimal(mantissa, exponent, scaled);
+        bool parsed_ok = hft::decimal::parse_fixed(text, parsed);
+        if (scaled_ok != parsed_ok || (scaled_ok && scaled != parsed)) {
+            if (mismatches++ < 5) std::cout << "  Mismatch on " << mantissa << "e" << exponent << ": " << scaled << " vs " << parsed << std::endl;
+        }
+    }
+    ok &= expect(mismatches == 0, "Decimal64 agrees with parse_fixed on the text form");
+
+    // Exchange timestamps (the other text field on every Coinbase message)
+    using hft::utils::parse_iso8601_ns;
+    ok &= expect(parse_iso8601_ns("2023-02-09T20:32:50.714964855Z") == 1675974770714964855ULL, "ISO-8601 with ns");
+    ok &= expect(parse_iso8601_ns("2024-02-29T00:00:00Z") == 1709164800000000000ULL &&
+                 parse_iso8601_ns("2023-02-09T20:32:50.7Z") == 1675974770700000000ULL, "ISO-8601 leap day, short fraction");
+    ok &= expect(parse_iso8601_ns("2023-02-09T20:32:50.7+05:00") == 0 && parse_iso8601_ns("2023-02-09T20:32:50.7Zjunk") == 0 &&
+                 parse_iso8601_ns("2023-02-09T20:32:50.Z") == 0, "ISO-8601 rejects offsets and trailing bytes");
+    ok &= expect(parse_iso8601_ns("2023-0x-09T20:32:50Z") == 0 && parse_iso8601_ns("2023-13-09T20:32:50Z") == 0 &&
+                 parse_iso8601_ns("2023-02-29T20:32:50Z") == 0 && parse_iso8601_ns("2023-02-09T24:32:50Z") == 0 &&
+                 parse_iso8601_ns("2023-02-09T20:60:50Z") == 0, "ISO-8601 rejects non-digits and out of range fields");
+
+    // Benchmark: ns per field on Coinbase-shaped inputs
+    std::vector<std::string> fields;
+    for (size_t i = 0; i < 4096; ++i) {
+        fields.push_back(std::to_string(90000 + rng() % 20000) + "." + std::to_string(10 + rng() % 90));
+        fields.push_back("0." + std::to_string(10000000 + rng() % 90000000));
+    }
+
+    constexpr size_t ROUNDS = 500;
+    int64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        for (const auto& f : fields) {
+            int64_t x = 0;
+            hft::decimal::parse_fixed(f, x);
+            sink += x;
+        }
+    }
+    double fast_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (ROUNDS * fields.size());
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        for (const auto& f : fields) {
+            std::string_view sv = f;
+            sink += static_cast<int64_t>(std::stod(std::string(sv)) * hft::constants::PRICE_SCALE_DBL);
+        }
+    }
+    double stod_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (ROUNDS * fields.size());
+
+    std::cout << "  parse_fixed: " << fast_ns << " ns/field" << std::endl;
+    std::cout << "  std::stod:   " << stod_ns << " ns/field" << " (sink " << (sink & 1) << ")" << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#include "simulation/MatchingEngine.hpp"
+#include "common/Types.hpp"
+#include "TestUtils.hpp"
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+    using hft::test::expect;
+
+    hft::Order make_order(uint64_t id, bool is_buy, int64_t price, int64_t quantity) {
+        hft::Order order{};
+        order.id = id;
+        order.is_buy = is_buy;
+        order.price = price;
+        order.quantity = quantity;
+        return order;
+    }
+
+}
+
+int main() {
+    std::cout << "Running MatchingEngine Unit Test..." << std::endl;
+
+    constexpr uint64_t LATENCY = 100;
+    constexpr int64_t PRICE = 50000LL * 100000000LL;
+    bool ok = true;
+
+    // Partial fills are sized by the trade print
+    {
+        hft::MatchingEngine engine;
+        engine.latency_ns_ = LATENCY;
+        std::vector<hft::MatchingEngine::Fill> fills;
+
+        engine.place_order(make_order(1, true, PRICE, 1000), 0);
+        engine.on_trade_update(PRICE, 300, LATENCY, fills);
+        ok &= expect(fills.size() == 1 && fills[0].quantity == 300 && !fills[0].is_complete, "Partial fill sized by trade quantity");
+
+        engine.on_trade_update(PRICE, 5000, LATENCY + 1, fills);
+        ok &= expect(fills.size() == 2 && fills[1].quantity == 700 && fills[1].is_complete, "Remainder fills and completes order");
+        ok &= expect(engine.open_order_count() == 0, "Completed order leaves the book");
+    }
+
+    // Orders are not live before the simulated latency has elapsed
+    {
+        hft::MatchingEngine engine;
+        engine.latency_ns_ = LATENCY;
+        std::vector<hft::MatchingEngine::Fill> fills;
+
+        engine.place_order(make_order(1, false, PRICE, 1000), 0);
+        engine.on_trade_update(PRICE, 1000, LATENCY - 1, fills);
+        ok &= expect(fills.empty(), "No fill before order is live");
+    }
+
+    // Cancels see the same latency as places, so a print in between still fills
+    {
+        hft::MatchingEngine engine;
+        engine.latency_ns_ = LATENCY;
+        std::vector<hft::MatchingEngine::Fill> fills;
+
+        engine.place_order(make_order(1, true, PRICE, 1000), 0);
+        engine.cancel_order(1, LATENCY);
+        ok &= expect(engine.open_order_count() == 1, "Queued cancel is not counted as an order");
+        engine.on_trade_update(PRICE, 400, LATENCY + 1, fills);
+        ok &= expect(fills.size() == 1 && fills[0].quantity == 400, "Fill before cancel arrives stands");
+
+        engine.on_trade_update(PRICE, 400, 2 * LATENCY, fills);
+        ok &= expect(fills.size() == 1 && engine.open_order_count() == 0, "Cancel removes remainder once live");
+    }
+
+    // Replace amends price once live
+    {
+        hft::MatchingEngine engine;
+        engine.latency_ns_ = LATENCY;
+        std::vector<hft::MatchingEngine::Fill> fills;
+
+        engine.place_order(make_order(1, true, PRICE, 1000), 0);
+        hft::Order amend = make_order(1, true, PRICE - 100, 1000);
+        amend.action = hft::OrderAction::REPLACE;
+        engine.submit(amend, LATENCY);
+
+        engine.on_trade_update(PRICE - 50, 1000, 2 * LATENCY, fills);
+        ok &= expect(fills.empty(), "Amended (lower) bid not hit by print above it");
+        engine.on_trade_update(PRICE - 100, 1000, 2 * LATENCY + 1, fills);
+        ok &= expect(fills.size() == 1 && fills[0].price == PRICE - 100, "Amended bid fills at new price");
+    }
+
+    // Throughput: place/replace/cancel churn with a trade print per event
+    {
+        hft::MatchingEngine engine;
+        engine.latency_ns_ = LATENCY;
+        std::vector<hft::MatchingEngine::Fill> fills;
+        fills.reserve(1 << 20);
+
+        constexpr uint64_t EVENTS = 20'000'000;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < EVENTS; ++i) {
+            uint64_t id = i / 4;
+            switch (i & 3) {
+                case 0: engine.place_order(make_order(id, (id & 1) != 0, PRICE, 1000), i); break;
+                case 1: {
+                    hft::Order amend = make_order(id, (id & 1) != 0, PRICE + 1, 1000);
+                    engine.replace_order(amend, i);
+                    break;
+                }
+                case 2: engine.on_trade_update(PRICE + 2, 300, i, fills); break;
+                case 3: engine.cancel_order(id, i); break;
+            }
+            if (fills.size() == fills.capacity()) fills.clear();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rate = EVENTS / elapsed;
+        std::cout << "  Throughput: " << rate / 1e6 << " M events/s" << std::endl;
+        ok &= expect(rate > 10e6, "Throughput above 10M events/s");
+    }
+
+    return ok ? 0 : 1;
+}
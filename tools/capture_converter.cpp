@@ -0,0 +1,256 @@
+#include "feed_handler/CoinbaseLive.hpp"
+#include "storage/CaptureReader.hpp"
+#include "storage/TickStore.hpp"
+#include "common/RingBuffer.hpp"
+#include "common/Types.hpp"
+#include "common/Utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Coinbase capture -> BinaryTick converter
+// Runs captured WebSocket frames (market_data.bin, block-indexed or bare) through
+// CoinbaseFeedHandler::process_message offline, at full speed, and writes the ticks as a
+// BinaryTick file that FeedHandler::init maps directly. Captures are sharded one file per
+// thread; every shard has its own handler, ring and output file, so shards share nothing.
+// Ticks keep what the live handler produced (snapshot flag, end_of_message, exchange
+// timestamp, rx TSC) except for:
+//   id          running tick number within the file
+//   timestamp   rx time in microseconds since the Unix epoch (what FeedHandler paces on),
+//               from the capture's TSC calibration; bare captures, which carry none, are
+//               anchored at the first tick's exchange time and scaled with this machine's TSC rate
+// Usage: capture_converter [--threads N] [--out-dir DIR] [--columnar] [capture... | @list]
+//   Output for <dir>/<name> is <dir>/<name>.ticks (or DIR/<name>.ticks); default market_data.bin
+//   --columnar  Write a compressed columnar tick store (<name>.tcol) instead of raw BinaryTick
+
+using namespace hft;
+
+namespace {
+
+    using TickRing = RingBuffer<BinaryTick, constants::RING_BUFFER_SIZE>;
+
+    constexpr size_t WRITE_BATCH = 1 << 16; // Ticks per write() (4 MB)
+
+    struct Shard {
+        std::string input;
+        std::string output;
+        bool ok = false;
+        uint64_t messages = 0;
+        uint64_t bytes = 0;
+        uint64_t ticks = 0;
+        uint64_t snapshots = 0;
+        uint64_t file_bytes = 0;
+        double seconds = 0;
+    };
+
+    // Function: TimeBase
+    // Description: Maps rx TSC to Unix microseconds.
+    struct TimeBase {
+        double cycles_per_ns = 0;
+        uint64_t tsc_anchor = 0;
+        int64_t unix_ns_anchor = 0;
+        bool set = false;
+
+        uint64_t to_unix_us(uint64_t tsc) const {
+            int64_t delta_ns = static_cast<int64_t>(static_cast<double>(static_cast<int64_t>(tsc - tsc_anchor)) / cycles_per_ns);
+            int64_t ns = unix_ns_anchor + delta_ns;
+            return ns > 0 ? static_cast<uint64_t>(ns) / 1000 : 0;
+        }
+    };
+
+    std::vector<std::string> expand_file_list(const std::vector<std::string>& args) {
+        std::vector<std::string> files;
+        for (const auto& arg : args) {
+            if (arg.size() > 1 && arg[0] == '@') {
+                std::ifstream list(arg.substr(1));
+                std::string line;
+                while (std::getline(list, line)) {
+                    if (!line.empty() && line[0] != '#') files.push_back(line);
+                }
+            } else {
+                files.push_back(arg);
+            }
+        }
+        return files;
+    }
+
+    std::string output_path(const std::string& input, const std::string& out_dir, bool columnar) {
+        const char* suffix = columnar ? ".tcol" : ".ticks";
+        if (out_dir.empty()) return input + suffix;
+        size_t slash = input.find_last_of('/');
+        std::string name = slash == std::string::npos ? input : input.substr(slash + 1);
+        return out_dir + "/" + name + suffix;
+    }
+
+    // Function: drain
+    // Description: Shard writer thread. Pops ticks off the handler's ring, stamps id and
+    //              timestamp, and hands them to sink(ticks, count) in WRITE_BATCH runs.
+    //              Runs until the parser is done and the ring is empty.
+    template<typename Sink>
+    bool drain(TickRing& ring, const std::atomic<bool>& parsing, TimeBase base, Shard& shard, Sink&& sink) {
+        std::vector<BinaryTick> batch(WRITE_BATCH);
+        size_t fill = 0;
+        bool ok = true;
+        while (true) {
+            bool finished = !parsing.load(std::memory_order_acquire);
+            BinaryTick& t = batch[fill];
+            if (!ring.pop(t)) {
+                if (finished) break;
+                // The parser refills 64K ticks in a few ms; sleeping leaves the core to it
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                continue;
+            }
+            if (!base.set) {
+                base.tsc_anchor = t.rx_timestamp;
+                base.unix_ns_anchor = static_cast<int64_t>(t.exchange_timestamp);
+                base.set = true;
+            }
+            t.id = shard.ticks++;
+            t.timestamp = base.to_unix_us(t.rx_timestamp);
+            shard.snapshots += t.is_snapshot;
+            if (++fill == batch.size()) {
+                ok &= sink(batch.data(), fill);
+                fill = 0;
+            }
+        }
+        ok &= sink(batch.data(), fill);
+        return ok;
+    }
+
+    // Function: convert
+    // Description: Converts one capture. The calling thread parses; a second thread drains
+    //              the ring to disk, so a message (e.g. a book snapshot) may publish more
+    //              ticks than the ring holds.
+    void convert(Shard& shard, bool columnar) {
+        auto start = std::chrono::steady_clock::now();
+
+        storage::CaptureReader reader;
+        if (!reader.open(shard.input)) {
+            std::cerr << "[Convert] Cannot open " << shard.input << std::endl;
+            return;
+        }
+        std::FILE* out = nullptr;
+        storage::TickStoreWriter store(shard.output);
+        if (columnar ? !store.open() : !(out = std::fopen(shard.output.c_str(), "wb"))) {
+            std::cerr << "[Convert] Cannot create " << shard.output << std::endl;
+            return;
+        }
+
+        TimeBase base;
+        base.cycles_per_ns = utils::CYCLES_PER_NS;
+        if (reader.block_format() && reader.header().cycles_per_ns > 0) {
+            base.cycles_per_ns = reader.header().cycles_per_ns;
+            base.tsc_anchor = reader.header().tsc_anchor;
+            base.unix_ns_anchor = reader.header().unix_ns_anchor;
+            base.set = true;
+        }
+
+        auto ring = std::make_unique<TickRing>();
+        CoinbaseFeedHandler handler(*ring);
+        std::atomic<bool> parsing{true};
+        bool written = false;
+        std::thread writer([&] {
+            written = drain(*ring, parsing, base, shard, [&](const BinaryTick* ticks, size_t count) {
+                if (columnar) {
+                    for (size_t i = 0; i < count; ++i) store.append(ticks[i]);
+                    return true;
+                }
+                return std::fwrite(ticks, sizeof(BinaryTick), count, out) == count;
+            });
+        });
+
+        storage::CaptureRecord record;
+        while (reader.next(record)) {
+            handler.process_message(record.data, record.timestamp);
+            ++shard.messages;
+            shard.bytes += record.data.size();
+        }
+        parsing.store(false, std::memory_order_release);
+        writer.join();
+
+        shard.ok = written && (columnar ? store.close() : std::fclose(out) == 0);
+        shard.file_bytes = columnar ? store.file_bytes() : shard.ticks * sizeof(BinaryTick);
+        shard.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!shard.ok) std::cerr << "[Convert] Write failed: " << shard.output << std::endl;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string out_dir;
+    bool columnar = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--out-dir") == 0 && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--columnar") == 0) {
+            columnar = true;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.empty()) args.push_back("market_data.bin");
+
+    utils::calibrate_tsc();
+
+    std::vector<Shard> shards;
+    for (const auto& file : expand_file_list(args)) {
+        Shard shard;
+        shard.input = file;
+        shard.output = output_path(file, out_dir, columnar);
+        shards.push_back(std::move(shard));
+    }
+    // Captures all default to market_data.bin; two of them must not share an output under --out-dir
+    for (size_t i = 0; i < shards.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (shards[i].output == shards[j].output) {
+                std::cerr << "[Convert] " << shards[j].input << " and " << shards[i].input << " both map to "
+                          << shards[i].output << "; convert them into different directories" << std::endl;
+                return 1;
+            }
+        }
+    }
+    threads = std::min(threads, shards.size());
+
+    // Shards pull the next capture as they finish one
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next_shard{0};
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&] {
+            for (size_t i; (i = next_shard.fetch_add(1)) < shards.size();) convert(shards[i], columnar);
+        });
+    }
+    for (auto& thread : pool) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t messages = 0, bytes = 0, ticks = 0;
+    size_t failed = 0;
+    for (const auto& shard : shards) {
+        if (!shard.ok) {
+            ++failed;
+            continue;
+        }
+        std::cout << shard.output << ": " << shard.ticks << " ticks (" << shard.snapshots << " snapshot) from "
+                  << shard.messages << " messages in " << shard.seconds << " s, " << shard.file_bytes / 1e6 << " MB"
+                  << std::endl;
+        messages += shard.messages;
+        bytes += shard.bytes;
+        ticks += shard.ticks;
+    }
+    std::cout << "Converted " << shards.size() - failed << "/" << shards.size() << " captures on " << threads
+              << " threads: " << messages << " messages, " << ticks << " ticks in " << seconds << " s ("
+              << messages / seconds << " msgs/s, " << bytes / 1e6 / seconds << " MB/s of JSON)" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -1,116 +1,294 @@
 #include "../include/common/Types.hpp"
+#include "../include/common/DecimalParser.hpp"
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <string>
 #include <charconv>
+#include <chrono>
 #include <cstring>
 #include <string_view>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Binance trades CSV -> BinaryTick converter
+// Input rows: id, price, qty, quote_qty, time, is_buyer_maker, is_best_match
+// The input is mmapped and cut into newline-aligned chunks, one per thread:
+//   1. Each thread counts the rows in its chunk (SIMD newline count).
+//   2. Prefix sums give every chunk its slot range in the output file, which is
+//      preallocated and mmapped, so threads parse straight into their slots.
+// Prices and quantities are parsed exactly into fixed point (no double round trip).
+// Usage: converter <input_csv> <output_bin> [threads]
 
 using namespace hft;
 
-void parse_line(std::string_view line, BinaryTick& tick) {
-    // Format: id, price, qty, quote_qty, time, is_buyer_maker, is_best_match
-    
-    auto find_next = [&](size_t start) {
-        return line.find(',', start);
-    };
+namespace {
 
-    size_t start = 0;
-    size_t end = find_next(start);
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        size_t rows = 0;      // Output slots reserved (upper bound on ticks)
+        size_t written = 0;   // Ticks actually produced
+        size_t skipped = 0;   // Blank or malformed lines
+    };
 
-    // 1. ID
-    if (end != std::string_view::npos) {
-        std::from_chars(line.data() + start, line.data() + end, tick.id);
-        start = end + 1;
-        end = find_next(start);
+    // Function: count_lines
+    // Description: Counts '\n' in [p, end).
+    size_t count_lines(const char* p, const char* end) {
+        size_t count = 0;
+#ifdef __AVX2__
+        const __m256i newline = _mm256_set1_epi8('\n');
+        for (; p + 32 <= end; p += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            count += static_cast<size_t>(__builtin_popcount(
+                static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)))));
+        }
+#endif
+        for (; p < end; ++p) count += (*p == '\n');
+        return count;
     }
 
-    // 2. Price
-    if (end != std::string_view::npos) {
-        double temp_price;
-        std::from_chars(line.data() + start, line.data() + end, temp_price);
-        tick.price = static_cast<int64_t>(temp_price * 100000000); // Convert to Satoshis
-        start = end + 1;
-        end = find_next(start);
+    // Function: DelimiterScanner
+    // Description: Yields the positions of ',' and '\n' in [begin, end) in order, scanning
+    //              64 bytes per step (two AVX2 compares) and walking the resulting bitmask.
+    class DelimiterScanner {
+    public:
+        DelimiterScanner(const char* begin, const char* end) : base_(begin), end_(begin), limit_(end) {}
+
+        // Outputs: Pointer to the next delimiter, or nullptr at the end of the range.
+        const char* next() {
+            while (mask_ == 0) {
+                if (end_ >= limit_) return nullptr;
+                base_ = end_;
+                refill();
+            }
+            int bit = __builtin_ctzll(mask_);
+            mask_ &= mask_ - 1;
+            return base_ + bit;
+        }
+
+    private:
+        void refill() {
+#ifdef __AVX2__
+            if (limit_ - base_ >= 64) {
+                const __m256i comma = _mm256_set1_epi8(',');
+                const __m256i newline = _mm256_set1_epi8('\n');
+                __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base_));
+                __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base_ + 32));
+                uint32_t lo_mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(lo, comma), _mm256_cmpeq_epi8(lo, newline))));
+                uint32_t hi_mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(hi, comma), _mm256_cmpeq_epi8(hi, newline))));
+                mask_ = (static_cast<uint64_t>(hi_mask) << 32) | lo_mask;
+                end_ = base_ + 64;
+                return;
+            }
+#endif
+            size_t n = std::min<size_t>(64, static_cast<size_t>(limit_ - base_));
+            mask_ = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (base_[i] == ',' || base_[i] == '\n') mask_ |= 1ULL << i;
+            }
+            end_ = base_ + n;
+        }
+
+        const char* base_;
+        const char* end_;
+        const char* limit_;
+        uint64_t mask_ = 0;
+    };
+
+    template<typename T>
+    bool parse_uint(std::string_view field, T& out) {
+        auto r = std::from_chars(field.data(), field.data() + field.size(), out);
+        return r.ec == std::errc() && r.ptr == field.data() + field.size();
     }
 
-    // 3. Quantity
-    if (end != std::string_view::npos) {
-        double temp_qty;
-        std::from_chars(line.data() + start, line.data() + end, temp_qty);
-        tick.quantity = static_cast<int64_t>(temp_qty * 100000000); // Convert to Satoshis
-        start = end + 1;
-        end = find_next(start);
+    uint64_t encode_symbol(const char* symbol) {
+        uint64_t encoded = 0;
+        std::memcpy(&encoded, symbol, std::min(std::strlen(symbol), sizeof(uint64_t)));
+        return encoded;
     }
 
-    // 4. Quote Quantity (Skip)
-    if (end != std::string_view::npos) {
-        start = end + 1;
-        end = find_next(start);
+    // Function: parse_row
+    // Description: Builds a tick from the row's fields (id, price, qty, quote_qty, time, is_buyer_maker).
+    bool parse_row(const std::string_view* fields, size_t count, uint64_t symbol, BinaryTick& tick) {
+        if (count < 6) return false;
+        tick = BinaryTick{};
+        if (!parse_uint(fields[0], tick.id)) return false;
+        if (!decimal::parse_fixed(fields[1], tick.price)) return false;
+        if (!decimal::parse_fixed(fields[2], tick.quantity)) return false;
+        if (!parse_uint(fields[4], tick.timestamp)) return false;
+
+        // is_buyer_maker (True = Sell/Bid, False = Buy/Ask)
+        tick.is_bid = fields[5] == "True" || fields[5] == "true";
+
+        // Each CSV row is one exchange event
+        tick.end_of_message = true;
+        tick.symbol = symbol;
+        return true;
     }
 
-    // 5. Timestamp
-    if (end != std::string_view::npos) {
-        std::from_chars(line.data() + start, line.data() + end, tick.timestamp);
-        start = end + 1;
-        end = find_next(start);
+    // Function: convert_chunk
+    // Description: Parses every row of the chunk into consecutive output slots.
+    void convert_chunk(Chunk& chunk, BinaryTick* out, uint64_t symbol) {
+        constexpr size_t MAX_FIELDS = 8;
+        std::string_view fields[MAX_FIELDS];
+        size_t field_count = 0;
+        const char* field_start = chunk.begin;
+
+        auto finish_row = [&](const char* row_end) {
+            std::string_view last(field_start, static_cast<size_t>(row_end - field_start));
+            if (!last.empty() && last.back() == '\r') last.remove_suffix(1);
+            if (field_count < MAX_FIELDS) fields[field_count++] = last;
+
+            if (chunk.written < chunk.rows && parse_row(fields, field_count, symbol, out[chunk.written])) {
+                ++chunk.written;
+            } else if (field_count > 1 || !fields[0].empty()) {
+                ++chunk.skipped;
+            }
+            field_count = 0;
+        };
+
+        DelimiterScanner scanner(chunk.begin, chunk.end);
+        while (const char* delim = scanner.next()) {
+            if (*delim == ',') {
+                if (field_count < MAX_FIELDS) {
+                    fields[field_count++] = std::string_view(field_start, static_cast<size_t>(delim - field_start));
+                }
+            } else {
+                finish_row(delim);
+            }
+            field_start = delim + 1;
+        }
+        // Unterminated last line of the file
+        if (field_start < chunk.end) finish_row(chunk.end);
     }
 
-    // 6. is_buyer_maker (True = Sell/Bid, False = Buy/Ask)
-    if (end != std::string_view::npos) {
-        std::string_view is_bid_str = line.substr(start, end - start);
-        tick.is_bid = (is_bid_str == "True");
-    } else {
-        // Handle case where it's the last field or something
-        std::string_view is_bid_str = line.substr(start);
-        tick.is_bid = (is_bid_str == "True");
+    double seconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
     }
 
-    // Symbol
-    // Optimization: Store symbol as uint64_t
-    const char* symbol_str = "BTCUSDT";
-    tick.symbol = 0;
-    std::memcpy(&tick.symbol, symbol_str, std::min(std::strlen(symbol_str), sizeof(uint64_t)));
 }
 
 int main(int argc, char* argv[]) {
     if (argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " <input_csv> <output_bin>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <input_csv> <output_bin> [threads]" << std::endl;
         return 1;
     }
+    size_t threads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
 
-    std::ifstream csv(argv[1]);
-    std::ofstream bin(argv[2], std::ios::binary);
+    auto start = std::chrono::steady_clock::now();
 
-    if (!csv.is_open() || !bin.is_open()) {
+    int in_fd = open(argv[1], O_RDONLY);
+    struct stat st;
+    if (in_fd < 0 || fstat(in_fd, &st) != 0) {
         std::cerr << "Failed to open files." << std::endl;
         return 1;
     }
+    size_t in_size = static_cast<size_t>(st.st_size);
+    if (in_size == 0) {
+        std::cerr << "Input is empty." << std::endl;
+        return 1;
+    }
+    const char* in = static_cast<const char*>(mmap(nullptr, in_size, PROT_READ, MAP_PRIVATE, in_fd, 0));
+    close(in_fd);
+    if (in == MAP_FAILED) {
+        std::cerr << "mmap failed" << std::endl;
+        return 1;
+    }
+    madvise(const_cast<char*>(in), in_size, MADV_SEQUENTIAL);
+    madvise(const_cast<char*>(in), in_size, MADV_WILLNEED);
 
-    std::string line;
+    const char* body = in;
+    const char* in_end = in + in_size;
     // Check for header
-    if (std::getline(csv, line)) {
-        if (!line.empty() && !isdigit(line[0])) {
-            // It's a header, skip it
-        } else {
-            // Not a header, reset
-            csv.clear();
-            csv.seekg(0);
+    if (!isdigit(static_cast<unsigned char>(in[0]))) {
+        const char* newline = static_cast<const char*>(std::memchr(in, '\n', in_size));
+        body = newline ? newline + 1 : in_end;
+    }
+
+    // 1. Newline-aligned chunks
+    size_t body_size = static_cast<size_t>(in_end - body);
+    threads = std::max<size_t>(1, std::min(threads, body_size / (1 << 20) + 1));
+    std::vector<Chunk> chunks;
+    const char* chunk_begin = body;
+    for (size_t i = 1; i <= threads && chunk_begin < in_end; ++i) {
+        const char* chunk_end = i == threads ? in_end : body + body_size * i / threads;
+        if (chunk_end < chunk_begin) chunk_end = chunk_begin;
+        if (chunk_end < in_end) {
+            const char* newline = static_cast<const char*>(std::memchr(chunk_end, '\n', static_cast<size_t>(in_end - chunk_end)));
+            chunk_end = newline ? newline + 1 : in_end;
         }
+        chunks.push_back({chunk_begin, chunk_end});
+        chunk_begin = chunk_end;
+    }
+
+    // 2. Row counts per chunk, in parallel
+    auto run_parallel = [&](auto&& fn) {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < chunks.size(); ++i) workers.emplace_back(fn, i);
+        fn(0);
+        for (auto& worker : workers) worker.join();
+    };
+    run_parallel([&](size_t i) {
+        chunks[i].rows = count_lines(chunks[i].begin, chunks[i].end);
+    });
+
+    std::vector<size_t> first_slot(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        // Chunks end on '\n' except the last, which may hold a final unterminated line
+        if (i + 1 == chunks.size()) ++chunks[i].rows;
+        first_slot[i + 1] = first_slot[i] + chunks[i].rows;
     }
+    size_t capacity = first_slot.back();
+    double count_seconds = seconds_since(start);
 
-    uint64_t count = 0;
-    while (std::getline(csv, line)) {
-        BinaryTick tick{};
-        parse_line(line, tick);
-        bin.write(reinterpret_cast<char*>(&tick), sizeof(BinaryTick));
-        count++;
-        if (count % 1000000 == 0) {
-            std::cout << "Processed " << count << " ticks..." << std::endl;
+    // 3. Preallocated, mmapped output
+    int out_fd = open(argv[2], O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0 || ftruncate(out_fd, static_cast<off_t>(capacity * sizeof(BinaryTick))) != 0) {
+        std::cerr << "Failed to open files." << std::endl;
+        return 1;
+    }
+    auto* out = static_cast<BinaryTick*>(mmap(nullptr, capacity * sizeof(BinaryTick), PROT_READ | PROT_WRITE, MAP_SHARED, out_fd, 0));
+    if (out == MAP_FAILED) {
+        std::cerr << "mmap failed" << std::endl;
+        return 1;
+    }
+
+    // 4. Parse every chunk straight into its slots
+    const uint64_t symbol = encode_symbol("BTCUSDT");
+    run_parallel([&](size_t i) {
+        convert_chunk(chunks[i], out + first_slot[i], symbol);
+    });
+
+    // 5. Close the gaps left by skipped lines, then trim the file
+    size_t count = 0;
+    size_t skipped = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (count != first_slot[i]) {
+            std::memmove(out + count, out + first_slot[i], chunks[i].written * sizeof(BinaryTick));
         }
+        count += chunks[i].written;
+        skipped += chunks[i].skipped;
+    }
+    munmap(out, capacity * sizeof(BinaryTick));
+    if (ftruncate(out_fd, static_cast<off_t>(count * sizeof(BinaryTick))) != 0) {
+        std::cerr << "Failed to trim output." << std::endl;
     }
+    close(out_fd);
+    munmap(const_cast<char*>(in), in_size);
 
-    std::cout << "Conversion complete. " << count << " ticks written." << std::endl;
+    double total_seconds = seconds_since(start);
+    std::cout << "Conversion complete. " << count << " ticks written";
+    if (skipped > 0) std::cout << " (" << skipped << " malformed lines skipped)";
+    std::cout << "." << std::endl;
+    std::cout << "  " << chunks.size() << " threads, " << in_size / 1e9 << " GB in " << total_seconds << " s ("
+              << in_size / 1e9 / total_seconds << " GB/s; row count " << count_seconds * 1e3 << " ms)" << std::endl;
     return 0;
 }
@@ -0,0 +1,420 @@
+"""SBE schema -> C++ flyweight header.
+
+Reads an SBE 1.0 message schema (schema/coinbase_market_data.xml) and writes a single
+header of zero-copy decoders: enum classes, composite and message flyweights that read
+fields in place with memcpy (no alignment requirement, no copies of the buffer), and
+range-for iterable repeating groups that step by the blockLength found on the wire.
+
+Message::wrap() validates everything the accessors touch before any of them are called:
+the message header, the root block and every group header and group body must fit the
+buffer, and block lengths may only be larger than the schema's (newer minor versions
+append fields). After a successful wrap no accessor needs a bounds check.
+
+Supported: little endian, primitive/enum/composite fields, one level of repeating
+groups. Variable length data, nested groups, arrays and constants are rejected.
+
+Usage: sbe_codegen.py schema.xml output.hpp [--namespace hft::sbe::coinbase]
+"""
+
+import argparse
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+PRIMITIVES = {
+    'char': ('char', 1),
+    'int8': ('int8_t', 1),
+    'uint8': ('uint8_t', 1),
+    'int16': ('int16_t', 2),
+    'uint16': ('uint16_t', 2),
+    'int32': ('int32_t', 4),
+    'uint32': ('uint32_t', 4),
+    'int64': ('int64_t', 8),
+    'uint64': ('uint64_t', 8),
+    'float': ('float', 4),
+    'double': ('double', 8),
+}
+
+
+class SchemaError(Exception):
+    pass
+
+
+def local(tag):
+    return tag.split('}', 1)[-1]
+
+
+def snake(name):
+    # TransactTime -> transact_time, MDEntryPx -> md_entry_px, numInGroup -> num_in_group
+    name = re.sub(r'([A-Z]+)([A-Z][a-z])', r'\1_\2', name)
+    name = re.sub(r'([a-z0-9])([A-Z])', r'\1_\2', name)
+    return name.lower()
+
+
+def upper(name):
+    return snake(name).upper()
+
+
+def pascal(name):
+    return name[0].upper() + name[1:]
+
+
+class Schema:
+    def __init__(self, path):
+        root = ET.parse(path).getroot()
+        if local(root.tag) != 'messageSchema':
+            raise SchemaError('root element is not messageSchema')
+        if root.get('byteOrder', 'littleEndian') != 'littleEndian':
+            raise SchemaError('only littleEndian schemas are supported')
+        self.source = os.path.basename(path)
+        self.id = int(root.get('id'))
+        self.version = int(root.get('version', '0'))
+        self.description = root.get('description', '')
+        self.types = {}  # name -> dict(kind, cpp, size, ...)
+        self.order = []  # type names in declaration order (for emission)
+        self.messages = []
+
+        for types in root.iter():
+            if local(types.tag) != 'types':
+                continue
+            for node in types:
+                self.add_type(node)
+
+        for node in root:
+            if local(node.tag) == 'message':
+                self.messages.append(self.parse_message(node))
+
+        for required in ('messageHeader', 'groupSizeEncoding'):
+            if required not in self.types:
+                raise SchemaError(f'schema has no {required} composite')
+
+    def add_type(self, node):
+        kind = local(node.tag)
+        name = node.get('name')
+        if node.get('presence') == 'constant' or int(node.get('length', '1')) != 1:
+            raise SchemaError(f'type {name}: constants and arrays are not supported')
+        if kind == 'type':
+            prim = node.get('primitiveType')
+            if prim not in PRIMITIVES:
+                raise SchemaError(f'type {name}: unknown primitiveType {prim}')
+            cpp, size = PRIMITIVES[prim]
+            self.types[name] = dict(kind='type', cpp=cpp, size=size, description=node.get('description', ''))
+        elif kind == 'enum':
+            encoding = node.get('encodingType')
+            if encoding not in PRIMITIVES:
+                raise SchemaError(f'enum {name}: encodingType must be a primitive')
+            cpp, size = PRIMITIVES[encoding]
+            values = [(v.get('name'), v.text.strip()) for v in node if local(v.tag) == 'validValue']
+            self.types[name] = dict(kind='enum', cpp=pascal(name), underlying=cpp, size=size, values=values,
+                                    description=node.get('description', ''))
+            self.order.append(name)
+        elif kind == 'composite':
+            members = []
+            offset = 0
+            for member in node:
+                if local(member.tag) != 'type':
+                    raise SchemaError(f'composite {name}: only primitive members are supported')
+                prim = member.get('primitiveType')
+                if prim not in PRIMITIVES or int(member.get('length', '1')) != 1:
+                    raise SchemaError(f'composite {name}: member {member.get("name")} is not a scalar primitive')
+                offset = int(member.get('offset', offset))
+                cpp, size = PRIMITIVES[prim]
+                members.append(dict(name=member.get('name'), cpp=cpp, size=size, offset=offset))
+                offset += size
+            self.types[name] = dict(kind='composite', cpp=pascal(name), size=offset, members=members,
+                                    description=node.get('description', ''))
+            self.order.append(name)
+        else:
+            raise SchemaError(f'unsupported type element <{kind}>')
+
+    def parse_fields(self, node, owner):
+        fields, groups = [], []
+        offset = 0
+        for child in node:
+            kind = local(child.tag)
+            if kind == 'field':
+                if groups:
+                    raise SchemaError(f'{owner}: field {child.get("name")} follows a group')
+                type_name = child.get('type')
+                if type_name in PRIMITIVES:
+                    cpp, size = PRIMITIVES[type_name]
+                    t = dict(kind='type', cpp=cpp, size=size)
+                elif type_name in self.types:
+                    t = self.types[type_name]
+                else:
+                    raise SchemaError(f'{owner}: field {child.get("name")} has unknown type {type_name}')
+                offset = int(child.get('offset', offset))
+                fields.append(dict(name=child.get('name'), id=int(child.get('id')), type=t, offset=offset))
+                offset += t['size']
+            elif kind == 'group':
+                if owner.count('.'):
+                    raise SchemaError(f'{owner}: nested groups are not supported')
+                if child.get('dimensionType', 'groupSizeEncoding') != 'groupSizeEncoding':
+                    raise SchemaError(f'{owner}: group {child.get("name")} must use groupSizeEncoding')
+                group_fields, _, block = self.parse_fields(child, owner + '.' + child.get('name'))
+                block = int(child.get('blockLength', block))
+                groups.append(dict(name=child.get('name'), id=int(child.get('id')), fields=group_fields,
+                                   block=block))
+            elif kind == 'data':
+                raise SchemaError(f'{owner}: variable length data is not supported')
+        return fields, groups, offset
+
+    def parse_message(self, node):
+        name = node.get('name')
+        fields, groups, block = self.parse_fields(node, name)
+        block = int(node.get('blockLength', block))
+        return dict(name=name, id=int(node.get('id')), fields=fields, groups=groups, block=block,
+                    description=node.get('description', ''))
+
+
+class Writer:
+    def __init__(self):
+        self.lines = []
+        self.depth = 0
+
+    def __call__(self, text=''):
+        self.lines.append(('    ' * self.depth + text) if text else '')
+
+    def indent(self):
+        self.depth += 1
+
+    def dedent(self):
+        self.depth -= 1
+
+
+def emit_accessor(w, field):
+    t = field['type']
+    name = snake(field['name'])
+    off = field['offset']
+    if t['kind'] == 'type':
+        w(f'{t["cpp"]} {name}() const {{ return detail::load<{t["cpp"]}>(p_ + {off}); }}')
+    elif t['kind'] == 'enum':
+        w(f'{t["cpp"]} {name}() const {{ return static_cast<{t["cpp"]}>(detail::load<{t["underlying"]}>(p_ + {off})); }}')
+    else:
+        w(f'{t["cpp"]} {name}() const {{ return {t["cpp"]}(p_ + {off}); }}')
+
+
+def emit_enum(w, t):
+    if t['description']:
+        w(f'// {t["description"]}')
+    w(f'enum class {t["cpp"]} : {t["underlying"]} {{')
+    w.indent()
+    for value_name, value in t['values']:
+        w(f'{upper(value_name)} = {value},')
+    w.dedent()
+    w('};')
+    w()
+
+
+def emit_composite(w, t):
+    if t['description']:
+        w(f'// {t["description"]}')
+    w(f'class {t["cpp"]} {{')
+    w('public:')
+    w.indent()
+    w(f'static constexpr size_t ENCODED_LENGTH = {t["size"]};')
+    w()
+    w(f'explicit {t["cpp"]}(const uint8_t* p) : p_(p) {{}}')
+    w()
+    for m in t['members']:
+        w(f'{m["cpp"]} {snake(m["name"])}() const {{ return detail::load<{m["cpp"]}>(p_ + {m["offset"]}); }}')
+    w.dedent()
+    w()
+    w('private:')
+    w.indent()
+    w('const uint8_t* p_;')
+    w.dedent()
+    w('};')
+    w()
+
+
+def emit_group(w, group):
+    name = pascal(group['name'])
+    w(f'// Repeating group {group["name"]} (id {group["id"]}). Entries are {group["block"]} bytes in this')
+    w('// schema version; iteration steps by the blockLength on the wire.')
+    w(f'class {name} {{')
+    w('public:')
+    w.indent()
+    w(f'static constexpr uint16_t ID = {group["id"]};')
+    w(f'static constexpr uint16_t BLOCK_LENGTH = {group["block"]};')
+    w()
+    w('class Entry {')
+    w('public:')
+    w.indent()
+    w('explicit Entry(const uint8_t* p) : p_(p) {}')
+    w()
+    for field in group['fields']:
+        emit_accessor(w, field)
+    w.dedent()
+    w()
+    w('private:')
+    w.indent()
+    w('const uint8_t* p_;')
+    w.dedent()
+    w('};')
+    w()
+    w('class Iterator {')
+    w('public:')
+    w.indent()
+    w('Iterator(const uint8_t* p, uint16_t stride) : p_(p), stride_(stride) {}')
+    w('Entry operator*() const { return Entry(p_); }')
+    w('Iterator& operator++() { p_ += stride_; return *this; }')
+    w('bool operator!=(const Iterator& other) const { return p_ != other.p_; }')
+    w.dedent()
+    w()
+    w('private:')
+    w.indent()
+    w('const uint8_t* p_;')
+    w('uint16_t stride_;')
+    w.dedent()
+    w('};')
+    w()
+    w(f'{name}() = default;')
+    w(f'{name}(const uint8_t* entries, uint16_t stride, uint16_t count)')
+    w('    : p_(entries), stride_(stride), count_(count) {}')
+    w()
+    w('uint16_t count() const { return count_; }')
+    w('bool empty() const { return count_ == 0; }')
+    w('Entry operator[](size_t i) const { return Entry(p_ + i * stride_); }')
+    w('Iterator begin() const { return Iterator(p_, stride_); }')
+    w('Iterator end() const { return Iterator(p_ + static_cast<size_t>(count_) * stride_, stride_); }')
+    w.dedent()
+    w()
+    w('private:')
+    w.indent()
+    w('const uint8_t* p_ = nullptr;')
+    w('uint16_t stride_ = 0;')
+    w('uint16_t count_ = 0;')
+    w.dedent()
+    w('};')
+    w()
+
+
+def emit_message(w, msg):
+    name = pascal(msg['name'])
+    w(f'// Function: {name}')
+    w(f'// Description: {msg["description"] or msg["name"]} (template {msg["id"]}).')
+    w(f'class {name} {{')
+    w('public:')
+    w.indent()
+    w(f'static constexpr uint16_t TEMPLATE_ID = {msg["id"]};')
+    w(f'static constexpr uint16_t BLOCK_LENGTH = {msg["block"]};')
+    w()
+    for group in msg['groups']:
+        emit_group(w, group)
+
+    w('// Function: wrap')
+    w('// Description: Points the flyweight at a message (starting at its header) and checks')
+    w('//              that the header, root block and every group fit in len bytes.')
+    w('// Outputs: False if the message is not this template or is truncated/malformed.')
+    w('bool wrap(const uint8_t* buffer, size_t len) {')
+    w.indent()
+    w('if (len < MessageHeader::ENCODED_LENGTH) return false;')
+    w('MessageHeader header(buffer);')
+    w('if (header.template_id() != TEMPLATE_ID || header.schema_id() != SCHEMA_ID) return false;')
+    w('uint16_t block = header.block_length();')
+    w('size_t pos = MessageHeader::ENCODED_LENGTH;')
+    w('if (block < BLOCK_LENGTH || len - pos < block) return false;')
+    w('p_ = buffer + pos;')
+    w('pos += block;')
+    for group in msg['groups']:
+        var = snake(group['name'])
+        w()
+        w(f'if (len - pos < GroupSizeEncoding::ENCODED_LENGTH) return false;')
+        w(f'GroupSizeEncoding {var}_dim(buffer + pos);')
+        w(f'uint16_t {var}_stride = {var}_dim.block_length();')
+        w(f'uint16_t {var}_count = {var}_dim.num_in_group();')
+        w('pos += GroupSizeEncoding::ENCODED_LENGTH;')
+        w(f'if ({var}_count > 0 && {var}_stride < {pascal(group["name"])}::BLOCK_LENGTH) return false;')
+        w(f'if (static_cast<size_t>({var}_stride) * {var}_count > len - pos) return false;')
+        w(f'{var}_ = {pascal(group["name"])}(buffer + pos, {var}_stride, {var}_count);')
+        w(f'pos += static_cast<size_t>({var}_stride) * {var}_count;')
+    w('encoded_length_ = pos;')
+    w('return true;')
+    w.dedent()
+    w('}')
+    w()
+    w('// Bytes from the message header to the end of the last group')
+    w('size_t encoded_length() const { return encoded_length_; }')
+    w()
+    for field in msg['fields']:
+        emit_accessor(w, field)
+    for group in msg['groups']:
+        w(f'const {pascal(group["name"])}& {snake(group["name"])}() const {{ return {snake(group["name"])}_; }}')
+    w.dedent()
+    w()
+    w('private:')
+    w.indent()
+    w('const uint8_t* p_ = nullptr;')
+    w('size_t encoded_length_ = 0;')
+    for group in msg['groups']:
+        w(f'{pascal(group["name"])} {snake(group["name"])}_;')
+    w.dedent()
+    w('};')
+    w()
+
+
+def generate(schema, namespace):
+    w = Writer()
+    w(f'// Generated by tools/sbe_codegen.py from {schema.source}. Do not edit.')
+    w(f'// {schema.description}'.rstrip())
+    w('#pragma once')
+    w()
+    w('#include <cstddef>')
+    w('#include <cstdint>')
+    w('#include <cstring>')
+    w()
+    w(f'namespace {namespace} {{')
+    w()
+    w.indent()
+    w(f'constexpr uint16_t SCHEMA_ID = {schema.id};')
+    w(f'constexpr uint16_t SCHEMA_VERSION = {schema.version};')
+    w()
+    w('namespace detail {')
+    w.indent()
+    w('// Unaligned little endian load; compiles to a single mov on x86')
+    w('template <typename T>')
+    w('inline T load(const uint8_t* p) {')
+    w.indent()
+    w('T value;')
+    w('std::memcpy(&value, p, sizeof(T));')
+    w('return value;')
+    w.dedent()
+    w('}')
+    w.dedent()
+    w('}')
+    w()
+    for name in schema.order:
+        t = schema.types[name]
+        if t['kind'] == 'enum':
+            emit_enum(w, t)
+        else:
+            emit_composite(w, t)
+    for msg in schema.messages:
+        emit_message(w, msg)
+    w.dedent()
+    w('}')
+    return '\n'.join(w.lines) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate C++ SBE flyweights from an XML schema')
+    parser.add_argument('schema', help='SBE message schema (XML)')
+    parser.add_argument('output', help='Header to write')
+    parser.add_argument('--namespace', default='hft::sbe::coinbase', help='C++ namespace')
+    args = parser.parse_args()
+
+    try:
+        code = generate(Schema(args.schema), args.namespace)
+    except (SchemaError, ET.ParseError, TypeError, ValueError) as e:
+        print(f'{args.schema}: {e}', file=sys.stderr)
+        sys.exit(1)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, 'w') as f:
+        f.write(code)
+
+
+if __name__ == '__main__':
+    main()
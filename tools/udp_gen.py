@@ -1,34 +1,211 @@
 import socket
 import struct
 import time
+import random
 import argparse
 
-def send_traffic(ip, port, rate, duration):
+# Packets follow schema/coinbase_market_data.xml (SBE, little endian): a packetHeader, then
+# one or more messages. Content depends only on --seed, so two generators started with the
+# same seed and --start-at send byte-identical A and B lines (drops aside).
+SCHEMA_ID = 1
+SCHEMA_VERSION = 1
+
+MID = 9600000   # 96000.00 in cents (price exponent -2)
+DEPTH = 100     # Levels per side the synthetic book may hold
+
+
+def packet_header(seq, sending_ns):
+    # packetHeader: msgSeqNum(I), sendingTime(Q)
+    return struct.pack('<IQ', seq, sending_ns)
+
+
+def sbe_header(block_length, template_id):
+    # messageHeader: blockLength(H), templateId(H), schemaId(H), version(H)
+    return struct.pack('<HHHH', block_length, template_id, SCHEMA_ID, SCHEMA_VERSION)
+
+
+def book_update(transact_ns, levels):
+    # MDIncrementalRefreshBook (202): TransactTime(Q), MatchEventIndicator(B)
+    # NoMDEntries: groupSizeEncoding blockLength(H), numInGroup(H), then per entry
+    # Price(q b), Size(q b), SecurityID(i), RptSeq(I), Side(B), UpdateAction(B)
+    entry = struct.Struct('<qbqbiIBB')
+    msg = sbe_header(9, 202) + struct.pack('<QB', transact_ns, 0x80)
+    msg += struct.pack('<HH', entry.size, len(levels))
+    for price, price_exp, size, size_exp, rpt_seq, side, action in levels:
+        msg += entry.pack(price, price_exp, size, size_exp, 1, rpt_seq, side, action)
+    return msg
+
+
+def trade(transact_ns, price, price_exp, size, size_exp, rpt_seq, trade_id, aggressor):
+    # MDIncrementalRefreshTrade (203): TransactTime(Q), MatchEventIndicator(B)
+    # NoMDEntries: Price(q b), Size(q b), SecurityID(i), RptSeq(I), TradeID(Q), AggressorSide(B)
+    entry = struct.Struct('<qbqbiIQB')
+    msg = sbe_header(9, 203) + struct.pack('<QB', transact_ns, 0x80)
+    msg += struct.pack('<HH', entry.size, 1)
+    msg += entry.pack(price, price_exp, size, size_exp, 1, rpt_seq, trade_id, aggressor)
+    return msg
+
+
+def snapshot(transact_ns, last_rpt_seq, book):
+    # MDSnapshotFullRefresh (201): TransactTime(Q), SecurityID(i), LastRptSeq(I)
+    # NoMDEntries: Price(q b), Size(q b), Side(B)
+    entry = struct.Struct('<qbqbB')
+    msg = sbe_header(16, 201) + struct.pack('<QiI', transact_ns, 1, last_rpt_seq)
+    msg += struct.pack('<HH', entry.size, len(book))
+    for (side, price), size in sorted(book.items()):
+        msg += entry.pack(price, -2, size, -8, side)
+    return msg
+
+
+class SyntheticBook:
+    """Random level updates around a fixed mid; RptSeq counts every entry and trade."""
+
+    def __init__(self, seed):
+        self.rng = random.Random(seed)
+        self.levels = {}  # (side, price) -> size in 1e-8
+        self.rpt_seq = 0
+
+    def update(self):
+        side = self.rng.randint(0, 1)  # 0 = Buy, 1 = Sell
+        price = MID - self.rng.randint(1, DEPTH) if side == 0 else MID + self.rng.randint(1, DEPTH)
+        size = self.rng.randint(1, 500000000)
+        key = (side, price)
+        if key not in self.levels:
+            action = 0
+            self.levels[key] = size
+        elif self.rng.random() < 0.3:
+            action = 2
+            size = 0
+            del self.levels[key]
+        else:
+            action = 1
+            self.levels[key] = size
+        self.rpt_seq += 1
+        return (price, -2, size, -8, self.rpt_seq, side, action)
+
+    def trade(self, transact_ns, trade_id):
+        aggressor = self.rng.randint(0, 1)
+        price = MID + 1 if aggressor == 0 else MID - 1
+        self.rpt_seq += 1
+        return trade(transact_ns, price, -2, self.rng.randint(1, 100000000), -8, self.rpt_seq, trade_id, aggressor)
+
+
+class PcapWriter:
+    """Writes Ethernet/IPv4/UDP frames to a capture: pcapng if the name ends in .pcapng,
+    otherwise classic pcap with nanosecond timestamps."""
+
+    def __init__(self, path):
+        self.file = open(path, 'wb')
+        self.ng = path.endswith('.pcapng')
+        if self.ng:
+            # Section header: byte-order magic, version 1.0, unknown section length
+            self.block(0x0A0D0D0A, struct.pack('<IHHq', 0x1A2B3C4D, 1, 0, -1))
+            # Interface: Ethernet, no snaplen limit, if_tsresol = 10^-9
+            self.block(1, struct.pack('<HHI', 1, 0, 0) + struct.pack('<HHB3x', 9, 1, 9) + struct.pack('<HH', 0, 0))
+        else:
+            self.file.write(struct.pack('<IHHiIII', 0xa1b23c4d, 2, 4, 0, 0, 65535, 1))
+
+    def block(self, block_type, body):
+        body += b'\0' * (-len(body) % 4)
+        total = len(body) + 12
+        self.file.write(struct.pack('<II', block_type, total) + body + struct.pack('<I', total))
+
+    def write(self, ts_ns, ip, port, payload):
+        src = socket.inet_aton('10.0.0.1')
+        dst = socket.inet_aton(ip)
+        mac = bytes([0x01, 0x00, 0x5e]) + dst[1:] if dst[0] >= 224 else bytes(6)
+        udp = struct.pack('!HHHH', 40000, port, 8 + len(payload), 0) + payload
+        ip_header = struct.pack('!BBHHHBBH4s4s', 0x45, 0, 20 + len(udp), 0, 0x4000, 64, 17, 0, src, dst)
+        frame = mac + bytes([0x02, 0, 0, 0, 0, 0x01]) + struct.pack('!H', 0x0800) + ip_header + udp
+        if self.ng:
+            self.block(6, struct.pack('<IIIII', 0, ts_ns >> 32, ts_ns & 0xFFFFFFFF, len(frame), len(frame)) + frame)
+        else:
+            self.file.write(struct.pack('<IIII', ts_ns // 1000000000, ts_ns % 1000000000, len(frame), len(frame)) + frame)
+
+    def close(self):
+        self.file.close()
+
+
+def write_capture(args):
+    # Every line (port, port + 1, ...) carries each packet LINE_SKEW_NS after the previous
+    # line, with its own drops; snapshots go to --snapshot-port
+    LINE_SKEW_NS = 3000
+    writer = PcapWriter(args.pcap)
+    book = SyntheticBook(args.seed)
+    drop_rngs = [random.Random(None if args.drop_seed is None else args.drop_seed + line) for line in range(args.lines)]
+    base_ns = int((args.start_at if args.start_at else time.time()) * 1e9)
+    interval_ns = int(1e9 / args.rate)
+    total = int(args.rate * args.duration)
+
+    written = dropped = snapshots = 0
+    for seq in range(1, total + 1):
+        transact_ns = base_ns + (seq - 1) * interval_ns
+        packet = packet_header(seq, transact_ns)
+        packet += book_update(transact_ns, [book.update() for _ in range(args.entries)])
+        if args.trade_every and seq % args.trade_every == 0:
+            packet += book.trade(transact_ns, seq)
+
+        for line in range(args.lines):
+            if drop_rngs[line].random() < args.drop:
+                dropped += 1
+            else:
+                writer.write(transact_ns + line * LINE_SKEW_NS, args.ip, args.port + line, packet)
+                written += 1
+
+        if args.snapshot_port and seq % args.snapshot_every == 0:
+            snapshots += 1
+            writer.write(transact_ns + args.lines * LINE_SKEW_NS, args.ip, args.snapshot_port,
+                         packet_header(snapshots, transact_ns) + snapshot(transact_ns, book.rpt_seq, book.levels))
+
+    writer.close()
+    print(f"Wrote {written} packets on {args.lines} line(s) to {args.pcap}, dropped {dropped}, {snapshots} snapshots.")
+
+
+def send_traffic(args):
     sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-    
-    # SbeHeader: block_length(H), template_id(H), schema_id(H), version(H)
-    # template_id = 202
-    # block_length = 0 (for simplicity in this demo)
-    sbe_header = struct.pack('<HHHH', 0, 202, 1, 1)
-    
-    # MDEntry: price_mantissa(q), order_qty(I), price_exponent(b), side(B)
-    # price = 50000 * 10^-2 = 500.00
-    md_entry = struct.pack('<qIbB', 5000000, 100, -2, 1)
-    
-    packet = sbe_header + md_entry
-    
-    print(f"Sending traffic to {ip}:{port} for {duration} seconds at {rate} pps...")
-    
-    start_time = time.time()
-    count = 0
-    delay = 1.0 / rate
-    
-    while time.time() - start_time < duration:
-        sock.sendto(packet, (ip, port))
-        count += 1
-        time.sleep(delay)
-        
-    print(f"Sent {count} packets.")
+    book = SyntheticBook(args.seed)
+    drop_rng = random.Random(args.drop_seed)
+    target = (args.ip, args.port)
+    snapshot_target = (args.ip, args.snapshot_port) if args.snapshot_port else None
+
+    start = args.start_at if args.start_at else time.time()
+    base_ns = int(start * 1e9)
+    interval = 1.0 / args.rate
+    total = int(args.rate * args.duration)
+
+    print(f"Sending {total} packets to {args.ip}:{args.port} at {args.rate} pps "
+          f"({args.entries} entries per book update, drop {args.drop:.2%})...")
+
+    while time.time() < start:
+        time.sleep(0.001)
+
+    sent = dropped = snapshots = 0
+    for seq in range(1, total + 1):
+        # Virtual exchange clock: identical on every line
+        transact_ns = base_ns + int((seq - 1) * interval * 1e9)
+        packet = packet_header(seq, transact_ns)
+        packet += book_update(transact_ns, [book.update() for _ in range(args.entries)])
+        if args.trade_every and seq % args.trade_every == 0:
+            packet += book.trade(transact_ns, seq)
+
+        if drop_rng.random() < args.drop:
+            dropped += 1
+        else:
+            sock.sendto(packet, target)
+            sent += 1
+
+        if snapshot_target and seq % args.snapshot_every == 0:
+            snapshots += 1
+            sock.sendto(packet_header(snapshots, transact_ns) + snapshot(transact_ns, book.rpt_seq, book.levels),
+                        snapshot_target)
+
+        # Pace against the schedule, not the previous send, so lines stay in step
+        ahead = start + seq * interval - time.time()
+        if ahead > 0:
+            time.sleep(ahead)
+
+    print(f"Sent {sent} packets, dropped {dropped}, {snapshots} snapshots.")
+
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description='Generate UDP traffic for HFT engine benchmark')
@@ -36,7 +213,20 @@ if __name__ == "__main__":
     parser.add_argument('--port', type=int, default=1234, help='Target port')
     parser.add_argument('--rate', type=int, default=1000, help='Packets per second')
     parser.add_argument('--duration', type=int, default=10, help='Duration in seconds')
-    
+    parser.add_argument('--entries', type=int, default=4, help='Book entries per update message')
+    parser.add_argument('--trade-every', type=int, default=8, help='Append a trade message every N packets (0 = never)')
+    parser.add_argument('--seed', type=int, default=42, help='Content seed (same seed = same packets on A and B)')
+    parser.add_argument('--drop', type=float, default=0.0, help='Fraction of packets to drop at random')
+    parser.add_argument('--drop-seed', type=int, default=None, help='Seed for the drop decisions')
+    parser.add_argument('--start-at', type=float, default=0.0, help='Unix time to start (to start A and B in step)')
+    parser.add_argument('--snapshot-port', type=int, default=0, help='Also send book snapshots (template 201) here')
+    parser.add_argument('--snapshot-every', type=int, default=500, help='Packets between snapshots')
+    parser.add_argument('--pcap', type=str, default=None, help='Write a capture (.pcap or .pcapng) instead of sending')
+    parser.add_argument('--lines', type=int, default=1, help='With --pcap: lines on consecutive ports from --port')
+
     args = parser.parse_args()
-    
-    send_traffic(args.ip, args.port, args.rate, args.duration)
+
+    if args.pcap:
+        write_capture(args)
+    else:
+        send_traffic(args)